@@ -44,6 +44,41 @@ public:
     static constexpr double SERVER_TIMEOUT_S{
         SharedConfig::NETWORK_TICK_TIMESTEP_S * 2};
 
+    /** Our outgoing messages are batched and sent once per network tick.
+        If true, input changes are instead sent immediately, trading a few
+        extra packets for lower input latency. */
+    static constexpr bool SEND_INPUTS_IMMEDIATELY{true};
+
+    /** If true, our outgoing batches will be compressed when they're larger
+        than SharedConfig::BATCH_COMPRESSION_THRESHOLD.
+        Our batches are usually small, and the server must allocate a
+        decompression stream for each client that compresses, so this is off
+        by default. */
+    static constexpr bool COMPRESS_BATCHES{false};
+
+    //-------------------------------------------------------------------------
+    // Simulation
+    //-------------------------------------------------------------------------
+    /** How far, in chunks, from the player's chunk that tile map chunks are
+        kept in memory. Chunks further away than this are evicted.
+        Must be at least 1, since we request the chunks directly around the
+        player. Higher values avoid re-requesting chunks when the player
+        moves back and forth across a chunk boundary. */
+    static constexpr int CHUNK_EVICTION_RADIUS{2};
+
+    /** How long, in seconds, we'll hold onto a cached chunk while waiting for
+        the server to tell us if it's up to date. If the server doesn't
+        respond in time, we drop it and request the chunk again. */
+    static constexpr double CHUNK_REPLY_TIMEOUT_S{5};
+
+    /** The most bytes of chunks that we'll keep in the on-disk chunk cache.
+        When it grows past this, the least recently used chunks are deleted.
+        Cached chunks from other maps are always deleted. */
+    static constexpr std::size_t CHUNK_CACHE_MAX_BYTES{64 * 1024 * 1024};
+
+    /** How often, in seconds, we'll log each sim system's timings. */
+    static constexpr double SYSTEM_PROFILER_REPORT_PERIOD_S{30};
+
     //-------------------------------------------------------------------------
     // Renderer, User Interface
     //-------------------------------------------------------------------------
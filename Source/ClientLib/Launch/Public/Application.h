@@ -203,7 +203,8 @@ void Application::registerSimulationExtension()
 {
     SimulationExDependencies simulationDeps{simulation.getWorld(),
                                             userInterface.getEventDispatcher(),
-                                            network, spriteData};
+                                            network, spriteData,
+                                            simulation.getSystemProfiler()};
 
     simulation.setExtension(std::make_unique<T>(simulationDeps));
 }
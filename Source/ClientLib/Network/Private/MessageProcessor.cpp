@@ -4,13 +4,6 @@
 #include "DispatchMessage.h"
 #include "IMessageProcessorExtension.h"
 #include "ClientNetworkDefs.h"
-#include "ExplicitConfirmation.h"
-#include "ConnectionResponse.h"
-#include "MovementUpdate.h"
-#include "ChunkUpdate.h"
-#include "TileUpdate.h"
-#include "EntityInit.h"
-#include "EntityDelete.h"
 #include "Log.h"
 
 namespace AM
@@ -20,6 +13,8 @@ namespace Client
 MessageProcessor::MessageProcessor(EventDispatcher& inNetworkEventDispatcher)
 : networkEventDispatcher{inNetworkEventDispatcher}
 , playerEntity{entt::null}
+, movementUpdatePool{}
+, chunkUpdatePool{}
 {
 }
 
@@ -27,49 +22,17 @@ void MessageProcessor::processReceivedMessage(MessageType messageType,
                                               Uint8* messageBuffer,
                                               unsigned int messageSize)
 {
-    // Match the enum values to their event types.
-    switch (messageType) {
-        case MessageType::ExplicitConfirmation: {
-            handleExplicitConfirmation(messageBuffer, messageSize);
-            break;
-        }
-        case MessageType::ConnectionResponse: {
-            handleConnectionResponse(messageBuffer, messageSize);
-            break;
-        }
-        case MessageType::MovementUpdate: {
-            handleMovementUpdate(messageBuffer, messageSize);
-            break;
-        }
-        case MessageType::ChunkUpdate: {
-            dispatchMessageSharedPtr<ChunkUpdate>(messageBuffer, messageSize,
-                                                  networkEventDispatcher);
-            break;
-        }
-        case MessageType::TileUpdate: {
-            dispatchMessage<TileUpdate>(messageBuffer, messageSize,
-                                        networkEventDispatcher);
-            break;
-        }
-        case MessageType::EntityInit: {
-            dispatchMessage<EntityInit>(messageBuffer, messageSize,
-                                        networkEventDispatcher);
-
-            break;
-        }
-        case MessageType::EntityDelete: {
-            dispatchMessage<EntityDelete>(messageBuffer, messageSize,
-                                          networkEventDispatcher);
-            break;
-        }
-        default: {
-            // If we don't have a handler for this message type, pass it to
-            // the project.
-            if (extension != nullptr) {
-                extension->processReceivedMessage(messageType, messageBuffer,
-                                                  messageSize);
-            }
-        }
+    // Match the enum value to its message type and pass it to its handler.
+    bool wasHandled{ServerToClientMessages::dispatch(
+        messageType, [&]<typename T>(std::type_identity<T> type) {
+            handleMessage(type, messageBuffer, messageSize);
+        })};
+
+    // If we don't have a handler for this message type, pass it to the
+    // project.
+    if (!wasHandled && (extension != nullptr)) {
+        extension->processReceivedMessage(messageType, messageBuffer,
+                                          messageSize);
     }
 }
 
@@ -79,8 +42,9 @@ void MessageProcessor::setExtension(
     extension = std::move(inExtension);
 }
 
-void MessageProcessor::handleExplicitConfirmation(Uint8* messageBuffer,
-                                                  unsigned int messageSize)
+void MessageProcessor::handleMessage(std::type_identity<ExplicitConfirmation>,
+                                     Uint8* messageBuffer,
+                                     unsigned int messageSize)
 {
     // Deserialize the message.
     ExplicitConfirmation explicitConfirmation{};
@@ -93,12 +57,13 @@ void MessageProcessor::handleExplicitConfirmation(Uint8* messageBuffer,
     }
 }
 
-void MessageProcessor::handleMovementUpdate(Uint8* messageBuffer,
-                                            unsigned int messageSize)
+void MessageProcessor::handleMessage(std::type_identity<MovementUpdate>,
+                                     Uint8* messageBuffer,
+                                     unsigned int messageSize)
 {
-    // Deserialize the message.
+    // Deserialize the message into a recycled update.
     std::shared_ptr<MovementUpdate> movementUpdate{
-        std::make_shared<MovementUpdate>()};
+        movementUpdatePool.acquire()};
     Deserialize::fromBuffer(messageBuffer, messageSize, *movementUpdate);
 
     // Pull out the vector of entities.
@@ -139,8 +104,19 @@ void MessageProcessor::handleMovementUpdate(Uint8* messageBuffer,
     }
 }
 
-void MessageProcessor::handleConnectionResponse(Uint8* messageBuffer,
-                                                unsigned int messageSize)
+void MessageProcessor::handleMessage(std::type_identity<ChunkUpdate>,
+                                     Uint8* messageBuffer,
+                                     unsigned int messageSize)
+{
+    // Deserialize into a recycled update and push it into any subscribed
+    // queues.
+    dispatchMessagePooled<ChunkUpdate>(messageBuffer, messageSize,
+                                       chunkUpdatePool, networkEventDispatcher);
+}
+
+void MessageProcessor::handleMessage(std::type_identity<ConnectionResponse>,
+                                     Uint8* messageBuffer,
+                                     unsigned int messageSize)
 {
     // Deserialize the message.
     ConnectionResponse connectionResponse{};
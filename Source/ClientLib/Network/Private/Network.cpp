@@ -4,6 +4,7 @@
 #include "Config.h"
 #include "UserConfig.h"
 #include "NetworkStats.h"
+#include "CompressionDictionary.h"
 #include "IMessageProcessorExtension.h"
 #include "AMAssert.h"
 #include "Ignore.h"
@@ -21,12 +22,17 @@ Network::Network()
 , adjustmentIteration(0)
 , isApplyingTickAdjustment(false)
 , messagesSentSinceTick(0)
+, sendBatchBuffer(Peer::MAX_WIRE_SIZE)
+, sendBatchIndex(CLIENT_HEADER_SIZE)
+, batchCompressor(CompressionDictionary::get())
+, compressedBatchBuffer()
 , currentTickPtr(nullptr)
 , receiveThreadObj()
 , exitRequested(false)
 , headerRecBuffer(SERVER_HEADER_SIZE)
 , batchRecBuffer(SharedConfig::MAX_BATCH_SIZE)
-, decompressedBatchRecBuffer(SharedConfig::MAX_BATCH_SIZE)
+, batchDecompressor(CompressionDictionary::get())
+, fragmentBuffer()
 , netstatsLoggingEnabled(true)
 , ticksSinceNetstatsLog(0)
 {
@@ -36,6 +42,14 @@ Network::Network()
 
     // Init the timer to the current time.
     receiveTimer.updateSavedTime();
+
+    // If we'll be compressing, size the compressed buffer to fit the
+    // worst case.
+    if (Config::COMPRESS_BATCHES) {
+        compressedBatchBuffer.resize(
+            CLIENT_HEADER_SIZE
+            + ByteTools::compressBound(MAX_BATCH_PAYLOAD_SIZE));
+    }
 }
 
 Network::~Network()
@@ -67,8 +81,9 @@ bool Network::connect()
 void Network::tick()
 {
     if (!Config::RUN_OFFLINE) {
-        // Send a heartbeat if we need to.
+        // Queue a heartbeat if we need to, then send this tick's batch.
         sendHeartbeatIfNecessary();
+        sendBatch();
 
         // If it's time to log our network statistics, do so.
         if (netstatsLoggingEnabled) {
@@ -131,31 +146,65 @@ void Network::setMessageProcessorExtension(
     messageProcessor.setExtension(std::move(extension));
 }
 
-void Network::send(const BinaryBufferSharedPtr& message)
+void Network::sendBatch()
 {
+    // If we have no messages waiting, there's nothing to send.
+    std::size_t batchSize{sendBatchIndex - CLIENT_HEADER_SIZE};
+    if (batchSize == 0) {
+        return;
+    }
+
     if ((server == nullptr) || !(server->isConnected())) {
         LOG_FATAL("Tried to send while server is disconnected.");
     }
 
-    // Send the message.
-    NetworkResult result{server->send(message)};
-    if (result == NetworkResult::Success) {
-        messagesSentSinceTick++;
+    // If the batch is large enough to be worth compressing, compress it.
+    // Note: Every compressed batch is added to batchCompressor's stream, so
+    //       it must be sent.
+    Uint8* bufferToSend{sendBatchBuffer.data()};
+    bool isCompressed{
+        Config::COMPRESS_BATCHES
+        && (batchSize > SharedConfig::BATCH_COMPRESSION_THRESHOLD)};
+    if (isCompressed) {
+        batchSize = batchCompressor.compress(
+            (sendBatchBuffer.data() + CLIENT_HEADER_SIZE), batchSize,
+            (compressedBatchBuffer.data() + CLIENT_HEADER_SIZE),
+            (compressedBatchBuffer.size() - CLIENT_HEADER_SIZE));
+        bufferToSend = compressedBatchBuffer.data();
+    }
 
+    // Copy the adjustment iteration into the client header.
+    bufferToSend[ClientHeaderIndex::AdjustmentIteration] = adjustmentIteration;
+
+    // Fill in the batch size. If the batch is compressed, set the high bit.
+    Uint16 batchSizeField{static_cast<Uint16>(batchSize)};
+    if (isCompressed) {
+        batchSizeField |= (1U << 15);
+    }
+    ByteTools::write16(batchSizeField,
+                       (bufferToSend + ClientHeaderIndex::BatchSize));
+
+    // Send the batch.
+    unsigned int totalSize{
+        static_cast<unsigned int>(CLIENT_HEADER_SIZE + batchSize)};
+    NetworkResult result{server->send(bufferToSend, totalSize)};
+    if (result == NetworkResult::Success) {
         // Record the number of sent bytes.
-        NetworkStats::recordBytesSent(
-            static_cast<unsigned int>(message->size()));
+        NetworkStats::recordBytesSent(totalSize);
     }
     else {
         LOG_FATAL("Message send failed.");
     }
+
+    // Start a new batch.
+    sendBatchIndex = CLIENT_HEADER_SIZE;
 }
 
 void Network::sendHeartbeatIfNecessary()
 {
     // If we haven't sent any relevant messages since the last tick.
     if (messagesSentSinceTick == 0) {
-        // Send the heartbeat message.
+        // Queue the heartbeat message.
         serializeAndSend<Heartbeat>({*currentTickPtr});
     }
 
@@ -165,23 +214,29 @@ void Network::sendHeartbeatIfNecessary()
 int Network::pollForMessages()
 {
     while (!exitRequested) {
-        // Wait for a server header.
-        NetworkResult headerResult{server->receiveBytesWait(
-            headerRecBuffer.data(), SERVER_HEADER_SIZE)};
-
-        if (headerResult == NetworkResult::Success) {
-            processBatch();
+        // Wait for a batch, along with its server header.
+        // Note: The peer buffers everything that's available in one receive,
+        //       so this only touches the socket when its buffer runs out of
+        //       full batches.
+        Uint16 batchSize{0};
+        NetworkResult result{server->receiveFrameWait(
+            headerRecBuffer.data(), SERVER_HEADER_SIZE,
+            ServerHeaderIndex::BatchSize, batchRecBuffer.data(),
+            SharedConfig::MAX_BATCH_SIZE, batchSize)};
+
+        if (result == NetworkResult::Success) {
+            processBatch(batchSize);
         }
-        else if (headerResult == NetworkResult::Disconnected) {
+        else if (result == NetworkResult::Disconnected) {
             LOG_FATAL("Found server to be disconnected while trying to "
-                      "receive header.");
+                      "receive a batch.");
         }
     }
 
     return 0;
 }
 
-void Network::processBatch()
+void Network::processBatch(Uint16 batchSize)
 {
     // Start tracking the number of received bytes.
     unsigned int bytesReceived{SERVER_HEADER_SIZE};
@@ -190,37 +245,31 @@ void Network::processBatch()
     adjustIfNeeded(headerRecBuffer[ServerHeaderIndex::TickAdjustment],
                    headerRecBuffer[ServerHeaderIndex::AdjustmentIteration]);
 
-    /* Process the BatchSize header field. */
-    // Read the high bit of batchSize to tell whether the batch is compressed
-    // or not. If the high bit is set, the batch is compressed.
-    Uint16 batchSize{
+    // Read the high bit of the BatchSize field to tell whether the batch is
+    // compressed or not. If the high bit is set, the batch is compressed.
+    // Note: The peer already removed the high bit from batchSize.
+    Uint16 batchSizeField{
         ByteTools::read16(&(headerRecBuffer[ServerHeaderIndex::BatchSize]))};
-    bool batchIsCompressed{(batchSize & (1U << 15)) != 0};
-
-    // Reset the high bit of batchSize to get the real size.
-    batchSize &= ~(1U << 15);
+    bool batchIsCompressed{(batchSizeField & (1U << 15)) != 0};
 
     /* Process the batch, if it contains any data. */
     if (batchSize > 0) {
-        // Receive the expected bytes.
-        NetworkResult result{
-            server->receiveBytesWait(&(batchRecBuffer[0]), batchSize)};
-        if (result != NetworkResult::Success) {
-            LOG_INFO("Failed to receive expected bytes.");
-        }
-
         // Track the number of bytes we've received.
         bytesReceived += MESSAGE_HEADER_SIZE + batchSize;
 
         // If the payload is compressed, decompress it.
         Uint8* bufferToUse{&(batchRecBuffer[0])};
+        // Note: Every compressed batch must go through batchDecompressor,
+        //       to keep its history in sync with the server's.
         if (batchIsCompressed) {
-            batchSize = static_cast<Uint16>(
-                ByteTools::decompress(&(batchRecBuffer[0]), batchSize,
-                                      &(decompressedBatchRecBuffer[0]),
-                                      SharedConfig::MAX_BATCH_SIZE));
-
-            bufferToUse = &(decompressedBatchRecBuffer[0]);
+            std::size_t decompressedSize{0};
+            bufferToUse = batchDecompressor.decompress(
+                &(batchRecBuffer[0]), batchSize, decompressedSize);
+            if (bufferToUse == nullptr) {
+                LOG_FATAL("Error during stream decompression. Does "
+                          "CompressionDictionary.bin match the server's?");
+            }
+            batchSize = static_cast<Uint16>(decompressedSize);
         }
 
         // Process the messages.
@@ -231,10 +280,17 @@ void Network::processBatch()
             Uint16 messageSize{ByteTools::read16(
                 &(bufferToUse[bufferIndex + MessageHeaderIndex::Size]))};
 
-            messageProcessor.processReceivedMessage(
-                messageType,
-                &(bufferToUse[bufferIndex + MessageHeaderIndex::MessageStart]),
-                messageSize);
+            // If this is a piece of a larger message, accumulate it.
+            // Otherwise, process it.
+            Uint8* messageStart{
+                &(bufferToUse[bufferIndex + MessageHeaderIndex::MessageStart])};
+            if (messageType == MessageType::MessageFragment) {
+                processFragment(messageStart, messageSize);
+            }
+            else {
+                messageProcessor.processReceivedMessage(
+                    messageType, messageStart, messageSize);
+            }
 
             bufferIndex += MESSAGE_HEADER_SIZE + messageSize;
             AM_ASSERT((bufferIndex <= batchSize),
@@ -279,6 +335,42 @@ void Network::adjustIfNeeded(Sint8 receivedTickAdj, Uint8 receivedAdjIteration)
     }
 }
 
+void Network::processFragment(const Uint8* fragment, Uint16 fragmentSize)
+{
+    fragmentBuffer.insert(fragmentBuffer.end(), fragment,
+                          (fragment + fragmentSize));
+
+    // If we haven't received the full message header yet, wait for more.
+    if (fragmentBuffer.size() < MESSAGE_HEADER_SIZE) {
+        return;
+    }
+
+    // If we haven't received the full message yet, wait for more.
+    Uint16 messageSize{
+        ByteTools::read16(&(fragmentBuffer[MessageHeaderIndex::Size]))};
+    std::size_t totalSize{MESSAGE_HEADER_SIZE + messageSize};
+    if (fragmentBuffer.size() > totalSize) {
+        // A fragment ran past the end of its message, so we've lost track
+        // of the message boundaries. Drop the partial message.
+        LOG_ERROR("Received more fragment bytes than expected. %zu, %zu",
+                  fragmentBuffer.size(), totalSize);
+        fragmentBuffer.clear();
+        return;
+    }
+    else if (fragmentBuffer.size() < totalSize) {
+        return;
+    }
+
+    // The message is complete, process it.
+    MessageType messageType{static_cast<MessageType>(
+        fragmentBuffer[MessageHeaderIndex::MessageType])};
+    messageProcessor.processReceivedMessage(
+        messageType, &(fragmentBuffer[MessageHeaderIndex::MessageStart]),
+        messageSize);
+
+    fragmentBuffer.clear();
+}
+
 void Network::logNetworkStatistics()
 {
     // Dump the stats from the tracker.
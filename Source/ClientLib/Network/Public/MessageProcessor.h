@@ -2,8 +2,12 @@
 
 #include "BinaryBuffer.h"
 #include "MessageType.h"
+#include "MessageRegistry.h"
+#include "MessagePool.h"
+#include "DispatchMessage.h"
 #include "entt/fwd.hpp"
 #include <memory>
+#include <type_traits>
 
 namespace AM
 {
@@ -16,11 +20,16 @@ class IMessageProcessorExtension;
 /**
  * Processes received messages.
  *
+ * Messages are matched to their handlers at compile time, using the types in
+ * ServerToClientMessages (see MessageRegistry.h).
+ *
  * If the message is relevant to the network layer, it's passed to a matching
- * function that contains all of its handling logic.
+ * handleMessage() overload that contains all of its handling logic.
  *
  * If the message isn't relevant to the network layer, it's passed to a generic
- * function that pushes it straight down to the simulation layer.
+ * handleMessage() that pushes it straight down to the simulation layer.
+ *
+ * If the message isn't one of ours, it's passed to the project's extension.
  */
 class MessageProcessor
 {
@@ -50,17 +59,33 @@ private:
     // Handlers for messages relevant to the network layer.
     //-------------------------------------------------------------------------
     /** Pushes ExplicitConfirmation event. */
-    void handleExplicitConfirmation(Uint8* messageBuffer,
-                                    unsigned int messageSize);
+    void handleMessage(std::type_identity<ExplicitConfirmation>,
+                       Uint8* messageBuffer, unsigned int messageSize);
 
     /** Pushes ConnectionResponse event. */
-    void handleConnectionResponse(Uint8* messageBuffer,
-                                  unsigned int messageSize);
+    void handleMessage(std::type_identity<ConnectionResponse>,
+                       Uint8* messageBuffer, unsigned int messageSize);
 
     /** Pushes std::shared_ptr<const MovementUpdate> event. **/
-    void handleMovementUpdate(Uint8* messageBuffer, unsigned int messageSize);
+    void handleMessage(std::type_identity<MovementUpdate>,
+                       Uint8* messageBuffer, unsigned int messageSize);
+
+    /** Pushes std::shared_ptr<const ChunkUpdate> event. **/
+    void handleMessage(std::type_identity<ChunkUpdate>, Uint8* messageBuffer,
+                       unsigned int messageSize);
     //-------------------------------------------------------------------------
 
+    /**
+     * Pushes T event. Used for messages that don't need any network-layer
+     * handling.
+     */
+    template<typename T>
+    void handleMessage(std::type_identity<T>, Uint8* messageBuffer,
+                       unsigned int messageSize)
+    {
+        dispatchMessage<T>(messageBuffer, messageSize, networkEventDispatcher);
+    }
+
     /** The dispatcher for network events. Used to send events to the
         subscribed queues. */
     EventDispatcher& networkEventDispatcher;
@@ -69,6 +94,14 @@ private:
         message. */
     entt::entity playerEntity;
 
+    /** Reusable storage for received movement updates. Updates are recycled
+        once the movement systems are done with them. */
+    MessagePool<MovementUpdate> movementUpdatePool;
+
+    /** Reusable storage for received chunk updates. Updates are recycled
+        once ChunkUpdateSystem is done with them. */
+    MessagePool<ChunkUpdate> chunkUpdatePool;
+
     /** If non-nullptr, contains the project's message processing extension
         functions.
         Allows the project to provide message processing code and have it be
@@ -1,11 +1,15 @@
 #pragma once
 
+#include "Config.h"
 #include "SharedConfig.h"
 #include "NetworkDefs.h"
 #include "ClientNetworkDefs.h"
 #include "MessageProcessor.h"
+#include "StreamCompressor.h"
+#include "StreamDecompressor.h"
 #include "QueuedEvents.h"
 #include "Serialize.h"
+#include "MessageRegistry.h"
 #include "Peer.h"
 #include "Deserialize.h"
 #include "ByteTools.h"
@@ -47,15 +51,20 @@ public:
     bool connect();
 
     /**
-     * Updates accumulatedTime. If greater than the tick timestep and no
-     * messages have been sent since the last heartbeat, sends a message.
+     * If no messages have been sent since the last network tick, queues a
+     * heartbeat. Then, sends all of the queued messages as a batch.
      *
      * Also logs network statistics if it's time to do so.
      */
     void tick();
 
     /**
-     * Sends bytes over the network.
+     * Serializes the given message and adds it to the current batch.
+     * The batch is sent at the next network tick, or sooner if it fills up.
+     *
+     * If Config::SEND_INPUTS_IMMEDIATELY is true, InputChangeRequests
+     * are sent right away (along with anything else in the batch).
+     *
      * Errors if the server is disconnected.
      *
      * @param messageStruct  A structure that defines MESSAGE_TYPE and has an
@@ -101,29 +110,31 @@ public:
 
 private:
     /**
-     * Sends bytes over the network.
+     * Fills the header of and sends the batch in sendBatchBuffer, compressing
+     * it if configured to. Does nothing if the batch is empty.
      * Errors if the server is disconnected.
      */
-    void send(const BinaryBufferSharedPtr& message);
+    void sendBatch();
 
     /**
-     * If we haven't sent any messages since the last network tick, sends a
+     * If we haven't sent any messages since the last network tick, queues a
      * heartbeat.
      */
     void sendHeartbeatIfNecessary();
 
     /**
      * Thread function, started from connect().
-     * Tries to retrieve a message batch from the server.
-     * If successful, calls processBatch().
+     * Waits for message batches from the server.
+     * When one is received, calls processBatch().
      */
     int pollForMessages();
 
     /**
-     * Processes the received header and following batch.
-     * If any messages are expected, receives the messages.
+     * Processes the received header and batch.
+     *
+     * @param batchSize  The size of the batch in batchRecBuffer.
      */
-    void processBatch();
+    void processBatch(Uint16 batchSize);
 
     /**
      * Checks if we need to process the received adjustment, does so if
@@ -139,6 +150,13 @@ private:
      */
     void logNetworkStatistics();
 
+    /**
+     * Appends the given MessageFragment payload to fragmentBuffer. If the
+     * fragmented message is now complete, passes it to messageProcessor.
+     * If the fragments overrun the message, drops it.
+     */
+    void processFragment(const Uint8* fragment, Uint16 fragmentSize);
+
     std::shared_ptr<Peer> server;
 
     /** Deserializes messages, does any network-layer message handling, and
@@ -162,6 +180,33 @@ private:
         Used to determine if we need to heartbeat. */
     unsigned int messagesSentSinceTick;
 
+    /** The worst-case number of bytes that compression may add to a batch.
+        Matches LZ4_COMPRESSBOUND() for a MAX_WIRE_SIZE batch. */
+    static constexpr std::size_t COMPRESSION_OVERHEAD{
+        (Peer::MAX_WIRE_SIZE / 255) + 16};
+
+    /** The max number of message bytes that fit in a single batch.
+        If compression is enabled, leaves room for it to expand the batch. */
+    static constexpr std::size_t MAX_BATCH_PAYLOAD_SIZE{
+        Peer::MAX_WIRE_SIZE - CLIENT_HEADER_SIZE
+        - (Config::COMPRESS_BATCHES ? COMPRESSION_OVERHEAD : 0)};
+
+    /** Holds header and message data while we're putting the next batch
+        together. */
+    BinaryBuffer sendBatchBuffer;
+
+    /** The current end of the batch in sendBatchBuffer. */
+    std::size_t sendBatchIndex;
+
+    /** If Config::COMPRESS_BATCHES is true, compresses our batches as a
+        single stream. The server's Client holds the matching
+        StreamDecompressor. */
+    StreamCompressor batchCompressor;
+
+    /** If a batch is compressed, the compressed bytes will be written to and
+        sent from this buffer. */
+    BinaryBuffer compressedBatchBuffer;
+
     /** Pointer to the game's current tick. */
     const std::atomic<Uint32>* currentTickPtr;
 
@@ -179,9 +224,12 @@ private:
     /** Holds a received message batch while we pass its messages to
         MessageProcessor. */
     BinaryBuffer batchRecBuffer;
-    /** If a batch is compressed, it's decompressed into this buffer before
-        processing. */
-    BinaryBuffer decompressedBatchRecBuffer;
+    /** Decompresses the server's batch stream. If a batch is compressed,
+        it's decompressed into this object's ring buffer before processing. */
+    StreamDecompressor batchDecompressor;
+    /** Accumulates MessageFragment payloads until a full message has been
+        received. Holds the message's header, followed by its data. */
+    BinaryBuffer fragmentBuffer;
 
     /** The number of seconds we'll wait before logging our network
         statistics. */
@@ -200,43 +248,50 @@ private:
 template<typename T>
 void Network::serializeAndSend(const T& messageStruct)
 {
-    // Allocate the buffer.
-    std::size_t totalMessageSize{CLIENT_HEADER_SIZE + MESSAGE_HEADER_SIZE
-                                 + Serialize::measureSize(messageStruct)};
-    BinaryBufferSharedPtr messageBuffer{
-        std::make_shared<BinaryBuffer>(totalMessageSize)};
-
-    // Serialize the message struct into the buffer, leaving room for the
-    // headers.
-    std::size_t messageSize{Serialize::toBuffer(
-        messageBuffer->data(), messageBuffer->size(), messageStruct,
-        (CLIENT_HEADER_SIZE + MESSAGE_HEADER_SIZE))};
+    static_assert(NetworkMessage<T>,
+                  "Sent messages must declare a static constexpr MessageType "
+                  "MESSAGE_TYPE.");
 
     // Check that the message isn't too big.
-    // Note: We don't compress messages on this side, so we know the final
-    //       message size at this point.
-    if ((totalMessageSize > Peer::MAX_WIRE_SIZE)
-        || (messageSize > UINT16_MAX)) {
-        LOG_FATAL("Tried to send a too-large message. Size: %u, max: %u",
-                  totalMessageSize, Peer::MAX_WIRE_SIZE);
+    // Note: Fixed-size messages skip the measure pass.
+    std::size_t totalMessageSize{MESSAGE_HEADER_SIZE
+                                 + measureMessageSize(messageStruct)};
+    if (totalMessageSize > MAX_BATCH_PAYLOAD_SIZE) {
+        LOG_FATAL("Tried to send a too-large message. Size: %zu, max: %zu",
+                  totalMessageSize, MAX_BATCH_PAYLOAD_SIZE);
     }
 
-    // Copy the adjustment iteration into the client header.
-    messageBuffer->at(ClientHeaderIndex::AdjustmentIteration)
-        = adjustmentIteration;
+    // If the message won't fit in the current batch, send the batch.
+    if ((sendBatchIndex + totalMessageSize)
+        > (CLIENT_HEADER_SIZE + MAX_BATCH_PAYLOAD_SIZE)) {
+        sendBatch();
+    }
+
+    // Serialize the message struct into the batch, leaving room for the
+    // message header.
+    Uint8* messageHeader{sendBatchBuffer.data() + sendBatchIndex};
+    std::size_t messageSize{Serialize::toBuffer(
+        sendBatchBuffer.data(), sendBatchBuffer.size(), messageStruct,
+        (sendBatchIndex + MESSAGE_HEADER_SIZE))};
 
     // Copy the message type into the message header.
-    // TODO: Add a nice compile-time message if T doesn't define MESSAGE_TYPE.
-    messageBuffer->at(CLIENT_HEADER_SIZE + MessageHeaderIndex::MessageType)
+    messageHeader[MessageHeaderIndex::MessageType]
         = static_cast<Uint8>(T::MESSAGE_TYPE);
 
     // Copy the message size into the message header.
     ByteTools::write16(static_cast<Uint16>(messageSize),
-                       (messageBuffer->data() + CLIENT_HEADER_SIZE
-                        + MessageHeaderIndex::Size));
+                       (messageHeader + MessageHeaderIndex::Size));
 
-    // Send the message.
-    send(messageBuffer);
+    sendBatchIndex += (MESSAGE_HEADER_SIZE + messageSize);
+    messagesSentSinceTick++;
+
+    // If this is a latency-critical input, send it right away if we're
+    // configured to.
+    if constexpr (T::MESSAGE_TYPE == MessageType::InputChangeRequest) {
+        if (Config::SEND_INPUTS_IMMEDIATELY) {
+            sendBatch();
+        }
+    }
 }
 
 } // namespace Client
@@ -12,6 +12,7 @@
 #include "Config.h"
 #include "Log.h"
 #include <memory>
+#include <algorithm>
 
 namespace AM
 {
@@ -23,6 +24,7 @@ ChunkUpdateSystem::ChunkUpdateSystem(Simulation& inSimulation, World& inWorld,
 , world{inWorld}
 , network{inNetwork}
 , chunkUpdateQueue{network.getEventDispatcher()}
+, cachedChunks{}
 {
 }
 
@@ -31,8 +33,19 @@ void ChunkUpdateSystem::updateChunks()
     // Request chunk updates, if necessary.
     requestNeededUpdates();
 
+    // Request any chunks that finished loading from our cache.
+    requestLoadedChunks();
+
     // Process any received chunk updates.
     receiveAndApplyUpdates();
+
+    // Drop any cached chunks that the server never responded about.
+    expireCachedChunks();
+}
+
+void ChunkUpdateSystem::clearCachedChunks()
+{
+    cachedChunks.clear();
 }
 
 void ChunkUpdateSystem::requestNeededUpdates()
@@ -44,7 +57,9 @@ void ChunkUpdateSystem::requestNeededUpdates()
 
     // If we're flagged as needing to load all adjacent chunks, request them.
     if (registry.all_of<NeedsAdjacentChunks>(world.playerEntity)) {
-        requestAllInRangeChunks(currentPosition.asChunkPosition());
+        ChunkPosition currentChunk{currentPosition.asChunkPosition()};
+        requestAllInRangeChunks(currentChunk);
+        evictOutOfRangeChunks(currentChunk);
 
         registry.remove<NeedsAdjacentChunks>(world.playerEntity);
     }
@@ -56,6 +71,9 @@ void ChunkUpdateSystem::requestNeededUpdates()
         if (previousChunk != currentChunk) {
             // Request the chunks that we're now in range of.
             requestNewInRangeChunks(previousChunk, currentChunk);
+
+            // Free any chunks that we've moved far away from.
+            evictOutOfRangeChunks(currentChunk);
         }
     }
 }
@@ -82,12 +100,14 @@ void ChunkUpdateSystem::requestAllInRangeChunks(
             int chunkX{currentExtent.x + j};
             int chunkY{currentExtent.y + i};
 
-            chunkUpdateRequest.requestedChunks.emplace_back(chunkX, chunkY);
+            addChunkToRequest({chunkX, chunkY}, chunkUpdateRequest);
         }
     }
 
-    // Send the request.
-    network.serializeAndSend(chunkUpdateRequest);
+    // Send the request, if we added any chunks to it.
+    if (!(chunkUpdateRequest.requestedChunks.empty())) {
+        network.serializeAndSend(chunkUpdateRequest);
+    }
 }
 
 void ChunkUpdateSystem::requestNewInRangeChunks(
@@ -115,13 +135,126 @@ void ChunkUpdateSystem::requestNewInRangeChunks(
             ChunkPosition chunkPosition{chunkX, chunkY};
 
             if (!(previousExtent.containsPosition(chunkPosition))) {
-                chunkUpdateRequest.requestedChunks.emplace_back(chunkX, chunkY);
+                addChunkToRequest(chunkPosition, chunkUpdateRequest);
             }
         }
     }
 
-    // Send the request.
-    network.serializeAndSend(chunkUpdateRequest);
+    // Send the request, if we added any chunks to it.
+    if (!(chunkUpdateRequest.requestedChunks.empty())) {
+        network.serializeAndSend(chunkUpdateRequest);
+    }
+}
+
+void ChunkUpdateSystem::addChunkToRequest(
+    const ChunkPosition& chunkPosition, ChunkUpdateRequest& chunkUpdateRequest)
+{
+    // If we already have the chunk in memory, send its version.
+    if (const Chunk* chunk{world.tileMap.getChunk(chunkPosition)}) {
+        ChunkUpdateRequest::RequestedChunk& requestedChunk{
+            chunkUpdateRequest.requestedChunks.emplace_back()};
+        requestedChunk.position = chunkPosition;
+        requestedChunk.hasCachedVersion = true;
+        requestedChunk.cachedVersion = chunk->version;
+        return;
+    }
+
+    // Check our cache for the chunk. We'll request it once it's loaded.
+    world.chunkCache.requestLoad(chunkPosition);
+}
+
+void ChunkUpdateSystem::requestLoadedChunks()
+{
+    ChunkUpdateRequest chunkUpdateRequest{};
+    ChunkCache::LoadResult loadResult{};
+    while (world.chunkCache.popLoadResult(loadResult)) {
+        // If we moved away from the chunk or received it while it was
+        // loading, we don't need to request it.
+        const ChunkPosition& chunkPosition{loadResult.position};
+        if (!isInRange(chunkPosition)
+            || world.tileMap.hasChunk(chunkPosition)) {
+            continue;
+        }
+
+        ChunkUpdateRequest::RequestedChunk& requestedChunk{
+            chunkUpdateRequest.requestedChunks.emplace_back()};
+        requestedChunk.position = chunkPosition;
+
+        // If the chunk was in our cache, send its version and hold onto it
+        // until the server tells us whether it's up to date.
+        if (loadResult.succeeded) {
+            requestedChunk.hasCachedVersion = true;
+            requestedChunk.cachedVersion = loadResult.snapshot.version;
+
+            eraseCachedChunk(chunkPosition);
+            cachedChunks.push_back(
+                {std::move(loadResult.snapshot), simulation.getCurrentTick()});
+        }
+    }
+
+    // Send the request, if we added any chunks to it.
+    if (!(chunkUpdateRequest.requestedChunks.empty())) {
+        network.serializeAndSend(chunkUpdateRequest);
+    }
+}
+
+void ChunkUpdateSystem::expireCachedChunks()
+{
+    static constexpr Uint32 TIMEOUT_TICKS{static_cast<Uint32>(
+        Config::CHUNK_REPLY_TIMEOUT_S / SharedConfig::SIM_TICK_TIMESTEP_S)};
+
+    // Drop any cached chunks that timed out, and re-request them if we still
+    // need them.
+    // Note: The server may have dropped our request, so we can't rely on
+    //       eventually getting a response.
+    Uint32 currentTick{simulation.getCurrentTick()};
+    for (auto it = cachedChunks.begin(); it != cachedChunks.end();) {
+        if ((currentTick > it->requestTick)
+            && ((currentTick - it->requestTick) > TIMEOUT_TICKS)) {
+            ChunkPosition chunkPosition{it->snapshot.x, it->snapshot.y};
+            it = cachedChunks.erase(it);
+
+            // Note: The chunk will be requested once it's re-loaded.
+            if (isInRange(chunkPosition)
+                && !(world.tileMap.hasChunk(chunkPosition))) {
+                world.chunkCache.requestLoad(chunkPosition);
+            }
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+bool ChunkUpdateSystem::isInRange(const ChunkPosition& chunkPosition)
+{
+    Position& position{world.registry.get<Position>(world.playerEntity)};
+    return getKeepExtent(position.asChunkPosition())
+        .containsPosition(chunkPosition);
+}
+
+ChunkExtent
+    ChunkUpdateSystem::getKeepExtent(const ChunkPosition& currentChunk)
+{
+    static constexpr int RADIUS{Config::CHUNK_EVICTION_RADIUS};
+    static_assert(RADIUS >= 1,
+                  "Eviction radius must include the chunks that we request.");
+
+    return {(currentChunk.x - RADIUS), (currentChunk.y - RADIUS),
+            ((RADIUS * 2) + 1), ((RADIUS * 2) + 1)};
+}
+
+void ChunkUpdateSystem::evictOutOfRangeChunks(
+    const ChunkPosition& currentChunk)
+{
+    ChunkExtent keepExtent{getKeepExtent(currentChunk)};
+    world.tileMap.evictChunksOutside(keepExtent);
+
+    // We won't need any cached chunks that are out of range either.
+    std::erase_if(cachedChunks, [&](const CachedChunk& cachedChunk) {
+        return !(keepExtent.containsPosition(
+            {cachedChunk.snapshot.x, cachedChunk.snapshot.y}));
+    });
 }
 
 void ChunkUpdateSystem::receiveAndApplyUpdates()
@@ -129,10 +262,51 @@ void ChunkUpdateSystem::receiveAndApplyUpdates()
     // Process any received chunk updates.
     std::shared_ptr<const ChunkUpdate> receivedUpdate{nullptr};
     while (chunkUpdateQueue.pop(receivedUpdate)) {
-        // Apply all chunk snapshots from the update to our map.
+        // Apply all chunk snapshots from the update to our map, and save
+        // them to our cache.
         for (const ChunkWireSnapshot& chunk : receivedUpdate->chunks) {
             applyChunkSnapshot(chunk);
+            world.chunkCache.save(chunk);
+            eraseCachedChunk({chunk.x, chunk.y});
         }
+
+        // Our copies of the unchanged chunks are up to date. If they aren't
+        // in memory, apply our cached copies.
+        for (const ChunkPosition& chunkPosition :
+             receivedUpdate->unchangedChunks) {
+            auto cachedIt{findCachedChunk(chunkPosition)};
+            if (cachedIt != cachedChunks.end()) {
+                applyChunkSnapshot(cachedIt->snapshot);
+                cachedChunks.erase(cachedIt);
+            }
+            // If we sent the version of a chunk that was in memory, but it
+            // was evicted before this reply arrived, we need to request it
+            // again (if we still need it).
+            // Note: The chunk will be requested once it's loaded.
+            else if (!(world.tileMap.hasChunk(chunkPosition))
+                     && isInRange(chunkPosition)) {
+                world.chunkCache.requestLoad(chunkPosition);
+            }
+        }
+    }
+}
+
+std::vector<ChunkUpdateSystem::CachedChunk>::iterator
+    ChunkUpdateSystem::findCachedChunk(const ChunkPosition& chunkPosition)
+{
+    return std::find_if(cachedChunks.begin(), cachedChunks.end(),
+                        [&](const CachedChunk& cachedChunk) {
+                            return (cachedChunk.snapshot.x == chunkPosition.x)
+                                   && (cachedChunk.snapshot.y
+                                       == chunkPosition.y);
+                        });
+}
+
+void ChunkUpdateSystem::eraseCachedChunk(const ChunkPosition& chunkPosition)
+{
+    auto cachedIt{findCachedChunk(chunkPosition)};
+    if (cachedIt != cachedChunks.end()) {
+        cachedChunks.erase(cachedIt);
     }
 }
 
@@ -167,6 +341,9 @@ void ChunkUpdateSystem::applyChunkSnapshot(const ChunkWireSnapshot& chunk)
             tileIndex++;
         }
     }
+
+    // Match the server's version.
+    world.tileMap.setChunkVersion({chunk.x, chunk.y}, chunk.version);
 }
 
 } // namespace Client
@@ -35,6 +35,11 @@ Simulation::Simulation(EventDispatcher& inUiEventDispatcher, Network& inNetwork,
 , currentTick(0)
 , connectionResponseQueue(network.getEventDispatcher())
 , extension{nullptr}
+, systemProfiler{"Sim",
+                 Config::SYSTEM_PROFILER_REPORT_PERIOD_S,
+                 {"ChunkUpdateSystem", "TileUpdateSystem", "NpcLifetimeSystem",
+                  "PlayerInputSystem", "PlayerMovementSystem",
+                  "NpcMovementSystem", "CameraSystem"}}
 , chunkUpdateSystem(*this, world, network)
 , tileUpdateSystem(world, inUiEventDispatcher, network)
 , npcLifetimeSystem(*this, world, spriteData, network.getEventDispatcher())
@@ -81,6 +86,11 @@ void Simulation::connect()
     // Resize the world's tile map.
     world.tileMap.setMapSize(connectionResponse.mapXLengthChunks,
                              connectionResponse.mapYLengthChunks);
+
+    // Point our chunk cache at the server's map.
+    // Note: Any chunk requests from a previous connection won't be answered.
+    world.chunkCache.setMapID(connectionResponse.mapID);
+    chunkUpdateSystem.clearCachedChunks();
     world.worldSignals.tileMapExtentChanged.publish(
         world.tileMap.getTileExtent());
     LOG_INFO("Setting map size to: (%u, %u)ch.",
@@ -171,6 +181,8 @@ void Simulation::fakeConnection()
 
 void Simulation::tick()
 {
+    using ScopedTimer = SystemProfiler::ScopedTimer;
+
     /* Calculate what tick we should be on. */
     // Increment the tick to the next.
     Uint32 targetTick{currentTick + 1};
@@ -198,36 +210,58 @@ void Simulation::tick()
         }
 
         // Process chunk updates from the server.
-        chunkUpdateSystem.updateChunks();
+        {
+            ScopedTimer timer{systemProfiler, ProfiledSystem::ChunkUpdate};
+            chunkUpdateSystem.updateChunks();
+        }
 
         // Process tile updates from the UI and server.
-        tileUpdateSystem.updateTiles();
+        {
+            ScopedTimer timer{systemProfiler, ProfiledSystem::TileUpdate};
+            tileUpdateSystem.updateTiles();
+        }
 
         // Process entities that need to be constructed or destructed.
-        npcLifetimeSystem.processUpdates();
+        {
+            ScopedTimer timer{systemProfiler, ProfiledSystem::NpcLifetime};
+            npcLifetimeSystem.processUpdates();
+        }
 
         // Call the project's pre-movement logic.
         if (extension != nullptr) {
             extension->afterMapAndLifetimeUpdates();
         }
 
-        // Process the held user input state and send change requests to the
-        // server.
-        // Note: Mouse and momentary inputs are processed through our OS event
-        //       handling, prior to this tick.
-        playerInputSystem.processHeldInputs();
+        {
+            ScopedTimer timer{systemProfiler, ProfiledSystem::PlayerInput};
+
+            // Process the held user input state and send change requests to
+            // the server.
+            // Note: Mouse and momentary inputs are processed through our OS
+            //       event handling, prior to this tick.
+            playerInputSystem.processHeldInputs();
 
-        // Push the new input state into the player's history.
-        playerInputSystem.addCurrentInputsToHistory();
+            // Push the new input state into the player's history.
+            playerInputSystem.addCurrentInputsToHistory();
+        }
 
         // Process player movement.
-        playerMovementSystem.processMovement();
+        {
+            ScopedTimer timer{systemProfiler, ProfiledSystem::PlayerMovement};
+            playerMovementSystem.processMovement();
+        }
 
         // Process NPC movement.
-        npcMovementSystem.updateNpcs();
+        {
+            ScopedTimer timer{systemProfiler, ProfiledSystem::NpcMovement};
+            npcMovementSystem.updateNpcs();
+        }
 
         // Move all cameras to their new positions.
-        cameraSystem.moveCameras();
+        {
+            ScopedTimer timer{systemProfiler, ProfiledSystem::Camera};
+            cameraSystem.moveCameras();
+        }
 
         // Call the project's post-movement logic.
         if (extension != nullptr) {
@@ -236,6 +270,9 @@ void Simulation::tick()
 
         currentTick++;
     }
+
+    // If it's time to report our system timings, do so.
+    systemProfiler.update();
 }
 
 World& Simulation::getWorld()
@@ -275,5 +312,10 @@ void Simulation::setExtension(std::unique_ptr<ISimulationExtension> inExtension)
     extension = std::move(inExtension);
 }
 
+const SystemProfiler& Simulation::getSystemProfiler() const
+{
+    return systemProfiler;
+}
+
 } // namespace Client
 } // namespace AM
@@ -0,0 +1,322 @@
+#include "ChunkCache.h"
+#include "SpriteData.h"
+#include "ChunkSnapshot.h"
+#include "Serialize.h"
+#include "Paths.h"
+#include "Config.h"
+#include "Log.h"
+#include "bitsery/bitsery.h"
+#include "bitsery/adapter/buffer.h"
+#include "bitsery/traits/vector.h"
+#include "bitsery/traits/string.h"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <vector>
+
+namespace AM
+{
+namespace Client
+{
+/**
+ * The form that chunks are saved to the cache in.
+ */
+struct CachedChunk {
+    /** The chunk's version, see Chunk::version. */
+    Uint32 version{0};
+
+    /** The chunk's tiles, using string IDs for persistence. */
+    ChunkSnapshot snapshot{};
+};
+
+template<typename S>
+void serialize(S& serializer, CachedChunk& cachedChunk)
+{
+    serializer.value4b(cachedChunk.version);
+    serializer.object(cachedChunk.snapshot);
+}
+
+ChunkCache::ChunkCache(SpriteData& inSpriteData)
+: spriteData{inSpriteData}
+, cacheDirPath{}
+, jobs{}
+, results{}
+, fileThreadObj{}
+, exitRequested{false}
+{
+    // Start the file thread.
+    fileThreadObj = std::thread(&ChunkCache::processJobs, this);
+}
+
+ChunkCache::~ChunkCache()
+{
+    {
+        std::unique_lock lock{jobMutex};
+        exitRequested = true;
+    }
+    jobCondVar.notify_one();
+    fileThreadObj.join();
+}
+
+void ChunkCache::setMapID(Uint32 mapID)
+{
+    cacheDirPath = Paths::BASE_PATH + "ChunkCache/" + std::to_string(mapID)
+                   + "/";
+
+    // Make sure the directory exists. If we can't create it, run without
+    // the cache.
+    std::error_code errorCode{};
+    std::filesystem::create_directories(cacheDirPath, errorCode);
+    if (errorCode) {
+        LOG_INFO("Failed to create chunk cache directory, disabling cache: "
+                 "%s",
+                 errorCode.message().c_str());
+        cacheDirPath.clear();
+        return;
+    }
+
+    // Clean out anything we no longer need.
+    pushJob({FileJob::Type::Prune, {}, cacheDirPath, {}});
+}
+
+void ChunkCache::requestLoad(const ChunkPosition& chunkPosition)
+{
+    // If the cache is disabled, fail the load without bothering the thread.
+    if (cacheDirPath.empty()) {
+        std::unique_lock lock{resultMutex};
+        results.push({chunkPosition, "", false, {}});
+        return;
+    }
+
+    pushJob({FileJob::Type::Load, chunkPosition,
+             getChunkFilePath(chunkPosition), {}});
+}
+
+bool ChunkCache::popLoadResult(LoadResult& outResult)
+{
+    FileResult fileResult{};
+    {
+        std::unique_lock lock{resultMutex};
+        if (results.empty()) {
+            return false;
+        }
+
+        fileResult = std::move(results.front());
+        results.pop();
+    }
+
+    outResult.position = fileResult.position;
+    outResult.succeeded = false;
+    if (!(fileResult.succeeded)) {
+        return true;
+    }
+
+    // Deserialize the chunk.
+    // Note: We use bitsery directly instead of Deserialize, since a bad
+    //       cache file isn't an error.
+    CachedChunk cachedChunk{};
+    std::pair<bitsery::ReaderError, bool> result{
+        bitsery::quickDeserialization<
+            bitsery::InputBufferAdapter<const Uint8*>>(
+            {fileResult.bytes.data(), fileResult.bytes.size()}, cachedChunk)};
+    if (!(result.second)) {
+        pushJob({FileJob::Type::Remove, fileResult.position,
+                 fileResult.filePath, {}});
+        return true;
+    }
+
+    // Convert the palette's string IDs to numeric IDs.
+    ChunkWireSnapshot& snapshot{outResult.snapshot};
+    snapshot.palette.clear();
+    for (const std::string& stringID : cachedChunk.snapshot.palette) {
+        const Sprite* sprite{spriteData.find(stringID)};
+        if (sprite == nullptr) {
+            pushJob({FileJob::Type::Remove, fileResult.position,
+                     fileResult.filePath, {}});
+            return true;
+        }
+        snapshot.palette.push_back(sprite->numericID);
+    }
+
+    snapshot.x = static_cast<Uint16>(fileResult.position.x);
+    snapshot.y = static_cast<Uint16>(fileResult.position.y);
+    snapshot.version = cachedChunk.version;
+    snapshot.tiles = cachedChunk.snapshot.tiles;
+
+    outResult.succeeded = true;
+    return true;
+}
+
+void ChunkCache::save(const ChunkWireSnapshot& chunkSnapshot)
+{
+    if (cacheDirPath.empty()) {
+        return;
+    }
+
+    // Convert the palette's numeric IDs to string IDs.
+    CachedChunk cachedChunk{};
+    cachedChunk.version = chunkSnapshot.version;
+    for (int numericID : chunkSnapshot.palette) {
+        cachedChunk.snapshot.palette.push_back(
+            spriteData.getStringID(numericID));
+    }
+    cachedChunk.snapshot.tiles = chunkSnapshot.tiles;
+
+    // Serialize the chunk and queue it to be written to its file.
+    FileJob job{};
+    job.type = FileJob::Type::Save;
+    job.position = {chunkSnapshot.x, chunkSnapshot.y};
+    job.filePath = getChunkFilePath(job.position);
+    job.bytes.resize(Serialize::measureSize(cachedChunk));
+    Serialize::toBuffer(job.bytes.data(), job.bytes.size(), cachedChunk);
+
+    pushJob(std::move(job));
+}
+
+std::string
+    ChunkCache::getChunkFilePath(const ChunkPosition& chunkPosition) const
+{
+    return cacheDirPath + std::to_string(chunkPosition.x) + "_"
+           + std::to_string(chunkPosition.y) + ".bin";
+}
+
+void ChunkCache::pushJob(FileJob&& job)
+{
+    {
+        std::unique_lock lock{jobMutex};
+        jobs.push(std::move(job));
+    }
+    jobCondVar.notify_one();
+}
+
+void ChunkCache::processJobs()
+{
+    tracy::SetThreadName("ChunkCache");
+
+    while (true) {
+        // Wait until there's a job to do.
+        // Note: We finish any queued jobs before exiting, so that saves
+        //       aren't lost.
+        FileJob job{};
+        {
+            std::unique_lock lock{jobMutex};
+            jobCondVar.wait(lock, [this] {
+                return (exitRequested || !(jobs.empty()));
+            });
+            if (jobs.empty()) {
+                break;
+            }
+
+            job = std::move(jobs.front());
+            jobs.pop();
+        }
+
+        switch (job.type) {
+            case FileJob::Type::Load: {
+                // Read the file's contents and pass them back to the sim.
+                FileResult result{job.position, std::move(job.filePath),
+                                  false, {}};
+                std::ifstream file(result.filePath, std::ios::binary);
+                if (file.is_open()) {
+                    result.bytes.assign(std::istreambuf_iterator<char>(file),
+                                        std::istreambuf_iterator<char>());
+                    result.succeeded = true;
+
+                    // Mark the file as recently used, so pruning keeps it.
+                    std::error_code errorCode{};
+                    std::filesystem::last_write_time(
+                        result.filePath,
+                        std::filesystem::file_time_type::clock::now(),
+                        errorCode);
+                }
+
+                std::unique_lock lock{resultMutex};
+                results.push(std::move(result));
+                break;
+            }
+            case FileJob::Type::Save: {
+                std::ofstream file(job.filePath,
+                                   std::ios::binary | std::ios::trunc);
+                if (file.is_open()) {
+                    file.write(reinterpret_cast<const char*>(job.bytes.data()),
+                               job.bytes.size());
+                }
+                break;
+            }
+            case FileJob::Type::Remove: {
+                std::error_code errorCode{};
+                std::filesystem::remove(job.filePath, errorCode);
+                break;
+            }
+            case FileJob::Type::Prune: {
+                pruneCache(job.filePath);
+                break;
+            }
+        }
+    }
+}
+
+void ChunkCache::pruneCache(const std::string& keepDirPath)
+{
+    namespace fs = std::filesystem;
+    std::error_code errorCode{};
+
+    // Delete any other maps' directories.
+    // Note: We iterate manually so that errors don't throw on this thread.
+    fs::path keepDir{fs::path{keepDirPath}.parent_path()};
+    for (fs::directory_iterator it{keepDir.parent_path(), errorCode};
+         !errorCode && (it != fs::directory_iterator{});
+         it.increment(errorCode)) {
+        if (it->path().filename() != keepDir.filename()) {
+            std::error_code removeError{};
+            fs::remove_all(it->path(), removeError);
+        }
+    }
+
+    // Gather this map's chunk files.
+    struct CachedFile {
+        fs::path path{};
+        fs::file_time_type lastUsed{};
+        std::uintmax_t size{0};
+    };
+    std::vector<CachedFile> files{};
+    std::uintmax_t totalBytes{0};
+    errorCode.clear();
+    for (fs::directory_iterator it{keepDir, errorCode};
+         !errorCode && (it != fs::directory_iterator{});
+         it.increment(errorCode)) {
+        std::error_code timeError{};
+        std::error_code sizeError{};
+        CachedFile file{it->path(), it->last_write_time(timeError),
+                        it->file_size(sizeError)};
+        if (!timeError && !sizeError) {
+            totalBytes += file.size;
+            files.push_back(file);
+        }
+    }
+
+    // If we're over the limit, delete the least recently used files until
+    // we're back under it.
+    if (totalBytes <= Config::CHUNK_CACHE_MAX_BYTES) {
+        return;
+    }
+    std::sort(files.begin(), files.end(),
+              [](const CachedFile& a, const CachedFile& b) {
+                  return (a.lastUsed < b.lastUsed);
+              });
+    for (const CachedFile& file : files) {
+        if (totalBytes <= Config::CHUNK_CACHE_MAX_BYTES) {
+            break;
+        }
+        std::error_code removeError{};
+        if (fs::remove(file.path, removeError)) {
+            totalBytes -= file.size;
+        }
+    }
+
+    LOG_INFO("Pruned chunk cache to %ju bytes.", totalBytes);
+}
+
+} // End namespace Client
+} // End namespace AM
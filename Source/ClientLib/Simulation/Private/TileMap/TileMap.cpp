@@ -29,8 +29,10 @@ TileMap::TileMap(SpriteData& inSpriteData)
 
         // Fill every tile with a ground layer.
         const Sprite& ground{spriteData.get("test_6")};
-        for (Tile& tile : tiles) {
-            tile.spriteLayers.emplace_back(ground, BoundingBox{});
+        for (int y = 0; y < tileExtent.yLength; ++y) {
+            for (int x = 0; x < tileExtent.xLength; ++x) {
+                setTileSpriteLayer(x, y, 0, ground);
+            }
         }
 
         // Add some rugs to layer 1.
@@ -67,8 +69,30 @@ void TileMap::setMapSize(unsigned int inMapXLengthChunks,
     tileExtent.xLength = (chunkExtent.xLength * SharedConfig::CHUNK_WIDTH);
     tileExtent.yLength = (chunkExtent.yLength * SharedConfig::CHUNK_WIDTH);
 
-    // Resize the tiles vector to fit the map.
-    tiles.resize(tileExtent.xLength * tileExtent.yLength);
+    // Clear any chunks from the old map. The new map's chunks will be
+    // streamed in as they're needed.
+    chunks.clear();
+}
+
+void TileMap::evictChunksOutside(const ChunkExtent& keepExtent)
+{
+    std::erase_if(chunks, [&](const auto& chunkPair) {
+        unsigned int chunkIndex{chunkPair.first};
+        ChunkPosition chunkPosition{
+            static_cast<int>(chunkIndex % chunkExtent.xLength),
+            static_cast<int>(chunkIndex / chunkExtent.xLength)};
+        return !(keepExtent.containsPosition(chunkPosition));
+    });
+}
+
+void TileMap::setChunkVersion(const ChunkPosition& chunkPosition,
+                              Uint32 version)
+{
+    auto chunkIt{
+        chunks.find(linearizeChunkIndex(chunkPosition.x, chunkPosition.y))};
+    if (chunkIt != chunks.end()) {
+        chunkIt->second.version = version;
+    }
 }
 
 } // End namespace Client
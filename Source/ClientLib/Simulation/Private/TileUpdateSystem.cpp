@@ -1,6 +1,8 @@
 #include "TileUpdateSystem.h"
 #include "World.h"
 #include "Network.h"
+#include "TilePosition.h"
+#include "ChunkPosition.h"
 
 namespace AM
 {
@@ -40,10 +42,24 @@ void TileUpdateSystem::processNetworkUpdates()
     // Process any waiting tile updates from the server.
     TileUpdate tileUpdate;
     while (tileUpdateQueue.pop(tileUpdate)) {
+        // If we don't have the tile's chunk, skip it. We'll receive the
+        // updated tile when we receive the chunk.
+        TilePosition tilePosition{tileUpdate.tileX, tileUpdate.tileY};
+        if (!(world.tileMap.getTileExtent().containsPosition(tilePosition))
+            || !(world.tileMap.hasChunk(ChunkPosition{tilePosition}))) {
+            continue;
+        }
+
         // Update the map.
         world.tileMap.setTileSpriteLayer(tileUpdate.tileX, tileUpdate.tileY,
                                          tileUpdate.layerIndex,
                                          tileUpdate.numericID);
+
+        // Match the server's version for the chunk. Our local edit gave it
+        // a version from our own counter, which the server won't recognize
+        // when we later ask for the chunk using our cached copy.
+        world.tileMap.setChunkVersion(ChunkPosition{tilePosition},
+                                      tileUpdate.chunkVersion);
     }
 }
 
@@ -11,6 +11,7 @@ World::World(SpriteData& spriteData)
 : registry()
 , playerEntity(entt::null)
 , tileMap(spriteData)
+, chunkCache(spriteData)
 , mouseScreenPoint{}
 {
 }
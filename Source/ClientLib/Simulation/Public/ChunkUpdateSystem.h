@@ -2,8 +2,11 @@
 
 #include "QueuedEvents.h"
 #include "ChunkUpdate.h"
+#include "ChunkUpdateRequest.h"
 #include "ChunkPosition.h"
+#include "ChunkExtent.h"
 #include <SDL_stdinc.h>
+#include <vector>
 
 namespace AM
 {
@@ -16,7 +19,15 @@ class SpriteData;
 class TileMap;
 
 /**
- * Requests needed tile map chunk data, and applies received chunk updates.
+ * Requests needed tile map chunk data, applies received chunk updates, and
+ * evicts chunks that are far away from the player.
+ *
+ * When requesting a chunk that we have a copy of (either in memory or in our
+ * ChunkCache), we send our copy's version. If it's up to date, the server
+ * won't re-send it.
+ *
+ * Chunks that aren't in memory are first loaded from the cache (which
+ * happens on the cache's thread), then requested once the load finishes.
  */
 class ChunkUpdateSystem
 {
@@ -29,6 +40,13 @@ public:
      */
     void updateChunks();
 
+    /**
+     * Drops all of the cached chunks that are waiting on the server.
+     * Should be called when we (re-)connect, since requests from a previous
+     * connection won't be answered.
+     */
+    void clearCachedChunks();
+
 private:
     /**
      * Checks if we need new chunk data. If so, sends a ChunkUpdateRequest to
@@ -53,6 +71,47 @@ private:
     void requestNewInRangeChunks(const ChunkPosition& previousChunk,
                                  const ChunkPosition& currentChunk);
 
+    /**
+     * If we have the given chunk in memory, adds it to the given request
+     * along with its version. Otherwise, starts loading it from our cache.
+     * It'll be requested when the load finishes, see requestLoadedChunks().
+     */
+    void addChunkToRequest(const ChunkPosition& chunkPosition,
+                           ChunkUpdateRequest& chunkUpdateRequest);
+
+    /**
+     * Requests the chunks that finished loading from our cache, along with
+     * the version of our copy if we had one.
+     */
+    void requestLoadedChunks();
+
+    /**
+     * Drops any cached chunks that the server hasn't responded about within
+     * Config::CHUNK_REPLY_TIMEOUT_S, and re-requests them if we still need
+     * them.
+     */
+    void expireCachedChunks();
+
+    /**
+     * Returns true if the given chunk is within Config::CHUNK_EVICTION_RADIUS
+     * of the player's chunk.
+     */
+    bool isInRange(const ChunkPosition& chunkPosition);
+
+    /**
+     * Returns the extent of chunks that we keep in memory around the given
+     * chunk.
+     */
+    static ChunkExtent getKeepExtent(const ChunkPosition& currentChunk);
+
+    /**
+     * Removes any chunks that are further than Config::CHUNK_EVICTION_RADIUS
+     * from the given chunk from our tile map.
+     *
+     * @param currentChunk  The chunk that we are currently in.
+     */
+    void evictOutOfRangeChunks(const ChunkPosition& currentChunk);
+
     /**
      * Receives any waiting chunk updates from the queue and applies them
      * to our tile map.
@@ -64,6 +123,30 @@ private:
      */
     void applyChunkSnapshot(const ChunkWireSnapshot& chunk);
 
+    /**
+     * A chunk that we loaded from our cache, which is waiting on the server
+     * to tell us if it's up to date.
+     */
+    struct CachedChunk {
+        /** Our cached copy of the chunk. */
+        ChunkWireSnapshot snapshot{};
+
+        /** The tick that we requested the chunk on. */
+        Uint32 requestTick{0};
+    };
+
+    /**
+     * Returns the given chunk's element in cachedChunks, or end() if it isn't
+     * present.
+     */
+    std::vector<CachedChunk>::iterator
+        findCachedChunk(const ChunkPosition& chunkPosition);
+
+    /**
+     * Erases the given chunk from cachedChunks, if it's present.
+     */
+    void eraseCachedChunk(const ChunkPosition& chunkPosition);
+
     /** Used to get the current tick. */
     Simulation& simulation;
     /** Used to access the player entity and components. */
@@ -72,6 +155,10 @@ private:
     Network& network;
 
     EventQueue<std::shared_ptr<const ChunkUpdate>> chunkUpdateQueue;
+
+    /** Chunks that we loaded from our cache, which are waiting on the server
+        to tell us if they're up to date. */
+    std::vector<CachedChunk> cachedChunks;
 };
 
 } // namespace Client
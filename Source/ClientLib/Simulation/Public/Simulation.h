@@ -13,6 +13,7 @@
 #include "CameraSystem.h"
 #include "Timer.h"
 #include "ReplicationTickOffset.h"
+#include "SystemProfiler.h"
 #include <atomic>
 
 namespace AM
@@ -93,7 +94,29 @@ public:
      */
     void setExtension(std::unique_ptr<ISimulationExtension> inExtension);
 
+    /**
+     * Returns the profiler that times each of our systems.
+     */
+    const SystemProfiler& getSystemProfiler() const;
+
 private:
+    /**
+     * The systems that systemProfiler tracks.
+     * Note: Wrapped in a struct so the names don't collide with our
+     *       components, while still converting to an index.
+     */
+    struct ProfiledSystem {
+        enum Index : std::size_t {
+            ChunkUpdate,
+            TileUpdate,
+            NpcLifetime,
+            PlayerInput,
+            PlayerMovement,
+            NpcMovement,
+            Camera
+        };
+    };
+
     /** How long the sim should wait for the server to send a connection
         response, in microseconds. */
     static constexpr int CONNECTION_RESPONSE_WAIT_US = 1 * 1000 * 1000;
@@ -122,6 +145,9 @@ private:
         the appropriate time. */
     std::unique_ptr<ISimulationExtension> extension;
 
+    /** Times each of our systems. */
+    SystemProfiler systemProfiler;
+
     //-------------------------------------------------------------------------
     // Systems
     //-------------------------------------------------------------------------
@@ -3,6 +3,7 @@
 namespace AM
 {
 class EventDispatcher;
+class SystemProfiler;
 
 namespace Client
 {
@@ -23,6 +24,9 @@ public:
     Network& network;
 
     SpriteData& spriteData;
+
+    /** Holds the timings of the engine's sim systems. */
+    const SystemProfiler& systemProfiler;
 };
 
 } // namespace Client
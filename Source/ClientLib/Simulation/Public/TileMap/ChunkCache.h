@@ -0,0 +1,193 @@
+#pragma once
+
+#include "ChunkPosition.h"
+#include "ChunkWireSnapshot.h"
+#include "BinaryBuffer.h"
+#include "Tracy.hpp"
+#include <SDL_stdinc.h>
+#include <string>
+#include <queue>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+namespace AM
+{
+namespace Client
+{
+class SpriteData;
+
+/**
+ * A persistent, on-disk cache of the tile map chunks that we've received
+ * from the server.
+ *
+ * Lets us skip re-downloading chunks that haven't changed since we last saw
+ * them, even across reconnects. See ChunkUpdateRequest::RequestedChunk.
+ *
+ * Chunks are stored in ChunkCache/<mapID>/, next to the program binary.
+ * Sprites are saved using their string IDs, so the cache stays valid if
+ * the sprites' numeric IDs change.
+ *
+ * The cache is pruned whenever the map is set: other maps' chunks are
+ * deleted, and the least recently used chunks are deleted until we're within
+ * Config::CHUNK_CACHE_MAX_BYTES.
+ *
+ * File reads and writes happen on a separate thread, so that the sim doesn't
+ * block on them. Loads are requested with requestLoad(), and their results
+ * are collected with popLoadResult().
+ */
+class ChunkCache
+{
+public:
+    /**
+     * The result of a single chunk load.
+     */
+    struct LoadResult {
+        /** The position of the chunk that was loaded. */
+        ChunkPosition position{};
+
+        /** True if we had a valid cached copy of the chunk, else false. */
+        bool succeeded{false};
+
+        /** If succeeded == true, holds the loaded chunk. */
+        ChunkWireSnapshot snapshot{};
+    };
+
+    ChunkCache(SpriteData& inSpriteData);
+
+    /**
+     * Finishes any queued saves, then stops the file thread.
+     */
+    ~ChunkCache();
+
+    /**
+     * Sets the map that we're caching chunks for, creating its cache
+     * directory if necessary and queueing a prune of the cache.
+     *
+     * Until this is called, the cache is disabled.
+     */
+    void setMapID(Uint32 mapID);
+
+    /**
+     * Queues our cached copy of the given chunk to be loaded.
+     *
+     * If the cache is disabled, a failed result is immediately available.
+     */
+    void requestLoad(const ChunkPosition& chunkPosition);
+
+    /**
+     * If a load has finished, moves its result into outResult.
+     *
+     * If the cached copy failed to parse or uses sprites that we don't have,
+     * the result is marked as failed and the copy is deleted.
+     *
+     * @return true if a result was available, else false.
+     */
+    bool popLoadResult(LoadResult& outResult);
+
+    /**
+     * Queues the given chunk to be saved to the cache, replacing any
+     * existing copy.
+     */
+    void save(const ChunkWireSnapshot& chunkSnapshot);
+
+private:
+    /**
+     * A file operation for the file thread to perform.
+     */
+    struct FileJob {
+        enum class Type {
+            /** Read the file into a FileResult. */
+            Load,
+            /** Write bytes to the file. */
+            Save,
+            /** Delete the file. */
+            Remove,
+            /** Delete other maps' directories, and trim this map's
+                directory down to our size limit. */
+            Prune
+        };
+
+        Type type{Type::Load};
+
+        /** The position of the chunk that this job is for. */
+        ChunkPosition position{};
+
+        /** The path to the chunk's cache file.
+            If type == Prune, the path to the map's cache directory. */
+        std::string filePath{};
+
+        /** If type == Save, the bytes to write. */
+        BinaryBuffer bytes{};
+    };
+
+    /**
+     * The result of a Load job.
+     */
+    struct FileResult {
+        /** The position of the chunk that was loaded. */
+        ChunkPosition position{};
+
+        /** The path to the chunk's cache file. */
+        std::string filePath{};
+
+        /** True if the file was read, else false. */
+        bool succeeded{false};
+
+        /** If succeeded == true, the file's contents. */
+        BinaryBuffer bytes{};
+    };
+
+    /**
+     * Returns the path to the given chunk's cache file.
+     */
+    std::string getChunkFilePath(const ChunkPosition& chunkPosition) const;
+
+    /**
+     * Queues the given job for the file thread.
+     */
+    void pushJob(FileJob&& job);
+
+    /**
+     * Thread function, started from constructor.
+     * Waits for file jobs and performs them.
+     */
+    void processJobs();
+
+    /**
+     * Deletes every map directory in the cache except the given one, then
+     * deletes the given directory's least recently used chunks until it's
+     * within Config::CHUNK_CACHE_MAX_BYTES.
+     *
+     * Only called on the file thread.
+     */
+    void pruneCache(const std::string& keepDirPath);
+
+    /** Used to convert between numeric and string sprite IDs. */
+    SpriteData& spriteData;
+
+    /** The directory that we save chunks to. Empty if the cache is disabled.
+     */
+    std::string cacheDirPath;
+
+    /** Jobs that are waiting for the file thread. */
+    std::queue<FileJob> jobs;
+    /** Guards jobs. */
+    TracyLockable(std::mutex, jobMutex);
+    /** Used for signaling the file thread. */
+    std::condition_variable_any jobCondVar;
+
+    /** The results of finished Load jobs. */
+    std::queue<FileResult> results;
+    /** Guards results. */
+    TracyLockable(std::mutex, resultMutex);
+
+    /** Calls processJobs(). */
+    std::thread fileThreadObj;
+    /** Turn true to signal that the file thread should end. */
+    std::atomic<bool> exitRequested;
+};
+
+} // End namespace Client
+} // End namespace AM
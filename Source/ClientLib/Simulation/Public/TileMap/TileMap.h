@@ -1,6 +1,7 @@
 #pragma once
 
 #include "TileMapBase.h"
+#include "ChunkExtent.h"
 
 namespace AM
 {
@@ -10,9 +11,11 @@ class SpriteData;
 
 /**
  * Owns and manages the world's tile map state.
- * Tiles are conceptually organized into 16x16 chunks.
+ * Tiles are organized into 16x16 chunks.
  *
- * Tile map data is streamed from the server at runtime.
+ * Tile map data is streamed from the server at runtime. Only the chunks
+ * around the player are kept in memory, so our memory usage doesn't depend
+ * on the size of the server's map.
  */
 class TileMap : public TileMapBase
 {
@@ -25,10 +28,22 @@ public:
     TileMap(SpriteData& inSpriteData);
 
     /**
-     * Sets the size of the map and resizes the tiles vector.
+     * Sets the size of the map and clears any chunks that are in memory.
      */
     void setMapSize(unsigned int inMapXLengthChunks,
                     unsigned int inMapYLengthChunks);
+
+    /**
+     * Removes every chunk that isn't within the given extent from memory.
+     * The removed chunks' tiles will appear empty until they're re-added.
+     */
+    void evictChunksOutside(const ChunkExtent& keepExtent);
+
+    /**
+     * Sets the version of the given chunk, if it's in memory.
+     * Used to match the server's version after receiving the chunk.
+     */
+    void setChunkVersion(const ChunkPosition& chunkPosition, Uint32 version);
 };
 
 } // End namespace Client
@@ -2,6 +2,7 @@
 
 #include "WorldSignals.h"
 #include "TileMap.h"
+#include "ChunkCache.h"
 #include "ScreenPoint.h"
 
 #include "entt/entity/registry.hpp"
@@ -20,7 +21,7 @@ class SpriteData;
  *
  * The client's world state consists of:
  *   Map data
- *     See TileMap.h
+ *     See TileMap.h and ChunkCache.h
  *   Entity data
  *     Maintained at runtime in an ECS registry.
  *
@@ -45,6 +46,9 @@ public:
     /** The tile map that makes up the world. */
     TileMap tileMap;
 
+    /** Our on-disk cache of the tile map's chunks. */
+    ChunkCache chunkCache;
+
     /** The mouse's current position in screen space.
         Temporarily here, should be removed eventually. */
     ScreenPoint mouseScreenPoint;
@@ -6,6 +6,7 @@
 #else
 #include "SharedConfig.h"
 #include "ConstexprTools.h"
+#include "MetricsFormat.h"
 #include <SDL_stdinc.h>
 #include <string>
 
@@ -66,6 +67,25 @@ public:
     /** How often the world's tile map should be saved, in seconds. */
     static constexpr float MAP_SAVE_PERIOD_S{60 * 15};
 
+    /** The approximate amount of memory, in MB, that resident tile map chunks
+        may use before the least recently used ones are evicted. */
+    static constexpr std::size_t CHUNK_MEMORY_BUDGET_MB{512};
+
+    /** How far, in chunks, around each client entity that tile map chunks
+        are kept resident.
+        Should be larger than the range that clients request chunks in (1),
+        so that chunks are loaded before they're needed. */
+    static constexpr int CHUNK_RESIDENCY_RADIUS{2};
+
+    /** If >= 0, the sim thread will be pinned to this CPU core.
+        Only supported on Linux. */
+    static constexpr int SIM_THREAD_CPU_CORE{-1};
+
+    /** If > 0, the sim thread will be scheduled with SCHED_FIFO at this
+        real-time priority (1 - 99). Requires CAP_SYS_NICE.
+        Only supported on Linux. */
+    static constexpr int SIM_THREAD_FIFO_PRIORITY{0};
+
     //-------------------------------------------------------------------------
     // Network
     //-------------------------------------------------------------------------
@@ -111,6 +131,94 @@ public:
     /** The minimum number of fresh diffs we'll use to calculate an adjustment.
         Aims to prevent thrashing. */
     static constexpr unsigned int MIN_FRESH_DIFFS{3};
+
+    /** If compressing a client's batches of a given message mix has been
+        saving less than this fraction of their size, we'll stop compressing
+        them. */
+    static constexpr float COMPRESSION_MIN_SAVINGS{0.1f};
+
+    /** While we aren't compressing a message mix, we'll still compress every
+        Nth batch, to see if it's started compressing better. */
+    static constexpr unsigned int COMPRESSION_PROBE_INTERVAL{30};
+
+    /** The fraction of each network tick that the send thread must have
+        spare before we'll raise the compression level. If the spare time
+        drops below the lower bound, we'll lower the level. */
+    static constexpr double COMPRESSION_RAISE_SPARE_TIME{0.6};
+    static constexpr double COMPRESSION_LOWER_SPARE_TIME{0.3};
+
+    /** The number of consecutive network ticks that must have enough spare
+        time before we'll raise the compression level. Aims to prevent
+        thrashing. */
+    static constexpr unsigned int COMPRESSION_RAISE_TICKS{
+        SharedConfig::NETWORK_TICKS_PER_SECOND};
+
+    /** The maximum number of chunk data and bulk message bytes (before
+        compression) that we'll send to each client per network tick.
+        Messages past this are left queued and sent on later ticks. Sync and
+        lifetime messages are always sent, but count towards this limit. */
+    static constexpr std::size_t CLIENT_SEND_BYTES_PER_TICK{32 * 1024};
+
+    /** If a client's queued messages exceed this many bytes, we consider
+        them unable to keep up and disconnect them. Bounds the memory that a
+        slow connection can hold onto. */
+    static constexpr std::size_t CLIENT_SEND_QUEUE_LIMIT_BYTES{512 * 1024};
+
+    /** If more than this many MovementUpdates are waiting to be sent to a
+        client, we consider them behind and coalesce the updates. The sim
+        normally produces 1-2 per network tick, which are all sent so the
+        client can replay each tick. */
+    static constexpr std::size_t MOVEMENT_COALESCE_THRESHOLD{4};
+
+    /** The maximum number of message buffers that we'll keep around for
+        re-use. Buffers are recycled once they've been sent to the client. */
+    static constexpr std::size_t MESSAGE_BUFFER_POOL_SIZE{4096};
+
+    /** If a recycled message buffer's capacity is larger than this, we free
+        it instead of re-using it. Keeps occasional large messages from
+        pinning memory in the pool. */
+    static constexpr std::size_t MESSAGE_BUFFER_MAX_POOLED_BYTES{16 * 1024};
+
+    /** The maximum number of chunk bytes (before compression) that we'll send
+        to each client per sim tick. Chunks past this are sent on later ticks.
+        Multiple sim ticks may share a network batch, so this should leave
+        plenty of room in SharedConfig::MAX_BATCH_SIZE for other traffic
+        (e.g. movement updates). */
+    static constexpr std::size_t CHUNK_STREAMING_BYTES_PER_TICK{2000};
+
+    /** How far ahead, in seconds, we predict client movement when deciding
+        which of their requested chunks to send first. */
+    static constexpr float CHUNK_STREAMING_LOOKAHEAD_S{1};
+
+    //-------------------------------------------------------------------------
+    // Metrics
+    //-------------------------------------------------------------------------
+    /** The format that we'll write network metrics snapshots in. Snapshots
+        are written to Metrics.prom or Metrics.json, next to the executable.
+        If None, metrics are still tracked but aren't written. */
+    static constexpr MetricsFormat METRICS_FORMAT{MetricsFormat::Prometheus};
+
+    /** How often, in seconds, we'll write a metrics snapshot. */
+    static constexpr unsigned int METRICS_EXPORT_PERIOD_S{10};
+
+    /** Every Nth received InputChangeRequest is traced through the server's
+        pipeline. See InputLatencyMetrics. */
+    static constexpr unsigned int INPUT_LATENCY_SAMPLE_INTERVAL{8};
+
+    /** How often, in seconds, we'll log each sim system's timings. */
+    static constexpr double SYSTEM_PROFILER_REPORT_PERIOD_S{30};
+
+    /** How often, in seconds, we'll log the sim and network threads' tick
+        jitter. See TickThread. */
+    static constexpr double TICK_JITTER_REPORT_PERIOD_S{30};
+
+    /** If true, client connections, disconnections, and simulation-relevant
+        messages are recorded to InputTrace.bin, next to the executable.
+        The trace can be replayed into a fresh simulation by ReplayTest, to
+        benchmark the sim against real player behavior.
+        Only applies to the TCP Network, see Network's constructors.
+        See InputTrace.h. */
+    static constexpr bool RECORD_INPUT_TRACE{false};
 };
 
 } // End namespace Server
@@ -1,5 +1,6 @@
 #include "Application.h"
 #include "SharedConfig.h"
+#include "Config.h"
 #include "Log.h"
 
 #include "Tracy.hpp"
@@ -17,44 +18,37 @@ Application::Application()
 , userConfigInitializer()
 , spriteData()
 , network()
-, networkCaller(std::bind_front(&Network::tick, &network),
-                SharedConfig::NETWORK_TICK_TIMESTEP_S, "Network", true)
+, networkThread(std::bind_front(&Network::tick, &network),
+                SharedConfig::NETWORK_TICK_TIMESTEP_S, "ServerNetwork", true)
 , simulation(network, spriteData)
-, simCaller(std::bind_front(&Simulation::tick, &simulation),
-            SharedConfig::SIM_TICK_TIMESTEP_S, "Sim", false)
+, simThread(std::bind_front(&Simulation::tick, &simulation),
+            SharedConfig::SIM_TICK_TIMESTEP_S, "ServerSim", false)
 , exitRequested(false)
 {
     // Enable delay reporting.
-    simCaller.reportDelays(Simulation::SIM_DELAYED_TIME_S);
+    simThread.reportDelays(Simulation::SIM_DELAYED_TIME_S);
 }
 
 void Application::start()
 {
     tracy::SetThreadName("ServerMain");
 
-    LOG_INFO("Starting main loop.");
-
-    // Prime the timers so they don't start at 0.
-    simCaller.initTimer();
-    networkCaller.initTimer();
-    while (!exitRequested) {
-        // Let the simulation process an iteration if it needs to.
-        simCaller.update();
-
-        // Send any queued messages, if necessary.
-        networkCaller.update();
-
-        // See if we have enough time left to sleep.
-        double simTimeLeft{simCaller.getTimeTillNextCall()};
-        double networkTimeLeft{networkCaller.getTimeTillNextCall()};
-        if ((simTimeLeft > SLEEP_MINIMUM_TIME_S)
-            && (networkTimeLeft > SLEEP_MINIMUM_TIME_S)) {
-            // We have enough time to sleep for a few ms.
-            // Note: We try to delay for 1ms because the OS will generally end
-            //       up delaying us for 1-3ms.
-            SDL_Delay(1);
-        }
-    }
+    LOG_INFO("Starting sim and network threads.");
+
+    // Start ticking the sim and network.
+    // Note: The sim thread gets the configured affinity and priority, since
+    //       its tick timing matters the most.
+    TickThread::Settings simSettings{};
+    simSettings.cpuCore = Config::SIM_THREAD_CPU_CORE;
+    simSettings.fifoPriority = Config::SIM_THREAD_FIFO_PRIORITY;
+    simThread.start(simSettings);
+    networkThread.start(TickThread::Settings{});
+
+    // Wait until we're asked to exit.
+    exitRequested.wait(false);
+
+    simThread.stop();
+    networkThread.stop();
 }
 
 } // End namespace Server
@@ -0,0 +1,275 @@
+#include "TickThread.h"
+#include "Config.h"
+#include "Log.h"
+#include "Tracy.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
+
+namespace AM
+{
+namespace Server
+{
+TickThread::TickThread(std::function<void(void)> inTickFunct,
+                       double inTimestepS, std::string_view inDebugName,
+                       bool inSkipLateSteps)
+: tickFunct{std::move(inTickFunct)}
+, timestepS{inTimestepS}
+, timestep{std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(inTimestepS))}
+, debugName{inDebugName}
+, skipLateSteps{inSkipLateSteps}
+, delayedTimeS{0}
+, nextDeadline{}
+#if defined(__linux__)
+, timerFd{-1}
+#endif
+, jitterUs{}
+, maxJitterUs{0}
+, skippedTicks{0}
+, overranTicks{0}
+, lastJitterReportTime{}
+, tickThreadObj{}
+, exitRequested{false}
+{
+}
+
+TickThread::~TickThread()
+{
+    stop();
+}
+
+void TickThread::start(const Settings& settings)
+{
+    if (tickThreadObj.joinable()) {
+        LOG_ERROR("%s thread was already started.", debugName.c_str());
+        return;
+    }
+
+    exitRequested = false;
+    tickThreadObj = std::thread(&TickThread::threadLoop, this, settings);
+}
+
+void TickThread::stop()
+{
+    exitRequested = true;
+    if (tickThreadObj.joinable()) {
+        tickThreadObj.join();
+    }
+}
+
+void TickThread::reportDelays(double inDelayedTimeS)
+{
+    delayedTimeS = inDelayedTimeS;
+}
+
+void TickThread::threadLoop(Settings settings)
+{
+    tracy::SetThreadName(debugName.c_str());
+    applySettings(settings);
+
+    // Schedule our first deadline.
+    nextDeadline = std::chrono::steady_clock::now() + timestep;
+    lastJitterReportTime = std::chrono::steady_clock::now();
+
+#if defined(__linux__)
+    // Set up a periodic timer, starting at our first deadline.
+    // Note: steady_clock uses CLOCK_MONOTONIC on Linux, so their time points
+    //       are interchangeable.
+    timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (timerFd == -1) {
+        LOG_FATAL("Failed to create %s timer: %s", debugName.c_str(),
+                  std::strerror(errno));
+    }
+
+    auto toTimespec = [](std::chrono::steady_clock::duration duration) {
+        auto seconds{
+            std::chrono::duration_cast<std::chrono::seconds>(duration)};
+        auto nanoseconds{
+            std::chrono::duration_cast<std::chrono::nanoseconds>(duration
+                                                                 - seconds)};
+        return timespec{static_cast<time_t>(seconds.count()),
+                        static_cast<long>(nanoseconds.count())};
+    };
+    itimerspec timerSpec{};
+    timerSpec.it_value = toTimespec(nextDeadline.time_since_epoch());
+    timerSpec.it_interval = toTimespec(timestep);
+    if (timerfd_settime(timerFd, TFD_TIMER_ABSTIME, &timerSpec, nullptr)
+        == -1) {
+        LOG_FATAL("Failed to set %s timer: %s", debugName.c_str(),
+                  std::strerror(errno));
+    }
+#endif
+
+    while (!exitRequested) {
+        // Wait for our next deadline.
+        Uint64 passedDeadlines{waitForDeadline()};
+        auto wakeTime{std::chrono::steady_clock::now()};
+
+        // Record how late we woke up.
+        auto lateness{wakeTime - nextDeadline};
+        Uint64 latenessUs{static_cast<Uint64>(std::max<Sint64>(
+            0, std::chrono::duration_cast<std::chrono::microseconds>(lateness)
+                   .count()))};
+        jitterUs.record(latenessUs);
+        maxJitterUs = std::max(maxJitterUs, latenessUs);
+
+        // If we're late by multiple steps, either skip or catch up.
+        Uint64 tickCount{passedDeadlines};
+        if (passedDeadlines > 1) {
+            LOG_INFO("Detected a request for multiple %s ticks at once. Tick "
+                     "was delayed by: %.5fs.",
+                     debugName.c_str(),
+                     std::chrono::duration<double>(lateness).count());
+
+            if (skipLateSteps) {
+                skippedTicks += (passedDeadlines - 1);
+                tickCount = 1;
+            }
+        }
+        else if ((delayedTimeS > 0) && (latenessUs >= (delayedTimeS * 1e6))) {
+            LOG_INFO("%s tick missed its ideal call time. Tick was delayed by "
+                     "%.5fs.",
+                     debugName.c_str(),
+                     std::chrono::duration<double>(lateness).count());
+        }
+
+        // Run the ticks.
+        for (Uint64 i = 0; i < tickCount; ++i) {
+            auto tickStartTime{std::chrono::steady_clock::now()};
+            tickFunct();
+
+            double executionTime{std::chrono::duration<double>(
+                                     std::chrono::steady_clock::now()
+                                     - tickStartTime)
+                                     .count()};
+            if (executionTime > timestepS) {
+                LOG_INFO("%s overran its tick timestep. executionTime: %.5fs",
+                         debugName.c_str(), executionTime);
+                overranTicks++;
+            }
+        }
+
+        // Move to the next deadline. Deadlines stay on a fixed grid from our
+        // start time, so a late tick doesn't push the following ones back.
+        nextDeadline += (timestep * static_cast<Sint64>(passedDeadlines));
+
+        // If it's time to report our jitter, do so.
+        if (std::chrono::duration<double>(wakeTime - lastJitterReportTime)
+                .count()
+            >= Config::TICK_JITTER_REPORT_PERIOD_S) {
+            logJitter();
+            lastJitterReportTime = wakeTime;
+        }
+    }
+
+#if defined(__linux__)
+    close(timerFd);
+    timerFd = -1;
+#endif
+}
+
+void TickThread::applySettings(const Settings& settings)
+{
+#if defined(__linux__)
+    // Pin this thread to the given core.
+    if (settings.cpuCore >= 0) {
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        CPU_SET(settings.cpuCore, &cpuSet);
+        int result{
+            pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet)};
+        if (result != 0) {
+            LOG_WARNING("Failed to pin %s thread to CPU core %d: %s",
+                        debugName.c_str(), settings.cpuCore,
+                        std::strerror(result));
+        }
+        else {
+            LOG_INFO("Pinned %s thread to CPU core %d.", debugName.c_str(),
+                     settings.cpuCore);
+        }
+    }
+
+    // Give this thread real-time priority.
+    // Note: This requires CAP_SYS_NICE (or root).
+    if (settings.fifoPriority > 0) {
+        sched_param schedParam{};
+        schedParam.sched_priority = settings.fifoPriority;
+        int result{
+            pthread_setschedparam(pthread_self(), SCHED_FIFO, &schedParam)};
+        if (result != 0) {
+            LOG_WARNING("Failed to set %s thread to SCHED_FIFO priority %d: "
+                        "%s",
+                        debugName.c_str(), settings.fifoPriority,
+                        std::strerror(result));
+        }
+        else {
+            LOG_INFO("Set %s thread to SCHED_FIFO priority %d.",
+                     debugName.c_str(), settings.fifoPriority);
+        }
+    }
+#else
+    if ((settings.cpuCore >= 0) || (settings.fifoPriority > 0)) {
+        LOG_WARNING("%s thread settings are only supported on Linux. "
+                    "Ignoring them.",
+                    debugName.c_str());
+    }
+#endif
+}
+
+Uint64 TickThread::waitForDeadline()
+{
+#if defined(__linux__)
+    // Block until the timer fires. It gives us the number of expirations
+    // since our last read.
+    Uint64 expirations{0};
+    while (read(timerFd, &expirations, sizeof(expirations)) == -1) {
+        if (errno != EINTR) {
+            LOG_FATAL("Failed to read %s timer: %s", debugName.c_str(),
+                      std::strerror(errno));
+        }
+    }
+
+    return expirations;
+#else
+    std::this_thread::sleep_until(nextDeadline);
+
+    // Count how many deadlines have passed.
+    auto lateness{std::chrono::steady_clock::now() - nextDeadline};
+    return static_cast<Uint64>(1 + std::max<Sint64>(0, lateness / timestep));
+#endif
+}
+
+void TickThread::logJitter()
+{
+    Histogram::Snapshot snapshot{jitterUs.getSnapshot()};
+    if (snapshot.count == 0) {
+        return;
+    }
+
+    LOG_INFO("%s tick jitter (us) mean: %llu, p50: <=%llu, p99: <=%llu, "
+             "max: %llu. Skipped ticks: %llu, overran ticks: %llu",
+             debugName.c_str(),
+             static_cast<unsigned long long>(snapshot.sum / snapshot.count),
+             static_cast<unsigned long long>(snapshot.getPercentile(0.5)),
+             static_cast<unsigned long long>(snapshot.getPercentile(0.99)),
+             static_cast<unsigned long long>(maxJitterUs),
+             static_cast<unsigned long long>(skippedTicks),
+             static_cast<unsigned long long>(overranTicks));
+
+    jitterUs.reset();
+    maxJitterUs = 0;
+    skippedTicks = 0;
+    overranTicks = 0;
+}
+
+} // End namespace Server
+} // End namespace AM
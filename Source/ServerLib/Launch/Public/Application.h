@@ -4,7 +4,7 @@
 #include "Network.h"
 #include "Simulation.h"
 #include "SpriteData.h"
-#include "PeriodicCaller.h"
+#include "TickThread.h"
 #include "SDLNetInitializer.h"
 #include "IMessageProcessorExtension.h"
 #include "MessageProcessorExDependencies.h"
@@ -26,8 +26,8 @@ namespace Server
  * The start of all server application activity. Owns all of the application's
  * modules (Simulation, Network, etc).
  *
- * Also manages the main thread's loop, calling each module's update function
- * when appropriate.
+ * The simulation and network are each ticked on their own thread. The main
+ * thread waits until the application exits.
  */
 class Application
 {
@@ -35,7 +35,7 @@ public:
     Application();
 
     /**
-     * Begins the application. Assumes control of the thread until the
+     * Begins the application. Blocks the calling thread until the
      * application exits.
      */
     void start();
@@ -64,13 +64,6 @@ public:
     void registerSimulationExtension();
 
 private:
-    /** The minimum "time to next call" required to trigger a main loop sleep.
-        We sleep for 1ms when possible to reduce our CPU usage. We can't trust
-        the scheduler to come back to us after exactly 1ms though, so we busy
-        wait if something needs to be called soon.
-        Higher value == more CPU usage. */
-    static constexpr double SLEEP_MINIMUM_TIME_S = .003;
-
     //-------------------------------------------------------------------------
     // SDL Objects
     //-------------------------------------------------------------------------
@@ -79,7 +72,7 @@ private:
     SDLNetInitializer sdlNetInit;
 
     //-------------------------------------------------------------------------
-    // Modules, Dependencies, PeriodicCallers
+    // Modules, Dependencies, TickThreads
     //-------------------------------------------------------------------------
     UserConfigInitializer userConfigInitializer;
 
@@ -87,14 +80,14 @@ private:
 
     Network network;
     /** Calls network.tick() at the network tick rate. */
-    PeriodicCaller networkCaller;
+    TickThread networkThread;
 
     Simulation simulation;
     /** Calls simulation.tick() at the sim tick rate. */
-    PeriodicCaller simCaller;
+    TickThread simThread;
 
     //-------------------------------------------------------------------------
-    // Additional, used during the loop
+    // Additional
     //-------------------------------------------------------------------------
     /** Flags when to end the application. */
     std::atomic<bool> exitRequested;
@@ -113,8 +106,10 @@ void Application::registerMessageProcessorExtension()
 template<typename T>
 void Application::registerSimulationExtension()
 {
-    SimulationExDependencies simulationDeps{simulation.getWorld(), network,
-                                            spriteData};
+    World& world{simulation.getWorld()};
+    SimulationExDependencies simulationDeps{world, world.tileMap, network,
+                                            spriteData,
+                                            simulation.getSystemProfiler()};
 
     simulation.setExtension(std::make_unique<T>(simulationDeps));
 }
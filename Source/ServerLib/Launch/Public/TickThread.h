@@ -0,0 +1,151 @@
+#pragma once
+
+#include "Histogram.h"
+#include <SDL_stdinc.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace AM
+{
+namespace Server
+{
+/**
+ * Calls a function at a fixed time step, on its own thread.
+ *
+ * Unlike PeriodicCaller, this doesn't need to be fed by a loop. Ticks are
+ * scheduled against absolute deadlines (start time + N * timestep), so late
+ * wake-ups don't accumulate into drift. On Linux, we wait on a periodic
+ * timerfd. Elsewhere, we sleep until the next deadline.
+ *
+ * The time between each deadline and when we actually woke up is recorded
+ * as jitter, and periodically logged.
+ */
+class TickThread
+{
+public:
+    /**
+     * Scheduling settings for the thread. Only supported on Linux.
+     */
+    struct Settings {
+        /** If >= 0, the thread will be pinned to this CPU core. */
+        int cpuCore{-1};
+
+        /** If > 0, the thread will be scheduled with SCHED_FIFO at this
+            priority (1 - 99). */
+        int fifoPriority{0};
+    };
+
+    /**
+     * See associated members for descriptions.
+     */
+    TickThread(std::function<void(void)> inTickFunct, double inTimestepS,
+               std::string_view inDebugName, bool inSkipLateSteps);
+
+    /**
+     * Stops the thread, if it's running.
+     */
+    ~TickThread();
+
+    /**
+     * Starts the thread. The first tick will happen one timestep from now.
+     */
+    void start(const Settings& settings);
+
+    /**
+     * Signals the thread to exit and waits for it to finish its current tick.
+     */
+    void stop();
+
+    /**
+     * Enables reporting of ticks that are late by delayedTimeS or more
+     * seconds.
+     * Must be called before start().
+     */
+    void reportDelays(double inDelayedTimeS);
+
+private:
+    /**
+     * The thread's loop. Waits for each deadline and calls tickFunct.
+     */
+    void threadLoop(Settings settings);
+
+    /**
+     * Applies the given settings to the calling thread.
+     */
+    void applySettings(const Settings& settings);
+
+    /**
+     * Blocks until nextDeadline.
+     *
+     * @return The number of deadlines that have passed since the last call
+     *         (more than 1 if we're running late).
+     */
+    Uint64 waitForDeadline();
+
+    /**
+     * Logs the jitter that was recorded since the last report, then resets
+     * it.
+     */
+    void logJitter();
+
+    /** The function to call every timestep. */
+    const std::function<void(void)> tickFunct;
+
+    /** The amount of time between calls of tickFunct, in seconds. */
+    const double timestepS;
+
+    /** timestepS, as a duration. */
+    const std::chrono::steady_clock::duration timestep;
+
+    /** A name used to identify this thread in logs and profiles. */
+    const std::string debugName;
+
+    /**
+     * Determines behavior when we detect that multiple deadlines have passed
+     * since our last tick.
+     * If true, will only call tickFunct once (and log a warning.)
+     * If false, will call tickFunct for each deadline (and log warnings.)
+     */
+    const bool skipLateSteps;
+
+    /** An unreasonable amount of time for a tick to be late by.
+        If <= 0, no delay reporting will occur. */
+    double delayedTimeS;
+
+    /** The deadline of the next tick. */
+    std::chrono::steady_clock::time_point nextDeadline;
+
+#if defined(__linux__)
+    /** The periodic timer that we wait on. */
+    int timerFd;
+#endif
+
+    /** How late we woke up for each tick, in microseconds. */
+    Histogram jitterUs;
+
+    /** The largest value in jitterUs. */
+    Uint64 maxJitterUs;
+
+    /** The number of ticks that were skipped because we were running late,
+        since the last report. */
+    Uint64 skippedTicks;
+
+    /** The number of ticks that took longer than timestepS to run, since the
+        last report. */
+    Uint64 overranTicks;
+
+    /** When we last logged our jitter. */
+    std::chrono::steady_clock::time_point lastJitterReportTime;
+
+    std::thread tickThreadObj;
+
+    /** Turn true to signal that the thread should end. */
+    std::atomic<bool> exitRequested;
+};
+
+} // End namespace Server
+} // End namespace AM
@@ -3,12 +3,19 @@
 #include "Log.h"
 #include "ByteTools.h"
 #include "ExplicitConfirmation.h"
+#include "MovementUpdate.h"
 #include "Serialize.h"
+#include "Deserialize.h"
 #include "NetworkStats.h"
+#include "NetworkMetrics.h"
+#include "InputLatencyMetrics.h"
+#include "CompressionDictionary.h"
 #include "AMAssert.h"
 #include "Ignore.h"
+#include <SDL_timer.h>
 #include <cmath>
 #include <array>
+#include <algorithm>
 
 namespace AM
 {
@@ -21,6 +28,22 @@ BinaryBuffer Client::compressedBatchBuffer;
 Client::Client(NetworkID inNetID, std::unique_ptr<Peer> inPeer)
 : netID(inNetID)
 , peer(std::move(inPeer))
+, sendQueues()
+, queuedBytes(0)
+, sendQueueOverflowed(false)
+, syncMessages()
+, supersededEntities()
+, batchCompressor(CompressionDictionary::get())
+, compressionPolicy()
+, compressionLevel(StreamCompressor::Level::Default)
+, batchMix(MessageType::NotSet)
+, batchMixSize(0)
+, receivedBatchBuffer(Peer::MAX_WIRE_SIZE)
+, receivedBatch(nullptr)
+, receivedBatchSize(0)
+, receivedBatchIndex(0)
+, batchDecompressor(nullptr)
+, metrics()
 , latestSentSimTick(0)
 , tickDiffHistory(Config::TICKDIFF_TARGET)
 , numFreshDiffs(0)
@@ -31,70 +54,380 @@ Client::Client(NetworkID inNetID, std::unique_ptr<Peer> inPeer)
 }
 
 void Client::queueMessage(const BinaryBufferSharedPtr& message,
-                          Uint32 messageTick)
+                          Uint32 messageTick, Uint64 inputReceiveTime)
 {
-    bool emplaceSucceeded{sendQueue.emplace(message, messageTick)};
+    // If this client has fallen too far behind, drop the message.
+    // isConnected() will report them as disconnected, and they'll be erased.
+    std::size_t messageSize{message->size()};
+    if ((queuedBytes + messageSize) > Config::CLIENT_SEND_QUEUE_LIMIT_BYTES) {
+        if (!(sendQueueOverflowed.exchange(true))) {
+            LOG_INFO("Client fell too far behind, dropping connection. "
+                     "Queued bytes: %zu, NetID: %u",
+                     queuedBytes.load(), netID);
+        }
+        return;
+    }
+    queuedBytes += messageSize;
+
+    // Queue the message in its priority class.
+    MessageType messageType{static_cast<MessageType>(
+        (*message)[MessageHeaderIndex::MessageType])};
+    bool emplaceSucceeded{getSendQueue(getSendPriority(messageType))
+                              .emplace(message, messageTick,
+                                       SDL_GetPerformanceCounter(),
+                                       inputReceiveTime)};
     AM_ASSERT(emplaceSucceeded, "Queue emplace failed.");
     ignore(emplaceSucceeded);
 }
 
-NetworkResult Client::sendWaitingMessages(Uint32 currentTick)
+NetworkResult Client::sendWaitingMessages(
+    Uint32 currentTick, StreamCompressor::Level inCompressionLevel)
 {
-    if (peer == nullptr) {
+    if ((peer == nullptr) || sendQueueOverflowed) {
+        return NetworkResult::Disconnected;
+    }
+    compressionLevel = inCompressionLevel;
+
+    // Try to send any bytes that the socket wasn't ready for last time.
+    if (peer->flushSendBacklog() == NetworkResult::Disconnected) {
         return NetworkResult::Disconnected;
     }
 
+    // Pull out the waiting sync messages.
+    syncMessages.clear();
+    QueuedMessage queuedMessage{};
+    while (getSendQueue(SendPriority::Sync).try_dequeue(queuedMessage)) {
+        queuedBytes -= queuedMessage.message->size();
+        syncMessages.push_back(std::move(queuedMessage));
+    }
+
+    // If we fell behind, coalesce the waiting movement updates.
+    // Note: If any lifetime messages are waiting, an entity may have entered
+    //       or left the client's AOI, so we leave the updates alone.
+    //       We check after pulling the sync messages, so any lifetime messages
+    //       that were queued before them are visible.
+    if (getSendQueue(SendPriority::Lifetime).size_approx() == 0) {
+        coalesceMovementUpdates(syncMessages);
+    }
+
     // If we have no messages to send, return early.
-    Uint8 messageCount{getWaitingMessageCount()};
-    if ((latestSentSimTick == 0) && (messageCount == 0)) {
+    bool hasWaitingMessages{!(syncMessages.empty())};
+    for (auto& sendQueue : sendQueues) {
+        hasWaitingMessages |= (sendQueue.size_approx() > 0);
+    }
+    if ((latestSentSimTick == 0) && !hasWaitingMessages) {
         return NetworkResult::Success;
     }
 
-    // Copy any waiting messages into the buffer.
+    // Copy the waiting messages into the batch buffer, in priority order.
+    // If the buffer fills up, send it and start a new batch.
     unsigned int currentIndex{ServerHeaderIndex::MessageHeaderStart};
-    for (unsigned int i = 0; i < messageCount; ++i) {
-        // Pop the message.
-        QueuedMessage queuedMessage;
-        bool dequeueSucceeded{sendQueue.try_dequeue(queuedMessage)};
-        AM_ASSERT(dequeueSucceeded, "Expected element but dequeue failed.");
-        ignore(dequeueSucceeded);
+    bool sentBatch{false};
+    std::size_t bytesAdded{0};
+    NetworkResult result{NetworkResult::Success};
+    for (const QueuedMessage& syncMessage : syncMessages) {
+        result = addMessage(syncMessage, currentIndex, sentBatch);
+        if (result == NetworkResult::Disconnected) {
+            return result;
+        }
+        bytesAdded += syncMessage.message->size();
+    }
+
+    // Note: Lifetime messages are never deferred, since the client needs
+    //       them in step with the sync messages.
+    result = addQueuedMessages(SendPriority::Lifetime, SIZE_MAX, bytesAdded,
+                               currentIndex, sentBatch);
+    if (result == NetworkResult::Disconnected) {
+        return result;
+    }
+
+    // Add as many of the deferrable messages as our budget allows.
+    for (SendPriority priority :
+         {SendPriority::ChunkData, SendPriority::Bulk}) {
+        result = addQueuedMessages(priority,
+                                   Config::CLIENT_SEND_BYTES_PER_TICK,
+                                   bytesAdded, currentIndex, sentBatch);
+        if (result == NetworkResult::Disconnected) {
+            return result;
+        }
+    }
+
+    // If we've started talking to this client and none of this tick's
+    // messages confirm the latest tick, add an explicit confirmation message.
+    if ((latestSentSimTick != 0) && (latestSentSimTick < (currentTick - 1))) {
+        if ((currentIndex + EXPLICIT_CONFIRMATION_SIZE)
+            > MAX_BATCH_END_INDEX) {
+            result = sendBatch(currentIndex, sentBatch);
+            if (result == NetworkResult::Disconnected) {
+                return result;
+            }
+        }
+
+        addExplicitConfirmation(currentIndex, currentTick);
+    }
+
+    // Send the last batch.
+    // Note: If we haven't sent anything yet, we send even an empty batch,
+    //       since it acts as a heartbeat.
+    if (!sentBatch || (currentIndex > ServerHeaderIndex::MessageHeaderStart)) {
+        result = sendBatch(currentIndex, sentBatch);
+    }
+
+    std::size_t sendBacklogSize{peer->getSendBacklogSize()};
+    NetworkStats::recordSendBacklog(sendBacklogSize);
+    metrics.sendBacklogBytes = sendBacklogSize;
+
+    return result;
+}
+
+Client::SendPriority Client::getSendPriority(MessageType messageType)
+{
+    switch (messageType) {
+        case MessageType::ConnectionResponse:
+        case MessageType::MovementUpdate:
+            return SendPriority::Sync;
+        case MessageType::EntityInit:
+        case MessageType::EntityDelete:
+            return SendPriority::Lifetime;
+        case MessageType::ChunkUpdate:
+        case MessageType::TileUpdate:
+            return SendPriority::ChunkData;
+        default:
+            return SendPriority::Bulk;
+    }
+}
+
+moodycamel::ReaderWriterQueue<Client::QueuedMessage>&
+    Client::getSendQueue(SendPriority priority)
+{
+    return sendQueues[static_cast<std::size_t>(priority)];
+}
+
+void Client::coalesceMovementUpdates(std::vector<QueuedMessage>& messages)
+{
+    // If the client is keeping up, send every update so it can replay each
+    // tick. We're behind if the socket couldn't take our last batches, or
+    // if more updates are waiting than the sim normally produces.
+    auto isMovementUpdate = [](const QueuedMessage& queuedMessage) {
+        return (static_cast<MessageType>(
+                    (*queuedMessage.message)[MessageHeaderIndex::MessageType])
+                == MessageType::MovementUpdate);
+    };
+    std::size_t updateCount{static_cast<std::size_t>(
+        std::count_if(messages.begin(), messages.end(), isMovementUpdate))};
+    bool isBehind{(peer->getSendBacklogSize() > 0)
+                  || (updateCount > Config::MOVEMENT_COALESCE_THRESHOLD)};
+    if (!isBehind || (updateCount < 2)) {
+        return;
+    }
+
+    /* Walk from the newest update to the oldest, removing any states that
+       are superseded by a newer one. */
+    supersededEntities.clear();
+    bool isNewestUpdate{true};
+    for (auto it = messages.rbegin(); it != messages.rend(); ++it) {
+        if (!isMovementUpdate(*it)) {
+            continue;
+        }
+
+        BinaryBuffer& message{*(it->message)};
+        MovementUpdate movementUpdate{};
+        if (!(Deserialize::fromBuffer(
+                (message.data() + MESSAGE_HEADER_SIZE),
+                (message.size() - MESSAGE_HEADER_SIZE), movementUpdate))) {
+            LOG_FATAL("Failed to deserialize queued MovementUpdate.");
+        }
+
+        // Remove the superseded states, and mark the rest as superseded for
+        // the older updates.
+        std::vector<MovementState>& states{movementUpdate.movementStates};
+        std::size_t originalCount{states.size()};
+        std::erase_if(states, [this](const MovementState& state) {
+            return supersededEntities.contains(state.entity);
+        });
+        for (const MovementState& state : states) {
+            supersededEntities.insert(state.entity);
+        }
+
+        // If nothing was removed, leave the message as-is.
+        // Note: The newest update never has anything removed, so there's
+        //       always a later update to implicitly confirm any that end up
+        //       empty.
+        if (isNewestUpdate || (states.size() == originalCount)) {
+            isNewestUpdate = false;
+            continue;
+        }
+
+        // If every state was superseded, drop the message. Otherwise,
+        // re-serialize it.
+        if (states.empty()) {
+            it->message = nullptr;
+        }
+        else {
+            BinaryBufferSharedPtr newMessage{std::make_shared<BinaryBuffer>()};
+            newMessage->reserve(it->message->size());
+            std::size_t payloadSize{Serialize::toGrowableBuffer(
+                *newMessage, movementUpdate, MESSAGE_HEADER_SIZE)};
+            (*newMessage)[MessageHeaderIndex::MessageType]
+                = static_cast<Uint8>(MessageType::MovementUpdate);
+            ByteTools::write16(static_cast<Uint16>(payloadSize),
+                               (newMessage->data() + MessageHeaderIndex::Size));
+            it->message = newMessage;
+        }
+    }
+
+    // Remove the dropped messages.
+    std::erase_if(messages, [](const QueuedMessage& queuedMessage) {
+        return (queuedMessage.message == nullptr);
+    });
+}
+
+NetworkResult Client::addMessage(const QueuedMessage& queuedMessage,
+                                 unsigned int& currentIndex, bool& sentBatch)
+{
+    const BinaryBuffer& message{*(queuedMessage.message)};
+    unsigned int messageSize{static_cast<unsigned int>(message.size())};
+
+    // If the message is too large to fit in any batch, split it up.
+    NetworkResult result{NetworkResult::Success};
+    if (messageSize > MAX_BATCH_PAYLOAD_SIZE) {
+        result = addFragmentedMessage(message, currentIndex, sentBatch);
+    }
+    else {
+        // If the message doesn't fit in this batch, send it and start
+        // a new one.
+        if ((currentIndex + messageSize) > MAX_BATCH_END_INDEX) {
+            result = sendBatch(currentIndex, sentBatch);
+        }
 
         // Copy the message data into the batchBuffer.
-        std::copy(queuedMessage.message->begin(), queuedMessage.message->end(),
+        std::copy(message.begin(), message.end(),
                   &(batchBuffer[currentIndex]));
+        currentIndex += messageSize;
+        updateBatchMix(message, messageSize);
+    }
 
-        // Increment the index.
-        currentIndex
-            += static_cast<unsigned int>(queuedMessage.message->size());
+    // Track the latest tick we've sent.
+    if (queuedMessage.tick != 0) {
+        latestSentSimTick = queuedMessage.tick;
+    }
+
+    // Record the message and how long it spent in our queues.
+    MessageType messageType{
+        static_cast<MessageType>(message[MessageHeaderIndex::MessageType])};
+    NetworkMetrics::recordMessageSent(messageType, messageSize);
+    metrics.messagesSent.fetch_add(1, std::memory_order_relaxed);
+
+    Uint64 currentTime{SDL_GetPerformanceCounter()};
+    Uint64 latencyUs{((currentTime - queuedMessage.queueTime) * 1'000'000)
+                     / SDL_GetPerformanceFrequency()};
+    NetworkMetrics::recordSendLatency(latencyUs);
+    metrics.sendLatencyUs.record(latencyUs);
+
+    // If the message responds to a traced input, finish the trace.
+    if (queuedMessage.inputReceiveTime != 0) {
+        InputLatencyMetrics::recordStage(InputLatencyMetrics::Stage::Send,
+                                         queuedMessage.queueTime,
+                                         currentTime);
+        InputLatencyMetrics::recordStage(InputLatencyMetrics::Stage::Total,
+                                         queuedMessage.inputReceiveTime,
+                                         currentTime);
+    }
 
-        // Track the latest tick we've sent.
-        if (queuedMessage.tick != 0) {
-            latestSentSimTick = queuedMessage.tick;
+    return result;
+}
+
+NetworkResult Client::addQueuedMessages(SendPriority priority,
+                                        std::size_t byteBudget,
+                                        std::size_t& bytesAdded,
+                                        unsigned int& currentIndex,
+                                        bool& sentBatch)
+{
+    moodycamel::ReaderWriterQueue<QueuedMessage>& sendQueue{
+        getSendQueue(priority)};
+    QueuedMessage queuedMessage{};
+    while ((bytesAdded < byteBudget)
+           && sendQueue.try_dequeue(queuedMessage)) {
+        std::size_t messageSize{queuedMessage.message->size()};
+        queuedBytes -= messageSize;
+
+        NetworkResult result{
+            addMessage(queuedMessage, currentIndex, sentBatch)};
+        if (result == NetworkResult::Disconnected) {
+            return result;
         }
+        bytesAdded += messageSize;
     }
 
-    // If we've started talking to this client and none of this batch's
-    // messages confirm the latest tick, add an explicit confirmation message.
-    if ((latestSentSimTick != 0) && (latestSentSimTick < (currentTick - 1))) {
-        addExplicitConfirmation(currentIndex, currentTick, messageCount);
+    return NetworkResult::Success;
+}
+
+NetworkResult Client::addFragmentedMessage(const BinaryBuffer& message,
+                                           unsigned int& currentIndex,
+                                           bool& sentBatch)
+{
+    /* Split the message (including its header) across as many batches as it
+       takes, wrapping each piece in a MessageFragment header.
+       The receiver appends fragments together until it has a full message.
+       Note: The fragments are written to the wire in order, without any
+             other fragmented message in between, so no IDs are needed. */
+    std::size_t messageIndex{0};
+    while (messageIndex < message.size()) {
+        // If there isn't room in this batch for a fragment header and at
+        // least 1 byte, send it and start a new one.
+        if ((currentIndex + MESSAGE_HEADER_SIZE) >= MAX_BATCH_END_INDEX) {
+            NetworkResult result{sendBatch(currentIndex, sentBatch)};
+            if (result == NetworkResult::Disconnected) {
+                return result;
+            }
+        }
+
+        // Fill the rest of the batch with as much of the message as fits.
+        std::size_t fragmentSize{std::min(
+            (message.size() - messageIndex),
+            static_cast<std::size_t>(MAX_BATCH_END_INDEX - currentIndex
+                                     - MESSAGE_HEADER_SIZE))};
+        batchBuffer[currentIndex + MessageHeaderIndex::MessageType]
+            = static_cast<Uint8>(MessageType::MessageFragment);
+        ByteTools::write16(
+            static_cast<Uint16>(fragmentSize),
+            &(batchBuffer[currentIndex + MessageHeaderIndex::Size]));
+        std::copy((message.begin() + messageIndex),
+                  (message.begin() + messageIndex + fragmentSize),
+                  &(batchBuffer[currentIndex + MESSAGE_HEADER_SIZE]));
+
+        currentIndex
+            += static_cast<unsigned int>(MESSAGE_HEADER_SIZE + fragmentSize);
+        messageIndex += fragmentSize;
+        updateBatchMix(message, static_cast<unsigned int>(fragmentSize));
     }
 
-    // If the batch + header is too large, error.
-    AM_ASSERT((currentIndex <= SharedConfig::MAX_BATCH_SIZE),
-              "Batch too large to fit into buffers. Increase MAX_BATCH_SIZE. "
-              "Size: %u, Max: %u",
-              currentIndex, SharedConfig::MAX_BATCH_SIZE);
+    return NetworkResult::Success;
+}
 
-    // If we have a large enough payload, compress it.
+NetworkResult Client::sendBatch(unsigned int& currentIndex, bool& sentBatch)
+{
+    // If our policy says it's worthwhile, compress the payload.
+    // Note: Once a batch is added to the compression stream, we have to send
+    //       it compressed, since the client's stream needs to see it too.
+    //       MAX_BATCH_PAYLOAD_SIZE leaves room for the worst-case expansion,
+    //       so the result always fits the client's frame limit.
     unsigned int batchSize{currentIndex - SERVER_HEADER_SIZE};
     Uint8* bufferToSend{&(batchBuffer[0])};
     bool isCompressed{false};
-    if (batchSize > SharedConfig::BATCH_COMPRESSION_THRESHOLD) {
-        batchSize = compressBatch(batchSize);
-
+    if (compressionPolicy.shouldCompress(batchSize, batchMix)) {
+        unsigned int compressedBatchSize{compressBatch(batchSize)};
+        compressionPolicy.recordResult(batchMix, batchSize,
+                                       compressedBatchSize);
+        NetworkStats::recordCompressedBatch(compressionLevel, batchSize,
+                                            compressedBatchSize);
+        metrics.bytesBeforeCompression.fetch_add(batchSize,
+                                                 std::memory_order_relaxed);
+        metrics.bytesAfterCompression.fetch_add(compressedBatchSize,
+                                                std::memory_order_relaxed);
+
+        batchSize = compressedBatchSize;
         isCompressed = true;
-
-        // Use the compressed buffer.
         bufferToSend = &(compressedBatchBuffer[0]);
     }
 
@@ -104,6 +437,7 @@ NetworkResult Client::sendWaitingMessages(Uint32 currentTick)
     // Record the number of sent bytes.
     unsigned int totalSize{SERVER_HEADER_SIZE + batchSize};
     NetworkStats::recordBytesSent(totalSize);
+    metrics.bytesSent.fetch_add(totalSize, std::memory_order_relaxed);
 
     // Send the header and batch.
     unsigned int sendIndex{0};
@@ -126,11 +460,17 @@ NetworkResult Client::sendWaitingMessages(Uint32 currentTick)
         sendIndex += bytesToSend;
     }
 
+    // Start a new batch.
+    currentIndex = ServerHeaderIndex::MessageHeaderStart;
+    sentBatch = true;
+    batchMix = MessageType::NotSet;
+    batchMixSize = 0;
+
     return result;
 }
 
 void Client::addExplicitConfirmation(unsigned int& currentIndex,
-                                     Uint32 currentTick, Uint8& messageCount)
+                                     Uint32 currentTick)
 {
     /* Add the ExplicitConfirmation to the batch.
        Note: We add it by hand instead of using the normal functions because
@@ -158,34 +498,45 @@ void Client::addExplicitConfirmation(unsigned int& currentIndex,
         batchBuffer.data(), (SharedConfig::MAX_BATCH_SIZE - currentIndex),
         explicitConfirmation, currentIndex));
 
-    // Increment the message count.
-    messageCount++;
-
     // Update our latestSent tracking to account for the confirmed ticks.
     latestSentSimTick += confirmedTickCount;
+
+    NetworkMetrics::recordMessageSent(MessageType::ExplicitConfirmation,
+                                      EXPLICIT_CONFIRMATION_SIZE);
+    metrics.messagesSent.fetch_add(1, std::memory_order_relaxed);
 }
 
 unsigned int Client::compressBatch(unsigned int batchSize)
 {
     // If the destination buffer is too small, resize it.
     std::size_t compressBound{ByteTools::compressBound(batchSize)};
-    if (compressedBatchBuffer.size() < compressBound) {
-        compressedBatchBuffer.resize(compressBound);
+    if (compressedBatchBuffer.size() < (SERVER_HEADER_SIZE + compressBound)) {
+        compressedBatchBuffer.resize(SERVER_HEADER_SIZE + compressBound);
     }
 
-    // Compress the batch.
+    // Compress the batch, using this client's previous batches as history.
     unsigned int compressedBatchSize{
-        static_cast<unsigned int>(ByteTools::compress(
+        static_cast<unsigned int>(batchCompressor.compress(
             &(batchBuffer[ServerHeaderIndex::MessageHeaderStart]), batchSize,
             &(compressedBatchBuffer[ServerHeaderIndex::MessageHeaderStart]),
-            compressedBatchBuffer.size()))};
-    AM_ASSERT((compressedBatchSize <= MAX_BATCH_SIZE),
-              "Batch too large, even after compression. Size: %u",
-              compressedBatchSize);
+            (compressedBatchBuffer.size() - SERVER_HEADER_SIZE),
+            compressionLevel))};
 
     return compressedBatchSize;
 }
 
+void Client::updateBatchMix(const BinaryBuffer& message,
+                            unsigned int bytesAdded)
+{
+    // Note: This is a cheap approximation. The mix is the type of the largest
+    //       message (or fragment) in the batch.
+    if (bytesAdded > batchMixSize) {
+        batchMix = static_cast<MessageType>(
+            message[MessageHeaderIndex::MessageType]);
+        batchMixSize = bytesAdded;
+    }
+}
+
 void Client::fillHeader(Uint8* bufferToFill, Uint16 batchSize,
                         bool isCompressed)
 {
@@ -206,79 +557,45 @@ void Client::fillHeader(Uint8* bufferToFill, Uint16 batchSize,
                        &(bufferToFill[ServerHeaderIndex::BatchSize]));
 }
 
-Uint8 Client::getWaitingMessageCount() const
-{
-    std::size_t size{sendQueue.size_approx()};
-    AM_ASSERT(
-        (size <= SDL_MAX_UINT8),
-        "Client's sendQueue contains too many messages to return as a Uint8.");
-
-    return static_cast<Uint8>(size);
-}
-
 ReceiveResult Client::receiveMessage(Uint8* messageBuffer)
 {
     if (peer == nullptr) {
         return {NetworkResult::Disconnected};
     }
 
-    // Receive the header.
-    Uint8 headerBuf[CLIENT_HEADER_SIZE];
-    NetworkResult headerResult{
-        peer->receiveBytes(headerBuf, CLIENT_HEADER_SIZE, false)};
-
-    // Receive the following message, or check for timeouts.
-    if (headerResult == NetworkResult::Success) {
-        // Process the adjustment iteration.
-        Uint8 receivedAdjIteration{
-            headerBuf[ClientHeaderIndex::AdjustmentIteration]};
-        Uint8 expectedNextIteration{static_cast<Uint8>(latestAdjIteration + 1)};
-
-        // If we received the next expected iteration, save it.
-        if (receivedAdjIteration == expectedNextIteration) {
-            latestAdjIteration = expectedNextIteration;
-            numFreshDiffs = 0;
-        }
-        else if (receivedAdjIteration > expectedNextIteration) {
-            LOG_FATAL("Skipped an adjustment iteration. Logic must be flawed.");
+    // If we've read every message in the current batch, try to receive a
+    // new one.
+    while (receivedBatchIndex == receivedBatchSize) {
+        NetworkResult result{receiveBatch()};
+        if (result == NetworkResult::NoWaitingData) {
+            // If we timed out, drop the connection.
+            double delta{receiveTimer.getDeltaSeconds(false)};
+            if (delta > Config::CLIENT_TIMEOUT_S) {
+                peer = nullptr;
+                LOG_INFO("Dropped connection, peer timed out. Time since last "
+                         "message: %.6f seconds. Timeout: %.6f, NetID: %u",
+                         delta, Config::CLIENT_TIMEOUT_S, netID);
+                return {NetworkResult::TimedOut};
+            }
+
+            return {NetworkResult::NoWaitingData};
         }
-
-        // Get the message.
-        // Note: This is a blocking read, but the data should immediately be
-        //       available since we send it all in 1 packet.
-        ReceiveResult receiveResult{peer->receiveMessageWait(messageBuffer)};
-        if (receiveResult.networkResult == NetworkResult::Success) {
-            // Got a message, update the receiveTimer.
-            receiveTimer.updateSavedTime();
-
-            // Record the number of received bytes.
-            NetworkStats::recordBytesReceived(CLIENT_HEADER_SIZE
-                                              + MESSAGE_HEADER_SIZE
-                                              + receiveResult.messageSize);
-
-            return receiveResult;
-        }
-        else {
-            LOG_FATAL("Data was not present when expected.");
-        }
-    }
-    else if (headerResult == NetworkResult::NoWaitingData) {
-        // If we timed out, drop the connection.
-        double delta{receiveTimer.getDeltaSeconds(false)};
-        if (delta > Config::CLIENT_TIMEOUT_S) {
-            peer = nullptr;
-            LOG_INFO("Dropped connection, peer timed out. Time since last "
-                     "message: %.6f seconds. Timeout: %.6f, NetID: %u",
-                     delta, Config::CLIENT_TIMEOUT_S, netID);
-            return {NetworkResult::TimedOut};
+        else if (result != NetworkResult::Success) {
+            return {result};
         }
     }
 
-    return {NetworkResult::NoWaitingData};
+    // Return the next message in the batch.
+    return readBatchedMessage(messageBuffer);
 }
 
 bool Client::isConnected()
 {
+    // If the client fell too far behind, we're dropping them.
+    if (sendQueueOverflowed) {
+        return false;
+    }
+
     // Peer might've been force-disconnected by dropping the reference.
     // It also could have internally detected a client-initiated disconnect.
     return (peer == nullptr) ? false : peer->isConnected();
@@ -325,6 +642,127 @@ NetworkID Client::getNetID()
     return netID;
 }
 
+std::size_t Client::getSendBacklogSize()
+{
+    return (peer == nullptr) ? 0 : peer->getSendBacklogSize();
+}
+
+std::size_t Client::getQueuedBytes()
+{
+    return queuedBytes;
+}
+
+ClientMetrics& Client::getMetrics()
+{
+    return metrics;
+}
+
+NetworkResult Client::receiveBatch()
+{
+    // Try to receive a batch, along with its client header.
+    // Note: The peer buffers everything that's available in one receive,
+    //       so this only touches the socket when its buffer runs out of
+    //       full batches.
+    std::array<Uint8, CLIENT_HEADER_SIZE> headerBuf{};
+    Uint16 batchSize{0};
+    NetworkResult result{peer->receiveFrame(
+        headerBuf.data(), CLIENT_HEADER_SIZE, ClientHeaderIndex::BatchSize,
+        receivedBatchBuffer.data(), Peer::MAX_WIRE_SIZE, batchSize, false)};
+    if (result != NetworkResult::Success) {
+        return result;
+    }
+
+    // Process the adjustment iteration.
+    Uint8 receivedAdjIteration{
+        headerBuf[ClientHeaderIndex::AdjustmentIteration]};
+    Uint8 expectedNextIteration{static_cast<Uint8>(latestAdjIteration + 1)};
+
+    // If we received the next expected iteration, save it.
+    if (receivedAdjIteration == expectedNextIteration) {
+        latestAdjIteration = expectedNextIteration;
+        numFreshDiffs = 0;
+    }
+    else if (receivedAdjIteration > expectedNextIteration) {
+        LOG_FATAL("Skipped an adjustment iteration. Logic must be flawed.");
+    }
+
+    // Got a batch, update the receiveTimer.
+    receiveTimer.updateSavedTime();
+
+    // Record the number of received bytes.
+    NetworkStats::recordBytesReceived(CLIENT_HEADER_SIZE + batchSize);
+    metrics.bytesReceived.fetch_add((CLIENT_HEADER_SIZE + batchSize),
+                                    std::memory_order_relaxed);
+
+    receivedBatch = receivedBatchBuffer.data();
+    receivedBatchSize = batchSize;
+    receivedBatchIndex = 0;
+
+    // If the batch is compressed, decompress it.
+    bool isCompressed{
+        (ByteTools::read16(&(headerBuf[ClientHeaderIndex::BatchSize]))
+         & (1U << 15))
+        != 0};
+    if (isCompressed) {
+        if (batchDecompressor == nullptr) {
+            batchDecompressor = std::make_unique<StreamDecompressor>(
+                CompressionDictionary::get());
+        }
+
+        receivedBatch = batchDecompressor->decompress(
+            receivedBatchBuffer.data(), batchSize, receivedBatchSize);
+
+        // Note: The client never sends more than MAX_WIRE_SIZE bytes of
+        //       messages in a batch.
+        if ((receivedBatch == nullptr)
+            || (receivedBatchSize > Peer::MAX_WIRE_SIZE)) {
+            LOG_INFO("Received malformed compressed batch, dropping "
+                     "connection. NetID: %u",
+                     netID);
+            peer = nullptr;
+            receivedBatchSize = 0;
+            return NetworkResult::Disconnected;
+        }
+    }
+
+    return NetworkResult::Success;
+}
+
+ReceiveResult Client::readBatchedMessage(Uint8* messageBuffer)
+{
+    // If the message runs past the end of the batch, the client is
+    // misbehaving.
+    const Uint8* messageHeader{receivedBatch + receivedBatchIndex};
+    std::size_t remainingBytes{receivedBatchSize - receivedBatchIndex};
+    Uint16 messageSize{0};
+    if (remainingBytes >= MESSAGE_HEADER_SIZE) {
+        messageSize
+            = ByteTools::read16(messageHeader + MessageHeaderIndex::Size);
+    }
+    if ((remainingBytes < MESSAGE_HEADER_SIZE)
+        || ((remainingBytes - MESSAGE_HEADER_SIZE) < messageSize)) {
+        LOG_INFO("Received malformed batch, dropping connection. NetID: %u",
+                 netID);
+        peer = nullptr;
+        receivedBatchSize = 0;
+        receivedBatchIndex = 0;
+        return {NetworkResult::Disconnected};
+    }
+
+    // Copy the message out and move to the next one.
+    const Uint8* messageStart{messageHeader + MESSAGE_HEADER_SIZE};
+    std::copy(messageStart, (messageStart + messageSize), messageBuffer);
+    receivedBatchIndex += (MESSAGE_HEADER_SIZE + messageSize);
+
+    MessageType messageType{static_cast<MessageType>(
+        messageHeader[MessageHeaderIndex::MessageType])};
+    NetworkMetrics::recordMessageReceived(messageType,
+                                          (MESSAGE_HEADER_SIZE + messageSize));
+    metrics.messagesReceived.fetch_add(1, std::memory_order_relaxed);
+
+    return {NetworkResult::Success, messageType, messageSize};
+}
+
 Sint8 Client::calcAdjustment(
     CircularBuffer<Sint8, Config::TICKDIFF_HISTORY_LENGTH>& tickDiffHistoryCopy,
     unsigned int numFreshDiffsCopy)
@@ -1,13 +1,14 @@
 #include "ClientHandler.h"
 #include "Network.h"
 #include "NetworkDefs.h"
-#include "SocketSet.h"
+#include "Peer.h"
+#include "Paths.h"
 #include "Config.h"
 #include "Log.h"
 #include "Tracy.hpp"
-#include <shared_mutex>
 #include <mutex>
 #include <memory>
+#include <vector>
 
 namespace AM
 {
@@ -15,19 +16,27 @@ namespace Server
 {
 
 ClientHandler::ClientHandler(Network& inNetwork, EventDispatcher& inDispatcher,
-                             MessageProcessor& inMessageProcessor)
+                             MessageProcessor& inMessageProcessor,
+                             std::unique_ptr<AcceptorBase> inAcceptor,
+                             bool recordInputTrace)
 : network{inNetwork}
 , dispatcher{inDispatcher}
 , messageProcessor{inMessageProcessor}
-, idPool{Config::MAX_CLIENTS}
-, clientCount{0}
-, clientSet{std::make_shared<SocketSet>(Config::MAX_CLIENTS)}
-, acceptor{Network::SERVER_PORT, clientSet}
+, acceptor{std::move(inAcceptor)}
 , messageRecBuffer(Peer::MAX_WIRE_SIZE)
+, inputTraceRecorder{nullptr}
 , receiveThreadObj{}
 , exitRequested{false}
 , sendRequested{false}
+, sendTimer{}
+, compressionLevel{StreamCompressor::Level::Default}
+, ticksWithSpareTime{0}
 {
+    if (recordInputTrace) {
+        inputTraceRecorder = std::make_unique<InputTraceRecorder>(
+            Paths::BASE_PATH + "InputTrace.bin");
+    }
+
     // Start the send and receive threads.
     receiveThreadObj = std::thread(&ClientHandler::serviceClients, this);
     sendThreadObj = std::thread(&ClientHandler::sendClientUpdates, this);
@@ -60,22 +69,24 @@ void ClientHandler::serviceClients()
 {
     tracy::SetThreadName("ServerReceive");
 
-    ClientMap& clientMap{network.getClientMap()};
+    ClientRegistry& clientRegistry{network.getClientRegistry()};
 
     while (!exitRequested) {
         // Check if there are any new clients to connect.
-        acceptNewClients(clientMap);
+        acceptNewClients(clientRegistry);
 
-        // Erase any clients who were detected to be disconnected.
-        eraseDisconnectedClients(clientMap);
+        // Erase any clients who were detected to be disconnected, and destroy
+        // any erased clients that the other threads are done with.
+        eraseDisconnectedClients(clientRegistry);
+        clientRegistry.reclaim();
 
         // Check if there's any clients with activity, and process all their
         // messages.
-        // Note: Doesn't need a lock because we only mutate the map from this
-        //       thread.
+        // Note: Doesn't need a read guard because we're the registry's
+        //       writer thread.
         int numReceived = 0;
-        if (clientMap.size() != 0) {
-            numReceived = receiveAndProcessClientMessages(clientMap);
+        if (clientRegistry.size() != 0) {
+            numReceived = receiveAndProcessClientMessages(clientRegistry);
         }
 
         // There wasn't any activity, delay so we don't waste CPU spinning.
@@ -89,9 +100,7 @@ void ClientHandler::sendClientUpdates()
 {
     tracy::SetThreadName("ServerSend");
 
-    SharedLockableBase(std::shared_mutex)
-        & clientMapMutex{network.getClientMapMutex()};
-    ClientMap& clientMap{network.getClientMap()};
+    ClientRegistry& clientRegistry{network.getClientRegistry()};
 
     while (!exitRequested) {
         // Wait until this thread is signaled by beginSendClientUpdates().
@@ -101,27 +110,63 @@ void ClientHandler::sendClientUpdates()
         {
             ZoneScoped;
 
-            // Acquire a read lock before running through the client map.
-            std::shared_lock readLock{clientMapMutex};
+            // Hold a read guard while we run through the clients, so none
+            // of them get destroyed mid-send.
+            ClientRegistry::ReadGuard readGuard{clientRegistry};
 
             // Run through the clients, sending their waiting messages.
+            sendTimer.updateSavedTime();
             Uint32 currentTick{network.getCurrentTick()};
-            for (auto& pair : clientMap) {
-                pair.second->sendWaitingMessages(currentTick);
-            }
+            clientRegistry.forEach([&](Client& client) {
+                client.sendWaitingMessages(currentTick, compressionLevel);
+            });
+
+            // Adjust our compression level to fit our spare time.
+            updateCompressionLevel(sendTimer.getDeltaSeconds(false));
 
             sendRequested = false;
         }
     }
 }
 
-void ClientHandler::acceptNewClients(ClientMap& clientMap)
+void ClientHandler::updateCompressionLevel(double sendTimeS)
+{
+    double spareTime{1.0 - (sendTimeS / SharedConfig::NETWORK_TICK_TIMESTEP_S)};
+
+    // If we're running low on time, step down a level.
+    if (spareTime < Config::COMPRESSION_LOWER_SPARE_TIME) {
+        ticksWithSpareTime = 0;
+        if (compressionLevel != StreamCompressor::Level::Fast) {
+            compressionLevel = static_cast<StreamCompressor::Level>(
+                static_cast<Uint8>(compressionLevel) - 1);
+            LOG_INFO("Lowered compression level to %u. Spare time: %.2f",
+                     static_cast<unsigned int>(compressionLevel), spareTime);
+        }
+    }
+    // If we've had plenty of time for a while, step up a level.
+    else if (spareTime > Config::COMPRESSION_RAISE_SPARE_TIME) {
+        ticksWithSpareTime++;
+        if ((ticksWithSpareTime >= Config::COMPRESSION_RAISE_TICKS)
+            && (compressionLevel != StreamCompressor::Level::High)) {
+            compressionLevel = static_cast<StreamCompressor::Level>(
+                static_cast<Uint8>(compressionLevel) + 1);
+            ticksWithSpareTime = 0;
+            LOG_INFO("Raised compression level to %u. Spare time: %.2f",
+                     static_cast<unsigned int>(compressionLevel), spareTime);
+        }
+    }
+    else {
+        ticksWithSpareTime = 0;
+    }
+}
+
+void ClientHandler::acceptNewClients(ClientRegistry& clientRegistry)
 {
     ZoneScoped;
 
     // If we're at max capacity, reject any waiting connections.
-    if (clientCount == Config::MAX_CLIENTS) {
-        while (acceptor.reject()) {
+    if (clientRegistry.size() == Config::MAX_CLIENTS) {
+        while (acceptor->reject()) {
             LOG_INFO("Rejected connection attempt: Already at maximum "
                      "connected clients.");
         }
@@ -129,99 +174,81 @@ void ClientHandler::acceptNewClients(ClientMap& clientMap)
     }
 
     // We have room for more peers. Connect to any that are waiting.
-    // Note: newPeer adds itself to the socket set.
-    std::unique_ptr<Peer> newPeer{acceptor.accept()};
+    std::unique_ptr<Peer> newPeer{acceptor->accept()};
     while (newPeer != nullptr) {
-        NetworkID newID{idPool.reserveID()};
+        // Add the peer to the Network's client registry.
+        NetworkID newID{clientRegistry.emplace(std::move(newPeer))};
         LOG_INFO("New client connected. Assigning netID: %u", newID);
 
-        {
-            // Add the peer to the Network's clientMap.
-            std::unique_lock writeLock{network.getClientMapMutex()};
-            if (!(clientMap
-                      .try_emplace(newID, std::make_shared<Client>(
-                                              newID, std::move(newPeer)))
-                      .second)) {
-                idPool.freeID(newID);
-                LOG_FATAL(
-                    "Ran out of room in client map or key already existed.");
-            }
-        }
-
-        clientCount++;
-
         // Notify the sim that a client was connected.
         dispatcher.emplace<ClientConnected>(newID);
+        if (inputTraceRecorder != nullptr) {
+            inputTraceRecorder->recordConnection(network.getCurrentTick(),
+                                                 newID);
+        }
 
-        newPeer = acceptor.accept();
+        newPeer = acceptor->accept();
     }
 }
 
-void ClientHandler::eraseDisconnectedClients(ClientMap& clientMap)
+void ClientHandler::eraseDisconnectedClients(ClientRegistry& clientRegistry)
 {
     ZoneScoped;
 
-    /* Erase any disconnected clients. */
-    for (auto it = clientMap.begin(); it != clientMap.end();) {
-        std::shared_ptr<Client>& client{it->second};
-
-        if (!(client->isConnected())) {
-            // Save the ID since we're going to erase this client.
-            NetworkID clientID{it->first};
-
-            {
-                // Need to modify the map, acquire a write lock.
-                std::unique_lock writeLock{network.getClientMapMutex()};
-
-                // Erase the disconnected client.
-                idPool.freeID(it->first);
-                it = clientMap.erase(it);
-            }
-
-            clientCount--;
-
-            // Notify the sim that a client was disconnected.
-            LOG_INFO("Erased disconnected client with netID: %u.", clientID);
-            dispatcher.emplace<ClientDisconnected>(clientID);
+    /* Find any disconnected clients. */
+    std::vector<NetworkID> disconnectedIDs{};
+    clientRegistry.forEach([&](Client& client) {
+        if (!(client.isConnected())) {
+            disconnectedIDs.push_back(client.getNetID());
         }
-        else {
-            ++it;
+    });
+
+    /* Erase them. */
+    for (NetworkID clientID : disconnectedIDs) {
+        // Note: The client isn't destroyed until the other threads are
+        //       done with it. See ClientRegistry::reclaim().
+        clientRegistry.erase(clientID);
+
+        // Notify the sim that a client was disconnected.
+        LOG_INFO("Erased disconnected client with netID: %u.", clientID);
+        dispatcher.emplace<ClientDisconnected>(clientID);
+        if (inputTraceRecorder != nullptr) {
+            inputTraceRecorder->recordDisconnection(network.getCurrentTick(),
+                                                    clientID);
         }
     }
 }
 
-int ClientHandler::receiveAndProcessClientMessages(ClientMap& clientMap)
+int ClientHandler::receiveAndProcessClientMessages(
+    ClientRegistry& clientRegistry)
 {
     ZoneScoped;
 
     // Update each client's internal socket isReady().
-    // Note: We check all clients regardless of whether this returns > 0
+    // Note: We check all clients regardless of whether there was activity
     //       because, even if there's no activity, we need to check for
     //       timeouts.
-    clientSet->checkSockets(0);
+    acceptor->checkPeerSockets();
 
     /* Iterate through all clients. */
-    // Note: Doesn't need a lock because we only mutate the map from this
+    // Note: Doesn't need a read guard because we're the registry's writer
     //       thread.
     int numReceived = 0;
-    for (auto& pair : clientMap) {
-        const std::shared_ptr<Client>& clientPtr{pair.second};
-
+    clientRegistry.forEach([&](Client& client) {
         /* If there's potentially data waiting, try to receive all messages
            from the client. */
-        ReceiveResult result{
-            clientPtr->receiveMessage(messageRecBuffer.data())};
+        ReceiveResult result{client.receiveMessage(messageRecBuffer.data())};
         while (result.networkResult == NetworkResult::Success) {
             numReceived++;
 
             // Process the message.
-            processReceivedMessage(*clientPtr, result.messageType,
+            processReceivedMessage(client, result.messageType,
                                    result.messageSize);
 
             // Try to receive the next message.
-            result = clientPtr->receiveMessage(messageRecBuffer.data());
+            result = client.receiveMessage(messageRecBuffer.data());
         }
-    }
+    });
 
     return numReceived;
 }
@@ -230,6 +257,14 @@ void ClientHandler::processReceivedMessage(Client& client,
                                            MessageType messageType,
                                            unsigned int messageSize)
 {
+    // If we're recording, record the message.
+    if (inputTraceRecorder != nullptr) {
+        inputTraceRecorder->recordMessage(network.getCurrentTick(),
+                                          client.getNetID(), messageType,
+                                          messageRecBuffer.data(),
+                                          messageSize);
+    }
+
     // Process the message.
     // Note: messageTick will be > -1 if the message contained a tick number.
     Sint64 messageTick{messageProcessor.processReceivedMessage(
@@ -0,0 +1,139 @@
+#include "ClientRegistry.h"
+#include "Client.h"
+#include "Peer.h"
+#include "Log.h"
+
+namespace AM
+{
+namespace Server
+{
+ClientRegistry::ReadGuard::ReadGuard(ClientRegistry& inRegistry)
+: registry{inRegistry}
+, epochIndex{0}
+{
+    // Count ourselves in the current epoch. If the epoch advanced before we
+    // were counted, the writer may not have seen us, so retry in the new one.
+    while (true) {
+        Uint32 currentEpoch{registry.epoch.load()};
+        epochIndex = (currentEpoch % 2);
+        registry.activeReaders[epochIndex]++;
+
+        if (registry.epoch.load() == currentEpoch) {
+            break;
+        }
+        registry.activeReaders[epochIndex]--;
+    }
+}
+
+ClientRegistry::ReadGuard::~ReadGuard()
+{
+    registry.activeReaders[epochIndex]--;
+}
+
+ClientRegistry::ClientRegistry(unsigned int maxClients)
+: idPool{maxClients}
+, slots(idPool.getContainerSize())
+, owners(idPool.getContainerSize())
+, generations(idPool.getContainerSize())
+, clientCount{0}
+, epoch{0}
+, activeReaders{}
+, retiredClients{}
+{
+    if (idPool.getContainerSize() > (INDEX_MASK + 1)) {
+        LOG_FATAL("Too many clients to fit in NetworkID's slot index.");
+    }
+}
+
+ClientRegistry::~ClientRegistry() = default;
+
+NetworkID ClientRegistry::emplace(std::unique_ptr<Peer> peer)
+{
+    // Build the new ID from a free slot and its current generation.
+    unsigned int slotIndex{idPool.reserveID()};
+    NetworkID netID{(static_cast<NetworkID>(generations[slotIndex])
+                     << INDEX_BITS)
+                    | slotIndex};
+
+    // Construct the client and publish it to readers.
+    owners[slotIndex] = std::make_unique<Client>(netID, std::move(peer));
+    slots[slotIndex].store(owners[slotIndex].get());
+    clientCount++;
+
+    return netID;
+}
+
+void ClientRegistry::erase(NetworkID netID)
+{
+    unsigned int slotIndex{getSlotIndex(netID)};
+    if ((slotIndex >= slots.size()) || (owners[slotIndex] == nullptr)
+        || (owners[slotIndex]->getNetID() != netID)) {
+        LOG_FATAL("Tried to erase a client that doesn't exist: %u", netID);
+    }
+
+    // Unpublish the client so that new readers can't find it.
+    slots[slotIndex].store(nullptr);
+
+    // Retire it. Readers that already found it may still be using it.
+    retiredClients.push_back({epoch.load(), std::move(owners[slotIndex])});
+
+    // Free the slot. Bumping the generation invalidates the old ID.
+    generations[slotIndex]++;
+    idPool.freeID(slotIndex);
+    clientCount--;
+}
+
+void ClientRegistry::reclaim()
+{
+    if (retiredClients.empty()) {
+        return;
+    }
+
+    // If every reader from the previous epoch has left, advance.
+    // Note: Readers only ever count themselves in the current epoch, so this
+    //       guarantees that only the current and previous epochs have
+    //       readers.
+    Uint32 currentEpoch{epoch.load()};
+    if (activeReaders[(currentEpoch + 1) % 2].load() == 0) {
+        epoch.store(currentEpoch + 1);
+    }
+
+    // Destroy any clients that were retired at least 2 epochs ago. All
+    // readers that could have seen them have left.
+    Uint32 newEpoch{epoch.load()};
+    while (!(retiredClients.empty())
+           && ((retiredClients.front().epoch + 2) <= newEpoch)) {
+        retiredClients.pop_front();
+    }
+}
+
+Client* ClientRegistry::find(NetworkID netID)
+{
+    unsigned int slotIndex{getSlotIndex(netID)};
+    if (slotIndex >= slots.size()) {
+        return nullptr;
+    }
+
+    // If the slot holds a client from a different generation, the client
+    // that this ID refers to is gone.
+    Client* client{slots[slotIndex].load()};
+    if ((client != nullptr) && (client->getNetID() == netID)) {
+        return client;
+    }
+    else {
+        return nullptr;
+    }
+}
+
+unsigned int ClientRegistry::size() const
+{
+    return clientCount;
+}
+
+unsigned int ClientRegistry::getSlotIndex(NetworkID netID)
+{
+    return (netID & INDEX_MASK);
+}
+
+} // End namespace Server
+} // End namespace AM
@@ -0,0 +1,48 @@
+#include "CompressionPolicy.h"
+#include "Config.h"
+#include "SharedConfig.h"
+#include "NetworkStats.h"
+
+namespace AM
+{
+namespace Server
+{
+bool CompressionPolicy::shouldCompress(unsigned int batchSize,
+                                       MessageType batchMix)
+{
+    // Small batches don't have enough repetition to be worth it.
+    if (batchSize <= SharedConfig::BATCH_COMPRESSION_THRESHOLD) {
+        NetworkStats::recordSkippedSmallBatch();
+        return false;
+    }
+
+    // If this mix hasn't been compressing well, skip it unless it's time to
+    // probe it again.
+    MixStats& stats{mixStats[batchMix]};
+    if (stats.averageSavings < Config::COMPRESSION_MIN_SAVINGS) {
+        stats.skippedBatches++;
+        if (stats.skippedBatches < Config::COMPRESSION_PROBE_INTERVAL) {
+            NetworkStats::recordSkippedLowGainBatch();
+            return false;
+        }
+    }
+
+    stats.skippedBatches = 0;
+    return true;
+}
+
+void CompressionPolicy::recordResult(MessageType batchMix,
+                                     unsigned int sizeBefore,
+                                     unsigned int sizeAfter)
+{
+    float savings{1.f
+                  - (static_cast<float>(sizeAfter)
+                     / static_cast<float>(sizeBefore))};
+
+    MixStats& stats{mixStats[batchMix]};
+    stats.averageSavings += (SAVINGS_SMOOTHING
+                             * (savings - stats.averageSavings));
+}
+
+} // End namespace Server
+} // End namespace AM
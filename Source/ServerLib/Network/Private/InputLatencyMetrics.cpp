@@ -0,0 +1,44 @@
+#include "InputLatencyMetrics.h"
+#include <SDL_timer.h>
+
+namespace AM
+{
+namespace Server
+{
+// Initialize data.
+std::array<Histogram, InputLatencyMetrics::STAGE_COUNT>
+    InputLatencyMetrics::stageLatenciesUs{};
+
+void InputLatencyMetrics::recordStage(Stage stage, Uint64 startTime,
+                                      Uint64 endTime)
+{
+    Uint64 latencyUs{((endTime - startTime) * 1'000'000)
+                     / SDL_GetPerformanceFrequency()};
+    stageLatenciesUs[static_cast<std::size_t>(stage)].record(latencyUs);
+}
+
+Histogram::Snapshot InputLatencyMetrics::getSnapshot(Stage stage)
+{
+    return stageLatenciesUs[static_cast<std::size_t>(stage)].getSnapshot();
+}
+
+const char* InputLatencyMetrics::getStageName(Stage stage)
+{
+    switch (stage) {
+        case Stage::Dispatch:
+            return "Dispatch";
+        case Stage::Sort:
+            return "Sort";
+        case Stage::Simulate:
+            return "Simulate";
+        case Stage::Send:
+            return "Send";
+        case Stage::Total:
+            return "Total";
+        default:
+            return "Unknown";
+    }
+}
+
+} // End namespace Server
+} // End namespace AM
@@ -0,0 +1,67 @@
+#include "InputTraceReader.h"
+#include "ByteTools.h"
+#include "Log.h"
+
+namespace AM
+{
+namespace Server
+{
+InputTraceReader::InputTraceReader(const std::string& filePath)
+: file(filePath, std::ios::binary)
+, recordHeader{}
+{
+    if (!file) {
+        LOG_FATAL("Failed to open input trace file: %s", filePath.c_str());
+    }
+
+    // Read and validate the file header.
+    std::array<Uint8, InputTrace::FILE_HEADER_SIZE> fileHeader{};
+    file.read(reinterpret_cast<char*>(fileHeader.data()), fileHeader.size());
+    if (!file || (ByteTools::read32(fileHeader.data()) != InputTrace::MAGIC)) {
+        LOG_FATAL("File is not an input trace: %s", filePath.c_str());
+    }
+    else if (fileHeader[4] != InputTrace::VERSION) {
+        LOG_FATAL("Unsupported input trace version: %u. Expected: %u",
+                  fileHeader[4], InputTrace::VERSION);
+    }
+}
+
+bool InputTraceReader::readNext(InputTraceRecord& outRecord)
+{
+    // Read the record header.
+    file.read(reinterpret_cast<char*>(recordHeader.data()),
+              recordHeader.size());
+    if (file.gcount() == 0) {
+        return false;
+    }
+    else if (!file) {
+        LOG_INFO("Input trace ends with a partial record. Ignoring it.");
+        return false;
+    }
+
+    using Index = InputTrace::RecordHeaderIndex;
+    outRecord.tickNum = ByteTools::read32(recordHeader.data() + Index::TickNum);
+    outRecord.recordType
+        = static_cast<InputTrace::RecordType>(recordHeader[Index::RecordType]);
+    outRecord.netID = ByteTools::read32(recordHeader.data() + Index::NetID);
+    outRecord.messageType
+        = static_cast<MessageType>(recordHeader[Index::MessageType]);
+
+    // Read the message, if there is one.
+    Uint16 messageSize{
+        ByteTools::read16(recordHeader.data() + Index::MessageSize)};
+    outRecord.messageBuffer.resize(messageSize);
+    if (messageSize > 0) {
+        file.read(reinterpret_cast<char*>(outRecord.messageBuffer.data()),
+                  messageSize);
+        if (!file) {
+            LOG_INFO("Input trace ends with a partial record. Ignoring it.");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // End namespace Server
+} // End namespace AM
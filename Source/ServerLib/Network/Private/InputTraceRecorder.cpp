@@ -0,0 +1,109 @@
+#include "InputTraceRecorder.h"
+#include "ByteTools.h"
+#include "Log.h"
+#include <algorithm>
+
+namespace AM
+{
+namespace Server
+{
+InputTraceRecorder::InputTraceRecorder(const std::string& filePath)
+: file(filePath, (std::ios::binary | std::ios::trunc))
+, recordBuffer{}
+{
+    if (!file) {
+        LOG_INFO("Failed to open input trace file: %s", filePath.c_str());
+        return;
+    }
+
+    // Leave room for the record that pushes us past FLUSH_SIZE.
+    recordBuffer.reserve(2 * FLUSH_SIZE);
+
+    // Write the file header.
+    recordBuffer.resize(InputTrace::FILE_HEADER_SIZE);
+    ByteTools::write32(InputTrace::MAGIC, recordBuffer.data());
+    recordBuffer[4] = InputTrace::VERSION;
+
+    LOG_INFO("Recording input trace to: %s", filePath.c_str());
+}
+
+InputTraceRecorder::~InputTraceRecorder()
+{
+    flush();
+}
+
+void InputTraceRecorder::recordConnection(Uint32 tickNum, NetworkID netID)
+{
+    appendRecord(tickNum, InputTrace::RecordType::ClientConnected, netID,
+                 MessageType::NotSet, nullptr, 0);
+}
+
+void InputTraceRecorder::recordDisconnection(Uint32 tickNum, NetworkID netID)
+{
+    appendRecord(tickNum, InputTrace::RecordType::ClientDisconnected, netID,
+                 MessageType::NotSet, nullptr, 0);
+}
+
+void InputTraceRecorder::recordMessage(Uint32 tickNum, NetworkID netID,
+                                       MessageType messageType,
+                                       const Uint8* messageBuffer,
+                                       unsigned int messageSize)
+{
+    if (InputTrace::isRecordedMessageType(messageType)) {
+        appendRecord(tickNum, InputTrace::RecordType::Message, netID,
+                     messageType, messageBuffer, messageSize);
+    }
+}
+
+void InputTraceRecorder::appendRecord(Uint32 tickNum,
+                                      InputTrace::RecordType recordType,
+                                      NetworkID netID, MessageType messageType,
+                                      const Uint8* messageBuffer,
+                                      unsigned int messageSize)
+{
+    // If the file failed to open, do nothing.
+    if (!file) {
+        return;
+    }
+
+    // Append the record header.
+    using Index = InputTrace::RecordHeaderIndex;
+    std::size_t recordStart{recordBuffer.size()};
+    recordBuffer.resize(recordStart + InputTrace::RECORD_HEADER_SIZE
+                        + messageSize);
+    Uint8* record{recordBuffer.data() + recordStart};
+    ByteTools::write32(tickNum, (record + Index::TickNum));
+    record[Index::RecordType] = static_cast<Uint8>(recordType);
+    ByteTools::write32(netID, (record + Index::NetID));
+    record[Index::MessageType] = static_cast<Uint8>(messageType);
+    ByteTools::write16(static_cast<Uint16>(messageSize),
+                       (record + Index::MessageSize));
+
+    // Append the message, if there is one.
+    if (messageSize > 0) {
+        std::copy(messageBuffer, (messageBuffer + messageSize),
+                  (record + Index::MessageStart));
+    }
+
+    if (recordBuffer.size() >= FLUSH_SIZE) {
+        flush();
+    }
+}
+
+void InputTraceRecorder::flush()
+{
+    if (!file || recordBuffer.empty()) {
+        return;
+    }
+
+    file.write(reinterpret_cast<const char*>(recordBuffer.data()),
+               recordBuffer.size());
+    if (!file) {
+        LOG_INFO("Failed to write to input trace file. Recording stopped.");
+    }
+
+    recordBuffer.clear();
+}
+
+} // End namespace Server
+} // End namespace AM
@@ -4,11 +4,9 @@
 #include "DispatchMessage.h"
 #include "IMessageProcessorExtension.h"
 #include "ServerNetworkDefs.h"
-#include "Heartbeat.h"
-#include "InputChangeRequest.h"
-#include "ChunkUpdateRequest.h"
-#include "TileUpdateRequest.h"
+#include "Config.h"
 #include "Log.h"
+#include <SDL_timer.h>
 
 namespace AM
 {
@@ -16,6 +14,7 @@ namespace Server
 {
 MessageProcessor::MessageProcessor(EventDispatcher& inNetworkEventDispatcher)
 : networkEventDispatcher{inNetworkEventDispatcher}
+, inputsSinceTrace{0}
 {
 }
 
@@ -28,30 +27,14 @@ Sint64 MessageProcessor::processReceivedMessage(NetworkID netID,
     // Will be -1 if the message doesn't correspond to any tick.
     Sint64 messageTick{-1};
 
-    // Match the enum values to their event types.
-    switch (messageType) {
-        case MessageType::Heartbeat: {
-            messageTick = static_cast<Sint64>(
-                handleHeartbeat(messageBuffer, messageSize));
-            break;
-        }
-        case MessageType::InputChangeRequest: {
-            messageTick = static_cast<Sint64>(
-                handleInputChangeRequest(netID, messageBuffer, messageSize));
-            break;
-        }
-        case MessageType::ChunkUpdateRequest: {
-            handleChunkUpdateRequest(netID, messageBuffer, messageSize);
-            break;
-        }
-        case MessageType::TileUpdateRequest: {
-            dispatchMessage<TileUpdateRequest>(messageBuffer, messageSize,
-                                               networkEventDispatcher);
-            break;
-        }
-        default: {
-            LOG_FATAL("Received unexpected message type: %u", messageType);
-        }
+    // Match the enum value to its message type and pass it to its handler.
+    bool wasHandled{ClientToServerMessages::dispatch(
+        messageType, [&]<typename T>(std::type_identity<T> type) {
+            messageTick
+                = handleMessage(type, netID, messageBuffer, messageSize);
+        })};
+    if (!wasHandled) {
+        LOG_FATAL("Received unexpected message type: %u", messageType);
     }
 
     return messageTick;
@@ -63,8 +46,9 @@ void MessageProcessor::setExtension(
     extension = std::move(inExtension);
 }
 
-Uint32 MessageProcessor::handleHeartbeat(Uint8* messageBuffer,
-                                         unsigned int messageSize)
+Sint64 MessageProcessor::handleMessage(std::type_identity<Heartbeat>, NetworkID,
+                                      Uint8* messageBuffer,
+                                      unsigned int messageSize)
 {
     // Deserialize the message.
     Heartbeat heartbeat{};
@@ -74,9 +58,9 @@ Uint32 MessageProcessor::handleHeartbeat(Uint8* messageBuffer,
     return heartbeat.tickNum;
 }
 
-Uint32 MessageProcessor::handleInputChangeRequest(NetworkID netID,
-                                                  Uint8* messageBuffer,
-                                                  unsigned int messageSize)
+Sint64 MessageProcessor::handleMessage(std::type_identity<InputChangeRequest>,
+                                      NetworkID netID, Uint8* messageBuffer,
+                                      unsigned int messageSize)
 {
     // Deserialize the message.
     InputChangeRequest inputChangeRequest{};
@@ -85,6 +69,13 @@ Uint32 MessageProcessor::handleInputChangeRequest(NetworkID netID,
     // Fill in the network ID that we assigned to this client.
     inputChangeRequest.netID = netID;
 
+    // If it's time to trace an input, stamp this one with its receive time.
+    inputsSinceTrace++;
+    if (inputsSinceTrace >= Config::INPUT_LATENCY_SAMPLE_INTERVAL) {
+        inputChangeRequest.receiveTime = SDL_GetPerformanceCounter();
+        inputsSinceTrace = 0;
+    }
+
     // Push the message into any subscribed queues.
     networkEventDispatcher.push<InputChangeRequest>(inputChangeRequest);
 
@@ -92,9 +83,9 @@ Uint32 MessageProcessor::handleInputChangeRequest(NetworkID netID,
     return inputChangeRequest.tickNum;
 }
 
-void MessageProcessor::handleChunkUpdateRequest(NetworkID netID,
-                                                Uint8* messageBuffer,
-                                                unsigned int messageSize)
+Sint64 MessageProcessor::handleMessage(std::type_identity<ChunkUpdateRequest>,
+                                      NetworkID netID, Uint8* messageBuffer,
+                                      unsigned int messageSize)
 {
     // Deserialize the message.
     ChunkUpdateRequest chunkUpdateRequest{};
@@ -105,6 +96,9 @@ void MessageProcessor::handleChunkUpdateRequest(NetworkID netID,
 
     // Push the message into any subscribed queues.
     networkEventDispatcher.push<ChunkUpdateRequest>(chunkUpdateRequest);
+
+    // This message doesn't correspond to a tick.
+    return -1;
 }
 
 } // End namespace Server
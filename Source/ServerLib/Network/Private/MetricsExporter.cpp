@@ -0,0 +1,429 @@
+#include "MetricsExporter.h"
+#include "ClientRegistry.h"
+#include "Client.h"
+#include "NetworkMetrics.h"
+#include "InputLatencyMetrics.h"
+#include "Paths.h"
+#include "Log.h"
+#include "Tracy.hpp"
+#include <fstream>
+#include <filesystem>
+#include <string_view>
+#include <cstdarg>
+#include <cstdio>
+#include <ctime>
+
+namespace AM
+{
+namespace Server
+{
+MetricsExporter::MetricsExporter(ClientRegistry& inClientRegistry)
+: clientRegistry{inClientRegistry}
+, filePath{Paths::BASE_PATH
+           + ((Config::METRICS_FORMAT == MetricsFormat::Json)
+                  ? "Metrics.json"
+                  : "Metrics.prom")}
+, snapshotText{}
+, ticksSinceExport{0}
+, lastPlottedLatency{}
+{
+}
+
+void MetricsExporter::tick()
+{
+#if defined(TRACY_ENABLE)
+    plotToTracy();
+#endif
+
+    if constexpr (Config::METRICS_FORMAT == MetricsFormat::None) {
+        return;
+    }
+
+    // If it's time to write a snapshot, do so.
+    ticksSinceExport++;
+    if (ticksSinceExport >= TICKS_TILL_EXPORT) {
+        writeSnapshot();
+        ticksSinceExport = 0;
+    }
+}
+
+void MetricsExporter::writeSnapshot()
+{
+    ZoneScoped;
+
+    // Build the snapshot.
+    snapshotText.clear();
+    if (Config::METRICS_FORMAT == MetricsFormat::Json) {
+        appendJson();
+    }
+    else {
+        appendPrometheus();
+    }
+
+    // Write it to a temporary file, then move it into place so that readers
+    // never see a partial snapshot.
+    // Note: Failures are logged instead of being fatal, since metrics
+    //       aren't worth stopping the server over.
+    std::string tempFilePath{filePath + ".tmp"};
+    {
+        std::ofstream outFile(tempFilePath, std::ios::trunc);
+        outFile.write(snapshotText.data(), snapshotText.size());
+        if (!outFile) {
+            LOG_INFO("Failed to write metrics file: %s", tempFilePath.c_str());
+            return;
+        }
+    }
+
+    std::error_code errorCode{};
+    std::filesystem::rename(tempFilePath, filePath, errorCode);
+    if (errorCode) {
+        LOG_INFO("Failed to replace %s: %s", filePath.c_str(),
+                 errorCode.message().c_str());
+    }
+}
+
+void MetricsExporter::appendPrometheus()
+{
+    // Hold a read guard so clients can't be destroyed while we read them.
+    ClientRegistry::ReadGuard readGuard{clientRegistry};
+
+    append("# TYPE am_connected_clients gauge\n");
+    append("am_connected_clients %u\n", clientRegistry.size());
+
+    // Per-MessageType counters.
+    // Note: Types that have never been seen are skipped.
+    append("# TYPE am_messages_sent_total counter\n"
+           "# TYPE am_message_bytes_sent_total counter\n"
+           "# TYPE am_messages_received_total counter\n"
+           "# TYPE am_message_bytes_received_total counter\n");
+    for (std::size_t i = 0; i < NetworkMetrics::MESSAGE_TYPE_COUNT; ++i) {
+        MessageType messageType{static_cast<MessageType>(i)};
+        MessageTypeMetrics typeMetrics{
+            NetworkMetrics::getMessageTypeMetrics(messageType)};
+        if ((typeMetrics.messagesSent == 0)
+            && (typeMetrics.messagesReceived == 0)) {
+            continue;
+        }
+
+        const char* typeName{getMessageTypeName(messageType)};
+        char unknownName[16];
+        if (typeName == nullptr) {
+            std::snprintf(unknownName, sizeof(unknownName), "Unknown%zu", i);
+            typeName = unknownName;
+        }
+
+        append("am_messages_sent_total{type=\"%s\"} %llu\n", typeName,
+               static_cast<unsigned long long>(typeMetrics.messagesSent));
+        append("am_message_bytes_sent_total{type=\"%s\"} %llu\n", typeName,
+               static_cast<unsigned long long>(typeMetrics.bytesSent));
+        append("am_messages_received_total{type=\"%s\"} %llu\n", typeName,
+               static_cast<unsigned long long>(typeMetrics.messagesReceived));
+        append("am_message_bytes_received_total{type=\"%s\"} %llu\n",
+               typeName,
+               static_cast<unsigned long long>(typeMetrics.bytesReceived));
+    }
+
+    // Per-client counters and gauges.
+    append("# TYPE am_client_bytes_sent_total counter\n"
+           "# TYPE am_client_bytes_received_total counter\n"
+           "# TYPE am_client_messages_sent_total counter\n"
+           "# TYPE am_client_messages_received_total counter\n"
+           "# TYPE am_client_compression_ratio gauge\n"
+           "# TYPE am_client_dropped_inputs_total counter\n"
+           "# TYPE am_client_queued_bytes gauge\n"
+           "# TYPE am_client_send_backlog_bytes gauge\n"
+           "# TYPE am_client_send_latency_us summary\n");
+    clientRegistry.forEach([&](Client& client) {
+        ClientMetrics& metrics{client.getMetrics()};
+        unsigned int netID{client.getNetID()};
+        Uint64 bytesAfterCompression{metrics.bytesAfterCompression};
+        double compressionRatio{
+            (bytesAfterCompression == 0)
+                ? 1.0
+                : (metrics.bytesBeforeCompression
+                   / static_cast<double>(bytesAfterCompression))};
+        Histogram::Snapshot latency{metrics.sendLatencyUs.getSnapshot()};
+
+        append("am_client_bytes_sent_total{client=\"%u\"} %llu\n", netID,
+               static_cast<unsigned long long>(metrics.bytesSent));
+        append("am_client_bytes_received_total{client=\"%u\"} %llu\n", netID,
+               static_cast<unsigned long long>(metrics.bytesReceived));
+        append("am_client_messages_sent_total{client=\"%u\"} %llu\n", netID,
+               static_cast<unsigned long long>(metrics.messagesSent));
+        append("am_client_messages_received_total{client=\"%u\"} %llu\n",
+               netID,
+               static_cast<unsigned long long>(metrics.messagesReceived));
+        append("am_client_compression_ratio{client=\"%u\"} %.3f\n", netID,
+               compressionRatio);
+        append("am_client_dropped_inputs_total{client=\"%u\"} %llu\n", netID,
+               static_cast<unsigned long long>(metrics.droppedInputs));
+        append("am_client_queued_bytes{client=\"%u\"} %zu\n", netID,
+               client.getQueuedBytes());
+        append("am_client_send_backlog_bytes{client=\"%u\"} %zu\n", netID,
+               metrics.sendBacklogBytes.load());
+        append("am_client_send_latency_us{client=\"%u\",quantile=\"0.5\"} "
+               "%llu\n",
+               netID,
+               static_cast<unsigned long long>(latency.getPercentile(0.5)));
+        append("am_client_send_latency_us{client=\"%u\",quantile=\"0.99\"} "
+               "%llu\n",
+               netID,
+               static_cast<unsigned long long>(latency.getPercentile(0.99)));
+        append("am_client_send_latency_us_sum{client=\"%u\"} %llu\n", netID,
+               static_cast<unsigned long long>(latency.sum));
+        append("am_client_send_latency_us_count{client=\"%u\"} %llu\n", netID,
+               static_cast<unsigned long long>(latency.count));
+    });
+
+    // The send latency histogram, across all clients.
+    append("# TYPE am_send_latency_us histogram\n");
+    appendPrometheusHistogram("am_send_latency_us", "",
+                              NetworkMetrics::getSendLatencySnapshot());
+
+    // The input latency histograms, one per pipeline stage.
+    append("# TYPE am_input_latency_us histogram\n");
+    for (std::size_t i = 0; i < InputLatencyMetrics::STAGE_COUNT; ++i) {
+        using Stage = InputLatencyMetrics::Stage;
+        Stage stage{static_cast<Stage>(i)};
+        char labels[32];
+        std::snprintf(labels, sizeof(labels), "stage=\"%s\",",
+                      InputLatencyMetrics::getStageName(stage));
+        appendPrometheusHistogram("am_input_latency_us", labels,
+                                  InputLatencyMetrics::getSnapshot(stage));
+    }
+}
+
+void MetricsExporter::appendPrometheusHistogram(
+    const char* name, const char* labels, const Histogram::Snapshot& snapshot)
+{
+    // Note: Prometheus buckets are cumulative.
+    Uint64 cumulativeCount{0};
+    for (std::size_t i = 0; i < (Histogram::BUCKET_COUNT - 1); ++i) {
+        cumulativeCount += snapshot.bucketCounts[i];
+        append("%s_bucket{%sle=\"%llu\"} %llu\n", name, labels,
+               static_cast<unsigned long long>(
+                   Histogram::getBucketUpperBound(i)),
+               static_cast<unsigned long long>(cumulativeCount));
+    }
+    append("%s_bucket{%sle=\"+Inf\"} %llu\n", name, labels,
+           static_cast<unsigned long long>(snapshot.count));
+
+    // Strip the trailing comma from the labels for the sum and count.
+    std::string_view labelView{labels};
+    if (!(labelView.empty())) {
+        labelView.remove_suffix(1);
+        append("%s_sum{%.*s} %llu\n", name,
+               static_cast<int>(labelView.size()), labelView.data(),
+               static_cast<unsigned long long>(snapshot.sum));
+        append("%s_count{%.*s} %llu\n", name,
+               static_cast<int>(labelView.size()), labelView.data(),
+               static_cast<unsigned long long>(snapshot.count));
+    }
+    else {
+        append("%s_sum %llu\n", name,
+               static_cast<unsigned long long>(snapshot.sum));
+        append("%s_count %llu\n", name,
+               static_cast<unsigned long long>(snapshot.count));
+    }
+}
+
+void MetricsExporter::appendJson()
+{
+    // Hold a read guard so clients can't be destroyed while we read them.
+    ClientRegistry::ReadGuard readGuard{clientRegistry};
+
+    append("{\n  \"timestamp\": %lld,\n  \"connectedClients\": %u,\n",
+           static_cast<long long>(std::time(nullptr)),
+           clientRegistry.size());
+
+    // Per-MessageType counters.
+    // Note: Types that have never been seen are skipped.
+    append("  \"messageTypes\": [");
+    bool isFirst{true};
+    for (std::size_t i = 0; i < NetworkMetrics::MESSAGE_TYPE_COUNT; ++i) {
+        MessageType messageType{static_cast<MessageType>(i)};
+        MessageTypeMetrics typeMetrics{
+            NetworkMetrics::getMessageTypeMetrics(messageType)};
+        if ((typeMetrics.messagesSent == 0)
+            && (typeMetrics.messagesReceived == 0)) {
+            continue;
+        }
+
+        const char* typeName{getMessageTypeName(messageType)};
+        append("%s\n    {\"type\": %zu, \"name\": \"%s\", "
+               "\"messagesSent\": %llu, \"bytesSent\": %llu, "
+               "\"messagesReceived\": %llu, \"bytesReceived\": %llu}",
+               (isFirst ? "" : ","), i,
+               ((typeName == nullptr) ? "Unknown" : typeName),
+               static_cast<unsigned long long>(typeMetrics.messagesSent),
+               static_cast<unsigned long long>(typeMetrics.bytesSent),
+               static_cast<unsigned long long>(typeMetrics.messagesReceived),
+               static_cast<unsigned long long>(typeMetrics.bytesReceived));
+        isFirst = false;
+    }
+    append("\n  ],\n");
+
+    // Per-client counters and gauges.
+    append("  \"clients\": [");
+    isFirst = true;
+    clientRegistry.forEach([&](Client& client) {
+        ClientMetrics& metrics{client.getMetrics()};
+        Histogram::Snapshot latency{metrics.sendLatencyUs.getSnapshot()};
+        append("%s\n    {\"netID\": %u, \"bytesSent\": %llu, "
+               "\"bytesReceived\": %llu, \"messagesSent\": %llu, "
+               "\"messagesReceived\": %llu, "
+               "\"bytesBeforeCompression\": %llu, "
+               "\"bytesAfterCompression\": %llu, \"droppedInputs\": %llu, "
+               "\"queuedBytes\": %zu, \"sendBacklogBytes\": %zu, "
+               "\"sendLatencyUs\": {\"count\": %llu, \"sum\": %llu, "
+               "\"p50\": %llu, \"p99\": %llu}}",
+               (isFirst ? "" : ","), client.getNetID(),
+               static_cast<unsigned long long>(metrics.bytesSent),
+               static_cast<unsigned long long>(metrics.bytesReceived),
+               static_cast<unsigned long long>(metrics.messagesSent),
+               static_cast<unsigned long long>(metrics.messagesReceived),
+               static_cast<unsigned long long>(metrics.bytesBeforeCompression),
+               static_cast<unsigned long long>(metrics.bytesAfterCompression),
+               static_cast<unsigned long long>(metrics.droppedInputs),
+               client.getQueuedBytes(), metrics.sendBacklogBytes.load(),
+               static_cast<unsigned long long>(latency.count),
+               static_cast<unsigned long long>(latency.sum),
+               static_cast<unsigned long long>(latency.getPercentile(0.5)),
+               static_cast<unsigned long long>(latency.getPercentile(0.99)));
+        isFirst = false;
+    });
+    append("\n  ],\n");
+
+    // The send latency histogram, across all clients.
+    append("  \"sendLatencyUs\": ");
+    appendJsonHistogram(NetworkMetrics::getSendLatencySnapshot());
+
+    // The input latency histograms, one per pipeline stage.
+    append(",\n  \"inputLatencyUs\": {");
+    for (std::size_t i = 0; i < InputLatencyMetrics::STAGE_COUNT; ++i) {
+        using Stage = InputLatencyMetrics::Stage;
+        Stage stage{static_cast<Stage>(i)};
+        append("%s\n    \"%s\": ", ((i == 0) ? "" : ","),
+               InputLatencyMetrics::getStageName(stage));
+        appendJsonHistogram(InputLatencyMetrics::getSnapshot(stage));
+    }
+    append("\n  }\n}\n");
+}
+
+void MetricsExporter::appendJsonHistogram(const Histogram::Snapshot& snapshot)
+{
+    append("{\"count\": %llu, \"sum\": %llu, \"p50\": %llu, \"p99\": %llu, "
+           "\"buckets\": [",
+           static_cast<unsigned long long>(snapshot.count),
+           static_cast<unsigned long long>(snapshot.sum),
+           static_cast<unsigned long long>(snapshot.getPercentile(0.5)),
+           static_cast<unsigned long long>(snapshot.getPercentile(0.99)));
+
+    // Note: The last bucket is unbounded, so we give it a null bound.
+    for (std::size_t i = 0; i < Histogram::BUCKET_COUNT; ++i) {
+        bool isLast{i == (Histogram::BUCKET_COUNT - 1)};
+        if (isLast) {
+            append("{\"le\": null, \"count\": %llu}",
+                   static_cast<unsigned long long>(snapshot.bucketCounts[i]));
+        }
+        else {
+            append("{\"le\": %llu, \"count\": %llu}, ",
+                   static_cast<unsigned long long>(
+                       Histogram::getBucketUpperBound(i)),
+                   static_cast<unsigned long long>(snapshot.bucketCounts[i]));
+        }
+    }
+    append("]}");
+}
+
+void MetricsExporter::plotToTracy()
+{
+    // Sum up our per-client gauges.
+    std::size_t queuedBytes{0};
+    std::size_t sendBacklogBytes{0};
+    Uint64 droppedInputs{0};
+    unsigned int clientCount{0};
+    {
+        ClientRegistry::ReadGuard readGuard{clientRegistry};
+        clientRegistry.forEach([&](Client& client) {
+            queuedBytes += client.getQueuedBytes();
+            sendBacklogBytes += client.getMetrics().sendBacklogBytes;
+            droppedInputs += client.getMetrics().droppedInputs;
+        });
+        clientCount = clientRegistry.size();
+    }
+
+    // Calc the mean send latency since our last plot.
+    Histogram::Snapshot latency{NetworkMetrics::getSendLatencySnapshot()};
+    Uint64 newCount{latency.count - lastPlottedLatency.count};
+    double meanLatencyUs{
+        (newCount == 0)
+            ? 0
+            : ((latency.sum - lastPlottedLatency.sum)
+               / static_cast<double>(newCount))};
+    lastPlottedLatency = latency;
+
+    TracyPlot("ConnectedClients", static_cast<int64_t>(clientCount));
+    TracyPlot("QueuedBytes", static_cast<int64_t>(queuedBytes));
+    TracyPlot("SendBacklogBytes", static_cast<int64_t>(sendBacklogBytes));
+    TracyPlot("DroppedInputs", static_cast<int64_t>(droppedInputs));
+    TracyPlot("SendLatencyUs", meanLatencyUs);
+}
+
+void MetricsExporter::append(const char* format, ...)
+{
+    // Find the formatted size, then format directly into the string.
+    std::va_list args;
+    va_start(args, format);
+    std::va_list argsCopy;
+    va_copy(argsCopy, args);
+    int formattedSize{std::vsnprintf(nullptr, 0, format, args)};
+    va_end(args);
+
+    if (formattedSize > 0) {
+        std::size_t oldSize{snapshotText.size()};
+        snapshotText.resize(oldSize + formattedSize);
+        // Note: vsnprintf writes a null terminator, which lands on the
+        //       string's own terminator.
+        std::vsnprintf(&(snapshotText[oldSize]), (formattedSize + 1), format,
+                       argsCopy);
+    }
+    va_end(argsCopy);
+}
+
+const char* MetricsExporter::getMessageTypeName(MessageType messageType)
+{
+    switch (messageType) {
+        case MessageType::Heartbeat:
+            return "Heartbeat";
+        case MessageType::ConnectionRequest:
+            return "ConnectionRequest";
+        case MessageType::InputChangeRequest:
+            return "InputChangeRequest";
+        case MessageType::ChunkUpdateRequest:
+            return "ChunkUpdateRequest";
+        case MessageType::TileUpdateRequest:
+            return "TileUpdateRequest";
+        case MessageType::ExplicitConfirmation:
+            return "ExplicitConfirmation";
+        case MessageType::ConnectionResponse:
+            return "ConnectionResponse";
+        case MessageType::MovementUpdate:
+            return "MovementUpdate";
+        case MessageType::ChunkUpdate:
+            return "ChunkUpdate";
+        case MessageType::TileUpdate:
+            return "TileUpdate";
+        case MessageType::EntityInit:
+            return "EntityInit";
+        case MessageType::EntityDelete:
+            return "EntityDelete";
+        case MessageType::MessageFragment:
+            return "MessageFragment";
+        default:
+            return nullptr;
+    }
+}
+
+} // End namespace Server
+} // End namespace AM
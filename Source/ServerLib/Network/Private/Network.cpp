@@ -1,4 +1,6 @@
 #include "Network.h"
+#include "Client.h"
+#include "Config.h"
 #include "Acceptor.h"
 #include "Peer.h"
 #include "Deserialize.h"
@@ -17,8 +19,19 @@ namespace Server
 {
 
 Network::Network()
-: messageProcessor(eventDispatcher)
-, clientHandler(*this, eventDispatcher, messageProcessor)
+: Network(std::make_unique<Acceptor>(SERVER_PORT, Config::MAX_CLIENTS),
+          Config::RECORD_INPUT_TRACE)
+{
+}
+
+Network::Network(std::unique_ptr<AcceptorBase> inAcceptor,
+                 bool recordInputTrace)
+: clientRegistry(Config::MAX_CLIENTS)
+, messageProcessor(eventDispatcher)
+, clientHandler(*this, eventDispatcher, messageProcessor,
+                std::move(inAcceptor), recordInputTrace)
+, messageBufferPool(Config::MESSAGE_BUFFER_POOL_SIZE)
+, metricsExporter(clientRegistry)
 , ticksSinceNetstatsLog(0)
 , currentTickPtr(nullptr)
 {
@@ -38,6 +51,9 @@ void Network::tick()
         logNetworkStatistics();
         ticksSinceNetstatsLog = 0;
     }
+
+    // Export our metrics, if it's time to do so.
+    metricsExporter.tick();
 }
 
 EventDispatcher& Network::getEventDispatcher()
@@ -45,14 +61,21 @@ EventDispatcher& Network::getEventDispatcher()
     return eventDispatcher;
 }
 
-ClientMap& Network::getClientMap()
+ClientRegistry& Network::getClientRegistry()
 {
-    return clientMap;
+    return clientRegistry;
 }
 
-SharedLockableBase(std::shared_mutex) & Network::getClientMapMutex()
+void Network::recordDroppedInput(NetworkID networkID)
 {
-    return clientMapMutex;
+    // Hold a read guard so the client can't be destroyed while we use it.
+    ClientRegistry::ReadGuard readGuard{clientRegistry};
+
+    Client* client{clientRegistry.find(networkID)};
+    if (client != nullptr) {
+        client->getMetrics().droppedInputs.fetch_add(
+            1, std::memory_order_relaxed);
+    }
 }
 
 void Network::registerCurrentTickPtr(
@@ -73,15 +96,15 @@ void Network::setMessageProcessorExtension(
 }
 
 void Network::send(NetworkID networkID, const BinaryBufferSharedPtr& message,
-                   Uint32 messageTick)
+                   Uint32 messageTick, Uint64 inputReceiveTime)
 {
-    // Acquire a read lock before running through the client map.
-    std::shared_lock readLock(clientMapMutex);
+    // Hold a read guard so the client can't be destroyed while we use it.
+    ClientRegistry::ReadGuard readGuard{clientRegistry};
 
     // Check that the client still exists, queue the message if so.
-    auto clientPair = clientMap.find(networkID);
-    if (clientPair != clientMap.end()) {
-        clientPair->second->queueMessage(message, messageTick);
+    Client* client{clientRegistry.find(networkID)};
+    if (client != nullptr) {
+        client->queueMessage(message, messageTick, inputReceiveTime);
     }
 }
 
@@ -97,6 +120,27 @@ void Network::logNetworkStatistics()
                                  / static_cast<float>(SECONDS_TILL_STATS_DUMP)};
     LOG_INFO("Bytes sent per second: %.0f, Bytes received per second: %.0f",
              bytesSentPerSecond, bytesReceivedPerSecond);
+
+    // Log our compression decisions.
+    using Level = StreamCompressor::Level;
+    float compressionRatio{0};
+    if (netStats.bytesAfterCompression > 0) {
+        compressionRatio
+            = netStats.bytesBeforeCompression
+              / static_cast<float>(netStats.bytesAfterCompression);
+    }
+    LOG_INFO("Compressed batches (fast/default/high): %u/%u/%u, Ratio: %.2f, "
+             "Skipped (small/low gain): %u/%u",
+             netStats.compressedBatches[static_cast<std::size_t>(Level::Fast)],
+             netStats.compressedBatches[static_cast<std::size_t>(
+                 Level::Default)],
+             netStats.compressedBatches[static_cast<std::size_t>(Level::High)],
+             compressionRatio, netStats.skippedSmallBatches,
+             netStats.skippedLowGainBatches);
+
+    // Log how well our clients are keeping up.
+    LOG_INFO("Backlogged sends: %u, Max send backlog: %zu bytes",
+             netStats.backloggedSends, netStats.maxSendBacklog);
 }
 
 } // namespace Server
@@ -1,14 +1,22 @@
 #pragma once
 
 #include "Peer.h"
+#include "StreamCompressor.h"
+#include "StreamDecompressor.h"
+#include "CompressionPolicy.h"
+#include "ClientMetrics.h"
 #include "NetworkDefs.h"
 #include "Config.h"
+#include "SharedConfig.h"
 #include "CircularBuffer.h"
 #include "Timer.h"
 #include "readerwriterqueue.h"
 #include "Tracy.hpp"
+#include "entt/fwd.hpp"
 #include <memory>
 #include <array>
+#include <vector>
+#include <unordered_set>
 #include <mutex>
 #include <atomic>
 
@@ -23,30 +31,69 @@ namespace Server
 class Client
 {
 public:
+    /** The worst-case number of bytes that compression may add to a batch.
+        Matches LZ4_COMPRESSBOUND() for a MAX_BATCH_SIZE batch. */
+    static constexpr unsigned int COMPRESSION_OVERHEAD{
+        (SharedConfig::MAX_BATCH_SIZE / 255) + 16};
+
+    /** The max number of message bytes that fit in a single batch. Messages
+        larger than this are sent as MessageFragments.
+        Leaves room for compression to expand the batch, since the client
+        won't accept a batch larger than SharedConfig::MAX_BATCH_SIZE. */
+    static constexpr unsigned int MAX_BATCH_PAYLOAD_SIZE{
+        SharedConfig::MAX_BATCH_SIZE - SERVER_HEADER_SIZE
+        - COMPRESSION_OVERHEAD};
+
+    /** The index in the batch buffer that a full batch ends at. */
+    static constexpr unsigned int MAX_BATCH_END_INDEX{
+        SERVER_HEADER_SIZE + MAX_BATCH_PAYLOAD_SIZE};
+
     Client(NetworkID inNetID, std::unique_ptr<Peer> inPeer);
 
     /**
      * Queues a message to be sent the next time sendWaitingMessages is called.
      *
+     * If this client's queued messages would exceed
+     * Config::CLIENT_SEND_QUEUE_LIMIT_BYTES, the message is dropped and the
+     * client is considered disconnected.
+     *
      * @param message  The message to queue.
      * @param messageTick  If non-0, used to update our latestSentSimTick.
      *                     Use 0 if sending messages that aren't associated
      *                     with a tick.
+     * @param inputReceiveTime  If non-0, the time that the traced input that
+     *                          this message responds to was received. See
+     *                          InputLatencyMetrics.
      */
-    void queueMessage(const BinaryBufferSharedPtr& message, Uint32 messageTick);
+    void queueMessage(const BinaryBufferSharedPtr& message, Uint32 messageTick,
+                      Uint64 inputReceiveTime = 0);
 
     /**
-     * Attempts to send all queued messages over the network.
+     * Attempts to send the queued messages over the network.
+     *
+     * Sync and lifetime messages are always sent. Chunk data and bulk
+     * messages are sent until Config::CLIENT_SEND_BYTES_PER_TICK is reached,
+     * and the rest are left for the next call.
      *
      * @param currentTick  The sim's current tick.
+     * @param inCompressionLevel  The level to use for any batches that our
+     *                            CompressionPolicy decides to compress.
      * @return An appropriate NetworkResult.
      */
-    NetworkResult sendWaitingMessages(Uint32 currentTick);
+    NetworkResult sendWaitingMessages(
+        Uint32 currentTick,
+        StreamCompressor::Level inCompressionLevel
+        = StreamCompressor::Level::Default);
 
     /**
      * Tries to receive a message from this client.
      * If no message is received, checks if this client has timed out.
      *
+     * The client sends its messages in batches. Each call returns the next
+     * message from the current batch, receiving a new batch when it runs
+     * out. Batches that arrived together are buffered by the peer, so this
+     * should be called until it stops returning Success.
+     *
      * Note: It's expected that you called SDLNet_CheckSockets() on the
      *       outside-managed socket set before calling this.
      *
@@ -61,11 +108,13 @@ public:
     /**
      * @return True if the client is connected, else false.
      *
-     * Note: There's 2 places where a disconnect can occur:
+     * Note: There's 3 places where a disconnect can occur:
      *       If the client initiates a disconnect, the peer will internally set
      *       a flag.
      *       If we initiated a disconnect, peer will be set to nullptr.
-     *       Both cases are detected by this method.
+     *       If the client fell too far behind, sendQueueOverflowed will be
+     *       set.
+     *       All cases are detected by this method.
      */
     bool isConnected();
 
@@ -82,29 +131,175 @@ public:
 
     NetworkID getNetID();
 
+    /**
+     * Returns the number of bytes that we've sent to this client, but that
+     * the OS hasn't accepted yet. A growing backlog means the client isn't
+     * keeping up.
+     */
+    std::size_t getSendBacklogSize();
+
+    /**
+     * Returns the number of bytes that are waiting in our send queues.
+     */
+    std::size_t getQueuedBytes();
+
+    /**
+     * Returns this client's network metrics.
+     */
+    ClientMetrics& getMetrics();
+
 private:
+    /**
+     * The classes that our queued messages are sorted into, from highest to
+     * lowest priority.
+     */
+    enum class SendPriority : Uint8 {
+        /** Tick synchronization (ConnectionResponse, MovementUpdate). */
+        Sync,
+        /** Entity lifetime (EntityInit, EntityDelete). */
+        Lifetime,
+        /** Tile map data (ChunkUpdate, TileUpdate). These share a class so
+            that tile updates can't overtake the chunk data they modify. */
+        ChunkData,
+        /** Everything else. */
+        Bulk,
+        Count
+    };
+
+    /** Convenience struct for passing data through the send queues. */
+    struct QueuedMessage {
+        /** The message to send. */
+        BinaryBufferSharedPtr message;
+
+        /** The tick that the message corresponds to. */
+        Uint32 tick;
+
+        /** The SDL performance counter value from when the message was
+            queued. Used to measure send latency. */
+        Uint64 queueTime;
+
+        /** If non-0, the time that the traced input that this message
+            responds to was received. */
+        Uint64 inputReceiveTime;
+    };
+
     //--------------------------------------------------------------------------
     // Helpers
     //--------------------------------------------------------------------------
     /**
-     * Returns the number of messages waiting in the sendQueue.
-     * The return type is Uint8 because it needs to fit in 1 byte of a message.
+     * Returns the priority class that the given type of message belongs to.
      */
-    Uint8 getWaitingMessageCount() const;
+    static SendPriority getSendPriority(MessageType messageType);
+
+    /**
+     * Returns the send queue for the given priority class.
+     */
+    moodycamel::ReaderWriterQueue<QueuedMessage>&
+        getSendQueue(SendPriority priority);
+
+    /**
+     * If any of the given MovementUpdates have entity states that are
+     * superseded by a newer update, removes them. Updates that end up empty
+     * are removed entirely, since the next update implicitly confirms their
+     * tick.
+     *
+     * Only does anything if the client has fallen behind: our send backlog
+     * is non-empty, or more than Config::MOVEMENT_COALESCE_THRESHOLD
+     * updates are waiting. Otherwise, every update is sent.
+     *
+     * @param messages  The waiting sync messages, oldest first.
+     */
+    void coalesceMovementUpdates(std::vector<QueuedMessage>& messages);
+
+    /**
+     * Adds the given message to the current batch, fragmenting it if
+     * necessary and sending batches as they fill up.
+     *
+     * @param currentIndex  The current end of the batch.
+     * @param sentBatch  Set to true if a batch was sent.
+     * @return An appropriate NetworkResult.
+     */
+    NetworkResult addMessage(const QueuedMessage& queuedMessage,
+                             unsigned int& currentIndex, bool& sentBatch);
+
+    /**
+     * Pops messages from the given send queue and adds them to the current
+     * batch until the queue is empty or bytesAdded reaches byteBudget.
+     *
+     * @param bytesAdded  Incremented by the size of each added message.
+     * @return An appropriate NetworkResult.
+     */
+    NetworkResult addQueuedMessages(SendPriority priority,
+                                    std::size_t byteBudget,
+                                    std::size_t& bytesAdded,
+                                    unsigned int& currentIndex,
+                                    bool& sentBatch);
+
+    /**
+     * Splits the given message into MessageFragments and adds them to the
+     * current batch, sending batches as they fill up.
+     *
+     * Used for messages that are too large to fit in a single batch.
+     *
+     * @param message  The message to fragment, including its header.
+     * @param currentIndex  The current end of the batch. Updated to the new
+     *                      end after the fragments are added.
+     * @param sentBatch  Set to true if a batch was sent.
+     * @return An appropriate NetworkResult.
+     */
+    NetworkResult addFragmentedMessage(const BinaryBuffer& message,
+                                       unsigned int& currentIndex,
+                                       bool& sentBatch);
+
+    /**
+     * Compresses (if worthwhile), fills the header of, and sends the batch
+     * currently in batchBuffer, then resets currentIndex to start a new batch.
+     *
+     * @param currentIndex  The current end of the batch.
+     * @param sentBatch  Set to true.
+     * @return An appropriate NetworkResult.
+     */
+    NetworkResult sendBatch(unsigned int& currentIndex, bool& sentBatch);
 
     /**
      * Adds an explicit confirmation to the current batch.
      */
-    void addExplicitConfirmation(unsigned int& currentIndex, Uint32 currentTick,
-                                 Uint8& messageCount);
+    void addExplicitConfirmation(unsigned int& currentIndex,
+                                 Uint32 currentTick);
+
+    /**
+     * Updates batchMix to account for the given message (or fragment of a
+     * message) being added to the current batch.
+     */
+    void updateBatchMix(const BinaryBuffer& message, unsigned int bytesAdded);
 
     /**
      * Compresses the first batchSize bytes in the payload section of
      * batchBuffer into compressedBatchBuffer and returns the compressed
      * payload size.
+     *
+     * The batch is added to batchCompressor's stream, so it must be sent.
      */
     unsigned int compressBatch(unsigned int batchSize);
 
+    /**
+     * Tries to receive a batch from this client into receivedBatchBuffer,
+     * decompressing it if necessary.
+     *
+     * @return Success if a batch was received, NoWaitingData if a full batch
+     *         isn't available yet, or Disconnected if the client disconnected
+     *         or sent a malformed batch.
+     */
+    NetworkResult receiveBatch();
+
+    /**
+     * Copies the next message in the current received batch into the given
+     * buffer.
+     *
+     * If the message is malformed, drops the connection.
+     */
+    ReceiveResult readBatchedMessage(Uint8* messageBuffer);
+
     /**
      * Fills in the header information for the message batch currently being
      * built.
@@ -124,32 +319,89 @@ private:
     /** Our connection and interface to the client. */
     std::unique_ptr<Peer> peer;
 
-    /** Convenience struct for passing data through the sendQueue. */
-    struct QueuedMessage {
-        /** The message to send. */
-        BinaryBufferSharedPtr message;
+    /** Holds messages to be sent with the next call to sendWaitingMessages,
+        one queue per SendPriority. */
+    std::array<moodycamel::ReaderWriterQueue<QueuedMessage>,
+               static_cast<std::size_t>(SendPriority::Count)>
+        sendQueues;
 
-        /** The tick that the message corresponds to. */
-        Uint32 tick;
-    };
-    /** Holds messages to be sent with the next call to sendWaitingMessages. */
-    moodycamel::ReaderWriterQueue<QueuedMessage> sendQueue;
+    /** The total size of the messages in sendQueues. */
+    std::atomic<std::size_t> queuedBytes;
+
+    /** Set if queuedBytes would've exceeded
+        Config::CLIENT_SEND_QUEUE_LIMIT_BYTES. Once set, this client is
+        considered disconnected. */
+    std::atomic<bool> sendQueueOverflowed;
+
+    /** Holds the sync messages while we coalesce and send them. */
+    std::vector<QueuedMessage> syncMessages;
+
+    /** Used while coalescing, holds the entities that have a newer state
+        waiting to be sent. */
+    std::unordered_set<entt::entity> supersededEntities;
+
+    /** The size of an ExplicitConfirmation message, including its header. */
+    static constexpr unsigned int EXPLICIT_CONFIRMATION_SIZE{
+        MESSAGE_HEADER_SIZE + 1};
 
     /** Holds header and message data while we're putting the next batch
         together.
+        Each call to sendWaitingMessages() may send multiple batches, if the
+        waiting messages don't fit in one.
         If the batch does not need to be compressed, it will be sent directly
         from this buffer. */
     static BinaryBuffer batchBuffer;
 
+    /** Compresses our batches as a single stream, so that each batch can
+        reference the ones before it. The client's Network holds the matching
+        StreamDecompressor. */
+    StreamCompressor batchCompressor;
+
+    /** Decides whether each batch is worth compressing. */
+    CompressionPolicy compressionPolicy;
+
+    /** The compression level to use for the batches that we're currently
+        sending. */
+    StreamCompressor::Level compressionLevel;
+
+    /** The type of message that makes up most of the current batch.
+        Used by compressionPolicy. */
+    MessageType batchMix;
+
+    /** The size of the largest message in the current batch. */
+    unsigned int batchMixSize;
+
     /** If a batch needs to be compressed, the compressed bytes will be written
         to and sent from this buffer.
-        See SharedConfig::BATCH_COMPRESSION_THRESHOLD for more info. */
+        See CompressionPolicy for more info. */
     static BinaryBuffer compressedBatchBuffer;
 
+    /** Holds the batch that we're currently reading received messages from.
+        If the batch was compressed, holds the compressed bytes. */
+    BinaryBuffer receivedBatchBuffer;
+
+    /** Points to the start of the batch that we're currently reading
+        received messages from, either in receivedBatchBuffer or in
+        batchDecompressor's ring buffer. */
+    const Uint8* receivedBatch;
+
+    /** The size of the batch at receivedBatch. */
+    std::size_t receivedBatchSize;
+
+    /** The index in receivedBatch of the next message to read. */
+    std::size_t receivedBatchIndex;
+
+    /** Decompresses the client's batch stream. Only allocated once the
+        client sends a compressed batch, since most clients don't. */
+    std::unique_ptr<StreamDecompressor> batchDecompressor;
+
     /** Tracks how long it's been since we've received a message from this
         client. */
     Timer receiveTimer;
 
+    /** Our cumulative network metrics. */
+    ClientMetrics metrics;
+
     //--------------------------------------------------------------------------
     // Synchronization Functions
     //--------------------------------------------------------------------------
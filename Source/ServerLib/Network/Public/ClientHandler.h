@@ -2,9 +2,12 @@
 
 #include "MessageType.h"
 #include "ServerNetworkDefs.h"
+#include "ClientRegistry.h"
 #include "Client.h"
-#include "Acceptor.h"
-#include "IDPool.h"
+#include "AcceptorBase.h"
+#include "InputTraceRecorder.h"
+#include "StreamCompressor.h"
+#include "Timer.h"
 #include "Tracy.hpp"
 #include <thread>
 #include <queue>
@@ -28,13 +31,20 @@ class MessageProcessor;
  * Accepts new client connections, erases clients that have been detected as
  * disconnected, and receives available messages.
  *
- * Acts directly on the Network's client map.
+ * Acts directly on the Network's client registry, as its writer thread.
  */
 class ClientHandler
 {
 public:
+    /**
+     * @param inAcceptor  The acceptor to accept new clients through.
+     * @param recordInputTrace  If true, client activity will be recorded to
+     *                          InputTrace.bin.
+     */
     ClientHandler(Network& inNetwork, EventDispatcher& inDispatcher,
-                  MessageProcessor& inMessageProcessor);
+                  MessageProcessor& inMessageProcessor,
+                  std::unique_ptr<AcceptorBase> inAcceptor,
+                  bool recordInputTrace);
 
     ~ClientHandler();
 
@@ -46,7 +56,7 @@ public:
 private:
     /**
      * How long the accept/disconnect/receive loop in serviceClients should
-     * delay if no socket activity was reported on the clientSet.
+     * delay if no socket activity was reported on the acceptor's clients.
      */
     static constexpr unsigned int INACTIVE_DELAY_TIME_MS = 1;
 
@@ -56,7 +66,7 @@ private:
      * Accepts new client connections, erases clients that have been detected as
      * disconnected, and receives available messages.
      *
-     * Acts directly on the Network's client map.
+     * Acts directly on the Network's client registry, as its writer thread.
      */
     void serviceClients();
 
@@ -73,14 +83,27 @@ private:
     void sendClientUpdates();
 
     /**
-     * Accepts any new clients, pushing them into the Network's client map.
+     * Raises or lowers compressionLevel based on how much of the network
+     * tick was left over after the last send.
+     *
+     * We step up a level at a time, after the spare time has stayed high for
+     * Config::COMPRESSION_RAISE_TICKS ticks. We step down as soon as the spare
+     * time drops too low.
+     *
+     * @param sendTimeS  How long the last send took, in seconds.
+     */
+    void updateCompressionLevel(double sendTimeS);
+
+    /**
+     * Accepts any new clients, pushing them into the Network's client
+     * registry.
      */
-    void acceptNewClients(ClientMap& clientMap);
+    void acceptNewClients(ClientRegistry& clientRegistry);
 
     /**
-     * Erase any disconnected clients from the Network's clientMap.
+     * Erase any disconnected clients from the Network's client registry.
      */
-    void eraseDisconnectedClients(ClientMap& clientMap);
+    void eraseDisconnectedClients(ClientRegistry& clientRegistry);
 
     /**
      * Receives any waiting client messages and passes them to
@@ -88,7 +111,7 @@ private:
      *
      * @return The number of messages that were received.
      */
-    int receiveAndProcessClientMessages(ClientMap& clientMap);
+    int receiveAndProcessClientMessages(ClientRegistry& clientRegistry);
 
     /**
      * Passes received client messages to the MessageProcessor.
@@ -103,7 +126,7 @@ private:
     void processReceivedMessage(Client& client, MessageType messageType,
                                 unsigned int messageSize);
 
-    /** Used to get the client map and current tick. */
+    /** Used to get the client registry and current tick. */
     Network& network;
 
     /** Used to push network events like connections/disconnections. */
@@ -112,22 +135,17 @@ private:
     /** Used to process received messages. */
     MessageProcessor& messageProcessor;
 
-    /** Used for generating network IDs. */
-    IDPool idPool;
-
-    /** The number of clients that are currently connected. */
-    unsigned int clientCount;
-
-    /** The socket set used for all clients. Lets us do select()-like behavior,
-        allowing our receive thread to not be constantly spinning. */
-    std::shared_ptr<SocketSet> clientSet;
-
-    /** The listener that we use to accept new clients. */
-    Acceptor acceptor;
+    /** The acceptor that we use to accept new clients. Also lets us check all
+        of the clients for activity at once. */
+    std::unique_ptr<AcceptorBase> acceptor;
 
     /** Holds a received message while we pass it to MessageProcessor. */
     BinaryBuffer messageRecBuffer;
 
+    /** If input trace recording was requested, records client activity to
+        InputTrace.bin. Else, nullptr. */
+    std::unique_ptr<InputTraceRecorder> inputTraceRecorder;
+
     /** Calls serviceClients(). */
     std::thread receiveThreadObj;
     /** Turn false to signal that the send and receive threads should end. */
@@ -141,6 +159,16 @@ private:
     std::condition_variable_any sendCondVar;
     /** Used for signaling the send thread. */
     bool sendRequested;
+
+    /** Used to time each send, to see how much spare time we have. */
+    Timer sendTimer;
+
+    /** The level that the send thread uses to compress batches. */
+    StreamCompressor::Level compressionLevel;
+
+    /** The number of consecutive sends that have had enough spare time to
+        raise compressionLevel. */
+    unsigned int ticksWithSpareTime;
 };
 
 } // End namespace Server
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Histogram.h"
+#include <SDL_stdinc.h>
+#include <atomic>
+#include <cstddef>
+
+namespace AM
+{
+namespace Server
+{
+/**
+ * Cumulative network metrics for a single client.
+ *
+ * Written by the network threads, and read by MetricsExporter. All members
+ * are atomic, so they may be read from any thread.
+ */
+struct ClientMetrics {
+    /** The number of bytes that we've sent, including batch headers and
+        after compression. */
+    std::atomic<Uint64> bytesSent{0};
+
+    /** The number of bytes that we've received, including batch headers and
+        before decompression. */
+    std::atomic<Uint64> bytesReceived{0};
+
+    /** The number of messages that we've sent. Fragmented messages count
+        once. */
+    std::atomic<Uint64> messagesSent{0};
+
+    /** The number of messages that we've received. */
+    std::atomic<Uint64> messagesReceived{0};
+
+    /** The total size of our compressed batches, before and after
+        compression. */
+    std::atomic<Uint64> bytesBeforeCompression{0};
+    std::atomic<Uint64> bytesAfterCompression{0};
+
+    /** The number of the client's inputs that arrived too late to be
+        processed. */
+    std::atomic<Uint64> droppedInputs{0};
+
+    /** The number of bytes that the OS hasn't accepted yet, as of our
+        latest send. */
+    std::atomic<std::size_t> sendBacklogBytes{0};
+
+    /** The time, in microseconds, between a message being queued and it
+        being added to an outgoing batch. */
+    Histogram sendLatencyUs{};
+};
+
+} // End namespace Server
+} // End namespace AM
@@ -0,0 +1,173 @@
+#pragma once
+
+#include "NetworkDefs.h"
+#include "IDPool.h"
+#include <SDL_stdinc.h>
+#include <memory>
+#include <vector>
+#include <deque>
+#include <array>
+#include <atomic>
+
+namespace AM
+{
+class Peer;
+
+namespace Server
+{
+class Client;
+
+/**
+ * Owns all connected clients, in a dense array of slots.
+ *
+ * NetworkIDs are made up of a slot index (the low 16 bits) and a generation
+ * (the high 16 bits). The generation is incremented each time a slot is
+ * freed, so stale messages that refer to a previous client's ID won't find
+ * the slot's new client.
+ *
+ * Threading:
+ *   Only one thread (the writer, i.e. the receive thread) may call emplace(),
+ *   erase(), and reclaim(). The writer can find() and forEach() freely.
+ *   Any other thread may find() and forEach() while it holds a ReadGuard.
+ *   Reads never take a lock.
+ *
+ *   Erased clients aren't destroyed right away. They're retired, and
+ *   reclaim() destroys them once every reader that may have seen them has
+ *   released its guard (epoch-based reclamation).
+ */
+class ClientRegistry
+{
+public:
+    /** The number of bits in a NetworkID that hold the slot index. */
+    static constexpr unsigned int INDEX_BITS{16};
+    static constexpr NetworkID INDEX_MASK{(1 << INDEX_BITS) - 1};
+
+    /**
+     * Marks a read-side critical section. While a guard is alive, any client
+     * pointer that was obtained through the registry stays valid.
+     *
+     * Guards should be short-lived, since they hold up reclamation.
+     */
+    class ReadGuard
+    {
+    public:
+        ReadGuard(ClientRegistry& inRegistry);
+
+        ~ReadGuard();
+
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+    private:
+        ClientRegistry& registry;
+
+        /** The index in activeReaders that we're counted in. */
+        unsigned int epochIndex;
+    };
+
+    /**
+     * @param maxClients  The maximum number of clients that may be connected
+     *                    at one time.
+     */
+    ClientRegistry(unsigned int maxClients);
+
+    ~ClientRegistry();
+
+    /**
+     * Reserves a slot and constructs a client in it, using the given peer.
+     * Writer thread only.
+     *
+     * @return The new client's NetworkID.
+     */
+    NetworkID emplace(std::unique_ptr<Peer> peer);
+
+    /**
+     * Removes the client with the given ID and frees its slot.
+     * The client is retired, to be destroyed by a later reclaim().
+     * Writer thread only.
+     */
+    void erase(NetworkID netID);
+
+    /**
+     * Advances the epoch if the previous epoch's readers have all left, and
+     * destroys any retired clients that can no longer be referenced.
+     * Writer thread only. Should be called regularly.
+     */
+    void reclaim();
+
+    /**
+     * Returns the client with the given ID, or nullptr if it doesn't exist.
+     *
+     * Non-writer threads must hold a ReadGuard while calling this and while
+     * using the returned client.
+     */
+    Client* find(NetworkID netID);
+
+    /**
+     * Calls the given function on each client.
+     *
+     * Non-writer threads must hold a ReadGuard while calling this.
+     */
+    template<typename Func>
+    void forEach(Func&& func);
+
+    /**
+     * Returns the number of clients in the registry.
+     */
+    unsigned int size() const;
+
+    /**
+     * Returns the slot index part of the given NetworkID.
+     */
+    static unsigned int getSlotIndex(NetworkID netID);
+
+private:
+    /**
+     * A client that was erased but may still be referenced by a reader.
+     */
+    struct RetiredClient {
+        /** The epoch that the client was retired during. */
+        Uint32 epoch{0};
+
+        std::unique_ptr<Client> client{};
+    };
+
+    /** Used for reserving slot indices. */
+    IDPool idPool;
+
+    /** The published client in each slot, or nullptr if the slot is empty.
+        Readers load from this array. */
+    std::vector<std::atomic<Client*>> slots;
+
+    /** Owns the client in each slot. Writer only. */
+    std::vector<std::unique_ptr<Client>> owners;
+
+    /** The current generation of each slot. Writer only. */
+    std::vector<Uint16> generations;
+
+    /** The number of clients in the registry. */
+    std::atomic<unsigned int> clientCount;
+
+    /** The current reclamation epoch. Only advanced by the writer. */
+    std::atomic<Uint32> epoch;
+
+    /** The number of readers that entered during an even or odd epoch. */
+    std::array<std::atomic<unsigned int>, 2> activeReaders;
+
+    /** Clients that are waiting to be destroyed, oldest first. */
+    std::deque<RetiredClient> retiredClients;
+};
+
+template<typename Func>
+void ClientRegistry::forEach(Func&& func)
+{
+    for (std::atomic<Client*>& slot : slots) {
+        Client* client{slot.load()};
+        if (client != nullptr) {
+            func(*client);
+        }
+    }
+}
+
+} // End namespace Server
+} // End namespace AM
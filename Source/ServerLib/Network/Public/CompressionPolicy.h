@@ -0,0 +1,59 @@
+#pragma once
+
+#include "MessageType.h"
+#include <unordered_map>
+
+namespace AM
+{
+namespace Server
+{
+/**
+ * Decides whether a client's message batches are worth compressing.
+ *
+ * Tracks the compression ratio that we've achieved for each "message mix"
+ * (the type of message that makes up most of a batch). If a mix isn't
+ * compressing well, we stop spending CPU on it, but periodically probe it to
+ * see if that's changed.
+ *
+ * Note: The compression level is chosen separately, based on the send
+ *       thread's spare time. See ClientHandler::updateCompressionLevel().
+ */
+class CompressionPolicy
+{
+public:
+    /**
+     * Returns true if a batch of the given size and message mix should be
+     * compressed. If not, records why in NetworkStats.
+     */
+    bool shouldCompress(unsigned int batchSize, MessageType batchMix);
+
+    /**
+     * Records the result of compressing a batch.
+     */
+    void recordResult(MessageType batchMix, unsigned int sizeBefore,
+                      unsigned int sizeAfter);
+
+private:
+    /** How much weight each new result has on a mix's average savings. */
+    static constexpr float SAVINGS_SMOOTHING{0.2f};
+
+    /**
+     * The compression results for a single message mix.
+     */
+    struct MixStats {
+        /** A moving average of the fraction of each batch's size that
+            compression saved. Starts optimistic, so that new mixes get
+            compressed until we know better. */
+        float averageSavings{1};
+
+        /** The number of batches we've skipped since we last compressed
+            one. */
+        unsigned int skippedBatches{0};
+    };
+
+    /** The compression results for each message mix that we've sent. */
+    std::unordered_map<MessageType, MixStats> mixStats;
+};
+
+} // End namespace Server
+} // End namespace AM
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "Histogram.h"
+#include <SDL_stdinc.h>
+#include <array>
+#include <cstddef>
+
+namespace AM
+{
+namespace Server
+{
+/**
+ * Tracks how long sampled InputChangeRequests spend in each stage of the
+ * server's pipeline, from being received to the resulting MovementUpdate
+ * being sent.
+ *
+ * Every Config::INPUT_LATENCY_SAMPLE_INTERVAL'th received input is stamped
+ * with its receive time, and each stage records its latency as the input
+ * (and then the update) passes through.
+ *
+ * Note: This is a static class for the same reasons as NetworkStats. The
+ *       stages are spread across the network and sim layers.
+ */
+class InputLatencyMetrics
+{
+public:
+    /**
+     * The stages that a traced input passes through.
+     */
+    enum class Stage : Uint8 {
+        /** From being received, to being pushed into the InputSystem's
+            EventSorter. Time spent waiting in the network event queue. */
+        Dispatch,
+        /** From being pushed into the EventSorter, to being applied to the
+            client's entity. Mostly decided by the tick diff target. */
+        Sort,
+        /** From being applied, to the resulting MovementUpdate being
+            serialized. */
+        Simulate,
+        /** From the MovementUpdate being serialized, to it being added to an
+            outgoing batch. Mostly decided by the network tick rate and the
+            client's send queue. */
+        Send,
+        /** From being received, to the MovementUpdate being added to an
+            outgoing batch. */
+        Total,
+        Count
+    };
+
+    /** The number of stages. */
+    static constexpr std::size_t STAGE_COUNT{
+        static_cast<std::size_t>(Stage::Count)};
+
+    /**
+     * Records that a traced input spent the time between the given SDL
+     * performance counter values in the given stage.
+     */
+    static void recordStage(Stage stage, Uint64 startTime, Uint64 endTime);
+
+    /**
+     * Returns the given stage's latencies, in microseconds.
+     */
+    static Histogram::Snapshot getSnapshot(Stage stage);
+
+    /**
+     * Returns the display name of the given stage.
+     */
+    static const char* getStageName(Stage stage);
+
+private:
+    /** Each stage's latencies, in microseconds. Indexed by Stage. */
+    static std::array<Histogram, STAGE_COUNT> stageLatenciesUs;
+};
+
+} // End namespace Server
+} // End namespace AM
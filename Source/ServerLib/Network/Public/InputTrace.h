@@ -0,0 +1,102 @@
+#pragma once
+
+#include "MessageType.h"
+#include "NetworkDefs.h"
+#include "BinaryBuffer.h"
+#include <SDL_stdinc.h>
+#include <cstddef>
+
+namespace AM
+{
+namespace Server
+{
+/**
+ * Input traces record the client activity that drives the simulation, so
+ * that it can be replayed into a fresh Simulation (see ReplayTest).
+ *
+ * A trace file starts with a file header:
+ *   [Magic u32 ("AMIT")][Version u8]
+ * Followed by any number of records, each with a record header:
+ *   [TickNum u32][RecordType u8][NetID u32][MessageType u8][MessageSize u16]
+ * Message records are followed by MessageSize bytes of serialized message.
+ * Connection records have a MessageSize of 0.
+ *
+ * TickNum is the sim tick that the server was on when the record was made.
+ * When replaying, each record should be fed in before its tick is processed.
+ */
+struct InputTrace {
+    /** "AMIT", written little-endian. */
+    static constexpr Uint32 MAGIC{0x54494D41};
+
+    /** Incremented when the format changes. */
+    static constexpr Uint8 VERSION{1};
+
+    /** The size of the file header in bytes. */
+    static constexpr std::size_t FILE_HEADER_SIZE{5};
+
+    enum class RecordType : Uint8 {
+        /** A client connected. */
+        ClientConnected,
+        /** A client disconnected. */
+        ClientDisconnected,
+        /** A message was received from a client. */
+        Message
+    };
+
+    /**
+     * Used for indexing into the parts of a record header.
+     */
+    struct RecordHeaderIndex {
+        enum Index : Uint8 {
+            /** Uint32, the tick that the server was on. */
+            TickNum = 0,
+            /** Uint8, the RecordType. */
+            RecordType = 4,
+            /** Uint32, the client's network ID. */
+            NetID = 5,
+            /** Uint8, the received message's MessageType. */
+            MessageType = 9,
+            /** Uint16, the size of the received message in bytes. */
+            MessageSize = 10,
+            /** The start of the message, if one is present. */
+            MessageStart = 12
+        };
+    };
+
+    /** The size of a record header in bytes. */
+    static constexpr std::size_t RECORD_HEADER_SIZE{
+        RecordHeaderIndex::MessageStart};
+
+    /**
+     * Returns true if messages of the given type are recorded.
+     * Only messages that drive the simulation are recorded.
+     */
+    static constexpr bool isRecordedMessageType(MessageType messageType)
+    {
+        return (messageType == MessageType::InputChangeRequest)
+               || (messageType == MessageType::ChunkUpdateRequest)
+               || (messageType == MessageType::TileUpdateRequest);
+    }
+};
+
+/**
+ * A single record, read from an input trace.
+ */
+struct InputTraceRecord {
+    /** The tick that the server was on when this record was made. */
+    Uint32 tickNum{0};
+
+    InputTrace::RecordType recordType{InputTrace::RecordType::Message};
+
+    /** The client that this record relates to. */
+    NetworkID netID{0};
+
+    /** If this is a Message record, the message's type. */
+    MessageType messageType{MessageType::NotSet};
+
+    /** If this is a Message record, holds the serialized message. */
+    BinaryBuffer messageBuffer{};
+};
+
+} // End namespace Server
+} // End namespace AM
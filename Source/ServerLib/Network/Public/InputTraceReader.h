@@ -0,0 +1,47 @@
+#pragma once
+
+#include "InputTrace.h"
+#include <array>
+#include <fstream>
+#include <string>
+
+namespace AM
+{
+namespace Server
+{
+/**
+ * Reads the records from an input trace file, in order. See InputTrace.h
+ * for the format.
+ */
+class InputTraceReader
+{
+public:
+    /**
+     * Opens the file at the given path and reads its file header.
+     *
+     * Errors if the file doesn't exist or isn't a valid input trace.
+     */
+    InputTraceReader(const std::string& filePath);
+
+    /**
+     * Reads the next record.
+     *
+     * Note: If the trace ends with a partial record (e.g. if the server
+     *       crashed while recording), it's treated as the end of the trace.
+     *
+     * @param outRecord  If returning true, set to the next record.
+     * @return true if a record was read, false if the end of the trace was
+     *         reached.
+     */
+    bool readNext(InputTraceRecord& outRecord);
+
+private:
+    /** The trace file. */
+    std::ifstream file;
+
+    /** Holds a record header while we parse it. */
+    std::array<Uint8, InputTrace::RECORD_HEADER_SIZE> recordHeader;
+};
+
+} // End namespace Server
+} // End namespace AM
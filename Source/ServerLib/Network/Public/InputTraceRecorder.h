@@ -0,0 +1,81 @@
+#pragma once
+
+#include "InputTrace.h"
+#include "MessageType.h"
+#include "NetworkDefs.h"
+#include "BinaryBuffer.h"
+#include <SDL_stdinc.h>
+#include <fstream>
+#include <string>
+
+namespace AM
+{
+namespace Server
+{
+/**
+ * Records client connections, disconnections, and simulation-relevant
+ * messages to an input trace file. See InputTrace.h for the format.
+ *
+ * Records are built in memory and written to the file in large chunks, so
+ * recording adds little cost to the receive thread.
+ *
+ * Note: Not thread-safe. Should only be used by the network's receive thread.
+ */
+class InputTraceRecorder
+{
+public:
+    /**
+     * Opens the file at the given path, replacing it if it exists.
+     * If the file fails to open, logs a message and records nothing.
+     */
+    InputTraceRecorder(const std::string& filePath);
+
+    /**
+     * Writes any buffered records to the file.
+     */
+    ~InputTraceRecorder();
+
+    /**
+     * Records that the given client connected.
+     */
+    void recordConnection(Uint32 tickNum, NetworkID netID);
+
+    /**
+     * Records that the given client disconnected.
+     */
+    void recordDisconnection(Uint32 tickNum, NetworkID netID);
+
+    /**
+     * Records the given received message, if it's a recorded type (see
+     * InputTrace::isRecordedMessageType()).
+     */
+    void recordMessage(Uint32 tickNum, NetworkID netID,
+                       MessageType messageType, const Uint8* messageBuffer,
+                       unsigned int messageSize);
+
+private:
+    /** When recordBuffer grows past this many bytes, it's written to the
+        file. */
+    static constexpr std::size_t FLUSH_SIZE{64 * 1024};
+
+    /**
+     * Appends a record to recordBuffer, flushing it if necessary.
+     */
+    void appendRecord(Uint32 tickNum, InputTrace::RecordType recordType,
+                      NetworkID netID, MessageType messageType,
+                      const Uint8* messageBuffer, unsigned int messageSize);
+
+    /**
+     * Writes recordBuffer to the file and clears it.
+     */
+    void flush();
+
+    /** The trace file. */
+    std::ofstream file;
+
+    /** Holds records until they're written to the file. */
+    BinaryBuffer recordBuffer;
+};
+
+} // End namespace Server
+} // End namespace AM
@@ -1,8 +1,11 @@
 #pragma once
 
 #include "NetworkDefs.h"
+#include "MessageRegistry.h"
+#include "DispatchMessage.h"
 #include "entt/fwd.hpp"
 #include <memory>
+#include <type_traits>
 
 namespace AM
 {
@@ -15,11 +18,14 @@ class IMessageProcessorExtension;
 /**
  * Processes received messages.
  *
+ * Messages are matched to their handlers at compile time, using the types in
+ * ClientToServerMessages (see MessageRegistry.h).
+ *
  * If the message is relevant to the network layer, it's passed to a matching
- * function that contains all of its handling logic.
+ * handleMessage() overload that contains all of its handling logic.
  *
  * If the message isn't relevant to the network layer, it's passed to a generic
- * function that pushes it straight down to the simulation layer.
+ * handleMessage() that pushes it straight down to the simulation layer.
  */
 class MessageProcessor
 {
@@ -52,25 +58,35 @@ public:
 private:
     //-------------------------------------------------------------------------
     // Handlers for messages relevant to the network layer.
+    // Each returns the message's tick number, or -1 if it doesn't have one.
     //-------------------------------------------------------------------------
-    /**
-     * Pushes nothing - Handled in network layer.
-     * @return The tick number that the message contained.
-     */
-    Uint32 handleHeartbeat(Uint8* messageBuffer, unsigned int messageSize);
+    /** Pushes nothing - Handled in network layer. */
+    Sint64 handleMessage(std::type_identity<Heartbeat>, NetworkID netID,
+                         Uint8* messageBuffer, unsigned int messageSize);
 
-    /**
-     * Pushes InputChangeRequest event.
-     * @return The tick number that the message contained.
-     */
-    Uint32 handleInputChangeRequest(NetworkID netID, Uint8* messageBuffer,
-                                    unsigned int messageSize);
+    /** Pushes InputChangeRequest event. */
+    Sint64 handleMessage(std::type_identity<InputChangeRequest>,
+                         NetworkID netID, Uint8* messageBuffer,
+                         unsigned int messageSize);
 
     /** Pushes ChunkUpdateRequest event. */
-    void handleChunkUpdateRequest(NetworkID netID, Uint8* messageBuffer,
-                                  unsigned int messageSize);
+    Sint64 handleMessage(std::type_identity<ChunkUpdateRequest>,
+                         NetworkID netID, Uint8* messageBuffer,
+                         unsigned int messageSize);
     //-------------------------------------------------------------------------
 
+    /**
+     * Pushes T event. Used for messages that don't need any network-layer
+     * handling.
+     */
+    template<typename T>
+    Sint64 handleMessage(std::type_identity<T>, NetworkID,
+                         Uint8* messageBuffer, unsigned int messageSize)
+    {
+        dispatchMessage<T>(messageBuffer, messageSize, networkEventDispatcher);
+        return -1;
+    }
+
     /** The network's event dispatcher. Used to send events to the subscribed
         queues. */
     EventDispatcher& networkEventDispatcher;
@@ -80,6 +96,10 @@ private:
         Allows the project to provide message processing code and have it be
         called at the appropriate time. */
     std::unique_ptr<IMessageProcessorExtension> extension;
+
+    /** The number of InputChangeRequests that we've received since we last
+        traced one. See InputLatencyMetrics. */
+    unsigned int inputsSinceTrace;
 };
 
 } // End namespace Server
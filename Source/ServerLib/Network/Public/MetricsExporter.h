@@ -0,0 +1,110 @@
+#pragma once
+
+#include "Histogram.h"
+#include "MessageType.h"
+#include "Config.h"
+#include "SharedConfig.h"
+#include <SDL_stdinc.h>
+#include <string>
+
+namespace AM
+{
+namespace Server
+{
+class ClientRegistry;
+
+/**
+ * Periodically writes a snapshot of our network metrics to a file, in the
+ * format given by Config::METRICS_FORMAT.
+ *
+ * Snapshots include the per-MessageType counters from NetworkMetrics, each
+ * connected client's ClientMetrics, the send latency histogram, and the
+ * per-stage InputLatencyMetrics histograms. Each snapshot replaces the last
+ * one, so an external collector can poll the file.
+ *
+ * If Tracy is enabled, a few aggregate values are also plotted each tick.
+ */
+class MetricsExporter
+{
+public:
+    MetricsExporter(ClientRegistry& inClientRegistry);
+
+    /**
+     * Plots to Tracy if it's enabled, and writes a snapshot if it's time to
+     * do so.
+     *
+     * Should be called once per network tick.
+     */
+    void tick();
+
+private:
+    /**
+     * Builds a snapshot in the configured format and writes it to filePath.
+     */
+    void writeSnapshot();
+
+    /**
+     * Appends a Prometheus text format snapshot to snapshotText.
+     */
+    void appendPrometheus();
+
+    /**
+     * Appends a JSON snapshot to snapshotText.
+     */
+    void appendJson();
+
+    /**
+     * Appends the given histogram's buckets, sum, and count in Prometheus
+     * text format.
+     *
+     * @param labels  Any extra labels, each followed by a comma. May be empty.
+     */
+    void appendPrometheusHistogram(const char* name, const char* labels,
+                                   const Histogram::Snapshot& snapshot);
+
+    /**
+     * Appends the given histogram as a JSON object.
+     */
+    void appendJsonHistogram(const Histogram::Snapshot& snapshot);
+
+    /**
+     * Plots our aggregate values to Tracy.
+     */
+    void plotToTracy();
+
+    /**
+     * Appends the given printf-style formatted string to snapshotText.
+     */
+    void append(const char* format, ...);
+
+    /**
+     * Returns the name of the given message type, or nullptr if it isn't
+     * a known type.
+     */
+    static const char* getMessageTypeName(MessageType messageType);
+
+    /** The clients to export metrics for. */
+    ClientRegistry& clientRegistry;
+
+    /** The path to the snapshot file. */
+    const std::string filePath;
+
+    /** Holds the snapshot while we build it. Kept around to avoid
+        re-allocating. */
+    std::string snapshotText;
+
+    /** The number of network ticks between snapshots. */
+    static constexpr unsigned int TICKS_TILL_EXPORT{
+        Config::METRICS_EXPORT_PERIOD_S
+        * SharedConfig::NETWORK_TICKS_PER_SECOND};
+
+    /** The number of ticks since we last wrote a snapshot. */
+    unsigned int ticksSinceExport;
+
+    /** The send latency data from our last Tracy plot. Used to plot the
+        mean latency since then. */
+    Histogram::Snapshot lastPlottedLatency;
+};
+
+} // End namespace Server
+} // End namespace AM
@@ -0,0 +1,22 @@
+#pragma once
+
+namespace AM
+{
+namespace Server
+{
+
+/**
+ * The file formats that we can export network metrics snapshots in.
+ */
+enum class MetricsFormat {
+    /** Don't export snapshots. Metrics are still tracked. */
+    None,
+    /** Prometheus text exposition format, e.g. for node_exporter's textfile
+        collector. */
+    Prometheus,
+    /** A single JSON object. */
+    Json
+};
+
+} // namespace Server
+} // namespace AM
@@ -3,21 +3,24 @@
 #include "SharedConfig.h"
 #include "NetworkDefs.h"
 #include "ServerNetworkDefs.h"
+#include "ClientRegistry.h"
 #include "MessageProcessor.h"
 #include "ClientHandler.h"
+#include "MetricsExporter.h"
 #include "Serialize.h"
+#include "MessageRegistry.h"
+#include "MessagePool.h"
+#include "Config.h"
 #include "Peer.h"
 #include "ByteTools.h"
 #include "QueuedEvents.h"
 #include "Tracy.hpp"
 #include <memory>
 #include <cstddef>
-#include <unordered_map>
-#include <shared_mutex>
 
 namespace AM
 {
-class Acceptor;
+class AcceptorBase;
 
 namespace Server
 {
@@ -33,12 +36,28 @@ class Network
 public:
     static constexpr unsigned int SERVER_PORT = 41499;
 
+    /**
+     * Accepts clients over TCP, on SERVER_PORT.
+     * Records an input trace if Config::RECORD_INPUT_TRACE is true.
+     */
     Network();
 
+    /**
+     * Accepts clients through the given acceptor.
+     *
+     * Useful for driving the server with in-process clients (see
+     * LoopbackAcceptor), e.g. for benchmarking.
+     *
+     * @param recordInputTrace  If true, client activity will be recorded to
+     *                          InputTrace.bin. See InputTraceRecorder.
+     */
+    Network(std::unique_ptr<AcceptorBase> inAcceptor, bool recordInputTrace);
+
     /**
      * Sends all queued messages over the network.
      *
-     * Also logs network statistics if it's time to do so.
+     * Also logs network statistics and exports metrics if it's time to do
+     * so.
      */
     void tick();
 
@@ -46,15 +65,21 @@ public:
      * Sends bytes over the network.
      * Errors if the server is disconnected.
      *
+     * Note: Only call this from the sim thread, since it uses
+     *       messageBufferPool.
+     *
      * @param networkID  The client to send the message to.
      * @param messageStruct  A structure that defines MESSAGE_TYPE and has an
      *                       associated serialize() function.
      * @param messageTick  Optional, used in certain cases to update the
      *                     Client's latestSentSimTick.
+     * @param inputReceiveTime  Optional, if this message responds to a
+     *                          traced input, the time that the input was
+     *                          received. See InputLatencyMetrics.
      */
     template<typename T>
     void serializeAndSend(NetworkID networkID, const T& messageStruct,
-                          Uint32 messageTick = 0);
+                          Uint32 messageTick = 0, Uint64 inputReceiveTime = 0);
 
     /**
      * Returns the Network event dispatcher. All messages that we receive
@@ -65,11 +90,14 @@ public:
     /** Initialize the tick timer. */
     void initTimer();
 
-    // Returning non-const refs because they need to be modified. Be careful not
-    // to attempt to re-assign the obtained ref (can't re-seat a reference once
-    // bound).
-    ClientMap& getClientMap();
-    SharedLockableBase(std::shared_mutex) & getClientMapMutex();
+    /** Returns the registry that owns all connected clients. */
+    ClientRegistry& getClientRegistry();
+
+    /**
+     * Records that an input from the given client arrived too late to be
+     * processed. If the client doesn't exist, does nothing.
+     */
+    void recordDroppedInput(NetworkID networkID);
 
     /** Used for passing us a pointer to the Game's currentTick. */
     void registerCurrentTickPtr(const std::atomic<Uint32>* inCurrentTickPtr);
@@ -91,15 +119,16 @@ public:
 private:
     /**
      * Queues a message to be sent the next time sendWaitingMessages is called.
-     * @throws std::out_of_range if id is not in the clients map.
+     * If the client doesn't exist, the message is dropped.
      *
      * @param networkID  The client to send the message to.
      * @param message  The message to send.
      * @param messageTick  Optional, used when sending entity movement updates
      *                     to update the Client's latestSentSimTick.
+     * @param inputReceiveTime  Optional, see serializeAndSend().
      */
     void send(NetworkID networkID, const BinaryBufferSharedPtr& message,
-              Uint32 messageTick = 0);
+              Uint32 messageTick = 0, Uint64 inputReceiveTime = 0);
 
     /**
      * Logs the network stats such as bytes sent/received per second.
@@ -108,10 +137,7 @@ private:
 
     /** Maps IDs to their connections. Allows the game to say "send this message
         to this entity" instead of needing to track the connection objects. */
-    ClientMap clientMap;
-
-    /** Used to lock access to the clientMap. */
-    TracySharedLockable(std::shared_mutex, clientMapMutex);
+    ClientRegistry clientRegistry;
 
     /** Deserializes messages, does any network-layer message handling, and
         passes messages down to the simulation. */
@@ -123,6 +149,13 @@ private:
     /** Handles asynchronous client activity. */
     ClientHandler clientHandler;
 
+    /** Recycled buffers for serializing outgoing messages into. A buffer is
+        recycled once every client that it was queued for has sent it. */
+    MessagePool<BinaryBuffer> messageBufferPool;
+
+    /** Writes our network metrics to a file. */
+    MetricsExporter metricsExporter;
+
     /** The number of seconds we'll wait before logging our network
         statistics. */
     static constexpr unsigned int SECONDS_TILL_STATS_DUMP = 5;
@@ -139,22 +172,30 @@ private:
 
 template<typename T>
 void Network::serializeAndSend(NetworkID networkID, const T& messageStruct,
-                               Uint32 messageTick)
+                               Uint32 messageTick, Uint64 inputReceiveTime)
 {
-    // Allocate the buffer.
-    std::size_t totalMessageSize{MESSAGE_HEADER_SIZE
-                                 + Serialize::measureSize(messageStruct)};
-    BinaryBufferSharedPtr messageBuffer{
-        std::make_shared<BinaryBuffer>(totalMessageSize)};
-
-    // Serialize the message struct into the buffer, leaving room for the
-    // header.
-    std::size_t messageSize{
-        Serialize::toBuffer(messageBuffer->data(), messageBuffer->size(),
-                            messageStruct, MESSAGE_HEADER_SIZE)};
+    static_assert(NetworkMessage<T>,
+                  "Sent messages must declare a static constexpr MessageType "
+                  "MESSAGE_TYPE.");
+
+    // Get a recycled buffer. If it was grown by a large message, free it so
+    // the pool doesn't pin that memory.
+    BinaryBufferSharedPtr messageBuffer{messageBufferPool.acquire()};
+    if (messageBuffer->capacity() > Config::MESSAGE_BUFFER_MAX_POOLED_BYTES) {
+        BinaryBuffer().swap(*messageBuffer);
+    }
+
+    // Serialize the message struct into the buffer in a single pass, leaving
+    // room for the header.
+    // Note: Fixed-size messages reserve their exact size up front.
+    messageBuffer->clear();
+    if constexpr (FixedSizeMessage<T>) {
+        messageBuffer->reserve(MESSAGE_HEADER_SIZE + T::SERIALIZED_SIZE);
+    }
+    std::size_t messageSize{Serialize::toGrowableBuffer(
+        *messageBuffer, messageStruct, MESSAGE_HEADER_SIZE)};
 
     // Copy the type into the buffer.
-    // TODO: Add a nice compile-time message if T doesn't have MESSAGE_TYPE.
     messageBuffer->at(MessageHeaderIndex::MessageType)
         = static_cast<Uint8>(T::MESSAGE_TYPE);
 
@@ -163,7 +204,7 @@ void Network::serializeAndSend(NetworkID networkID, const T& messageStruct,
                        (messageBuffer->data() + MessageHeaderIndex::Size));
 
     // Send the message.
-    send(networkID, messageBuffer, messageTick);
+    send(networkID, messageBuffer, messageTick, inputReceiveTime);
 }
 
 } // namespace Server
@@ -1,8 +1,6 @@
 #pragma once
 
 #include "NetworkDefs.h"
-#include <unordered_map>
-#include <memory>
 
 /**
  * This file contains client-specific network definitions.
@@ -11,13 +9,6 @@ namespace AM
 {
 namespace Server
 {
-//--------------------------------------------------------------------------
-// Typedefs
-//--------------------------------------------------------------------------
-/** A map type used to manage clients. */
-class Client;
-typedef std::unordered_map<NetworkID, std::shared_ptr<Client>> ClientMap;
-
 //--------------------------------------------------------------------------
 // Structs
 //--------------------------------------------------------------------------
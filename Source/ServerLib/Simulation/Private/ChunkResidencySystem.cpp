@@ -0,0 +1,88 @@
+#include "ChunkResidencySystem.h"
+#include "World.h"
+#include "ClientSimData.h"
+#include "Input.h"
+#include "Position.h"
+#include "Config.h"
+#include "Tracy.hpp"
+
+namespace AM
+{
+namespace Server
+{
+ChunkResidencySystem::ChunkResidencySystem(World& inWorld)
+: world(inWorld)
+, pinCenters{}
+{
+}
+
+void ChunkResidencySystem::updateResidency()
+{
+    ZoneScoped;
+
+    // Request the chunks around each client entity.
+    static constexpr int RADIUS{Config::CHUNK_RESIDENCY_RADIUS};
+    auto view = world.registry.view<ClientSimData, Position>();
+    for (entt::entity entity : view) {
+        Position& position{view.get<Position>(entity)};
+        ChunkPosition centerChunk{position.asChunkPosition()};
+
+        for (int y = (centerChunk.y - RADIUS); y <= (centerChunk.y + RADIUS);
+             ++y) {
+            for (int x = (centerChunk.x - RADIUS);
+                 x <= (centerChunk.x + RADIUS); ++x) {
+                // Note: Out of bounds chunks are ignored by the tile map.
+                world.tileMap.requestChunk({x, y});
+            }
+        }
+    }
+
+    // Keep the chunks around each movable entity pinned.
+    updateMovementPins();
+
+    // Add any chunks that finished loading and evict any that aren't needed.
+    world.tileMap.updateResidency();
+}
+
+void ChunkResidencySystem::updateMovementPins()
+{
+    // Pin the chunks around each movable entity, moving the pins if it
+    // changed chunks.
+    auto view = world.registry.view<Input, Position>();
+    for (entt::entity entity : view) {
+        ChunkPosition centerChunk{view.get<Position>(entity).asChunkPosition()};
+
+        auto [pinIt, isNew] = pinCenters.try_emplace(entity, centerChunk);
+        if (isNew) {
+            world.tileMap.pinChunks(getPinExtent(centerChunk));
+        }
+        else if (pinIt->second != centerChunk) {
+            world.tileMap.unpinChunks(getPinExtent(pinIt->second));
+            world.tileMap.pinChunks(getPinExtent(centerChunk));
+            pinIt->second = centerChunk;
+        }
+    }
+
+    // Unpin the chunks around any entities that were destroyed or can no
+    // longer move.
+    for (auto pinIt = pinCenters.begin(); pinIt != pinCenters.end();) {
+        if (!(view.contains(pinIt->first))) {
+            world.tileMap.unpinChunks(getPinExtent(pinIt->second));
+            pinIt = pinCenters.erase(pinIt);
+        }
+        else {
+            ++pinIt;
+        }
+    }
+}
+
+ChunkExtent
+    ChunkResidencySystem::getPinExtent(const ChunkPosition& centerChunk)
+{
+    return {(centerChunk.x - MOVEMENT_PIN_RADIUS),
+            (centerChunk.y - MOVEMENT_PIN_RADIUS),
+            ((MOVEMENT_PIN_RADIUS * 2) + 1), ((MOVEMENT_PIN_RADIUS * 2) + 1)};
+}
+
+} // namespace Server
+} // namespace AM
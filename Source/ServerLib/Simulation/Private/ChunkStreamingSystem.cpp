@@ -3,14 +3,17 @@
 #include "Network.h"
 #include "ClientSimData.h"
 #include "Position.h"
-#include "PreviousPosition.h"
+#include "Velocity.h"
 #include "ChunkUpdate.h"
+#include "ChunkPaletteBuilder.h"
 #include "SharedConfig.h"
+#include "Config.h"
 #include "Serialize.h"
 #include "Log.h"
 #include <SDL_rect.h>
 #include "Tracy.hpp"
 #include <vector>
+#include <algorithm>
 
 namespace AM
 {
@@ -22,6 +25,8 @@ ChunkStreamingSystem::ChunkStreamingSystem(
 : world{inWorld}
 , network{inNetwork}
 , chunkUpdateRequestQueue(inNetworkEventDispatcher)
+, clientStreamStates{}
+, measuredChunks{}
 {
 }
 
@@ -29,25 +34,195 @@ void ChunkStreamingSystem::sendChunks()
 {
     ZoneScoped;
 
-    // Process all chunk update requests.
+    // Queue all new chunk update requests.
     ChunkUpdateRequest chunkUpdateRequest{};
     while (chunkUpdateRequestQueue.pop(chunkUpdateRequest)) {
-        sendChunkUpdate(chunkUpdateRequest);
+        queueRequest(chunkUpdateRequest);
+    }
+
+    // If nobody is waiting on chunks, any sizes we measured won't be used.
+    if (clientStreamStates.empty()) {
+        measuredChunks.clear();
+        return;
+    }
+
+    // Send each client with queued chunks as many as fit in our budget.
+    auto view = world.registry.view<ClientSimData, Position, Velocity>();
+    for (entt::entity entity : view) {
+        auto [client, position, velocity]
+            = view.get<ClientSimData, Position, Velocity>(entity);
+
+        auto stateIt{clientStreamStates.find(client.netID)};
+        if (stateIt != clientStreamStates.end()) {
+            stateIt->second.wasFound = true;
+            sendChunksToClient(client.netID, position, velocity,
+                               stateIt->second);
+        }
+    }
+
+    // Drop any finished queues, or queues for clients that have disconnected.
+    // Note: erase_if() passes each element as const, so we reset wasFound
+    //       afterwards.
+    std::erase_if(clientStreamStates, [](const auto& statePair) {
+        const ClientStreamState& streamState{statePair.second};
+        return !(streamState.wasFound) || streamState.pendingChunks.empty();
+    });
+    for (auto& [netID, streamState] : clientStreamStates) {
+        streamState.wasFound = false;
     }
 }
 
-void ChunkStreamingSystem::sendChunkUpdate(
+void ChunkStreamingSystem::queueRequest(
     const ChunkUpdateRequest& chunkUpdateRequest)
 {
-    // Add the requested chunks to the message.
-    ChunkUpdate chunkUpdate{};
-    for (const ChunkPosition& requestedChunk :
+    std::vector<ChunkUpdateRequest::RequestedChunk>& pendingChunks{
+        clientStreamStates[chunkUpdateRequest.netID].pendingChunks};
+    for (const ChunkUpdateRequest::RequestedChunk& requestedChunk :
          chunkUpdateRequest.requestedChunks) {
-        addChunkToMessage(requestedChunk, chunkUpdate);
+        // If this chunk is already queued, replace it with the newer request.
+        auto it{std::find_if(
+            pendingChunks.begin(), pendingChunks.end(),
+            [&](const ChunkUpdateRequest::RequestedChunk& pendingChunk) {
+                return (pendingChunk.position.x == requestedChunk.position.x)
+                       && (pendingChunk.position.y
+                           == requestedChunk.position.y);
+            })};
+        if (it != pendingChunks.end()) {
+            *it = requestedChunk;
+        }
+        else {
+            pendingChunks.push_back(requestedChunk);
+        }
     }
+}
+
+void ChunkStreamingSystem::sendChunksToClient(NetworkID netID,
+                                              const Position& position,
+                                              const Velocity& velocity,
+                                              ClientStreamState& streamState)
+{
+    std::vector<ChunkUpdateRequest::RequestedChunk>& pendingChunks{
+        streamState.pendingChunks};
+    sortByPriority(pendingChunks, position, velocity);
+
+    // Add chunks to the message until we run out of budget, in priority
+    // order. Chunks that we can't send yet are kept in the queue.
+    ChunkUpdate chunkUpdate{};
+    std::size_t bytesUsed{0};
+    bool budgetIsSpent{false};
+    auto keepEnd{pendingChunks.begin()};
+    for (auto it = pendingChunks.begin(); it != pendingChunks.end(); ++it) {
+        const ChunkPosition& chunkPosition{it->position};
+
+        // Out of bounds chunks will never be resident, so we drop them.
+        if (!(world.tileMap.getChunkExtent().containsPosition(chunkPosition))) {
+            continue;
+        }
+
+        // If the client's cached copy is up to date, tell it to use that.
+        // Note: We know every chunk's version, so this doesn't require the
+        //       chunk to be loaded. These are tiny, so we don't budget them.
+        if (it->hasCachedVersion
+            && (it->cachedVersion
+                == world.tileMap.getChunkVersion(chunkPosition))) {
+            chunkUpdate.unchangedChunks.push_back(chunkPosition);
+            continue;
+        }
+
+        // Note: Requesting a resident chunk marks it as recently used.
+        world.tileMap.requestChunk(chunkPosition);
+        if (!budgetIsSpent && world.tileMap.hasChunk(chunkPosition)) {
+            // If we measured this chunk on a previous tick and it hasn't
+            // changed, use that size instead of re-building it.
+            const ChunkExtent& chunkExtent{world.tileMap.getChunkExtent()};
+            unsigned int chunkIndex{static_cast<unsigned int>(
+                (chunkPosition.y * chunkExtent.xLength) + chunkPosition.x)};
+            Uint32 chunkVersion{world.tileMap.getChunkVersion(chunkPosition)};
+            std::size_t chunkSize{0};
+            auto measuredIt{measuredChunks.find(chunkIndex)};
+            bool isMeasured{(measuredIt != measuredChunks.end())
+                            && (measuredIt->second.version == chunkVersion)};
+            if (isMeasured) {
+                chunkSize = measuredIt->second.sizeBytes;
+            }
+
+            // If we know this chunk won't fit in the budget, leave it for a
+            // later tick without building it.
+            // Note: We always send at least 1 chunk, so that we make progress
+            //       even if the budget is smaller than a chunk.
+            bool isFirstChunk{chunkUpdate.chunks.empty()};
+            bool exceedsBudget{(bytesUsed + chunkSize)
+                               > Config::CHUNK_STREAMING_BYTES_PER_TICK};
+            if (isMeasured && exceedsBudget && !isFirstChunk) {
+                budgetIsSpent = true;
+            }
+            else {
+                addChunkToMessage(chunkPosition, chunkUpdate);
+
+                // If this is the first time we've seen this version of the
+                // chunk, measure it. If it doesn't fit, take it back out and
+                // remember its size for next time.
+                if (!isMeasured) {
+                    chunkSize
+                        = Serialize::measureSize(chunkUpdate.chunks.back());
+                    exceedsBudget = ((bytesUsed + chunkSize)
+                                     > Config::CHUNK_STREAMING_BYTES_PER_TICK);
+                }
+                if (exceedsBudget && !isFirstChunk) {
+                    chunkUpdate.chunks.pop_back();
+                    measuredChunks[chunkIndex] = {chunkVersion, chunkSize};
+                    budgetIsSpent = true;
+                }
+                else {
+                    measuredChunks.erase(chunkIndex);
+                    bytesUsed += chunkSize;
+                    continue;
+                }
+            }
+        }
+
+        // We couldn't send this chunk, keep it in the queue.
+        *keepEnd = std::move(*it);
+        ++keepEnd;
+    }
+    pendingChunks.erase(keepEnd, pendingChunks.end());
 
     // Send the message.
-    network.serializeAndSend(chunkUpdateRequest.netID, chunkUpdate);
+    if ((chunkUpdate.chunks.size() > 0)
+        || (chunkUpdate.unchangedChunks.size() > 0)) {
+        network.serializeAndSend(netID, chunkUpdate);
+    }
+}
+
+void ChunkStreamingSystem::sortByPriority(
+    std::vector<ChunkUpdateRequest::RequestedChunk>& pendingChunks,
+    const Position& position, const Velocity& velocity)
+{
+    // Predict where the entity will be, so that chunks in its direction of
+    // travel come before chunks that it's moving away from.
+    static constexpr float LOOKAHEAD_S{Config::CHUNK_STREAMING_LOOKAHEAD_S};
+    float predictedX{position.x + (velocity.x * LOOKAHEAD_S)};
+    float predictedY{position.y + (velocity.y * LOOKAHEAD_S)};
+
+    // Returns the squared distance from the predicted position to the center
+    // of the given chunk.
+    static constexpr float CHUNK_WORLD_WIDTH{
+        static_cast<float>(SharedConfig::CHUNK_WIDTH
+                           * SharedConfig::TILE_WORLD_WIDTH)};
+    auto getDistanceSquared = [&](const ChunkPosition& chunkPosition) {
+        float xDistance{((chunkPosition.x + 0.5f) * CHUNK_WORLD_WIDTH)
+                        - predictedX};
+        float yDistance{((chunkPosition.y + 0.5f) * CHUNK_WORLD_WIDTH)
+                        - predictedY};
+        return ((xDistance * xDistance) + (yDistance * yDistance));
+    };
+
+    std::sort(pendingChunks.begin(), pendingChunks.end(),
+              [&](const ChunkUpdateRequest::RequestedChunk& chunkA,
+                  const ChunkUpdateRequest::RequestedChunk& chunkB) {
+                  return getDistanceSquared(chunkA.position)
+                         < getDistanceSquared(chunkB.position);
+              });
 }
 
 void ChunkStreamingSystem::addChunkToMessage(const ChunkPosition& chunkPosition,
@@ -57,15 +232,17 @@ void ChunkStreamingSystem::addChunkToMessage(const ChunkPosition& chunkPosition,
     chunkUpdate.chunks.emplace_back();
     ChunkWireSnapshot& chunk{chunkUpdate.chunks.back()};
 
-    // Save the chunk's position.
+    // Save the chunk's position and version.
     chunk.x = chunkPosition.x;
     chunk.y = chunkPosition.y;
+    chunk.version = world.tileMap.getChunkVersion(chunkPosition);
 
     // Calc what the chunk's starting tile is.
     unsigned int startX{chunk.x * SharedConfig::CHUNK_WIDTH};
     unsigned int startY{chunk.y * SharedConfig::CHUNK_WIDTH};
 
     // For each tile in the chunk.
+    ChunkPaletteBuilder<int> paletteBuilder{chunk.palette};
     int tileIndex{0};
     for (unsigned int tileY = 0; tileY < SharedConfig::CHUNK_WIDTH; ++tileY) {
         for (unsigned int tileX = 0; tileX < SharedConfig::CHUNK_WIDTH;
@@ -75,7 +252,7 @@ void ChunkStreamingSystem::addChunkToMessage(const ChunkPosition& chunkPosition,
                 = world.tileMap.getTile((startX + tileX), (startY + tileY));
             for (const Tile::SpriteLayer& layer : tile.spriteLayers) {
                 unsigned int paletteID{
-                    chunk.getPaletteIndex(layer.sprite.numericID)};
+                    paletteBuilder.getIndex(layer.sprite.numericID)};
                 chunk.tiles[tileIndex].spriteLayers.push_back(paletteID);
             }
 
@@ -82,7 +82,7 @@ void ClientConnectionSystem::processConnectEvents()
         world.entityLocator.setEntityLocation(newEntity, boundingBox);
 
         // Register the entity with the network ID map.
-        world.netIdMap[clientConnected.clientID] = newEntity;
+        world.addClientEntity(clientConnected.clientID, newEntity);
 
         LOG_INFO("Constructed entity with netID: %u, entityID: %u",
                  clientConnected.clientID, newEntity);
@@ -105,18 +105,17 @@ void ClientConnectionSystem::processDisconnectEvents()
         }
 
         // Find the disconnected client's associated entity.
-        auto disconnectedEntityIt{
-            world.netIdMap.find(clientDisconnected.clientID)};
-        if (disconnectedEntityIt != world.netIdMap.end()) {
+        entt::entity disconnectedEntity{
+            world.findClientEntity(clientDisconnected.clientID)};
+        if (disconnectedEntity != entt::null) {
             // Found the entity. Remove it from the entity locator.
             // Note: Since the entity was removed from the locator, its peers
             //       will be told by ClientAOISystem to delete it.
-            entt::entity disconnectedEntity{disconnectedEntityIt->second};
             world.entityLocator.removeEntity(disconnectedEntity);
 
             // Remove it from the registry and network ID map.
             world.registry.destroy(disconnectedEntity);
-            world.netIdMap.erase(disconnectedEntityIt);
+            world.removeClientEntity(clientDisconnected.clientID);
 
             LOG_INFO("Removed entity with entityID: %u", disconnectedEntity);
         }
@@ -145,6 +144,7 @@ void ClientConnectionSystem::sendConnectionResponse(NetworkID networkID,
     const ChunkExtent& mapChunkExtent{world.tileMap.getChunkExtent()};
     connectionResponse.mapXLengthChunks = mapChunkExtent.xLength;
     connectionResponse.mapYLengthChunks = mapChunkExtent.yLength;
+    connectionResponse.mapID = world.tileMap.getMapID();
 
     // Send the connection response message.
     network.serializeAndSend(networkID, connectionResponse, currentTick);
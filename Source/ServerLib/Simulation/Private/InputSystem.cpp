@@ -6,8 +6,10 @@
 #include "Input.h"
 #include "InputHasChanged.h"
 #include "ClientSimData.h"
+#include "InputLatencyMetrics.h"
 #include "Log.h"
 #include "Tracy.hpp"
+#include <SDL_timer.h>
 #include <memory>
 
 namespace AM
@@ -31,15 +33,24 @@ void InputSystem::processInputMessages()
     // Sort any waiting client input events.
     while (InputChangeRequest* inputChangeRequest
            = inputChangeRequestQueue.peek()) {
+        // If the event is being traced, record how long it took to get here.
+        if (inputChangeRequest->receiveTime != 0) {
+            inputChangeRequest->sortTime = SDL_GetPerformanceCounter();
+            InputLatencyMetrics::recordStage(
+                InputLatencyMetrics::Stage::Dispatch,
+                inputChangeRequest->receiveTime, inputChangeRequest->sortTime);
+        }
+
         // Push the event into the sorter.
         SorterBase::ValidityResult result{inputChangeRequestSorter.push(
             *inputChangeRequest, inputChangeRequest->tickNum)};
 
         // If we had to drop an event, handle it.
         if (result != SorterBase::ValidityResult::Valid) {
-            LOG_INFO("Dropped message from %u. Tick: %u, received: %u",
-                     inputChangeRequest->netID, simulation.getCurrentTick(),
-                     inputChangeRequest->tickNum);
+            LOG_WARNING("Dropped message from %u. Tick: %u, received: %u",
+                        inputChangeRequest->netID,
+                        simulation.getCurrentTick(),
+                        inputChangeRequest->tickNum);
             handleDroppedMessage(inputChangeRequest->netID);
         }
 
@@ -55,9 +66,10 @@ void InputSystem::processInputMessages()
 
         // If the input is from an earlier tick, drop it and continue.
         if (inputChangeRequest.tickNum < simulation.getCurrentTick()) {
-            LOG_INFO("Dropped message from %u. Tick: %u, received: %u",
-                     inputChangeRequest.netID, simulation.getCurrentTick(),
-                     inputChangeRequest.tickNum);
+            LOG_WARNING("Dropped message from %u. Tick: %u, received: %u",
+                        inputChangeRequest.netID,
+                        simulation.getCurrentTick(),
+                        inputChangeRequest.tickNum);
             handleDroppedMessage(inputChangeRequest.netID);
             inputChangeRequestQueue.pop();
             continue;
@@ -68,12 +80,12 @@ void InputSystem::processInputMessages()
         }
 
         // Find the entity associated with the given NetID.
-        auto clientEntityIt{world.netIdMap.find(inputChangeRequest.netID)};
+        entt::entity clientEntity{
+            world.findClientEntity(inputChangeRequest.netID)};
 
         // Update the client entity's inputs.
-        if (clientEntityIt != world.netIdMap.end()) {
+        if (clientEntity != entt::null) {
             // Update the entity's Input component.
-            entt::entity clientEntity{clientEntityIt->second};
             Input& input{world.registry.get<Input>(clientEntity)};
             input = inputChangeRequest.input;
 
@@ -82,6 +94,20 @@ void InputSystem::processInputMessages()
             if (!(world.registry.all_of<InputHasChanged>(clientEntity))) {
                 world.registry.emplace<InputHasChanged>(clientEntity);
             }
+
+            // If the event is being traced, record how long it was sorted
+            // for and pass the trace to MovementUpdateSystem.
+            if (inputChangeRequest.receiveTime != 0) {
+                Uint64 applyTime{SDL_GetPerformanceCounter()};
+                InputLatencyMetrics::recordStage(
+                    InputLatencyMetrics::Stage::Sort,
+                    inputChangeRequest.sortTime, applyTime);
+
+                ClientSimData& client{
+                    world.registry.get<ClientSimData>(clientEntity)};
+                client.tracedInputReceiveTime = inputChangeRequest.receiveTime;
+                client.tracedInputApplyTime = applyTime;
+            }
         }
         else {
             // The entity was probably disconnected. Do nothing with the
@@ -97,15 +123,17 @@ void InputSystem::processInputMessages()
 
 void InputSystem::handleDroppedMessage(NetworkID clientID)
 {
+    network.recordDroppedInput(clientID);
+
     // Find the entity ID of the client that we dropped a message from.
-    auto clientEntityIt{world.netIdMap.find(clientID)};
-    if (clientEntityIt == world.netIdMap.end()) {
+    entt::entity clientEntity{world.findClientEntity(clientID)};
+    if (clientEntity == entt::null) {
         // The entity is gone, we don't need to process this drop.
         return;
     }
 
     entt::registry& registry{world.registry};
-    Input& entityInput{registry.get<Input>(clientEntityIt->second)};
+    Input& entityInput{registry.get<Input>(clientEntity)};
 
     // Default the entity's inputs so they don't run off a cliff.
     Input defaultInput{};
@@ -113,11 +141,11 @@ void InputSystem::handleDroppedMessage(NetworkID clientID)
         entityInput.inputStates = defaultInput.inputStates;
 
         // Flag the entity as dirty.
-        registry.emplace<InputHasChanged>(clientEntityIt->second);
+        registry.emplace<InputHasChanged>(clientEntity);
     }
 
     // Flag that a drop occurred for this entity.
-    registry.get<ClientSimData>(clientEntityIt->second).inputWasDropped = true;
+    registry.get<ClientSimData>(clientEntity).inputWasDropped = true;
 }
 
 } // namespace Server
@@ -51,8 +51,19 @@ void MovementSystem::processMovements()
                 sprite.modelBounds, desiredPosition)};
 
             // Resolve any collisions with the surrounding bounding boxes.
-            BoundingBox resolvedBounds{MovementHelpers::resolveCollisions(
-                boundingBox, desiredBounds, world.tileMap)};
+            // Note: Tiles in non-resident chunks appear empty, so we don't
+            //       let entities move into them until they've loaded. We
+            //       request the chunks so the entity is only held up until
+            //       they arrive.
+            BoundingBox resolvedBounds{boundingBox};
+            TileExtent desiredTileExtent{desiredBounds.asTileExtent()};
+            if (world.tileMap.isResident(desiredTileExtent)) {
+                resolvedBounds = MovementHelpers::resolveCollisions(
+                    boundingBox, desiredBounds, world.tileMap);
+            }
+            else {
+                world.tileMap.requestChunks(desiredTileExtent);
+            }
 
             // Update their bounding box and position.
             // Note: Since desiredBounds was properly offset, we can do a
@@ -9,8 +9,10 @@
 #include "Velocity.h"
 #include "ClientSimData.h"
 #include "InputHasChanged.h"
+#include "InputLatencyMetrics.h"
 #include "Log.h"
 #include "Tracy.hpp"
+#include <SDL_timer.h>
 #include <algorithm>
 
 namespace AM
@@ -42,6 +44,10 @@ void MovementUpdateSystem::sendMovementUpdates()
         if (entitiesToSend.size() > 0) {
             sendEntityUpdate(client);
         }
+
+        // Any traced input ends with this tick's update.
+        client.tracedInputReceiveTime = 0;
+        client.tracedInputApplyTime = 0;
     }
 
     // Mark any entities with dirty inputs as clean.
@@ -104,9 +110,18 @@ void MovementUpdateSystem::sendEntityUpdate(ClientSimData& client)
     // Finish filling the other fields.
     movementUpdate.tickNum = simulation.getCurrentTick();
 
+    // If this update responds to a traced input, record how long the input
+    // took to simulate and pass the trace on to the network.
+    if (client.tracedInputReceiveTime != 0) {
+        InputLatencyMetrics::recordStage(InputLatencyMetrics::Stage::Simulate,
+                                         client.tracedInputApplyTime,
+                                         SDL_GetPerformanceCounter());
+    }
+
     // Send the message.
     network.serializeAndSend(client.netID, movementUpdate,
-                             movementUpdate.tickNum);
+                             movementUpdate.tickNum,
+                             client.tracedInputReceiveTime);
 }
 
 } // namespace Server
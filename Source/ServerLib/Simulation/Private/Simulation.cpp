@@ -2,6 +2,7 @@
 #include "Network.h"
 #include "EnttGroups.h"
 #include "ISimulationExtension.h"
+#include "Config.h"
 #include "Log.h"
 #include "Timer.h"
 #include "Tracy.hpp"
@@ -16,8 +17,15 @@ Simulation::Simulation(Network& inNetwork, SpriteData& inSpriteData)
 , world(inSpriteData)
 , currentTick(0)
 , extension{nullptr}
+, systemProfiler{"Sim",
+                 Config::SYSTEM_PROFILER_REPORT_PERIOD_S,
+                 {"ClientConnectionSystem", "ChunkResidencySystem",
+                  "TileUpdateSystem", "InputSystem", "MovementSystem",
+                  "ClientAOISystem", "MovementUpdateSystem",
+                  "ChunkStreamingSystem", "MapSaveSystem"}}
 , clientConnectionSystem(*this, world, network.getEventDispatcher(), network,
                          inSpriteData)
+, chunkResidencySystem(world)
 , tileUpdateSystem(world, network.getEventDispatcher(), network)
 , clientAOISystem(*this, world, network)
 , inputSystem(*this, world, network.getEventDispatcher(), network)
@@ -37,6 +45,7 @@ Simulation::Simulation(Network& inNetwork, SpriteData& inSpriteData)
 void Simulation::tick()
 {
     ZoneScoped;
+    using ScopedTimer = SystemProfiler::ScopedTimer;
 
     /* Run all systems. */
     // Call the project's pre-everything logic.
@@ -45,10 +54,22 @@ void Simulation::tick()
     }
 
     // Process client connections and disconnections.
-    clientConnectionSystem.processConnectionEvents();
+    {
+        ScopedTimer timer{systemProfiler, ProfiledSystem::ClientConnection};
+        clientConnectionSystem.processConnectionEvents();
+    }
+
+    // Load the map chunks around clients and evict ones that aren't needed.
+    {
+        ScopedTimer timer{systemProfiler, ProfiledSystem::ChunkResidency};
+        chunkResidencySystem.updateResidency();
+    }
 
     // Receive and process tile update requests.
-    tileUpdateSystem.updateTiles();
+    {
+        ScopedTimer timer{systemProfiler, ProfiledSystem::TileUpdate};
+        tileUpdateSystem.updateTiles();
+    }
 
     // Call the project's pre-movement logic.
     if (extension != nullptr) {
@@ -56,16 +77,28 @@ void Simulation::tick()
     }
 
     // Receive and process client input messages.
-    inputSystem.processInputMessages();
+    {
+        ScopedTimer timer{systemProfiler, ProfiledSystem::Input};
+        inputSystem.processInputMessages();
+    }
 
     // Move all of our entities.
-    movementSystem.processMovements();
+    {
+        ScopedTimer timer{systemProfiler, ProfiledSystem::Movement};
+        movementSystem.processMovements();
+    }
 
     // Update each client entity's "entities in my AOI" list.
-    clientAOISystem.updateAOILists();
+    {
+        ScopedTimer timer{systemProfiler, ProfiledSystem::ClientAOI};
+        clientAOISystem.updateAOILists();
+    }
 
     // Send any dirty entity movement state to the clients.
-    movementUpdateSystem.sendMovementUpdates();
+    {
+        ScopedTimer timer{systemProfiler, ProfiledSystem::MovementUpdate};
+        movementUpdateSystem.sendMovementUpdates();
+    }
 
     // Call the project's post-movement logic.
     if (extension != nullptr) {
@@ -73,10 +106,19 @@ void Simulation::tick()
     }
 
     // Respond to chunk data requests.
-    chunkStreamingSystem.sendChunks();
+    {
+        ScopedTimer timer{systemProfiler, ProfiledSystem::ChunkStreaming};
+        chunkStreamingSystem.sendChunks();
+    }
 
     // If enough time has passed, save the world's tile map state.
-    mapSaveSystem.saveMapIfNecessary();
+    {
+        ScopedTimer timer{systemProfiler, ProfiledSystem::MapSave};
+        mapSaveSystem.saveMapIfNecessary();
+    }
+
+    // If it's time to report our system timings, do so.
+    systemProfiler.update();
 
     currentTick++;
 }
@@ -96,5 +138,10 @@ void Simulation::setExtension(std::unique_ptr<ISimulationExtension> inExtension)
     extension = std::move(inExtension);
 }
 
+const SystemProfiler& Simulation::getSystemProfiler() const
+{
+    return systemProfiler;
+}
+
 } // namespace Server
 } // namespace AM
@@ -0,0 +1,94 @@
+#include "ChunkLoader.h"
+#include "PagedMapFile.h"
+#include "Deserialize.h"
+#include "BinaryBuffer.h"
+#include "Log.h"
+
+namespace AM
+{
+namespace Server
+{
+ChunkLoader::ChunkLoader(PagedMapFile& inMapFile)
+: mapFile{inMapFile}
+, loadRequests{}
+, loadResults{}
+, loadThreadObj{}
+, exitRequested{false}
+{
+    // Start the load thread.
+    loadThreadObj = std::thread(&ChunkLoader::loadChunks, this);
+}
+
+ChunkLoader::~ChunkLoader()
+{
+    {
+        std::unique_lock lock{requestMutex};
+        exitRequested = true;
+    }
+    requestCondVar.notify_one();
+    loadThreadObj.join();
+}
+
+void ChunkLoader::requestLoad(unsigned int chunkIndex)
+{
+    {
+        std::unique_lock lock{requestMutex};
+        loadRequests.push(chunkIndex);
+    }
+    requestCondVar.notify_one();
+}
+
+bool ChunkLoader::popLoadResult(LoadResult& outResult)
+{
+    std::unique_lock lock{resultMutex};
+    if (loadResults.empty()) {
+        return false;
+    }
+
+    outResult = std::move(loadResults.front());
+    loadResults.pop();
+    return true;
+}
+
+void ChunkLoader::loadChunks()
+{
+    tracy::SetThreadName("ChunkLoader");
+
+    BinaryBuffer chunkBytes{};
+    while (!exitRequested) {
+        // Wait until there's a chunk to load.
+        unsigned int chunkIndex{0};
+        {
+            std::unique_lock lock{requestMutex};
+            requestCondVar.wait(lock, [this] {
+                return (exitRequested || !(loadRequests.empty()));
+            });
+            if (exitRequested) {
+                break;
+            }
+
+            chunkIndex = loadRequests.front();
+            loadRequests.pop();
+        }
+
+        // Read and deserialize the chunk.
+        LoadResult result{};
+        result.chunkIndex = chunkIndex;
+        result.succeeded
+            = (mapFile.readChunkBytes(chunkIndex, chunkBytes)
+               && Deserialize::fromBuffer(chunkBytes.data(), chunkBytes.size(),
+                                          result.snapshot));
+        if (!(result.succeeded)) {
+            LOG_ERROR("Failed to load chunk with index: %u", chunkIndex);
+        }
+
+        // Pass the result back to the sim.
+        {
+            std::unique_lock lock{resultMutex};
+            loadResults.push(std::move(result));
+        }
+    }
+}
+
+} // End namespace Server
+} // End namespace AM
@@ -0,0 +1,216 @@
+#include "PagedMapFile.h"
+#include "ByteTools.h"
+#include "Log.h"
+#include <array>
+
+namespace AM
+{
+namespace Server
+{
+PagedMapFile::PagedMapFile()
+: filePath{}
+, file{}
+, xLengthChunks{0}
+, yLengthChunks{0}
+, mapID{0}
+, chunkTable{}
+, fileMutex{}
+{
+}
+
+Uint16 PagedMapFile::readVersion(const std::string& filePath)
+{
+    std::ifstream versionFile(filePath, std::ios::binary);
+    if (!(versionFile.is_open())) {
+        LOG_FATAL("Could not open map file: %s", filePath.c_str());
+    }
+
+    // Note: Every map format starts with a Uint16 version.
+    std::array<Uint8, 2> versionBytes{};
+    versionFile.read(reinterpret_cast<char*>(versionBytes.data()),
+                     versionBytes.size());
+    if (!versionFile) {
+        LOG_FATAL("Failed to read map file version: %s", filePath.c_str());
+    }
+
+    return ByteTools::read16(versionBytes.data());
+}
+
+void PagedMapFile::write(const std::string& filePath,
+                         unsigned int xLengthChunks,
+                         unsigned int yLengthChunks, Uint32 mapID,
+                         const ChunkBytesGetter& getChunkBytes)
+{
+    std::ofstream outFile(filePath, std::ios::binary | std::ios::trunc);
+    if (!(outFile.is_open())) {
+        LOG_FATAL("Could not open map file for writing: %s",
+                  filePath.c_str());
+    }
+
+    // Write the header.
+    std::array<Uint8, HEADER_SIZE> header{};
+    ByteTools::write16(FORMAT_VERSION, &(header[0]));
+    ByteTools::write32(xLengthChunks, &(header[2]));
+    ByteTools::write32(yLengthChunks, &(header[6]));
+    ByteTools::write32(mapID, &(header[10]));
+    outFile.write(reinterpret_cast<const char*>(header.data()),
+                  header.size());
+
+    // Reserve space for the chunk table. We'll fill it in after the chunk
+    // data is written, since we don't know the offsets yet.
+    std::size_t chunkCount{static_cast<std::size_t>(xLengthChunks)
+                           * yLengthChunks};
+    BinaryBuffer tableBytes(chunkCount * TABLE_ENTRY_SIZE);
+    outFile.write(reinterpret_cast<const char*>(tableBytes.data()),
+                  tableBytes.size());
+
+    // Write each chunk's data, filling in its table entry.
+    Uint64 offset{HEADER_SIZE + tableBytes.size()};
+    BinaryBuffer chunkBytes{};
+    for (std::size_t i = 0; i < chunkCount; ++i) {
+        chunkBytes.clear();
+        Uint32 chunkVersion{
+            getChunkBytes(static_cast<unsigned int>(i), chunkBytes)};
+
+        Uint8* entry{&(tableBytes[i * TABLE_ENTRY_SIZE])};
+        ByteTools::write32(static_cast<Uint32>(offset & 0xFFFFFFFF), entry);
+        ByteTools::write32(static_cast<Uint32>(offset >> 32), (entry + 4));
+        ByteTools::write32(static_cast<Uint32>(chunkBytes.size()),
+                           (entry + 8));
+        ByteTools::write32(chunkVersion, (entry + 12));
+
+        outFile.write(reinterpret_cast<const char*>(chunkBytes.data()),
+                      chunkBytes.size());
+        offset += chunkBytes.size();
+    }
+
+    // Go back and write the filled chunk table.
+    outFile.seekp(HEADER_SIZE);
+    outFile.write(reinterpret_cast<const char*>(tableBytes.data()),
+                  tableBytes.size());
+
+    if (!outFile) {
+        LOG_FATAL("Failed while writing map file: %s", filePath.c_str());
+    }
+}
+
+bool PagedMapFile::open(const std::string& inFilePath)
+{
+    std::scoped_lock lock{fileMutex};
+
+    if (file.is_open()) {
+        file.close();
+    }
+    chunkTable.clear();
+
+    filePath = inFilePath;
+    file.open(filePath, std::ios::binary);
+    if (!(file.is_open())) {
+        return false;
+    }
+
+    // Read and validate the version.
+    std::array<Uint8, HEADER_SIZE> header{};
+    file.read(reinterpret_cast<char*>(header.data()), 2);
+    Uint16 version{ByteTools::read16(&(header[0]))};
+    if (!file || (version < MIN_FORMAT_VERSION)
+        || (version > FORMAT_VERSION)) {
+        file.close();
+        return false;
+    }
+
+    // Read the rest of the header.
+    bool isV2{version == 2};
+    std::size_t headerSize{isV2 ? V2_HEADER_SIZE : HEADER_SIZE};
+    std::size_t entrySize{isV2 ? V2_TABLE_ENTRY_SIZE : TABLE_ENTRY_SIZE};
+    file.read(reinterpret_cast<char*>(&(header[2])), (headerSize - 2));
+    if (!file) {
+        file.close();
+        return false;
+    }
+    xLengthChunks = ByteTools::read32(&(header[2]));
+    yLengthChunks = ByteTools::read32(&(header[6]));
+    mapID = (isV2 ? 0 : ByteTools::read32(&(header[10])));
+
+    // Read the chunk table.
+    std::size_t chunkCount{static_cast<std::size_t>(xLengthChunks)
+                           * yLengthChunks};
+    BinaryBuffer tableBytes(chunkCount * entrySize);
+    file.read(reinterpret_cast<char*>(tableBytes.data()), tableBytes.size());
+    if (!file) {
+        file.close();
+        return false;
+    }
+
+    chunkTable.resize(chunkCount);
+    for (std::size_t i = 0; i < chunkCount; ++i) {
+        const Uint8* entry{&(tableBytes[i * entrySize])};
+        chunkTable[i].offset
+            = static_cast<Uint64>(ByteTools::read32(entry))
+              | (static_cast<Uint64>(ByteTools::read32(entry + 4)) << 32);
+        chunkTable[i].size = ByteTools::read32(entry + 8);
+        chunkTable[i].version = (isV2 ? 0 : ByteTools::read32(entry + 12));
+    }
+
+    return true;
+}
+
+void PagedMapFile::close()
+{
+    std::scoped_lock lock{fileMutex};
+
+    if (file.is_open()) {
+        file.close();
+    }
+}
+
+bool PagedMapFile::readChunkBytes(unsigned int chunkIndex,
+                                  BinaryBuffer& outBytes)
+{
+    std::scoped_lock lock{fileMutex};
+
+    if (!(file.is_open()) || (chunkIndex >= chunkTable.size())) {
+        return false;
+    }
+
+    const TableEntry& entry{chunkTable[chunkIndex]};
+    outBytes.resize(entry.size);
+    file.seekg(entry.offset);
+    file.read(reinterpret_cast<char*>(outBytes.data()), entry.size);
+    if (!file) {
+        // Clear the error so later reads can still succeed.
+        file.clear();
+        return false;
+    }
+
+    return true;
+}
+
+Uint32 PagedMapFile::getChunkVersion(unsigned int chunkIndex)
+{
+    std::scoped_lock lock{fileMutex};
+
+    if (chunkIndex >= chunkTable.size()) {
+        return 0;
+    }
+
+    return chunkTable[chunkIndex].version;
+}
+
+unsigned int PagedMapFile::getXLengthChunks() const
+{
+    return xLengthChunks;
+}
+
+unsigned int PagedMapFile::getYLengthChunks() const
+{
+    return yLengthChunks;
+}
+
+Uint32 PagedMapFile::getMapID() const
+{
+    return mapID;
+}
+
+} // End namespace Server
+} // End namespace AM
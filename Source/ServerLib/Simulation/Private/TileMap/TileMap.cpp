@@ -1,16 +1,19 @@
 #include "TileMap.h"
 #include "SpriteData.h"
 #include "Paths.h"
-#include "Position.h"
 #include "Serialize.h"
 #include "Deserialize.h"
-#include "ByteTools.h"
 #include "TileMapSnapshot.h"
+#include "ChunkSnapshot.h"
+#include "ChunkPaletteBuilder.h"
+#include "Config.h"
 #include "SharedConfig.h"
 #include "Timer.h"
 #include "Log.h"
 #include "AMAssert.h"
-#include "Ignore.h"
+#include "Tracy.hpp"
+#include <filesystem>
+#include <random>
 
 namespace AM
 {
@@ -18,21 +21,60 @@ namespace Server
 {
 TileMap::TileMap(SpriteData& inSpriteData)
 : TileMapBase{inSpriteData}
+, mapFilePath{Paths::BASE_PATH + "TileMap.bin"}
+, mapFile{}
+, chunkLoader{mapFile}
+, pendingLoads{}
+, pendingEdits{}
+, residencyData{}
+, lruList{}
+, pinCounts{}
+, evictedDirtyChunks{}
+, residencyEpoch{0}
+, residentBytes{0}
+, mapID{0}
 {
     // Prime a timer.
     Timer timer;
     timer.updateSavedTime();
 
-    // Deserialize the file into a snapshot.
-    TileMapSnapshot mapSnapshot;
-    Deserialize::fromFile((Paths::BASE_PATH + "TileMap.bin"), mapSnapshot);
+    // If the map is in the monolithic format, convert it to the paged format.
+    if (PagedMapFile::readVersion(mapFilePath)
+        < PagedMapFile::MIN_FORMAT_VERSION) {
+        convertSnapshotFile(mapFilePath);
+    }
 
-    // Load the map snapshot.
-    load(mapSnapshot);
+    // Open the map file.
+    if (!(mapFile.open(mapFilePath))) {
+        LOG_FATAL("Failed to open map file: %s", mapFilePath.c_str());
+    }
+
+    // Load the header data.
+    // Note: We set x/y to 0 since our map origin is always (0, 0). Change
+    //       this if we ever support negative origins.
+    chunkExtent.x = 0;
+    chunkExtent.y = 0;
+    chunkExtent.xLength = mapFile.getXLengthChunks();
+    chunkExtent.yLength = mapFile.getYLengthChunks();
+    tileExtent.x = 0;
+    tileExtent.y = 0;
+    tileExtent.xLength = (chunkExtent.xLength * SharedConfig::CHUNK_WIDTH);
+    tileExtent.yLength = (chunkExtent.yLength * SharedConfig::CHUNK_WIDTH);
+
+    // If the file doesn't have an ID (it's from before we added them),
+    // generate one. It'll be written on the next save.
+    mapID = mapFile.getMapID();
+    if (mapID == 0) {
+        mapID = generateID();
+    }
+
+    // Start a new version epoch, so that versions handed out during a
+    // previous run that didn't get saved won't be handed out again.
+    versionEpoch = generateID();
 
     // Print the time taken.
     double timeTaken{timer.getDeltaSeconds(false)};
-    LOG_INFO("Map loaded in %.6fs. Size: (%u, %u)ch.", timeTaken,
+    LOG_INFO("Map opened in %.6fs. Size: (%u, %u)ch.", timeTaken,
              chunkExtent.xLength, chunkExtent.yLength);
 }
 
@@ -48,122 +90,511 @@ void TileMap::save(const std::string& fileName)
     Timer timer;
     timer.updateSavedTime();
 
-    /* Save this map's state into a snapshot. */
-    // Save the header data.
-    TileMapSnapshot mapSnapshot{};
-    mapSnapshot.version = MAP_FORMAT_VERSION;
-    mapSnapshot.xLengthChunks = chunkExtent.xLength;
-    mapSnapshot.yLengthChunks = chunkExtent.yLength;
-
-    // Allocate room for our chunks.
-    mapSnapshot.chunks.resize(chunkExtent.getCount());
-
-    // Save our tiles into the snapshot as chunks.
-    unsigned int startLinearTileIndex{0};
-    int chunksProcessed{0};
-    for (unsigned int i = 0; i < chunkExtent.getCount(); ++i) {
-        ChunkSnapshot& chunk{mapSnapshot.chunks[i]};
-
-        // Process each tile in this chunk.
-        unsigned int nextLinearTileIndex{startLinearTileIndex};
-        unsigned int tilesProcessed{0};
-        for (unsigned int j = 0; j < SharedConfig::CHUNK_TILE_COUNT; ++j) {
-            // Copy all of the tile's layers into the snapshot.
-            TileSnapshot& tile{chunk.tiles[j]};
-            for (Tile::SpriteLayer& layer :
-                 tiles[nextLinearTileIndex].spriteLayers) {
-                const std::string& stringID{
-                    spriteData.getStringID(layer.sprite.numericID)};
-                unsigned int paletteID{chunk.getPaletteIndex(stringID)};
-                tile.spriteLayers.push_back(paletteID);
+    // Apply any edits that are still waiting on their chunk, so that they
+    // aren't lost. Saving already blocks on the file, so we load their
+    // chunks synchronously.
+    while (!(pendingEdits.empty())) {
+        unsigned int chunkIndex{pendingEdits.begin()->first};
+        loadChunkNow(chunkIndex);
+        applyPendingEdits(chunkIndex);
+    }
+
+    // Write the map to a temporary file. Resident chunks are saved from
+    // memory, evicted chunks are copied from the current file.
+    const std::string filePath{Paths::BASE_PATH + fileName};
+    const std::string tempFilePath{filePath + ".tmp"};
+    PagedMapFile::write(
+        tempFilePath, chunkExtent.xLength, chunkExtent.yLength, mapID,
+        [&](unsigned int chunkIndex, BinaryBuffer& outBytes) -> Uint32 {
+            // If the chunk is resident, save it from memory.
+            auto chunkIt{chunks.find(chunkIndex)};
+            if (chunkIt != chunks.end()) {
+                ChunkSnapshot chunkSnapshot{};
+                saveChunk(chunkIt->second, chunkSnapshot);
+                serializeChunk(chunkSnapshot, outBytes);
+                return chunkIt->second.version;
             }
 
-            // Increment to the next tile.
-            nextLinearTileIndex++;
+            // If the chunk was modified and evicted, save its snapshot.
+            auto evictedIt{evictedDirtyChunks.find(chunkIndex)};
+            if (evictedIt != evictedDirtyChunks.end()) {
+                outBytes = evictedIt->second.bytes;
+                return evictedIt->second.version;
+            }
 
-            // If we've processed all the tiles in this row, increment to the
-            // next row.
-            tilesProcessed++;
-            if (tilesProcessed == SharedConfig::CHUNK_WIDTH) {
-                nextLinearTileIndex
-                    += (tileExtent.xLength - SharedConfig::CHUNK_WIDTH);
-                tilesProcessed = 0;
+            // The chunk is unmodified, copy it from the current file.
+            if (!(mapFile.readChunkBytes(chunkIndex, outBytes))) {
+                LOG_ERROR("Failed to copy chunk with index: %u", chunkIndex);
             }
-        }
+            return mapFile.getChunkVersion(chunkIndex);
+        });
 
-        // Increment to the next chunk.
-        startLinearTileIndex += SharedConfig::CHUNK_WIDTH;
+    // If we saved over our own file, re-open it so that our chunk table
+    // matches the new file.
+    if (filePath == mapFilePath) {
+        mapFile.close();
+        replaceFile(tempFilePath, filePath);
+        if (!(mapFile.open(mapFilePath))) {
+            LOG_FATAL("Failed to re-open map file: %s", mapFilePath.c_str());
+        }
 
-        // If we've processed all the chunks in this row, increment to the
-        // next row.
-        chunksProcessed++;
-        if (chunksProcessed == chunkExtent.xLength) {
-            startLinearTileIndex
-                += ((SharedConfig::CHUNK_WIDTH - 1) * tileExtent.xLength);
-            chunksProcessed = 0;
+        // Everything is now saved.
+        evictedDirtyChunks.clear();
+        for (auto& [chunkIndex, chunk] : chunks) {
+            chunk.isDirty = false;
         }
     }
-
-    // Serialize the map snapshot and write it to the file.
-    Serialize::toFile((Paths::BASE_PATH + fileName), mapSnapshot);
+    else {
+        replaceFile(tempFilePath, filePath);
+    }
 
     // Print the time taken.
     double timeTaken{timer.getDeltaSeconds(false)};
     LOG_INFO("Map saved in %.6fs.", timeTaken);
 }
 
-void TileMap::load(TileMapSnapshot& mapSnapshot)
+void TileMap::requestChunk(const ChunkPosition& chunkPosition)
 {
-    /* Load the snapshot into this map. */
-    // Load the header data.
-    // Note: We set x/y to 0 since our map origin is always (0, 0). Change
-    //       this if we ever support negative origins.
-    chunkExtent.x = 0;
-    chunkExtent.y = 0;
-    chunkExtent.xLength = mapSnapshot.xLengthChunks;
-    chunkExtent.yLength = mapSnapshot.yLengthChunks;
-    tileExtent.x = 0;
-    tileExtent.y = 0;
-    tileExtent.xLength = (chunkExtent.xLength * SharedConfig::CHUNK_WIDTH);
-    tileExtent.yLength = (chunkExtent.yLength * SharedConfig::CHUNK_WIDTH);
+    // If the chunk is outside of the map bounds, ignore it.
+    if (!(chunkExtent.containsPosition(chunkPosition))) {
+        return;
+    }
+    unsigned int chunkIndex{
+        linearizeChunkIndex(chunkPosition.x, chunkPosition.y)};
 
-    // Resize the tiles vector to fit the map.
-    tiles.resize(tileExtent.xLength * tileExtent.yLength);
-
-    // Load the chunks into the tiles vector.
-    for (unsigned int chunkIndex = 0; chunkIndex < mapSnapshot.chunks.size();
-         ++chunkIndex) {
-        // Calc the coordinates of this chunk's first tile.
-        unsigned int startX{(chunkIndex % chunkExtent.xLength)
-                            * SharedConfig::CHUNK_WIDTH};
-        unsigned int startY{(chunkIndex / chunkExtent.xLength)
-                            * SharedConfig::CHUNK_WIDTH};
-        ChunkSnapshot& chunk{mapSnapshot.chunks[chunkIndex]};
-
-        // These vars track which tile we're looking at, with respect to the
-        // top left of the chunk.
-        unsigned int relativeX{0};
-        unsigned int relativeY{0};
-
-        // Add all of this chunk's tiles to the tiles vector.
-        for (unsigned int i = 0; i < SharedConfig::CHUNK_TILE_COUNT; ++i) {
-            // Push all of the snapshot's sprites into the tile.
-            TileSnapshot& tileSnapshot{chunk.tiles[i]};
-            unsigned int layerIndex{0};
-            for (unsigned int paletteID : tileSnapshot.spriteLayers) {
-                const Sprite& sprite{spriteData.get(chunk.palette[paletteID])};
-                setTileSpriteLayer((startX + relativeX), (startY + relativeY),
-                                   layerIndex++, sprite);
+    // If the chunk is resident, mark it as recently used.
+    auto residencyIt{residencyData.find(chunkIndex)};
+    if (residencyIt != residencyData.end()) {
+        ResidencyData& data{residencyIt->second};
+        lruList.splice(lruList.begin(), lruList, data.lruIt);
+        data.lastRequestedEpoch = residencyEpoch;
+        return;
+    }
+
+    // If the chunk was modified and evicted, re-load it from memory.
+    if (evictedDirtyChunks.contains(chunkIndex)) {
+        loadChunkNow(chunkIndex);
+        return;
+    }
+
+    // If the chunk isn't already being loaded, start loading it.
+    if (pendingLoads.insert(chunkIndex).second) {
+        chunkLoader.requestLoad(chunkIndex);
+    }
+}
+
+void TileMap::requestChunks(const TileExtent& extent)
+{
+    // Find the range of chunks that the extent touches.
+    int startX{extent.x / static_cast<int>(SharedConfig::CHUNK_WIDTH)};
+    int startY{extent.y / static_cast<int>(SharedConfig::CHUNK_WIDTH)};
+    int endX{(extent.x + extent.xLength - 1)
+             / static_cast<int>(SharedConfig::CHUNK_WIDTH)};
+    int endY{(extent.y + extent.yLength - 1)
+             / static_cast<int>(SharedConfig::CHUNK_WIDTH)};
+
+    for (int y = startY; y <= endY; ++y) {
+        for (int x = startX; x <= endX; ++x) {
+            requestChunk({x, y});
+        }
+    }
+}
+
+void TileMap::pinChunk(const ChunkPosition& chunkPosition)
+{
+    // If the chunk is outside of the map bounds, ignore it.
+    if (!(chunkExtent.containsPosition(chunkPosition))) {
+        return;
+    }
+
+    pinCounts[linearizeChunkIndex(chunkPosition.x, chunkPosition.y)]++;
+    requestChunk(chunkPosition);
+}
+
+void TileMap::unpinChunk(const ChunkPosition& chunkPosition)
+{
+    // If the chunk is outside of the map bounds, it was never pinned.
+    if (!(chunkExtent.containsPosition(chunkPosition))) {
+        return;
+    }
+
+    auto pinIt{pinCounts.find(
+        linearizeChunkIndex(chunkPosition.x, chunkPosition.y))};
+    if (pinIt == pinCounts.end()) {
+        LOG_ERROR("Tried to unpin a chunk that isn't pinned: (%d, %d)",
+                  chunkPosition.x, chunkPosition.y);
+        return;
+    }
+
+    pinIt->second--;
+    if (pinIt->second == 0) {
+        pinCounts.erase(pinIt);
+    }
+}
+
+void TileMap::pinChunks(const ChunkExtent& extent)
+{
+    for (int y = extent.y; y < (extent.y + extent.yLength); ++y) {
+        for (int x = extent.x; x < (extent.x + extent.xLength); ++x) {
+            pinChunk({x, y});
+        }
+    }
+}
+
+void TileMap::unpinChunks(const ChunkExtent& extent)
+{
+    for (int y = extent.y; y < (extent.y + extent.yLength); ++y) {
+        for (int x = extent.x; x < (extent.x + extent.xLength); ++x) {
+            unpinChunk({x, y});
+        }
+    }
+}
+
+bool TileMap::isResident(const TileExtent& extent) const
+{
+    // Find the range of chunks that the extent touches.
+    int startX{extent.x / static_cast<int>(SharedConfig::CHUNK_WIDTH)};
+    int startY{extent.y / static_cast<int>(SharedConfig::CHUNK_WIDTH)};
+    int endX{(extent.x + extent.xLength - 1)
+             / static_cast<int>(SharedConfig::CHUNK_WIDTH)};
+    int endY{(extent.y + extent.yLength - 1)
+             / static_cast<int>(SharedConfig::CHUNK_WIDTH)};
+
+    for (int y = startY; y <= endY; ++y) {
+        for (int x = startX; x <= endX; ++x) {
+            if (!(chunkExtent.containsPosition({x, y}))
+                || !(chunks.contains(linearizeChunkIndex(x, y)))) {
+                return false;
             }
+        }
+    }
+
+    return true;
+}
+
+void TileMap::updateResidency()
+{
+    ZoneScoped;
+
+    // Add any chunks that finished loading.
+    ChunkLoader::LoadResult loadResult{};
+    while (chunkLoader.popLoadResult(loadResult)) {
+        pendingLoads.erase(loadResult.chunkIndex);
+
+        // Note: If the load failed, the chunk will be re-requested the next
+        //       time it's needed.
+        // Note: If the chunk was loaded synchronously in the meantime (and
+        //       possibly edited and evicted), this result is stale.
+        if (loadResult.succeeded && !(chunks.contains(loadResult.chunkIndex))
+            && !(evictedDirtyChunks.contains(loadResult.chunkIndex))) {
+            addResidentChunk(loadResult.chunkIndex, loadResult.snapshot,
+                             mapFile.getChunkVersion(loadResult.chunkIndex));
+        }
+
+        applyPendingEdits(loadResult.chunkIndex);
+    }
+
+    // Evict the least recently used chunks until we're within our budget.
+    static constexpr std::size_t BUDGET_BYTES{Config::CHUNK_MEMORY_BUDGET_MB
+                                              * 1024 * 1024};
+    auto lruIt{lruList.end()};
+    while ((residentBytes > BUDGET_BYTES) && (lruIt != lruList.begin())) {
+        --lruIt;
+        unsigned int chunkIndex{*lruIt};
+
+        // If this chunk was requested during this epoch, so was every chunk
+        // in front of it. There's nothing left that we can evict.
+        if (residencyData[chunkIndex].lastRequestedEpoch == residencyEpoch) {
+            break;
+        }
 
-            // Increment the relative indices, wrapping at the chunk width.
-            relativeX++;
-            if (relativeX == SharedConfig::CHUNK_WIDTH) {
-                relativeY++;
-                relativeX = 0;
+        // Pinned chunks can't be evicted.
+        if (pinCounts.contains(chunkIndex)) {
+            continue;
+        }
+
+        lruIt = evictChunk(lruIt);
+    }
+
+    residencyEpoch++;
+}
+
+std::size_t TileMap::getResidentBytes() const
+{
+    return residentBytes;
+}
+
+Uint32 TileMap::getChunkVersion(const ChunkPosition& chunkPosition)
+{
+    unsigned int chunkIndex{
+        linearizeChunkIndex(chunkPosition.x, chunkPosition.y)};
+
+    // If the chunk is resident, its version may have changed since it was
+    // saved.
+    auto chunkIt{chunks.find(chunkIndex)};
+    if (chunkIt != chunks.end()) {
+        return chunkIt->second.version;
+    }
+
+    auto evictedIt{evictedDirtyChunks.find(chunkIndex)};
+    if (evictedIt != evictedDirtyChunks.end()) {
+        return evictedIt->second.version;
+    }
+
+    return mapFile.getChunkVersion(chunkIndex);
+}
+
+Uint32 TileMap::getMapID() const
+{
+    return mapID;
+}
+
+Chunk* TileMap::getChunkForEdit(const TileEdit& edit)
+{
+    ChunkPosition chunkPosition{
+        (edit.tileX / static_cast<int>(SharedConfig::CHUNK_WIDTH)),
+        (edit.tileY / static_cast<int>(SharedConfig::CHUNK_WIDTH))};
+    unsigned int chunkIndex{
+        linearizeChunkIndex(chunkPosition.x, chunkPosition.y)};
+    auto chunkIt{chunks.find(chunkIndex)};
+    if (chunkIt != chunks.end()) {
+        return &(chunkIt->second);
+    }
+
+    // If the chunk was modified and evicted, it's cheap to re-load it from
+    // memory.
+    if (evictedDirtyChunks.contains(chunkIndex)
+        && loadChunkNow(chunkIndex)) {
+        return &(chunks[chunkIndex]);
+    }
+
+    // The chunk needs to be read from the file. Hold onto the edit until
+    // it's loaded, so that the edit is applied on top of its saved tiles
+    // (an empty chunk would overwrite them on save).
+    pendingEdits[chunkIndex].push_back(edit);
+    requestChunk(chunkPosition);
+    return nullptr;
+}
+
+void TileMap::convertSnapshotFile(const std::string& filePath)
+{
+    LOG_INFO("Converting %s to the paged map format.", filePath.c_str());
+
+    // Deserialize the file into a snapshot.
+    TileMapSnapshot mapSnapshot;
+    Deserialize::fromFile(filePath, mapSnapshot);
+
+    // Write the snapshot's chunks to a paged file.
+    const std::string tempFilePath{filePath + ".tmp"};
+    PagedMapFile::write(
+        tempFilePath, mapSnapshot.xLengthChunks, mapSnapshot.yLengthChunks,
+        generateID(),
+        [&](unsigned int chunkIndex, BinaryBuffer& outBytes) -> Uint32 {
+            if (chunkIndex < mapSnapshot.chunks.size()) {
+                serializeChunk(mapSnapshot.chunks[chunkIndex], outBytes);
+            }
+            else {
+                ChunkSnapshot emptyChunk{};
+                serializeChunk(emptyChunk, outBytes);
+            }
+            return 0;
+        });
+
+    replaceFile(tempFilePath, filePath);
+}
+
+bool TileMap::loadChunkNow(unsigned int chunkIndex)
+{
+    // If the chunk was modified and evicted, re-load it from memory.
+    auto evictedIt{evictedDirtyChunks.find(chunkIndex)};
+    if (evictedIt != evictedDirtyChunks.end()) {
+        ChunkSnapshot chunkSnapshot{};
+        BinaryBuffer& chunkBytes{evictedIt->second.bytes};
+        bool succeeded{Deserialize::fromBuffer(
+            chunkBytes.data(), chunkBytes.size(), chunkSnapshot)};
+        if (succeeded) {
+            addResidentChunk(chunkIndex, chunkSnapshot,
+                             evictedIt->second.version);
+
+            // The chunk still hasn't been saved.
+            chunks[chunkIndex].isDirty = true;
+        }
+
+        evictedDirtyChunks.erase(evictedIt);
+        return succeeded;
+    }
+
+    // Read the chunk from the file.
+    // Note: If chunkLoader is also loading this chunk, its result will be
+    //       ignored since the chunk will already be resident.
+    BinaryBuffer chunkBytes{};
+    ChunkSnapshot chunkSnapshot{};
+    if (!(mapFile.readChunkBytes(chunkIndex, chunkBytes))
+        || !(Deserialize::fromBuffer(chunkBytes.data(), chunkBytes.size(),
+                                     chunkSnapshot))) {
+        return false;
+    }
+
+    addResidentChunk(chunkIndex, chunkSnapshot,
+                     mapFile.getChunkVersion(chunkIndex));
+    return true;
+}
+
+void TileMap::applyPendingEdits(unsigned int chunkIndex)
+{
+    auto editsIt{pendingEdits.find(chunkIndex)};
+    if (editsIt == pendingEdits.end()) {
+        return;
+    }
+
+    auto chunkIt{chunks.find(chunkIndex)};
+    if (chunkIt != chunks.end()) {
+        for (const TileEdit& edit : editsIt->second) {
+            applyEdit(chunkIt->second, edit);
+        }
+    }
+    else {
+        LOG_WARNING("Failed to load chunk for edit, dropped %zu edits. "
+                    "Chunk index: %u",
+                    editsIt->second.size(), chunkIndex);
+    }
+
+    pendingEdits.erase(editsIt);
+}
+
+void TileMap::addResidentChunk(unsigned int chunkIndex,
+                               const ChunkSnapshot& chunkSnapshot,
+                               Uint32 chunkVersion)
+{
+    loadChunk(chunkIndex, chunkSnapshot);
+    chunks[chunkIndex].version = chunkVersion;
+
+    // Track the new chunk as the most recently used.
+    lruList.push_front(chunkIndex);
+    ResidencyData& data{residencyData[chunkIndex]};
+    data.lruIt = lruList.begin();
+    data.lastRequestedEpoch = residencyEpoch;
+    data.sizeBytes = estimateChunkSize(chunks[chunkIndex]);
+
+    residentBytes += data.sizeBytes;
+}
+
+std::list<unsigned int>::iterator
+    TileMap::evictChunk(std::list<unsigned int>::iterator lruIt)
+{
+    unsigned int chunkIndex{*lruIt};
+
+    // If the chunk was modified, save it so it can be written on the next
+    // save.
+    auto chunkIt{chunks.find(chunkIndex)};
+    if (chunkIt->second.isDirty) {
+        ChunkSnapshot chunkSnapshot{};
+        saveChunk(chunkIt->second, chunkSnapshot);
+        EvictedChunk& evictedChunk{evictedDirtyChunks[chunkIndex]};
+        serializeChunk(chunkSnapshot, evictedChunk.bytes);
+        evictedChunk.version = chunkIt->second.version;
+    }
+
+    // Remove the chunk.
+    auto residencyIt{residencyData.find(chunkIndex)};
+    residentBytes -= residencyIt->second.sizeBytes;
+    residencyData.erase(residencyIt);
+    chunks.erase(chunkIt);
+
+    return lruList.erase(lruIt);
+}
+
+void TileMap::loadChunk(unsigned int chunkIndex,
+                        const ChunkSnapshot& chunkSnapshot)
+{
+    // Calc the coordinates of this chunk's first tile.
+    int startX{static_cast<int>((chunkIndex % chunkExtent.xLength)
+                                * SharedConfig::CHUNK_WIDTH)};
+    int startY{static_cast<int>((chunkIndex / chunkExtent.xLength)
+                                * SharedConfig::CHUNK_WIDTH)};
+
+    // Add the chunk, even if all of its tiles are empty.
+    // Note: The chunk must be in the map before we set its tiles, so that
+    //       getChunkForEdit() doesn't try to load it again.
+    Chunk& chunk{chunks[chunkIndex]};
+
+    // Look up each of the palette's sprites once, instead of once per layer.
+    std::vector<const Sprite*> paletteSprites{};
+    for (const std::string& stringID : chunkSnapshot.palette) {
+        paletteSprites.push_back(&(spriteData.get(stringID)));
+    }
+
+    // Push all of the snapshot's sprites into the chunk's tiles.
+    for (unsigned int i = 0; i < SharedConfig::CHUNK_TILE_COUNT; ++i) {
+        int tileX{startX + static_cast<int>(i % SharedConfig::CHUNK_WIDTH)};
+        int tileY{startY + static_cast<int>(i / SharedConfig::CHUNK_WIDTH)};
+
+        const TileSnapshot& tileSnapshot{chunkSnapshot.tiles[i]};
+        unsigned int layerIndex{0};
+        for (Uint8 paletteID : tileSnapshot.spriteLayers) {
+            if (paletteID >= paletteSprites.size()) {
+                LOG_ERROR("Invalid palette ID in chunk with index: %u",
+                          chunkIndex);
+                break;
             }
+            setTileSpriteLayer(tileX, tileY, layerIndex++,
+                               *(paletteSprites[paletteID]));
         }
     }
+
+    // The chunk matches what's saved.
+    chunk.isDirty = false;
+}
+
+void TileMap::saveChunk(const Chunk& chunk, ChunkSnapshot& chunkSnapshot)
+{
+    // Copy all of the tiles' layers into the snapshot.
+    ChunkPaletteBuilder<std::string> paletteBuilder{chunkSnapshot.palette};
+    for (unsigned int i = 0; i < SharedConfig::CHUNK_TILE_COUNT; ++i) {
+        TileSnapshot& tileSnapshot{chunkSnapshot.tiles[i]};
+        for (const Tile::SpriteLayer& layer : chunk.tiles[i].spriteLayers) {
+            const std::string& stringID{
+                spriteData.getStringID(layer.sprite.numericID)};
+            unsigned int paletteID{paletteBuilder.getIndex(stringID)};
+            tileSnapshot.spriteLayers.push_back(paletteID);
+        }
+    }
+}
+
+void TileMap::serializeChunk(ChunkSnapshot& chunkSnapshot,
+                             BinaryBuffer& outBytes)
+{
+    outBytes.resize(Serialize::measureSize(chunkSnapshot));
+    Serialize::toBuffer(outBytes.data(), outBytes.size(), chunkSnapshot);
+}
+
+void TileMap::replaceFile(const std::string& sourcePath,
+                          const std::string& destPath)
+{
+    std::error_code errorCode{};
+    std::filesystem::rename(sourcePath, destPath, errorCode);
+    if (errorCode) {
+        LOG_FATAL("Failed to replace %s: %s", destPath.c_str(),
+                  errorCode.message().c_str());
+    }
+}
+
+Uint32 TileMap::generateID()
+{
+    // Note: 0 means "no ID", so we avoid it.
+    std::random_device randomDevice{};
+    std::uniform_int_distribution<Uint32> distribution{1, UINT32_MAX};
+    return distribution(randomDevice);
+}
+
+std::size_t TileMap::estimateChunkSize(const Chunk& chunk)
+{
+    std::size_t sizeBytes{sizeof(Chunk)};
+    for (const Tile& tile : chunk.tiles) {
+        sizeBytes += (tile.spriteLayers.capacity() * sizeof(Tile::SpriteLayer));
+    }
+
+    return sizeBytes;
 }
 
 } // End namespace Server
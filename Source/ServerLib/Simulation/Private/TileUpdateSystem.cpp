@@ -3,6 +3,7 @@
 #include "Network.h"
 #include "ClientSimData.h"
 #include "TileUpdate.h"
+#include "Log.h"
 #include "Tracy.hpp"
 
 namespace AM
@@ -27,6 +28,21 @@ void TileUpdateSystem::updateTiles()
     // Process any waiting update requests.
     TileUpdateRequest updateRequest;
     while (tileUpdateRequestQueue.pop(updateRequest)) {
+        // If the tile is outside of the map bounds, skip it.
+        TilePosition tilePosition{updateRequest.tileX, updateRequest.tileY};
+        if (!(world.tileMap.getTileExtent().containsPosition(tilePosition))) {
+            continue;
+        }
+
+        // If the tile's chunk isn't resident, skip it (updating it would
+        // create an empty chunk that overwrites the saved one).
+        // Note: Clients only edit tiles near them, so this should only
+        //       happen if a request comes in as the client is moving away.
+        if (!(world.tileMap.hasChunk(ChunkPosition{tilePosition}))) {
+            LOG_INFO("Dropped tile update for non-resident chunk.");
+            continue;
+        }
+
         // Update the map.
         // Note: This doesn't check if the client entity is within any certain
         //       range of the tile or anything. We can add that if it's
@@ -36,14 +52,17 @@ void TileUpdateSystem::updateTiles()
             updateRequest.numericID);
 
         // Construct the new tile update.
+        // Note: We include the chunk's new version so that clients can
+        //       keep their cached copy in sync with ours.
+        ChunkPosition centerChunk{
+            TilePosition{updateRequest.tileX, updateRequest.tileY}};
         TileUpdate tileUpdate{updateRequest.tileX, updateRequest.tileY,
                               updateRequest.layerIndex,
-                              updateRequest.numericID};
+                              updateRequest.numericID,
+                              world.tileMap.getChunkVersion(centerChunk)};
 
         // Get the list of clients that are in range of the updated tile.
         // Note: This is hardcoded to match ChunkUpdateSystem.
-        ChunkPosition centerChunk{
-            TilePosition{updateRequest.tileX, updateRequest.tileY}};
         ChunkExtent chunkExtent{(centerChunk.x - 1), (centerChunk.y - 1), 3, 3};
         chunkExtent.intersectWith(world.tileMap.getChunkExtent());
 
@@ -1,5 +1,6 @@
 #include "World.h"
 #include "ClientSimData.h"
+#include "ClientRegistry.h"
 #include "SharedConfig.h"
 #include "Config.h"
 #include "Log.h"
@@ -13,6 +14,7 @@ World::World(SpriteData& spriteData)
 : registry()
 , tileMap(spriteData)
 , entityLocator(registry)
+, netIdMap()
 , device()
 , generator(device())
 , xDistribution(Config::SPAWN_POINT_RANDOM_MIN_X,
@@ -48,6 +50,39 @@ Position World::getSpawnPoint()
     }
 }
 
+void World::addClientEntity(NetworkID netID, entt::entity entity)
+{
+    unsigned int slotIndex{ClientRegistry::getSlotIndex(netID)};
+    if (slotIndex >= netIdMap.size()) {
+        netIdMap.resize(slotIndex + 1);
+    }
+
+    netIdMap[slotIndex] = {netID, entity};
+}
+
+entt::entity World::findClientEntity(NetworkID netID) const
+{
+    // If the slot is empty or holds a different generation, there's no
+    // entity for this ID.
+    unsigned int slotIndex{ClientRegistry::getSlotIndex(netID)};
+    if ((slotIndex < netIdMap.size())
+        && (netIdMap[slotIndex].netID == netID)) {
+        return netIdMap[slotIndex].entity;
+    }
+    else {
+        return entt::null;
+    }
+}
+
+void World::removeClientEntity(NetworkID netID)
+{
+    unsigned int slotIndex{ClientRegistry::getSlotIndex(netID)};
+    if ((slotIndex < netIdMap.size())
+        && (netIdMap[slotIndex].netID == netID)) {
+        netIdMap[slotIndex] = {};
+    }
+}
+
 Position World::getGroupedSpawnPoint()
 {
     // Calculate the next spawn point.
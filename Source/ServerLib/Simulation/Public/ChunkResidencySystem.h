@@ -0,0 +1,61 @@
+#pragma once
+
+#include "ChunkPosition.h"
+#include "ChunkExtent.h"
+#include "entt/fwd.hpp"
+#include <unordered_map>
+
+namespace AM
+{
+namespace Server
+{
+class World;
+
+/**
+ * Keeps the tile map chunks around each client entity resident in memory.
+ *
+ * Chunks are requested a bit further out than clients can see (see
+ * Config::CHUNK_RESIDENCY_RADIUS), so that they're usually done loading by
+ * the time a client needs them.
+ *
+ * Also pins the chunks around each entity that can move, so that the tiles
+ * that it collides with don't get evicted out from under it.
+ */
+class ChunkResidencySystem
+{
+public:
+    ChunkResidencySystem(World& inWorld);
+
+    /**
+     * Requests the chunks around each client entity and updates the pins
+     * around each movable entity, then lets the tile map add any loaded
+     * chunks and evict any that are no longer needed.
+     */
+    void updateResidency();
+
+private:
+    /** How far out from a movable entity's chunk we pin, in chunks.
+        Entities move much less than a chunk per tick, so the adjacent chunks
+        are enough. */
+    static constexpr int MOVEMENT_PIN_RADIUS{1};
+
+    /**
+     * Pins the chunks around each movable entity, and unpins them when the
+     * entity leaves its chunk or is destroyed.
+     */
+    void updateMovementPins();
+
+    /**
+     * Returns the extent of chunks that should be pinned around the given
+     * center chunk.
+     */
+    static ChunkExtent getPinExtent(const ChunkPosition& centerChunk);
+
+    World& world;
+
+    /** The chunk that each movable entity's pins are centered on. */
+    std::unordered_map<entt::entity, ChunkPosition> pinCenters;
+};
+
+} // namespace Server
+} // namespace AM
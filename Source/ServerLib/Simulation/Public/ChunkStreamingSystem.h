@@ -4,10 +4,15 @@
 #include "QueuedEvents.h"
 #include "ChunkUpdateRequest.h"
 #include "ChunkPosition.h"
+#include <SDL_stdinc.h>
+#include <unordered_map>
+#include <vector>
 
 namespace AM
 {
 struct ChunkUpdate;
+struct Position;
+struct Velocity;
 
 namespace Server
 {
@@ -20,6 +25,23 @@ class Network;
  * A client may require chunks to be sent when it logs in, moves into a new
  * chunk, or teleports.
  *
+ * Requested chunks are queued per-client, and each tick we send each client
+ * as many as fit in Config::CHUNK_STREAMING_BYTES_PER_TICK. This keeps large
+ * requests from crowding out movement traffic, spreading them over several
+ * network ticks instead. Queued chunks are sent in order of their distance
+ * to where the client's entity is predicted to be, so the chunks that it's
+ * in or moving towards arrive first.
+ *
+ * If the client already has an up to date copy of a requested chunk, we tell
+ * it to use that instead of re-sending it.
+ *
+ * If a requested chunk isn't resident in memory yet, we ask the tile map to
+ * load it and leave it in the queue.
+ *
+ * When a chunk doesn't fit in a client's remaining budget, we remember its
+ * serialized size so that we don't re-build it each tick just to find out
+ * that it still doesn't fit.
+ *
  * Note: We have no validation to see if client entities are in range of the
  *       requested chunks, but the worlds are all open source so it doesn't
  *       matter anyway. If someone wants to see the map, they can already get
@@ -33,16 +55,57 @@ public:
                          Network& inNetwork);
 
     /**
-     * Processes chunk update requests, sending chunk data if the request is
-     * valid.
+     * Queues any new chunk update requests, then sends each client its
+     * highest priority chunks.
      */
     void sendChunks();
 
 private:
     /**
-     * Send a chunk update, containing the chunks from the given request.
+     * A client's queue of chunks that are waiting to be sent.
+     */
+    struct ClientStreamState {
+        /** The chunks that this client has requested, but that we haven't
+            sent yet. */
+        std::vector<ChunkUpdateRequest::RequestedChunk> pendingChunks{};
+
+        /** Used to detect disconnected clients. True if we found this
+            client's entity during the current tick. */
+        bool wasFound{false};
+    };
+
+    /**
+     * The serialized size of a chunk, as of a particular version.
+     */
+    struct MeasuredChunk {
+        /** The chunk's version when it was measured. */
+        Uint32 version{0};
+
+        /** The chunk's serialized size, in bytes. */
+        std::size_t sizeBytes{0};
+    };
+
+    /**
+     * Adds the given request's chunks to its client's queue.
+     */
+    void queueRequest(const ChunkUpdateRequest& chunkUpdateRequest);
+
+    /**
+     * Sends a chunk update to the given client, containing its highest
+     * priority resident chunks that fit within our byte budget. The chunks
+     * that were sent are removed from the client's queue.
      */
-    void sendChunkUpdate(const ChunkUpdateRequest& chunkUpdateRequest);
+    void sendChunksToClient(NetworkID netID, const Position& position,
+                            const Velocity& velocity,
+                            ClientStreamState& streamState);
+
+    /**
+     * Sorts the given chunks from nearest to furthest from the given client
+     * entity's predicted position.
+     */
+    void sortByPriority(
+        std::vector<ChunkUpdateRequest::RequestedChunk>& pendingChunks,
+        const Position& position, const Velocity& velocity);
 
     /**
      * Adds the given chunk to the given UpdateChunks message.
@@ -59,6 +122,14 @@ private:
     Network& network;
 
     EventQueue<ChunkUpdateRequest> chunkUpdateRequestQueue;
+
+    /** Each client's queue of chunks that are waiting to be sent. */
+    std::unordered_map<NetworkID, ClientStreamState> clientStreamStates;
+
+    /** The sizes of chunks that were built but didn't fit in a client's
+        budget, keyed by linearized chunk index. Entries are removed when
+        their chunk is sent. */
+    std::unordered_map<unsigned int, MeasuredChunk> measuredChunks;
 };
 
 } // End namespace Server
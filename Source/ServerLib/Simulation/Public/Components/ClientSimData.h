@@ -2,6 +2,7 @@
 
 #include "NetworkDefs.h"
 #include "entt/fwd.hpp"
+#include <SDL_stdinc.h>
 #include <vector>
 
 namespace AM
@@ -30,6 +31,13 @@ public:
         dropped. */
     bool inputWasDropped{false};
 
+    /** If an input from this client is being traced, the SDL performance
+        counter values from when it was received and applied. Else, 0.
+        Cleared once the resulting movement update is sent.
+        See InputLatencyMetrics. */
+    Uint64 tracedInputReceiveTime{0};
+    Uint64 tracedInputApplyTime{0};
+
     /** Tracks the entities that are in range of this client's entity. */
     std::vector<entt::entity> entitiesInAOI{};
 
@@ -15,6 +15,11 @@ namespace Server
  *
  * The project can register the extension class with the engine through
  * Application::registerSimulationExtension().
+ *
+ * Note: The tile map only keeps chunks near clients and movable entities in
+ *       memory. If the project needs other chunks to stay resident (e.g. to
+ *       run logic on an area with no one in it), it can pin them through
+ *       SimulationExDependencies::tileMap.
  */
 class ISimulationExtension : public OSEventHandler
 {
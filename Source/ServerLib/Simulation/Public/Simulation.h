@@ -2,6 +2,7 @@
 
 #include "World.h"
 #include "ClientConnectionSystem.h"
+#include "ChunkResidencySystem.h"
 #include "TileUpdateSystem.h"
 #include "ClientAOISystem.h"
 #include "InputSystem.h"
@@ -9,6 +10,7 @@
 #include "MovementUpdateSystem.h"
 #include "ChunkStreamingSystem.h"
 #include "MapSaveSystem.h"
+#include "SystemProfiler.h"
 #include <SDL_stdinc.h>
 #include <atomic>
 
@@ -51,7 +53,31 @@ public:
      */
     void setExtension(std::unique_ptr<ISimulationExtension> inExtension);
 
+    /**
+     * Returns the profiler that times each of our systems.
+     */
+    const SystemProfiler& getSystemProfiler() const;
+
 private:
+    /**
+     * The systems that systemProfiler tracks.
+     * Note: Wrapped in a struct so the names don't collide with our
+     *       components, while still converting to an index.
+     */
+    struct ProfiledSystem {
+        enum Index : std::size_t {
+            ClientConnection,
+            ChunkResidency,
+            TileUpdate,
+            Input,
+            Movement,
+            ClientAOI,
+            MovementUpdate,
+            ChunkStreaming,
+            MapSave
+        };
+    };
+
     /** Used to receive events (through the Network's dispatcher) and to
         send messages. */
     Network& network;
@@ -66,10 +92,14 @@ private:
         the appropriate time. */
     std::unique_ptr<ISimulationExtension> extension;
 
+    /** Times each of our systems. */
+    SystemProfiler systemProfiler;
+
     //-------------------------------------------------------------------------
     // Systems
     //-------------------------------------------------------------------------
     ClientConnectionSystem clientConnectionSystem;
+    ChunkResidencySystem chunkResidencySystem;
     TileUpdateSystem tileUpdateSystem;
     ClientAOISystem clientAOISystem;
     InputSystem inputSystem;
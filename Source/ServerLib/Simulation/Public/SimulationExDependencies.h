@@ -2,9 +2,12 @@
 
 namespace AM
 {
+class SystemProfiler;
+
 namespace Server
 {
 class World;
+class TileMap;
 class Network;
 class SpriteData;
 
@@ -16,9 +19,16 @@ struct SimulationExDependencies {
 public:
     World& world;
 
+    /** The world's tile map. Used to pin chunks (see TileMap::pinChunk()),
+        so that they stay resident while the project needs them. */
+    TileMap& tileMap;
+
     Network& network;
 
     SpriteData& spriteData;
+
+    /** Holds the timings of the engine's sim systems. */
+    const SystemProfiler& systemProfiler;
 };
 
 } // namespace Server
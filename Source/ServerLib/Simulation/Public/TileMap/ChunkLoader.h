@@ -0,0 +1,83 @@
+#pragma once
+
+#include "ChunkSnapshot.h"
+#include "Tracy.hpp"
+#include <queue>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+namespace AM
+{
+namespace Server
+{
+class PagedMapFile;
+
+/**
+ * Loads chunks from a PagedMapFile on a separate thread, so that the sim
+ * doesn't block on file reads.
+ */
+class ChunkLoader
+{
+public:
+    /**
+     * The result of a single chunk load.
+     */
+    struct LoadResult {
+        /** The linearized index of the chunk that was loaded. */
+        unsigned int chunkIndex{0};
+
+        /** True if the chunk was successfully loaded, else false. */
+        bool succeeded{false};
+
+        /** If succeeded == true, holds the loaded chunk. */
+        ChunkSnapshot snapshot{};
+    };
+
+    ChunkLoader(PagedMapFile& inMapFile);
+
+    ~ChunkLoader();
+
+    /**
+     * Queues the chunk at the given index to be loaded.
+     */
+    void requestLoad(unsigned int chunkIndex);
+
+    /**
+     * If a load has finished, moves its result into outResult.
+     *
+     * @return true if a result was available, else false.
+     */
+    bool popLoadResult(LoadResult& outResult);
+
+private:
+    /**
+     * Thread function, started from constructor.
+     * Waits for load requests and fulfills them.
+     */
+    void loadChunks();
+
+    /** The file to load chunks from. */
+    PagedMapFile& mapFile;
+
+    /** Holds the indices of chunks that are waiting to be loaded. */
+    std::queue<unsigned int> loadRequests;
+    /** Guards loadRequests. */
+    TracyLockable(std::mutex, requestMutex);
+    /** Used for signaling the load thread. */
+    std::condition_variable_any requestCondVar;
+
+    /** Holds the results of finished loads. */
+    std::queue<LoadResult> loadResults;
+    /** Guards loadResults. */
+    TracyLockable(std::mutex, resultMutex);
+
+    /** Calls loadChunks(). */
+    std::thread loadThreadObj;
+    /** Turn true to signal that the load thread should end. */
+    std::atomic<bool> exitRequested;
+};
+
+} // End namespace Server
+} // End namespace AM
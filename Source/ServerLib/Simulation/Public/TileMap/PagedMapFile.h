@@ -0,0 +1,164 @@
+#pragma once
+
+#include "BinaryBuffer.h"
+#include <SDL_stdinc.h>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace AM
+{
+namespace Server
+{
+/**
+ * A chunk-addressable tile map file.
+ *
+ * Unlike a serialized TileMapSnapshot, which has to be loaded all at once,
+ * this format lets individual chunks be read on demand.
+ *
+ * Layout (little endian):
+ *   Uint16 version
+ *   Uint32 xLengthChunks
+ *   Uint32 yLengthChunks
+ *   Uint32 mapID
+ *   Chunk table: For each chunk, in row-major order, a Uint64 offset (from
+ *                the start of the file), a Uint32 size, and a Uint32 chunk
+ *                version.
+ *   Chunk data: Each chunk's serialized ChunkSnapshot.
+ *
+ * Version 2 files (which have no mapID or chunk versions) can still be
+ * opened. Their mapID and chunk versions read as 0.
+ *
+ * Reads are thread safe.
+ */
+class PagedMapFile
+{
+public:
+    /** The version of the paged map format.
+        Versions 0 and 1 are monolithic TileMapSnapshot files, see
+        TileMapBase::MAP_FORMAT_VERSION. */
+    static constexpr Uint16 FORMAT_VERSION{3};
+
+    /** The oldest paged map format version that we can open. */
+    static constexpr Uint16 MIN_FORMAT_VERSION{2};
+
+    /** Used to provide chunk data to write(). Must fill outBytes with the
+        serialized ChunkSnapshot of the chunk at the given index, and return
+        the chunk's version. */
+    using ChunkBytesGetter = std::function<Uint32(unsigned int chunkIndex,
+                                                  BinaryBuffer& outBytes)>;
+
+    PagedMapFile();
+
+    /**
+     * Returns the format version of the map file at the given path.
+     *
+     * Errors if the file can't be opened.
+     */
+    static Uint16 readVersion(const std::string& filePath);
+
+    /**
+     * Writes a paged map file to the given path.
+     *
+     * Errors if the file can't be opened.
+     *
+     * @param getChunkBytes  Called once for each chunk, in row-major order.
+     */
+    static void write(const std::string& filePath, unsigned int xLengthChunks,
+                      unsigned int yLengthChunks, Uint32 mapID,
+                      const ChunkBytesGetter& getChunkBytes);
+
+    /**
+     * Opens the paged map file at the given path and reads its chunk table.
+     *
+     * If a file is already open, it will be closed first.
+     *
+     * @return true if the file was successfully opened, false if it couldn't
+     *         be opened or isn't a paged map file.
+     */
+    bool open(const std::string& inFilePath);
+
+    /**
+     * Closes the currently open file, if there is one.
+     */
+    void close();
+
+    /**
+     * Reads the serialized ChunkSnapshot of the chunk at the given index.
+     *
+     * @return true if the chunk was successfully read, else false.
+     */
+    bool readChunkBytes(unsigned int chunkIndex, BinaryBuffer& outBytes);
+
+    /**
+     * Returns the saved version of the chunk at the given index.
+     */
+    Uint32 getChunkVersion(unsigned int chunkIndex);
+
+    /**
+     * Returns the length, in chunks, of the map's X axis.
+     */
+    unsigned int getXLengthChunks() const;
+
+    /**
+     * Returns the length, in chunks, of the map's Y axis.
+     */
+    unsigned int getYLengthChunks() const;
+
+    /**
+     * Returns the map's ID.
+     */
+    Uint32 getMapID() const;
+
+private:
+    /** The size of the version, xLengthChunks, yLengthChunks, and mapID
+        fields. */
+    static constexpr std::size_t HEADER_SIZE{2 + 4 + 4 + 4};
+
+    /** The size of a single chunk table entry. */
+    static constexpr std::size_t TABLE_ENTRY_SIZE{8 + 4 + 4};
+
+    /** The header and table entry sizes used by version 2 files. */
+    static constexpr std::size_t V2_HEADER_SIZE{2 + 4 + 4};
+    static constexpr std::size_t V2_TABLE_ENTRY_SIZE{8 + 4};
+
+    /**
+     * An entry in the chunk table.
+     */
+    struct TableEntry {
+        /** The offset, from the start of the file, of the chunk's data. */
+        Uint64 offset{0};
+
+        /** The size of the chunk's data. */
+        Uint32 size{0};
+
+        /** The chunk's version. */
+        Uint32 version{0};
+    };
+
+    /** The path to the currently open file. */
+    std::string filePath;
+
+    /** The currently open file. */
+    std::ifstream file;
+
+    /** The length, in chunks, of the map's X axis. */
+    unsigned int xLengthChunks;
+
+    /** The length, in chunks, of the map's Y axis. */
+    unsigned int yLengthChunks;
+
+    /** The map's ID. */
+    Uint32 mapID;
+
+    /** The location and version of each chunk's data, in row-major order. */
+    std::vector<TableEntry> chunkTable;
+
+    /** Guards file and chunkTable. */
+    std::mutex fileMutex;
+};
+
+} // End namespace Server
+} // End namespace AM
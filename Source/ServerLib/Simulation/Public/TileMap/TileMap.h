@@ -1,19 +1,35 @@
 #pragma once
 
 #include "TileMapBase.h"
+#include "PagedMapFile.h"
+#include "ChunkLoader.h"
+#include "BinaryBuffer.h"
+#include <SDL_stdinc.h>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <string>
 
 namespace AM
 {
-struct TileMapSnapshot;
+struct ChunkSnapshot;
 namespace Server
 {
 class SpriteData;
 
 /**
  * Owns and manages the world's tile map state.
- * Tiles are conceptually organized into 16x16 chunks.
+ * Tiles are organized into 16x16 chunks.
  *
- * Persisted tile map data is loaded from TileMap.bin.
+ * Persisted tile map data is paged in from TileMap.bin. Only chunks that were
+ * recently requested (e.g. chunks near clients) or that are pinned are kept
+ * in memory. When the resident chunks exceed Config::CHUNK_MEMORY_BUDGET_MB,
+ * the least recently used ones are evicted.
+ *
+ * Edits to a non-resident chunk are deferred: the chunk is loaded
+ * asynchronously, and the edits are applied on top of its saved tiles when it
+ * arrives (see updateResidency()).
  *
  * Note: This class expects a TileMap.bin file to be present in the same
  *       directory as the application executable.
@@ -22,7 +38,11 @@ class TileMap : public TileMapBase
 {
 public:
     /**
-     * Attempts to parse TileMap.bin and construct the tile map.
+     * Opens TileMap.bin and reads the map's dimensions. Chunks are loaded as
+     * they're requested.
+     *
+     * If TileMap.bin is a TileMapSnapshot (the monolithic map format), it
+     * will first be converted to the paged format.
      *
      * Errors if TileMap.bin doesn't exist or it fails to parse.
      */
@@ -41,11 +61,230 @@ public:
      */
     void save(const std::string& fileName);
 
+    /**
+     * Requests that the given chunk be kept in memory.
+     *
+     * If the chunk is resident, marks it as recently used. If not, starts
+     * loading it asynchronously. Either way, the chunk won't be evicted by
+     * the next updateResidency() call.
+     *
+     * Note: Until a chunk is resident, its tiles will appear empty. See
+     *       hasChunk().
+     */
+    void requestChunk(const ChunkPosition& chunkPosition);
+
+    /**
+     * Calls requestChunk() on each chunk that the given tile extent touches.
+     */
+    void requestChunks(const TileExtent& extent);
+
+    /**
+     * Requests the given chunk and prevents it from being evicted until it's
+     * unpinned.
+     *
+     * Pins are counted, each call must be matched by a call to unpinChunk().
+     * Out of bounds chunks are ignored.
+     */
+    void pinChunk(const ChunkPosition& chunkPosition);
+
+    /**
+     * Removes a pin that was added by pinChunk().
+     */
+    void unpinChunk(const ChunkPosition& chunkPosition);
+
+    /**
+     * Calls pinChunk() on each chunk in the given extent.
+     */
+    void pinChunks(const ChunkExtent& extent);
+
+    /**
+     * Calls unpinChunk() on each chunk in the given extent.
+     */
+    void unpinChunks(const ChunkExtent& extent);
+
+    /**
+     * Returns true if every chunk that the given tile extent touches is
+     * resident.
+     *
+     * Tiles in non-resident chunks appear empty, so e.g. collision checks
+     * should treat them as unknown until this returns true.
+     */
+    bool isResident(const TileExtent& extent) const;
+
+    /**
+     * Adds any chunks that finished loading and applies any edits that were
+     * waiting on them, then evicts least recently used chunks until we're
+     * within our memory budget.
+     *
+     * Should be called once per tick, after the tick's chunks have been
+     * requested.
+     */
+    void updateResidency();
+
+    /**
+     * Returns the approximate number of bytes used by resident chunks.
+     */
+    std::size_t getResidentBytes() const;
+
+    /**
+     * Returns the current version of the given chunk, whether it's resident
+     * or not.
+     */
+    Uint32 getChunkVersion(const ChunkPosition& chunkPosition);
+
+    /**
+     * Returns this map's ID, which is persisted with the map.
+     * Used by clients to tell which map their cached chunks belong to.
+     */
+    Uint32 getMapID() const;
+
+protected:
+    /**
+     * Returns the chunk that contains the given edit's tile.
+     *
+     * If the chunk was evicted with unsaved changes, re-loads it from memory.
+     * Otherwise, if it isn't resident, queues the edit and starts loading the
+     * chunk asynchronously.
+     *
+     * @return The chunk, or nullptr if the edit was queued.
+     */
+    Chunk* getChunkForEdit(const TileEdit& edit) override;
+
 private:
     /**
-     * Loads the given snapshot's data into this map.
+     * Tracks the residency of a single resident chunk.
+     */
+    struct ResidencyData {
+        /** This chunk's element in lruList. */
+        std::list<unsigned int>::iterator lruIt{};
+
+        /** The residencyEpoch that this chunk was last requested during. */
+        Uint32 lastRequestedEpoch{0};
+
+        /** The approximate number of bytes used by this chunk. */
+        std::size_t sizeBytes{0};
+    };
+
+    /**
+     * A modified chunk that was evicted before it could be saved.
      */
-    void load(TileMapSnapshot& mapSnapshot);
+    struct EvictedChunk {
+        /** The chunk's serialized snapshot. */
+        BinaryBuffer bytes{};
+
+        /** The chunk's version. */
+        Uint32 version{0};
+    };
+
+    /**
+     * Converts the TileMapSnapshot file at the given path into a paged map
+     * file, replacing it.
+     */
+    void convertSnapshotFile(const std::string& filePath);
+
+    /**
+     * Loads the chunk at the given index from evictedDirtyChunks or the map
+     * file, without waiting for chunkLoader, and makes it resident.
+     *
+     * @return true if the chunk was loaded, else false.
+     */
+    bool loadChunkNow(unsigned int chunkIndex);
+
+    /**
+     * Applies any edits that were waiting on the chunk at the given index.
+     * If the chunk isn't resident, the edits are dropped.
+     */
+    void applyPendingEdits(unsigned int chunkIndex);
+
+    /**
+     * Adds the given chunk to the map and starts tracking its residency.
+     */
+    void addResidentChunk(unsigned int chunkIndex,
+                          const ChunkSnapshot& chunkSnapshot,
+                          Uint32 chunkVersion);
+
+    /**
+     * Evicts the chunk at the given lruList element, saving its data to
+     * evictedDirtyChunks if it was modified.
+     *
+     * @return The lruList element that followed the evicted chunk.
+     */
+    std::list<unsigned int>::iterator
+        evictChunk(std::list<unsigned int>::iterator lruIt);
+
+    /**
+     * Loads the given snapshot's tiles into the chunk at the given index.
+     */
+    void loadChunk(unsigned int chunkIndex, const ChunkSnapshot& chunkSnapshot);
+
+    /**
+     * Saves the given chunk's tiles into the given snapshot.
+     */
+    void saveChunk(const Chunk& chunk, ChunkSnapshot& chunkSnapshot);
+
+    /**
+     * Serializes the given snapshot into outBytes.
+     */
+    static void serializeChunk(ChunkSnapshot& chunkSnapshot,
+                               BinaryBuffer& outBytes);
+
+    /**
+     * Moves the file at sourcePath to destPath, replacing it.
+     *
+     * Errors if the move fails.
+     */
+    static void replaceFile(const std::string& sourcePath,
+                            const std::string& destPath);
+
+    /**
+     * Returns a random, non-zero ID. Used for map IDs and version epochs.
+     */
+    static Uint32 generateID();
+
+    /**
+     * Returns the approximate number of bytes used by the given chunk.
+     */
+    static std::size_t estimateChunkSize(const Chunk& chunk);
+
+    /** The path to TileMap.bin. */
+    const std::string mapFilePath;
+
+    /** The file that chunks are paged in from. */
+    PagedMapFile mapFile;
+
+    /** Loads chunks from mapFile in the background. */
+    ChunkLoader chunkLoader;
+
+    /** The indices of chunks that are waiting on chunkLoader. */
+    std::unordered_set<unsigned int> pendingLoads;
+
+    /** Edits that are waiting on their chunk to load, in the order that
+        they were made. Keyed by chunk index. */
+    std::unordered_map<unsigned int, std::vector<TileEdit>> pendingEdits;
+
+    /** The residency data of each resident chunk. */
+    std::unordered_map<unsigned int, ResidencyData> residencyData;
+
+    /** The indices of each resident chunk, ordered from most to least
+        recently used. */
+    std::list<unsigned int> lruList;
+
+    /** The number of pins that each pinned chunk has. */
+    std::unordered_map<unsigned int, unsigned int> pinCounts;
+
+    /** Modified chunks that were evicted before they could be saved.
+        Written to the file on the next save. */
+    std::unordered_map<unsigned int, EvictedChunk> evictedDirtyChunks;
+
+    /** Incremented each time updateResidency() is called. Chunks that were
+        requested during the current epoch won't be evicted. */
+    Uint32 residencyEpoch;
+
+    /** The approximate number of bytes used by resident chunks. */
+    std::size_t residentBytes;
+
+    /** This map's ID. See getMapID(). */
+    Uint32 mapID;
 };
 
 } // End namespace Server
@@ -8,7 +8,7 @@
 
 #include "entt/entity/registry.hpp"
 
-#include <unordered_map>
+#include <vector>
 #include <random>
 
 namespace AM
@@ -44,22 +44,50 @@ public:
         position. */
     EntityLocator entityLocator;
 
-    /** Maps network IDs to entity IDs.
-        Used for interfacing with the Network. */
-    std::unordered_map<NetworkID, entt::entity> netIdMap;
-
     /**
      * Returns the spawn point position.
      * To configure, see Server::Config.
      */
     Position getSpawnPoint();
 
+    /**
+     * Associates the given client entity with the given network ID.
+     */
+    void addClientEntity(NetworkID netID, entt::entity entity);
+
+    /**
+     * Returns the client entity associated with the given network ID, or
+     * entt::null if there isn't one.
+     */
+    entt::entity findClientEntity(NetworkID netID) const;
+
+    /**
+     * Removes the association between the given network ID and its entity.
+     */
+    void removeClientEntity(NetworkID netID);
+
 private:
+    /**
+     * An element in netIdMap.
+     */
+    struct NetIdMapping {
+        /** The full ID (including generation) of the client in this slot. */
+        NetworkID netID{0};
+
+        /** The client's entity, or entt::null if the slot is empty. */
+        entt::entity entity{entt::null};
+    };
+
     /**
      * Returns the next spawn point, trying to build groups of 10.
      */
     Position getGroupedSpawnPoint();
 
+    /** Maps network IDs to entity IDs. Indexed by the ID's slot index (see
+        ClientRegistry).
+        Used for interfacing with the Network. */
+    std::vector<NetIdMapping> netIdMap;
+
     // For random spawn points.
     std::random_device device;
     std::mt19937 generator;
@@ -2,6 +2,7 @@
 
 #include "MessageType.h"
 #include "ChunkWireSnapshot.h"
+#include "ChunkPosition.h"
 #include <vector>
 
 namespace AM
@@ -21,6 +22,10 @@ public:
 
     /** The chunks that the client should load. */
     std::vector<ChunkWireSnapshot> chunks;
+
+    /** The requested chunks that the client's cached copy of is up to date.
+        The client should load these from its cache. */
+    std::vector<ChunkPosition> unchangedChunks;
 };
 
 template<typename S>
@@ -28,6 +33,8 @@ void serialize(S& serializer, ChunkUpdate& chunkUpdate)
 {
     serializer.container(chunkUpdate.chunks,
                          static_cast<std::size_t>(ChunkUpdate::MAX_CHUNKS));
+    serializer.container(chunkUpdate.unchangedChunks,
+                         static_cast<std::size_t>(ChunkUpdate::MAX_CHUNKS));
 }
 
 } // End namespace AM
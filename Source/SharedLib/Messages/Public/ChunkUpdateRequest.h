@@ -3,6 +3,7 @@
 #include "MessageType.h"
 #include "ChunkPosition.h"
 #include "NetworkDefs.h"
+#include <SDL_stdinc.h>
 #include <vector>
 
 namespace AM
@@ -23,8 +24,24 @@ public:
     //--------------------------------------------------------------------------
     // Replicated data
     //--------------------------------------------------------------------------
+    /**
+     * A single requested chunk.
+     */
+    struct RequestedChunk {
+        /** The position of the requested chunk. */
+        ChunkPosition position{};
+
+        /** True if the client has a cached copy of this chunk. */
+        bool hasCachedVersion{false};
+
+        /** If hasCachedVersion == true, the version of the client's cached
+            copy. If it matches the server's version, the chunk won't be
+            re-sent. */
+        Uint32 cachedVersion{0};
+    };
+
     /** The chunks that the client is requesting. */
-    std::vector<ChunkPosition> requestedChunks;
+    std::vector<RequestedChunk> requestedChunks;
 
     //--------------------------------------------------------------------------
     // Non-replicated data
@@ -38,6 +55,15 @@ public:
     NetworkID netID{0};
 };
 
+template<typename S>
+void serialize(S& serializer,
+               ChunkUpdateRequest::RequestedChunk& requestedChunk)
+{
+    serializer.object(requestedChunk.position);
+    serializer.value1b(requestedChunk.hasCachedVersion);
+    serializer.value4b(requestedChunk.cachedVersion);
+}
+
 template<typename S>
 void serialize(S& serializer, ChunkUpdateRequest& chunkUpdateRequest)
 {
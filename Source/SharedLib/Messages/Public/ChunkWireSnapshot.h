@@ -2,6 +2,7 @@
 
 #include "TileSnapshot.h"
 #include "ChunkSnapshot.h"
+#include "ChunkCodec.h"
 #include "SharedConfig.h"
 #include <vector>
 #include <array>
@@ -13,7 +14,7 @@ namespace AM
  * in the palette instead of their string ID.
  *
  * Since the integer ID isn't persistable, this struct is only suitable for
- * sending chunk data to clients.
+ * sending chunk data to clients. To build one, see ChunkPaletteBuilder.
  */
 struct ChunkWireSnapshot {
 public:
@@ -23,35 +24,16 @@ public:
     /** The chunk's Y-axis coordinate. */
     Uint16 y{0};
 
+    /** The chunk's version, see Chunk::version. */
+    Uint32 version{0};
+
     /** Holds the numeric IDs of all the sprites used in this chunk's tiles.
         Tile layers hold indices into this palette. */
     std::vector<int> palette;
 
-    /** The tiles that make up this chunk, stored in row-major order. */
-    std::array<TileSnapshot, SharedConfig::CHUNK_TILE_COUNT> tiles;
-
-    /**
-     * Returns the palette index for the given ID.
-     * If the ID is not in the palette, it will be added.
-     */
-    unsigned int getPaletteIndex(int numericID)
-    {
-        // TODO: If this gets to be a performance issue, we can look into
-        //       switching palette to a map. Serialization will be more
-        //       complicated, though.
-
-        // Check if we already have this id.
-        for (unsigned int i = 0; i < palette.size(); ++i) {
-            if (palette[i] == numericID) {
-                // We already have the string, return its index.
-                return i;
-            }
-        }
-
-        // We didn't have the id, add it.
-        palette.push_back(numericID);
-        return static_cast<unsigned int>(palette.size() - 1);
-    }
+    /** The tiles that make up this chunk, stored in row-major order.
+        Serialized through ChunkCodec. */
+    ChunkCodec::TileArray tiles;
 };
 
 template<typename S>
@@ -61,9 +43,11 @@ void serialize(S& serializer, ChunkWireSnapshot& testChunk)
 
     serializer.value2b(testChunk.y);
 
+    serializer.value4b(testChunk.version);
+
     serializer.container4b(testChunk.palette, ChunkSnapshot::MAX_IDS);
 
-    serializer.container(testChunk.tiles);
+    serializer.ext(testChunk.tiles, PackedChunkTiles{});
 }
 
 } // End namespace AM
@@ -14,6 +14,10 @@ struct ConnectionResponse {
     // Declares this struct as a message that the Network can send and receive.
     static constexpr MessageType MESSAGE_TYPE = MessageType::ConnectionResponse;
 
+    /** The number of bytes that this message serializes to.
+        See FixedSizeMessage in MessageRegistry.h. */
+    static constexpr std::size_t SERIALIZED_SIZE{28};
+
     /** The tick that the server is telling the client to assume. */
     Uint32 tickNum{0};
 
@@ -27,6 +31,10 @@ struct ConnectionResponse {
     /** The length, in tiles, of the tile map's Y axis. */
     unsigned int mapYLengthChunks{0};
 
+    /** Identifies the server's tile map. Used by the client to tell which
+        cached chunks belong to this map. */
+    Uint32 mapID{0};
+
     /** Position (spawn point or last logout). */
     float x{0};
     float y{0};
@@ -39,6 +47,7 @@ void serialize(S& serializer, ConnectionResponse& connectionResponse)
     serializer.value4b(connectionResponse.entity);
     serializer.value4b(connectionResponse.mapXLengthChunks);
     serializer.value4b(connectionResponse.mapYLengthChunks);
+    serializer.value4b(connectionResponse.mapID);
     serializer.value4b(connectionResponse.x);
     serializer.value4b(connectionResponse.y);
 }
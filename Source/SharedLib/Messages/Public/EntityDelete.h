@@ -15,6 +15,10 @@ struct EntityDelete {
     // Declares this struct as a message that the Network can send and receive.
     static constexpr MessageType MESSAGE_TYPE = MessageType::EntityDelete;
 
+    /** The number of bytes that this message serializes to.
+        See FixedSizeMessage in MessageRegistry.h. */
+    static constexpr std::size_t SERIALIZED_SIZE{8};
+
     /** The tick that this update corresponds to. */
     Uint32 tickNum{0};
 
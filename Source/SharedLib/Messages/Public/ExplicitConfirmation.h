@@ -18,6 +18,10 @@ struct ExplicitConfirmation {
     static constexpr MessageType MESSAGE_TYPE
         = MessageType::ExplicitConfirmation;
 
+    /** The number of bytes that this message serializes to.
+        See FixedSizeMessage in MessageRegistry.h. */
+    static constexpr std::size_t SERIALIZED_SIZE{1};
+
     Uint8 confirmedTickCount{0};
 };
 
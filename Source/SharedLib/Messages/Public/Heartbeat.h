@@ -14,6 +14,10 @@ struct Heartbeat {
     // Declares this struct as a message that the Network can send and receive.
     static constexpr MessageType MESSAGE_TYPE = MessageType::Heartbeat;
 
+    /** The number of bytes that this message serializes to.
+        See FixedSizeMessage in MessageRegistry.h. */
+    static constexpr std::size_t SERIALIZED_SIZE{4};
+
     /** The tick that this heartbeat was processed on. */
     Uint32 tickNum{0};
 };
@@ -35,6 +35,19 @@ struct InputChangeRequest {
      * so we fill in the ID based on which socket the message came from.
      */
     NetworkID netID{0};
+
+    /**
+     * If this input is being traced, the SDL performance counter value from
+     * when the server received it. Else, 0.
+     * Set by the server. See Server::InputLatencyMetrics.
+     */
+    Uint64 receiveTime{0};
+
+    /**
+     * If this input is being traced, the SDL performance counter value from
+     * when it was pushed into the InputSystem's sorter. Else, 0.
+     */
+    Uint64 sortTime{0};
 };
 
 template<typename S>
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "MessageType.h"
+#include "Heartbeat.h"
+#include "InputChangeRequest.h"
+#include "ChunkUpdateRequest.h"
+#include "TileUpdateRequest.h"
+#include "ExplicitConfirmation.h"
+#include "ConnectionResponse.h"
+#include "MovementUpdate.h"
+#include "ChunkUpdate.h"
+#include "TileUpdate.h"
+#include "EntityInit.h"
+#include "EntityDelete.h"
+#include "Serialize.h"
+#include "Ignore.h"
+#include <concepts>
+#include <type_traits>
+#include <cstddef>
+
+/**
+ * This file contains the compile-time registry of our message types.
+ *
+ * The network layer uses it to dispatch received messages to their handlers,
+ * and to skip measuring the serialized size of fixed-size messages.
+ */
+namespace AM
+{
+//--------------------------------------------------------------------------
+// Concepts
+//--------------------------------------------------------------------------
+/**
+ * A struct that can be sent over the network.
+ * Must declare its MessageType as a static constexpr MESSAGE_TYPE.
+ */
+template<typename T>
+concept NetworkMessage = requires {
+    { T::MESSAGE_TYPE } -> std::convertible_to<MessageType>;
+};
+
+/**
+ * A message that always serializes to the same number of bytes.
+ * Must declare that number as a static constexpr SERIALIZED_SIZE.
+ *
+ * Note: SERIALIZED_SIZE must be kept in sync with the message's serialize()
+ *       function. TestMessageRegistry checks that it is.
+ */
+template<typename T>
+concept FixedSizeMessage = NetworkMessage<T> && requires {
+    { T::SERIALIZED_SIZE } -> std::convertible_to<std::size_t>;
+};
+
+//--------------------------------------------------------------------------
+// Type Lists
+//--------------------------------------------------------------------------
+/**
+ * Returns true if no two of the given message types share a MESSAGE_TYPE.
+ */
+template<NetworkMessage... Ts>
+constexpr bool hasUniqueMessageTypes()
+{
+    constexpr MessageType types[]{Ts::MESSAGE_TYPE...};
+    for (std::size_t i = 0; i < sizeof...(Ts); ++i) {
+        for (std::size_t j = (i + 1); j < sizeof...(Ts); ++j) {
+            if (types[i] == types[j]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * A list of message types, used to generate dispatch code at compile time.
+ */
+template<NetworkMessage... Ts>
+struct MessageList {
+    /**
+     * Returns true if the given type is in this list.
+     */
+    static constexpr bool contains(MessageType messageType)
+    {
+        return ((messageType == Ts::MESSAGE_TYPE) || ...);
+    }
+
+    /**
+     * Calls func(std::type_identity<T>{}), where T is the message type in
+     * this list that matches the given messageType.
+     *
+     * @return true if a match was found, else false.
+     */
+    template<typename Func>
+    static bool dispatch(MessageType messageType, Func&& func)
+    {
+        return ((messageType == Ts::MESSAGE_TYPE
+                 && (func(std::type_identity<Ts>{}), true))
+                || ...);
+    }
+
+    static_assert(hasUniqueMessageTypes<Ts...>(),
+                  "Two messages in a MessageList share a MESSAGE_TYPE.");
+};
+
+/** The messages that clients send to the server. */
+using ClientToServerMessages
+    = MessageList<Heartbeat, InputChangeRequest, ChunkUpdateRequest,
+                  TileUpdateRequest>;
+
+/** The messages that the server sends to clients. */
+using ServerToClientMessages
+    = MessageList<ExplicitConfirmation, ConnectionResponse, MovementUpdate,
+                  ChunkUpdate, TileUpdate, EntityInit, EntityDelete>;
+
+//--------------------------------------------------------------------------
+// Helpers
+//--------------------------------------------------------------------------
+/**
+ * Returns the number of bytes that the given message will serialize to.
+ *
+ * If the message has a fixed size, returns it without measuring.
+ */
+template<NetworkMessage T>
+std::size_t measureMessageSize(const T& message)
+{
+    if constexpr (FixedSizeMessage<T>) {
+        ignore(message);
+        return T::SERIALIZED_SIZE;
+    }
+    else {
+        return Serialize::measureSize(message);
+    }
+}
+
+} // End namespace AM
@@ -28,6 +28,11 @@ enum class MessageType : Uint8 {
     TileUpdate = 34,
     EntityInit = 35,
     EntityDelete = 36,
+
+    // Server -> Client Framing
+    /** Holds a piece of a message that was too large to fit in a single
+        batch. See Server::Client::addFragmentedMessage(). */
+    MessageFragment = 37,
 };
 
 } // End namespace AM
@@ -15,6 +15,10 @@ public:
     // Declares this struct as a message that the Network can send and receive.
     static constexpr MessageType MESSAGE_TYPE{MessageType::TileUpdate};
 
+    /** The number of bytes that this message serializes to.
+        See FixedSizeMessage in MessageRegistry.h. */
+    static constexpr std::size_t SERIALIZED_SIZE{17};
+
     /** The X coordinate of the tile to update. */
     int tileX{0};
 
@@ -26,6 +30,9 @@ public:
 
     /** The new sprite's numeric ID. */
     int numericID{EMPTY_SPRITE_ID};
+
+    /** The tile's chunk's version, after this update was applied. */
+    Uint32 chunkVersion{0};
 };
 
 template<typename S>
@@ -35,6 +42,7 @@ void serialize(S& serializer, TileUpdate& tileUpdate)
     serializer.value4b(tileUpdate.tileY);
     serializer.value1b(tileUpdate.layerIndex);
     serializer.value4b(tileUpdate.numericID);
+    serializer.value4b(tileUpdate.chunkVersion);
 }
 
 } // End namespace AM
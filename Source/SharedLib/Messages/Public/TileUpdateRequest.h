@@ -15,6 +15,10 @@ public:
     // Declares this struct as a message that the Network can send and receive.
     static constexpr MessageType MESSAGE_TYPE = MessageType::TileUpdateRequest;
 
+    /** The number of bytes that this message serializes to.
+        See FixedSizeMessage in MessageRegistry.h. */
+    static constexpr std::size_t SERIALIZED_SIZE{13};
+
     /** The X coordinate of the tile to update. */
     int tileX{0};
 
@@ -3,10 +3,10 @@
 
 namespace AM
 {
-Acceptor::Acceptor(Uint16 port, const std::shared_ptr<SocketSet>& inClientSet)
+Acceptor::Acceptor(Uint16 port, int maxPeers)
 : socket(port)
 , listenerSet(1)
-, clientSet(inClientSet)
+, clientSet(std::make_shared<SocketSet>(maxPeers))
 {
     listenerSet.addSocket(socket);
 }
@@ -20,6 +20,8 @@ std::unique_ptr<Peer> Acceptor::accept()
     if (socket.isReady()) {
         std::unique_ptr<TcpSocket> newSocket{socket.accept()};
         if (newSocket != nullptr) {
+            // Don't let a slow peer block our sends to everyone else.
+            newSocket->setNonBlocking();
             return std::make_unique<Peer>(std::move(newSocket), clientSet);
         }
         else {
@@ -48,4 +50,9 @@ bool Acceptor::reject()
     return peerWasWaiting;
 }
 
+void Acceptor::checkPeerSockets()
+{
+    clientSet->checkSockets(0);
+}
+
 } // namespace AM
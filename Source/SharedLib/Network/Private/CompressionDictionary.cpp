@@ -0,0 +1,49 @@
+#include "CompressionDictionary.h"
+#include "Paths.h"
+#include "Log.h"
+#include <fstream>
+#include <iterator>
+
+namespace AM
+{
+const BinaryBuffer& CompressionDictionary::get()
+{
+    // Note: Static init is thread-safe, so the server and client threads can
+    //       call this concurrently.
+    static const BinaryBuffer dictionary{load()};
+    return dictionary;
+}
+
+bool CompressionDictionary::loadFromFile(const std::string& filePath,
+                                         BinaryBuffer& outDictionary)
+{
+    std::ifstream file(filePath, std::ios::binary);
+    if (!(file.is_open())) {
+        return false;
+    }
+
+    outDictionary.assign((std::istreambuf_iterator<char>(file)),
+                         std::istreambuf_iterator<char>());
+
+    // LZ4 only uses the last 64KB of a dictionary.
+    if (outDictionary.size() > MAX_SIZE) {
+        outDictionary.erase(outDictionary.begin(),
+                            (outDictionary.end() - MAX_SIZE));
+    }
+
+    return true;
+}
+
+BinaryBuffer CompressionDictionary::load()
+{
+    BinaryBuffer dictionary{};
+    if (!(loadFromFile(Paths::BASE_PATH + "CompressionDictionary.bin",
+                       dictionary))) {
+        return {};
+    }
+
+    LOG_INFO("Loaded compression dictionary. Size: %zuB", dictionary.size());
+    return dictionary;
+}
+
+} // End namespace AM
@@ -0,0 +1,58 @@
+#include "LoopbackAcceptor.h"
+#include "Peer.h"
+
+namespace AM
+{
+LoopbackAcceptor::LoopbackAcceptor(std::size_t inBufferSize)
+: bufferSize{inBufferSize}
+, pendingSockets{}
+, pendingMutex{}
+{
+}
+
+std::unique_ptr<Peer> LoopbackAcceptor::connect()
+{
+    auto [connectingSocket, acceptingSocket]
+        = LoopbackSocket::createPair(bufferSize);
+
+    {
+        std::scoped_lock lock{pendingMutex};
+        pendingSockets.push(std::move(acceptingSocket));
+    }
+
+    return std::make_unique<Peer>(std::move(connectingSocket));
+}
+
+std::unique_ptr<Peer> LoopbackAcceptor::accept()
+{
+    std::unique_ptr<LoopbackSocket> socket{popPendingSocket()};
+    if (socket != nullptr) {
+        return std::make_unique<Peer>(std::move(socket));
+    }
+
+    return nullptr;
+}
+
+bool LoopbackAcceptor::reject()
+{
+    // Note: Destroying the socket closes the connection.
+    return (popPendingSocket() != nullptr);
+}
+
+void LoopbackAcceptor::checkPeerSockets()
+{
+}
+
+std::unique_ptr<LoopbackSocket> LoopbackAcceptor::popPendingSocket()
+{
+    std::scoped_lock lock{pendingMutex};
+    if (pendingSockets.empty()) {
+        return nullptr;
+    }
+
+    std::unique_ptr<LoopbackSocket> socket{std::move(pendingSockets.front())};
+    pendingSockets.pop();
+    return socket;
+}
+
+} // End namespace AM
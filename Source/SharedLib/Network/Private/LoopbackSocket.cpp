@@ -0,0 +1,123 @@
+#include "LoopbackSocket.h"
+#include <algorithm>
+
+namespace AM
+{
+LoopbackSocket::Pipe::Pipe(std::size_t bufferSize)
+: mutex{}
+, condVar{}
+, buffer(bufferSize)
+, readIndex{0}
+, size{0}
+, isClosed{false}
+{
+}
+
+std::pair<std::unique_ptr<LoopbackSocket>, std::unique_ptr<LoopbackSocket>>
+    LoopbackSocket::createPair(std::size_t bufferSize)
+{
+    std::shared_ptr<Pipe> pipeA{std::make_shared<Pipe>(bufferSize)};
+    std::shared_ptr<Pipe> pipeB{std::make_shared<Pipe>(bufferSize)};
+
+    // Note: Our constructor is private, so we can't use make_unique.
+    return {std::unique_ptr<LoopbackSocket>(new LoopbackSocket(pipeA, pipeB)),
+            std::unique_ptr<LoopbackSocket>(new LoopbackSocket(pipeB, pipeA))};
+}
+
+LoopbackSocket::LoopbackSocket(const std::shared_ptr<Pipe>& inSendPipe,
+                               const std::shared_ptr<Pipe>& inReceivePipe)
+: sendPipe{inSendPipe}
+, receivePipe{inReceivePipe}
+{
+}
+
+LoopbackSocket::~LoopbackSocket()
+{
+    close(*sendPipe);
+    close(*receivePipe);
+}
+
+int LoopbackSocket::trySend(const Uint8* dataBuffer, int len)
+{
+    Pipe& pipe{*sendPipe};
+    {
+        std::scoped_lock lock{pipe.mutex};
+        if (pipe.isClosed) {
+            return -1;
+        }
+
+        // Copy as many bytes as will fit, wrapping around the end of the
+        // ring if necessary.
+        std::size_t capacity{pipe.buffer.size()};
+        std::size_t bytesToSend{std::min(static_cast<std::size_t>(len),
+                                         (capacity - pipe.size))};
+        std::size_t endIndex{(pipe.readIndex + pipe.size) % capacity};
+        std::size_t firstPartSize{
+            std::min(bytesToSend, (capacity - endIndex))};
+        std::copy(dataBuffer, (dataBuffer + firstPartSize),
+                  (pipe.buffer.data() + endIndex));
+        std::copy((dataBuffer + firstPartSize), (dataBuffer + bytesToSend),
+                  pipe.buffer.data());
+        pipe.size += bytesToSend;
+
+        len = static_cast<int>(bytesToSend);
+    }
+    pipe.condVar.notify_one();
+
+    return len;
+}
+
+int LoopbackSocket::receive(Uint8* dataBuffer, int maxLen)
+{
+    Pipe& pipe{*receivePipe};
+    std::unique_lock lock{pipe.mutex};
+
+    // Wait until there are bytes to receive.
+    pipe.condVar.wait(lock,
+                      [&pipe] { return ((pipe.size > 0) || pipe.isClosed); });
+    if (pipe.size == 0) {
+        // Disconnected
+        return 0;
+    }
+
+    // Copy as many bytes as we can, wrapping around the end of the ring if
+    // necessary.
+    std::size_t capacity{pipe.buffer.size()};
+    std::size_t bytesToReceive{
+        std::min(static_cast<std::size_t>(maxLen), pipe.size)};
+    std::size_t firstPartSize{
+        std::min(bytesToReceive, (capacity - pipe.readIndex))};
+    const Uint8* readStart{pipe.buffer.data() + pipe.readIndex};
+    std::copy(readStart, (readStart + firstPartSize), dataBuffer);
+    std::copy(pipe.buffer.data(),
+              (pipe.buffer.data() + (bytesToReceive - firstPartSize)),
+              (dataBuffer + firstPartSize));
+    pipe.readIndex = (pipe.readIndex + bytesToReceive) % capacity;
+    pipe.size -= bytesToReceive;
+
+    return static_cast<int>(bytesToReceive);
+}
+
+void LoopbackSocket::checkReady()
+{
+}
+
+bool LoopbackSocket::isReady()
+{
+    // Note: If closed, we report ready so that the receiver finds out about
+    //       the disconnect.
+    Pipe& pipe{*receivePipe};
+    std::scoped_lock lock{pipe.mutex};
+    return ((pipe.size > 0) || pipe.isClosed);
+}
+
+void LoopbackSocket::close(Pipe& pipe)
+{
+    {
+        std::scoped_lock lock{pipe.mutex};
+        pipe.isClosed = true;
+    }
+    pipe.condVar.notify_all();
+}
+
+} // End namespace AM
@@ -0,0 +1,58 @@
+#include "NetworkMetrics.h"
+
+namespace AM
+{
+// Initialize data.
+std::array<std::atomic<Uint64>, NetworkMetrics::MESSAGE_TYPE_COUNT>
+    NetworkMetrics::messagesSent{};
+std::array<std::atomic<Uint64>, NetworkMetrics::MESSAGE_TYPE_COUNT>
+    NetworkMetrics::bytesSent{};
+std::array<std::atomic<Uint64>, NetworkMetrics::MESSAGE_TYPE_COUNT>
+    NetworkMetrics::messagesReceived{};
+std::array<std::atomic<Uint64>, NetworkMetrics::MESSAGE_TYPE_COUNT>
+    NetworkMetrics::bytesReceived{};
+Histogram NetworkMetrics::sendLatencyUs{};
+
+MessageTypeMetrics
+    NetworkMetrics::getMessageTypeMetrics(MessageType messageType)
+{
+    std::size_t index{static_cast<std::size_t>(messageType)};
+
+    MessageTypeMetrics metrics{};
+    metrics.messagesSent = messagesSent[index].load(std::memory_order_relaxed);
+    metrics.bytesSent = bytesSent[index].load(std::memory_order_relaxed);
+    metrics.messagesReceived
+        = messagesReceived[index].load(std::memory_order_relaxed);
+    metrics.bytesReceived
+        = bytesReceived[index].load(std::memory_order_relaxed);
+
+    return metrics;
+}
+
+Histogram::Snapshot NetworkMetrics::getSendLatencySnapshot()
+{
+    return sendLatencyUs.getSnapshot();
+}
+
+void NetworkMetrics::recordMessageSent(MessageType messageType,
+                                       std::size_t bytes)
+{
+    std::size_t index{static_cast<std::size_t>(messageType)};
+    messagesSent[index].fetch_add(1, std::memory_order_relaxed);
+    bytesSent[index].fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void NetworkMetrics::recordMessageReceived(MessageType messageType,
+                                           std::size_t bytes)
+{
+    std::size_t index{static_cast<std::size_t>(messageType)};
+    messagesReceived[index].fetch_add(1, std::memory_order_relaxed);
+    bytesReceived[index].fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void NetworkMetrics::recordSendLatency(Uint64 latencyUs)
+{
+    sendLatencyUs.record(latencyUs);
+}
+
+} // End namespace AM
@@ -5,6 +5,14 @@ namespace AM
 // Initialize data.
 std::atomic<unsigned int> NetworkStats::bytesSent = 0;
 std::atomic<unsigned int> NetworkStats::bytesReceived = 0;
+std::array<std::atomic<unsigned int>, COMPRESSION_LEVEL_COUNT>
+    NetworkStats::compressedBatches{};
+std::atomic<unsigned int> NetworkStats::bytesBeforeCompression = 0;
+std::atomic<unsigned int> NetworkStats::bytesAfterCompression = 0;
+std::atomic<unsigned int> NetworkStats::skippedSmallBatches = 0;
+std::atomic<unsigned int> NetworkStats::skippedLowGainBatches = 0;
+std::atomic<std::size_t> NetworkStats::maxSendBacklog = 0;
+std::atomic<unsigned int> NetworkStats::backloggedSends = 0;
 
 NetStatsDump NetworkStats::dumpStats()
 {
@@ -14,6 +22,16 @@ NetStatsDump NetworkStats::dumpStats()
     netStatsDump.bytesSent = bytesSent.exchange(0);
     netStatsDump.bytesReceived = bytesReceived.exchange(0);
 
+    for (std::size_t i = 0; i < COMPRESSION_LEVEL_COUNT; ++i) {
+        netStatsDump.compressedBatches[i] = compressedBatches[i].exchange(0);
+    }
+    netStatsDump.bytesBeforeCompression = bytesBeforeCompression.exchange(0);
+    netStatsDump.bytesAfterCompression = bytesAfterCompression.exchange(0);
+    netStatsDump.skippedSmallBatches = skippedSmallBatches.exchange(0);
+    netStatsDump.skippedLowGainBatches = skippedLowGainBatches.exchange(0);
+    netStatsDump.maxSendBacklog = maxSendBacklog.exchange(0);
+    netStatsDump.backloggedSends = backloggedSends.exchange(0);
+
     return netStatsDump;
 }
 
@@ -27,4 +45,38 @@ void NetworkStats::recordBytesReceived(unsigned int inBytesReceived)
     bytesReceived += inBytesReceived;
 }
 
+void NetworkStats::recordCompressedBatch(StreamCompressor::Level level,
+                                         unsigned int sizeBefore,
+                                         unsigned int sizeAfter)
+{
+    compressedBatches[static_cast<std::size_t>(level)]++;
+    bytesBeforeCompression += sizeBefore;
+    bytesAfterCompression += sizeAfter;
+}
+
+void NetworkStats::recordSkippedSmallBatch()
+{
+    skippedSmallBatches++;
+}
+
+void NetworkStats::recordSkippedLowGainBatch()
+{
+    skippedLowGainBatches++;
+}
+
+void NetworkStats::recordSendBacklog(std::size_t backlogSize)
+{
+    if (backlogSize == 0) {
+        return;
+    }
+    backloggedSends++;
+
+    // Raise the max if this backlog is larger.
+    std::size_t currentMax{maxSendBacklog};
+    while ((backlogSize > currentMax)
+           && !(maxSendBacklog.compare_exchange_weak(currentMax,
+                                                     backlogSize))) {
+    }
+}
+
 } // End namespace AM
@@ -1,8 +1,11 @@
 #include "Peer.h"
 #include "TcpSocket.h"
+#include "TcpPeerSocket.h"
 #include "ByteTools.h"
 #include "Log.h"
 #include <SDL_stdinc.h>
+#include <algorithm>
+#include <array>
 
 namespace AM
 {
@@ -16,30 +19,30 @@ std::unique_ptr<Peer> Peer::initiate(const std::string& serverIP,
 }
 
 Peer::Peer(std::unique_ptr<TcpSocket> inSocket)
-: socket(std::move(inSocket))
-, set(std::make_shared<SocketSet>(
-      1)) // No set given, create a set of size 1 for this peer.
-, bIsConnected(false)
+: Peer(std::make_unique<TcpPeerSocket>(
+      std::move(inSocket),
+      std::make_shared<SocketSet>(
+          1))) // No set given, create a set of size 1 for this peer.
 {
-    set->addSocket(*socket);
-
-    bIsConnected = true;
 }
 
 Peer::Peer(std::unique_ptr<TcpSocket> inSocket,
            const std::shared_ptr<SocketSet>& inSet)
-: socket(std::move(inSocket))
-, set(inSet)
-, bIsConnected(false)
+: Peer(std::make_unique<TcpPeerSocket>(std::move(inSocket), inSet))
 {
-    set->addSocket(*socket);
-
-    bIsConnected = true;
 }
 
-Peer::~Peer()
+Peer::Peer(std::unique_ptr<PeerSocket> inSocket)
+: socket(std::move(inSocket))
+, bIsConnected(false)
+, receiveBuffer(RECEIVE_BUFFER_SIZE)
+, readIndex(0)
+, writeIndex(0)
+, sendBacklog()
+, sendBacklogStart(0)
+, sendBacklogSize(0)
 {
-    set->remSocket(*socket);
+    bIsConnected = true;
 }
 
 bool Peer::isConnected() const
@@ -48,58 +51,88 @@ bool Peer::isConnected() const
 }
 
 NetworkResult Peer::send(const BinaryBufferSharedPtr& buffer)
+{
+    return send(buffer->data(), static_cast<unsigned int>(buffer->size()));
+}
+
+NetworkResult Peer::send(const Uint8* buffer, unsigned int numBytesToSend)
 {
     if (!bIsConnected) {
         return NetworkResult::Disconnected;
     }
 
-    std::size_t messageSize{buffer->size()};
-    if (messageSize > MAX_WIRE_SIZE) {
+    if (numBytesToSend > MAX_WIRE_SIZE) {
         LOG_FATAL("Tried to send too many bytes. Size: %u, MAX_WIRE_SIZE: %u",
-                  messageSize, MAX_WIRE_SIZE);
+                  numBytesToSend, MAX_WIRE_SIZE);
     }
 
-    int bytesSent{socket->send(buffer->data(), static_cast<int>(messageSize))};
-    if (bytesSent < 0) {
-        LOG_FATAL("TCP_Send returned < 0. This should never happen, the socket"
-                  "was likely misused.");
+    // If we have a backlog, try to get it out first so that our bytes stay
+    // in order.
+    if ((sendBacklogSize > 0)
+        && (flushSendBacklog() == NetworkResult::Disconnected)) {
+        return NetworkResult::Disconnected;
     }
 
-    if (static_cast<unsigned int>(bytesSent) < messageSize) {
-        // The peer probably disconnected (could be a different issue).
+    // If there's no backlog, send as many bytes as the OS will accept.
+    unsigned int bytesSent{0};
+    if (sendBacklogSize == 0) {
+        int result{socket->trySend(buffer, static_cast<int>(numBytesToSend))};
+        if (result < 0) {
+            // The peer probably disconnected (could be a different issue).
+            bIsConnected = false;
+            return NetworkResult::Disconnected;
+        }
+        bytesSent = static_cast<unsigned int>(result);
+    }
+
+    // Save any bytes that didn't get sent.
+    if ((bytesSent < numBytesToSend)
+        && !addToSendBacklog((buffer + bytesSent),
+                             (numBytesToSend - bytesSent))) {
+        LOG_INFO("Peer's send backlog is full, disconnecting. Backlog size: "
+                 "%zu",
+                 sendBacklogSize);
         bIsConnected = false;
         return NetworkResult::Disconnected;
     }
-    else {
-        return NetworkResult::Success;
-    }
+
+    return NetworkResult::Success;
 }
 
-NetworkResult Peer::send(const Uint8* buffer, unsigned int numBytesToSend)
+NetworkResult Peer::flushSendBacklog()
 {
     if (!bIsConnected) {
         return NetworkResult::Disconnected;
     }
 
-    if (numBytesToSend > MAX_WIRE_SIZE) {
-        LOG_FATAL("Tried to send too many bytes. Size: %u, MAX_WIRE_SIZE: %u",
-                  numBytesToSend, MAX_WIRE_SIZE);
-    }
+    // Send until the backlog is empty or the OS stops accepting bytes.
+    // Note: The backlog may wrap around the end of the ring, so this may
+    //       take 2 sends.
+    while (sendBacklogSize > 0) {
+        std::size_t contiguousSize{
+            std::min(sendBacklogSize, (sendBacklog.size() - sendBacklogStart))};
+        int result{socket->trySend((sendBacklog.data() + sendBacklogStart),
+                                   static_cast<int>(contiguousSize))};
+        if (result < 0) {
+            // The peer probably disconnected (could be a different issue).
+            bIsConnected = false;
+            return NetworkResult::Disconnected;
+        }
 
-    int bytesSent{socket->send(buffer, numBytesToSend)};
-    if (bytesSent < 0) {
-        LOG_FATAL("TCP_Send returned < 0. This should never happen, the socket"
-                  "was likely misused.");
+        std::size_t bytesSent{static_cast<std::size_t>(result)};
+        sendBacklogStart = (sendBacklogStart + bytesSent) % sendBacklog.size();
+        sendBacklogSize -= bytesSent;
+        if (bytesSent < contiguousSize) {
+            break;
+        }
     }
 
-    if (static_cast<unsigned int>(bytesSent) < numBytesToSend) {
-        // The peer probably disconnected (could be a different issue).
-        bIsConnected = false;
-        return NetworkResult::Disconnected;
-    }
-    else {
-        return NetworkResult::Success;
-    }
+    return NetworkResult::Success;
+}
+
+std::size_t Peer::getSendBacklogSize() const
+{
+    return sendBacklogSize;
 }
 
 NetworkResult Peer::receiveBytes(Uint8* buffer, unsigned int numBytes,
@@ -110,10 +143,10 @@ NetworkResult Peer::receiveBytes(Uint8* buffer, unsigned int numBytes,
     }
     else if (checkSockets) {
         // Poll to see if there's data
-        set->checkSockets(0);
+        socket->checkReady();
     }
 
-    if (!(socket->isReady())) {
+    if ((readIndex == writeIndex) && !(socket->isReady())) {
         return NetworkResult::NoWaitingData;
     }
     else {
@@ -127,16 +160,26 @@ NetworkResult Peer::receiveBytesWait(Uint8* buffer, unsigned int numBytes)
         return NetworkResult::Disconnected;
     }
 
-    // Loop until we've received all of the bytes.
-    int bytesReceived{0};
-    while (static_cast<unsigned int>(bytesReceived) < numBytes) {
+    // Use any bytes that we've already buffered.
+    std::size_t bufferedBytes{
+        std::min((writeIndex - readIndex), static_cast<std::size_t>(numBytes))};
+    const Uint8* bufferStart{receiveBuffer.data() + readIndex};
+    std::copy(bufferStart, (bufferStart + bufferedBytes), buffer);
+    readIndex += bufferedBytes;
+
+    // Loop until we've received the rest of the bytes.
+    unsigned int bytesReceived{static_cast<unsigned int>(bufferedBytes)};
+    while (bytesReceived < numBytes) {
         // Try to receive bytes.
-        int result{socket->receive((buffer + bytesReceived), numBytes)};
+        int result{socket->receive((buffer + bytesReceived),
+                                   (numBytes - bytesReceived))};
         if (result > 0) {
             bytesReceived += result;
         }
-        else {
-            // Disconnected
+        else if (result != RECEIVE_WOULD_BLOCK) {
+            // Disconnected.
+            // Note: If the socket is non-blocking and ran dry, we keep
+            //       waiting instead.
             bIsConnected = false;
             return NetworkResult::Disconnected;
         }
@@ -145,111 +188,212 @@ NetworkResult Peer::receiveBytesWait(Uint8* buffer, unsigned int numBytes)
     return NetworkResult::Success;
 }
 
-ReceiveResult Peer::receiveMessage(Uint8* messageBuffer, bool checkSockets)
+NetworkResult Peer::receiveFrame(Uint8* headerBuffer, unsigned int headerSize,
+                                 unsigned int sizeIndex, Uint8* bodyBuffer,
+                                 unsigned int maxBodySize, Uint16& outBodySize,
+                                 bool checkSockets)
 {
     if (!bIsConnected) {
-        return {NetworkResult::Disconnected};
+        return NetworkResult::Disconnected;
     }
-    else if (checkSockets) {
+
+    // If we already have a full frame buffered, return it.
+    NetworkResult result{readBufferedFrame(headerBuffer, headerSize,
+                                           sizeIndex, bodyBuffer, maxBodySize,
+                                           outBodySize)};
+    if (result != NetworkResult::NoWaitingData) {
+        return result;
+    }
+
+    if (checkSockets) {
         // Poll to see if there's data
-        set->checkSockets(0);
+        socket->checkReady();
     }
 
+    // If there's data waiting, receive it all and try again.
     if (!(socket->isReady())) {
-        return {NetworkResult::NoWaitingData};
+        return NetworkResult::NoWaitingData;
     }
-    else {
-        return receiveMessageWait(messageBuffer);
+
+    result = fillReceiveBuffer();
+    if (result != NetworkResult::Success) {
+        return result;
     }
+
+    return readBufferedFrame(headerBuffer, headerSize, sizeIndex, bodyBuffer,
+                             maxBodySize, outBodySize);
 }
 
-ReceiveResult Peer::receiveMessageWait(Uint8* messageBuffer)
+NetworkResult Peer::receiveFrameWait(Uint8* headerBuffer,
+                                     unsigned int headerSize,
+                                     unsigned int sizeIndex, Uint8* bodyBuffer,
+                                     unsigned int maxBodySize,
+                                     Uint16& outBodySize)
 {
     if (!bIsConnected) {
-        return {NetworkResult::Disconnected};
+        return NetworkResult::Disconnected;
     }
 
-    // Receive the message header.
-    Uint8 headerBuf[MESSAGE_HEADER_SIZE];
-    int result{socket->receive(headerBuf, MESSAGE_HEADER_SIZE)};
-    if (result <= 0) {
-        // Disconnected
-        bIsConnected = false;
-        return {NetworkResult::Disconnected};
-    }
-    else if (result < static_cast<int>(MESSAGE_HEADER_SIZE)) {
-        LOG_FATAL("Didn't receive all size bytes in one chunk."
-                  "Need to add logic for this scenario.");
-    }
+    // Receive until we have a full frame.
+    NetworkResult result{readBufferedFrame(headerBuffer, headerSize,
+                                           sizeIndex, bodyBuffer, maxBodySize,
+                                           outBodySize)};
+    while (result == NetworkResult::NoWaitingData) {
+        if (fillReceiveBuffer() == NetworkResult::Disconnected) {
+            return NetworkResult::Disconnected;
+        }
 
-    // The number of bytes in the upcoming message.
-    Uint16 messageSize{
-        ByteTools::read16(&(headerBuf[MessageHeaderIndex::Size]))};
-    if (messageSize > MAX_WIRE_SIZE) {
-        LOG_FATAL("Tried to receive too large of a message. messageSize: %u, "
-                  "MAX_WIRE_SIZE: %u",
-                  messageSize, MAX_WIRE_SIZE);
+        result = readBufferedFrame(headerBuffer, headerSize, sizeIndex,
+                                   bodyBuffer, maxBodySize, outBodySize);
     }
 
-    result = socket->receive(messageBuffer, messageSize);
-    if (result <= 0) {
-        // Disconnected
-        bIsConnected = false;
-        return {NetworkResult::Disconnected};
+    return result;
+}
+
+ReceiveResult Peer::receiveMessage(Uint8* messageBuffer, bool checkSockets)
+{
+    std::array<Uint8, MESSAGE_HEADER_SIZE> headerBuf{};
+    Uint16 messageSize{0};
+    NetworkResult result{receiveFrame(
+        headerBuf.data(), MESSAGE_HEADER_SIZE, MessageHeaderIndex::Size,
+        messageBuffer, MAX_WIRE_SIZE, messageSize, checkSockets)};
+    if (result != NetworkResult::Success) {
+        return {result};
     }
-    else if (result < messageSize) {
-        LOG_FATAL("Didn't receive all message bytes in one chunk."
-                  "Need to add logic for this scenario.");
+
+    MessageType messageType{static_cast<MessageType>(
+        headerBuf[MessageHeaderIndex::MessageType])};
+    return {NetworkResult::Success, messageType, messageSize};
+}
+
+ReceiveResult Peer::receiveMessageWait(Uint8* messageBuffer)
+{
+    std::array<Uint8, MESSAGE_HEADER_SIZE> headerBuf{};
+    Uint16 messageSize{0};
+    NetworkResult result{receiveFrameWait(
+        headerBuf.data(), MESSAGE_HEADER_SIZE, MessageHeaderIndex::Size,
+        messageBuffer, MAX_WIRE_SIZE, messageSize)};
+    if (result != NetworkResult::Success) {
+        return {result};
     }
 
-    MessageType messageType{
-        static_cast<MessageType>(headerBuf[MessageHeaderIndex::MessageType])};
+    MessageType messageType{static_cast<MessageType>(
+        headerBuf[MessageHeaderIndex::MessageType])};
     return {NetworkResult::Success, messageType, messageSize};
 }
 
 ReceiveResult Peer::receiveMessageWait(BinaryBufferPtr& messageBuffer)
 {
-    if (!bIsConnected) {
-        return {NetworkResult::Disconnected};
+    // Receive into a max-sized buffer, then shrink it to fit.
+    messageBuffer = std::make_unique<BinaryBuffer>(MAX_WIRE_SIZE);
+    ReceiveResult result{receiveMessageWait(messageBuffer->data())};
+    messageBuffer->resize(result.messageSize);
+
+    return result;
+}
+
+NetworkResult Peer::readBufferedFrame(Uint8* headerBuffer,
+                                      unsigned int headerSize,
+                                      unsigned int sizeIndex,
+                                      Uint8* bodyBuffer,
+                                      unsigned int maxBodySize,
+                                      Uint16& outBodySize)
+{
+    // If we don't have a full frame header, wait for more bytes.
+    std::size_t bufferedBytes{writeIndex - readIndex};
+    if (bufferedBytes < headerSize) {
+        return NetworkResult::NoWaitingData;
     }
 
-    // Receive the message header.
-    std::array<Uint8, MESSAGE_HEADER_SIZE> headerBuf{};
-    int result{socket->receive(headerBuf.data(), MESSAGE_HEADER_SIZE)};
-    if (result <= 0) {
-        // Disconnected
+    // The number of bytes in the upcoming body.
+    // Note: The high bit is reserved for flags.
+    const Uint8* frame{receiveBuffer.data() + readIndex};
+    Uint16 bodySize{ByteTools::read16(frame + sizeIndex)};
+    bodySize &= ~(1U << 15);
+    if (bodySize > maxBodySize) {
+        // The peer is misbehaving, or we've lost track of the frames.
+        // Either way, we can't continue.
+        LOG_INFO("Received too large of a frame. Size: %u, max size: %u. "
+                 "Disconnecting.",
+                 bodySize, maxBodySize);
         bIsConnected = false;
-        return {NetworkResult::Disconnected};
-    }
-    else if (result < static_cast<int>(MESSAGE_HEADER_SIZE)) {
-        LOG_FATAL("Didn't receive all size bytes in one chunk."
-                  "Need to add logic for this scenario.");
+        return NetworkResult::Disconnected;
     }
 
-    // The number of bytes in the upcoming message.
-    Uint16 messageSize{
-        ByteTools::read16(&(headerBuf[MessageHeaderIndex::Size]))};
-    if (messageSize > MAX_WIRE_SIZE) {
-        LOG_FATAL("Tried to receive too large of a message. messageSize: %u, "
-                  "MAX_WIRE_SIZE: %u",
-                  messageSize, MAX_WIRE_SIZE);
+    // If we don't have the full body, wait for more bytes.
+    std::size_t frameSize{headerSize + static_cast<std::size_t>(bodySize)};
+    if (bufferedBytes < frameSize) {
+        // If the frame won't fit in our buffer, grow it.
+        if (receiveBuffer.size() < frameSize) {
+            receiveBuffer.resize(frameSize);
+        }
+        return NetworkResult::NoWaitingData;
     }
 
-    messageBuffer = std::make_unique<BinaryBuffer>(messageSize);
-    result = socket->receive(messageBuffer->data(), messageSize);
-    if (result <= 0) {
-        // Disconnected
+    // Copy the frame out and consume it.
+    std::copy(frame, (frame + headerSize), headerBuffer);
+    std::copy((frame + headerSize), (frame + headerSize + bodySize),
+              bodyBuffer);
+    readIndex += (headerSize + bodySize);
+    outBodySize = bodySize;
+
+    return NetworkResult::Success;
+}
+
+NetworkResult Peer::fillReceiveBuffer()
+{
+    // Move any partial frame to the front of the buffer, to make room.
+    if (readIndex > 0) {
+        std::copy((receiveBuffer.data() + readIndex),
+                  (receiveBuffer.data() + writeIndex), receiveBuffer.data());
+        writeIndex -= readIndex;
+        readIndex = 0;
+    }
+
+    // Receive as much as we have room for.
+    // Note: readBufferedFrame() grows our buffer to fit the pending frame,
+    //       so this always has room.
+    int result{socket->receive((receiveBuffer.data() + writeIndex),
+                               static_cast<int>(receiveBuffer.size()
+                                                - writeIndex))};
+    if (result == RECEIVE_WOULD_BLOCK) {
+        // Non-blocking socket with nothing waiting (e.g. a spurious ready).
+        return NetworkResult::NoWaitingData;
+    }
+    else if (result <= 0) {
+        // The peer closed the connection, or a real error occurred.
         bIsConnected = false;
-        return {NetworkResult::Disconnected};
+        return NetworkResult::Disconnected;
     }
-    else if (result < messageSize) {
-        LOG_FATAL("Didn't receive all message bytes in one chunk."
-                  "Need to add logic for this scenario.");
+
+    writeIndex += static_cast<std::size_t>(result);
+    return NetworkResult::Success;
+}
+
+bool Peer::addToSendBacklog(const Uint8* buffer, std::size_t numBytes)
+{
+    if ((sendBacklogSize + numBytes) > MAX_SEND_BACKLOG_SIZE) {
+        return false;
     }
 
-    MessageType messageType{
-        static_cast<MessageType>(headerBuf[MessageHeaderIndex::MessageType])};
-    return {NetworkResult::Success, messageType, messageSize};
+    // If this is our first backlog, allocate the ring.
+    if (sendBacklog.empty()) {
+        sendBacklog.resize(MAX_SEND_BACKLOG_SIZE);
+    }
+
+    // Copy the bytes to the end of the backlog, wrapping around the end of
+    // the ring if necessary.
+    std::size_t endIndex{(sendBacklogStart + sendBacklogSize)
+                         % sendBacklog.size()};
+    std::size_t firstPartSize{
+        std::min(numBytes, (sendBacklog.size() - endIndex))};
+    std::copy(buffer, (buffer + firstPartSize),
+              (sendBacklog.data() + endIndex));
+    std::copy((buffer + firstPartSize), (buffer + numBytes),
+              sendBacklog.data());
+    sendBacklogSize += numBytes;
+
+    return true;
 }
 
 } // End namespace AM
@@ -0,0 +1,140 @@
+#include "StreamCompressor.h"
+#include "Log.h"
+#include "AMAssert.h"
+#include "lz4.h"
+#include "lz4hc.h"
+#include <algorithm>
+
+namespace AM
+{
+StreamCompressor::StreamCompressor(const BinaryBuffer& inDictionary)
+: dictionary{inDictionary}
+, stream{LZ4_createStream()}
+, streamHC{nullptr}
+, highIsActive{false}
+, ringBuffer(RING_BUFFER_SIZE)
+, ringOffset{0}
+, streamIsEmpty{true}
+{
+    if (stream == nullptr) {
+        LOG_FATAL("Failed to create compression stream.");
+    }
+
+    reset();
+}
+
+StreamCompressor::~StreamCompressor()
+{
+    LZ4_freeStream(stream);
+    if (streamHC != nullptr) {
+        LZ4_freeStreamHC(streamHC);
+    }
+}
+
+std::size_t StreamCompressor::compress(const Uint8* sourceBuffer,
+                                       std::size_t sourceLength,
+                                       Uint8* destBuffer,
+                                       std::size_t destLength, Level level)
+{
+    AM_ASSERT((sourceLength <= MAX_BLOCK_SIZE),
+              "Block too large to compress. Size: %zu, Max: %zu",
+              sourceLength, MAX_BLOCK_SIZE);
+
+    // If a max-sized block wouldn't fit at the end of the ring, wrap around.
+    // Note: This must match StreamDecompressor, which doesn't know the block's
+    //       size until after it decompresses it.
+    if ((ringOffset + MAX_BLOCK_SIZE) > RING_BUFFER_SIZE) {
+        ringOffset = 0;
+    }
+
+    // If we're switching to or from LZ4HC, move our history to the other
+    // stream.
+    if ((level == Level::High) != highIsActive) {
+        switchStreams();
+    }
+
+    // Copy the data into the ring, so it stays available as history.
+    Uint8* block{&(ringBuffer[ringOffset])};
+    std::copy(sourceBuffer, (sourceBuffer + sourceLength), block);
+
+    // Compress the data.
+    const char* source{reinterpret_cast<const char*>(block)};
+    char* dest{reinterpret_cast<char*>(destBuffer)};
+    int compressedLength{0};
+    if (highIsActive) {
+        compressedLength = LZ4_compress_HC_continue(
+            streamHC, source, dest, static_cast<int>(sourceLength),
+            static_cast<int>(destLength));
+    }
+    else {
+        int acceleration{(level == Level::Fast) ? FAST_ACCELERATION : 1};
+        compressedLength = LZ4_compress_fast_continue(
+            stream, source, dest, static_cast<int>(sourceLength),
+            static_cast<int>(destLength), acceleration);
+    }
+
+    // Check for errors.
+    if (compressedLength <= 0) {
+        LOG_FATAL("Error during stream compression.");
+    }
+
+    ringOffset += sourceLength;
+    streamIsEmpty = false;
+
+    return static_cast<std::size_t>(compressedLength);
+}
+
+void StreamCompressor::reset()
+{
+    LZ4_initStream(stream, sizeof(*stream));
+    highIsActive = false;
+
+    if (!(dictionary.empty())) {
+        LZ4_loadDict(stream, reinterpret_cast<const char*>(dictionary.data()),
+                     static_cast<int>(dictionary.size()));
+    }
+
+    ringOffset = 0;
+    streamIsEmpty = true;
+}
+
+void StreamCompressor::switchStreams()
+{
+    /* Figure out what history the decompressor is guaranteed to have.
+       Note: The decompressor has at least the batches from the start of the
+             ring up to ringOffset, at the same positions. If we haven't
+             compressed anything yet, it has the dictionary instead. Data from
+             before the last wrap is dropped, so we just lose some history. */
+    const char* history{nullptr};
+    int historySize{0};
+    if (ringOffset > 0) {
+        history = reinterpret_cast<const char*>(ringBuffer.data());
+        historySize = static_cast<int>(ringOffset);
+    }
+    else if (streamIsEmpty && !(dictionary.empty())) {
+        history = reinterpret_cast<const char*>(dictionary.data());
+        historySize = static_cast<int>(dictionary.size());
+    }
+
+    // Load the history into the other stream.
+    // Note: LZ4 only uses the last 64KB, so we don't need to trim it.
+    highIsActive = !highIsActive;
+    if (highIsActive) {
+        // Note: The HC stream is large (~256KB), so we only allocate it if
+        //       it's actually used.
+        if (streamHC == nullptr) {
+            streamHC = LZ4_createStreamHC();
+            if (streamHC == nullptr) {
+                LOG_FATAL("Failed to create compression stream.");
+            }
+        }
+        LZ4_resetStreamHC_fast(streamHC, HIGH_COMPRESSION_LEVEL);
+        LZ4_loadDictHC(streamHC, history, historySize);
+    }
+    else {
+        LZ4_resetStream_fast(stream);
+        LZ4_loadDict(stream, history, historySize);
+    }
+}
+
+} // End namespace AM
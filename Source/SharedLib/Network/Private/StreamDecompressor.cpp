@@ -0,0 +1,64 @@
+#include "StreamDecompressor.h"
+#include "StreamCompressor.h"
+#include "Log.h"
+#include "lz4.h"
+
+namespace AM
+{
+StreamDecompressor::StreamDecompressor(const BinaryBuffer& inDictionary)
+: dictionary{inDictionary}
+, stream{LZ4_createStreamDecode()}
+, ringBuffer(StreamCompressor::RING_BUFFER_SIZE)
+, ringOffset{0}
+{
+    if (stream == nullptr) {
+        LOG_FATAL("Failed to create decompression stream.");
+    }
+
+    reset();
+}
+
+StreamDecompressor::~StreamDecompressor()
+{
+    LZ4_freeStreamDecode(stream);
+}
+
+Uint8* StreamDecompressor::decompress(const Uint8* sourceBuffer,
+                                      std::size_t sourceLength,
+                                      std::size_t& outDecompressedLength)
+{
+    // If a max-sized block wouldn't fit at the end of the ring, wrap around.
+    // Note: This must match StreamCompressor.
+    if ((ringOffset + StreamCompressor::MAX_BLOCK_SIZE)
+        > StreamCompressor::RING_BUFFER_SIZE) {
+        ringOffset = 0;
+    }
+
+    // Decompress the data into the ring.
+    Uint8* block{&(ringBuffer[ringOffset])};
+    int decompressedLength{LZ4_decompress_safe_continue(
+        stream, reinterpret_cast<const char*>(sourceBuffer),
+        reinterpret_cast<char*>(block), static_cast<int>(sourceLength),
+        static_cast<int>(StreamCompressor::MAX_BLOCK_SIZE))};
+
+    // Check for errors.
+    // Note: If the stream gets out of sync, there's no way to recover.
+    if (decompressedLength < 0) {
+        return nullptr;
+    }
+
+    ringOffset += static_cast<std::size_t>(decompressedLength);
+
+    outDecompressedLength = static_cast<std::size_t>(decompressedLength);
+    return block;
+}
+
+void StreamDecompressor::reset()
+{
+    LZ4_setStreamDecode(stream,
+                        reinterpret_cast<const char*>(dictionary.data()),
+                        static_cast<int>(dictionary.size()));
+    ringOffset = 0;
+}
+
+} // End namespace AM
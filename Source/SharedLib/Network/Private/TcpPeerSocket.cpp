@@ -0,0 +1,40 @@
+#include "TcpPeerSocket.h"
+#include "TcpSocket.h"
+#include "SocketSet.h"
+
+namespace AM
+{
+TcpPeerSocket::TcpPeerSocket(std::unique_ptr<TcpSocket> inSocket,
+                             const std::shared_ptr<SocketSet>& inSet)
+: socket{std::move(inSocket)}
+, set{inSet}
+{
+    set->addSocket(*socket);
+}
+
+TcpPeerSocket::~TcpPeerSocket()
+{
+    set->remSocket(*socket);
+}
+
+int TcpPeerSocket::trySend(const Uint8* dataBuffer, int len)
+{
+    return socket->trySend(dataBuffer, len);
+}
+
+int TcpPeerSocket::receive(Uint8* dataBuffer, int maxLen)
+{
+    return socket->receive(dataBuffer, maxLen);
+}
+
+void TcpPeerSocket::checkReady()
+{
+    set->checkSockets(0);
+}
+
+bool TcpPeerSocket::isReady()
+{
+    return socket->isReady();
+}
+
+} // End namespace AM
@@ -1,9 +1,68 @@
 #include "TcpSocket.h"
+#include "NetworkDefs.h"
 #include <SDL_net.h>
 #include "Log.h"
+#if defined(_WIN32)
+#include <winsock2.h>
+#else
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <cerrno>
+#endif
+
+// We reach into SDL_net's private socket struct below, so we can only
+// support versions whose struct we've checked.
+#if !((SDL_NET_MAJOR_VERSION == 2) && (SDL_NET_MINOR_VERSION <= 2))
+#error "SDLNetSocketLayout hasn't been checked against this SDL_net version."
+#endif
 
 namespace AM
 {
+namespace
+{
+#if defined(_WIN32)
+using OSSocket = SOCKET;
+#else
+using OSSocket = int;
+#endif
+
+/**
+ * Mirrors the layout of SDL_net's private TCP socket struct, from
+ * SDLnetTCP.c (2.0.x through 2.2.x):
+ *
+ *   struct _TCPsocket {
+ *       int ready;
+ *       SOCKET channel;
+ *       IPaddress remoteAddress;
+ *       IPaddress localAddress;
+ *       int sflag;
+ *   };
+ *
+ * SDL_net doesn't support non-blocking sends or receives, so we use this to
+ * reach the OS socket and do them ourselves.
+ *
+ * If SDL_net is updated, re-check this against its struct and update the
+ * version check above.
+ */
+struct SDLNetSocketLayout {
+    int ready;
+    OSSocket channel;
+    IPaddress remoteAddress;
+    IPaddress localAddress;
+    int sflag;
+};
+
+SDLNetSocketLayout* getSDLNetSocket(TCPsocket socket)
+{
+    return reinterpret_cast<SDLNetSocketLayout*>(socket);
+}
+
+OSSocket getOSSocket(TCPsocket socket)
+{
+    return getSDLNetSocket(socket)->channel;
+}
+} // namespace
+
 TcpSocket::TcpSocket(Uint16 inPort)
 : ip("")
 , port(inPort)
@@ -61,9 +120,81 @@ int TcpSocket::send(const void* dataBuffer, int len)
     return SDLNet_TCP_Send(socket, dataBuffer, len);
 }
 
+int TcpSocket::trySend(const void* dataBuffer, int len)
+{
+#if defined(_WIN32)
+    int bytesSent{::send(getOSSocket(socket),
+                         static_cast<const char*>(dataBuffer), len, 0)};
+    if (bytesSent == SOCKET_ERROR) {
+        return (WSAGetLastError() == WSAEWOULDBLOCK) ? 0 : -1;
+    }
+#else
+    // Note: SDLNet_Init() ignores SIGPIPE, but we also avoid it here when
+    //       the platform allows.
+#if defined(MSG_NOSIGNAL)
+    int flags{MSG_NOSIGNAL};
+#else
+    int flags{0};
+#endif
+    int bytesSent{static_cast<int>(::send(getOSSocket(socket), dataBuffer,
+                                          static_cast<std::size_t>(len),
+                                          flags))};
+    if (bytesSent < 0) {
+        bool wouldBlock{(errno == EAGAIN) || (errno == EWOULDBLOCK)
+                        || (errno == EINTR)};
+        return wouldBlock ? 0 : -1;
+    }
+#endif
+
+    return bytesSent;
+}
+
 int TcpSocket::receive(void* dataBuffer, int maxLen)
 {
-    return SDLNet_TCP_Recv(socket, dataBuffer, maxLen);
+    // Note: We receive from the OS socket ourselves so that we can tell a
+    //       non-blocking socket running dry apart from a real error.
+    SDLNetSocketLayout* sdlSocket{getSDLNetSocket(socket)};
+    sdlSocket->ready = 0;
+
+#if defined(_WIN32)
+    int bytesReceived{::recv(sdlSocket->channel,
+                             static_cast<char*>(dataBuffer), maxLen, 0)};
+    if (bytesReceived == SOCKET_ERROR) {
+        return (WSAGetLastError() == WSAEWOULDBLOCK) ? RECEIVE_WOULD_BLOCK
+                                                     : -1;
+    }
+#else
+    int bytesReceived{-1};
+    do {
+        bytesReceived = static_cast<int>(
+            ::recv(sdlSocket->channel, dataBuffer,
+                   static_cast<std::size_t>(maxLen), 0));
+    } while ((bytesReceived < 0) && (errno == EINTR));
+
+    if (bytesReceived < 0) {
+        bool wouldBlock{(errno == EAGAIN) || (errno == EWOULDBLOCK)};
+        return wouldBlock ? RECEIVE_WOULD_BLOCK : -1;
+    }
+#endif
+
+    return bytesReceived;
+}
+
+void TcpSocket::setNonBlocking()
+{
+#if defined(_WIN32)
+    u_long mode{1};
+    if (ioctlsocket(getOSSocket(socket), FIONBIO, &mode) != 0) {
+        LOG_FATAL("Failed to make socket non-blocking.");
+    }
+#else
+    OSSocket osSocket{getOSSocket(socket)};
+    int flags{fcntl(osSocket, F_GETFL, 0)};
+    if ((flags == -1)
+        || (fcntl(osSocket, F_SETFL, (flags | O_NONBLOCK)) == -1)) {
+        LOG_FATAL("Failed to make socket non-blocking.");
+    }
+#endif
 }
 
 bool TcpSocket::isReady()
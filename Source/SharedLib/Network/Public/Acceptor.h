@@ -1,6 +1,7 @@
 #ifndef ACCEPTOR_H_
 #define ACCEPTOR_H_
 
+#include "AcceptorBase.h"
 #include "Peer.h"
 #include "SocketSet.h"
 #include "TcpSocket.h"
@@ -11,18 +12,23 @@
 namespace AM
 {
 /**
- * This class owns a listener socket and can accept new Peers.
-
+ * This class owns a listener socket and can accept new TCP Peers.
+ *
  * TODO: Peer/Acceptor seem like a redundant layer and should probably be
  *       removed. The Client/Server classes and the SocketSet/TcpSocket
  *       classes should be able to cleanly handle all the responsibilities.
  */
-class Acceptor
+class Acceptor : public AcceptorBase
 {
 public:
-    Acceptor(Uint16 port, const std::shared_ptr<SocketSet>& inClientSet);
+    /**
+     * @param port  The port to listen on.
+     * @param maxPeers  The max number of accepted peers that can be
+     *                  connected at once.
+     */
+    Acceptor(Uint16 port, int maxPeers);
 
-    ~Acceptor();
+    ~Acceptor() override;
 
     /**
      * If a peer is waiting to connect, opens a connection to the peer and
@@ -30,17 +36,14 @@ public:
      *
      * @return A pointer to a new peer, if one was waiting. Else, nullptr.
      */
-    std::unique_ptr<Peer> accept();
+    std::unique_ptr<Peer> accept() override;
+
+    bool reject() override;
 
     /**
-     * If a peer is waiting to connect, opens a connection to the peer and
-     * immediately closes it.
-     *
-     * Use this to close connections when you're at maximum capacity.
-     *
-     * @return true if a peer was waiting, else false.
+     * Checks the whole clientSet for activity at once.
      */
-    bool reject();
+    void checkPeerSockets() override;
 
 private:
     /** Our listener socket. */
@@ -49,7 +52,8 @@ private:
     /** The set that we use to check if our socket has activity. */
     SocketSet listenerSet;
 
-    /** A pointer to the set to add accepted clients to. */
+    /** The set that we add accepted clients to. Lets us do select()-like
+        behavior, checking every client with a single call. */
     std::shared_ptr<SocketSet> clientSet;
 };
 
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <memory>
+
+namespace AM
+{
+class Peer;
+
+/**
+ * Accepts new Peers, independent of the transport that they use.
+ *
+ * Acceptor accepts TCP connections. LoopbackAcceptor accepts in-process
+ * connections.
+ */
+class AcceptorBase
+{
+public:
+    virtual ~AcceptorBase() = default;
+
+    /**
+     * If a peer is waiting to connect, opens a connection to the peer.
+     *
+     * @return A pointer to a new peer, if one was waiting. Else, nullptr.
+     */
+    virtual std::unique_ptr<Peer> accept() = 0;
+
+    /**
+     * If a peer is waiting to connect, opens a connection to the peer and
+     * immediately closes it.
+     *
+     * Use this to close connections when you're at maximum capacity.
+     *
+     * @return true if a peer was waiting, else false.
+     */
+    virtual bool reject() = 0;
+
+    /**
+     * Checks every peer that this acceptor has accepted for activity,
+     * updating their sockets' isReady().
+     *
+     * Call this before receiving from the peers with checkSockets == false.
+     */
+    virtual void checkPeerSockets() = 0;
+};
+
+} // End namespace AM
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "BinaryBuffer.h"
+#include <string>
+
+namespace AM
+{
+/**
+ * Provides the optional dictionary that's used to prime our batch
+ * compression streams.
+ *
+ * The dictionary is loaded from CompressionDictionary.bin, placed in the same
+ * directory as the application executable. If the file isn't present, no
+ * dictionary is used.
+ *
+ * LZ4 dictionaries are just raw content, so any recording of representative
+ * traffic (e.g. MovementUpdate and EntityInit batches) will work. For best
+ * results, train one offline using "zstd --train".
+ *
+ * Note: The server and client must use the same dictionary, or decompression
+ *       will fail.
+ */
+class CompressionDictionary
+{
+public:
+    /** The max dictionary size that LZ4 will use. Larger files are trimmed
+        to their last MAX_SIZE bytes. */
+    static constexpr std::size_t MAX_SIZE{64 * 1024};
+
+    /**
+     * Returns the dictionary, loading it the first time this is called.
+     * If no dictionary file is present, the returned buffer will be empty.
+     *
+     * Note: The returned buffer stays valid for the life of the program, as
+     *       LZ4 requires.
+     */
+    static const BinaryBuffer& get();
+
+    /**
+     * Reads the dictionary file at the given path into outDictionary,
+     * trimming it to MAX_SIZE the same way that get() does.
+     *
+     * Useful for tools that want to try out other dictionaries.
+     *
+     * @return false if the file couldn't be opened, else true.
+     */
+    static bool loadFromFile(const std::string& filePath,
+                             BinaryBuffer& outDictionary);
+
+private:
+    /**
+     * Loads the dictionary file, if present.
+     */
+    static BinaryBuffer load();
+};
+
+} // End namespace AM
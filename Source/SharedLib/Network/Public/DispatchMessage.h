@@ -2,6 +2,7 @@
 
 #include "Deserialize.h"
 #include "QueuedEvents.h"
+#include "MessagePool.h"
 #include <SDL_stdinc.h>
 #include <memory>
 
@@ -50,4 +51,25 @@ static void dispatchMessageSharedPtr(Uint8* messageBuffer,
     dispatcher.push<std::shared_ptr<const T>>(message);
 }
 
+/**
+ * Similar to dispatchMessageSharedPtr(), but deserializes into a message
+ * from the given pool instead of allocating a new one.
+ *
+ * The event can be received in a system using
+ * EventQueue<std::shared_ptr<const T>>.
+ */
+template<typename T>
+static void dispatchMessagePooled(Uint8* messageBuffer,
+                                  unsigned int messageSize,
+                                  MessagePool<T>& messagePool,
+                                  EventDispatcher& dispatcher)
+{
+    // Deserialize the message.
+    std::shared_ptr<T> message{messagePool.acquire()};
+    Deserialize::fromBuffer(messageBuffer, messageSize, *message);
+
+    // Push the message into any subscribed queues.
+    dispatcher.push<std::shared_ptr<const T>>(message);
+}
+
 } // End namespace AM
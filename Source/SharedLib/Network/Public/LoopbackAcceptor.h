@@ -0,0 +1,66 @@
+#pragma once
+
+#include "AcceptorBase.h"
+#include "LoopbackSocket.h"
+#include <memory>
+#include <queue>
+#include <mutex>
+#include <cstddef>
+
+namespace AM
+{
+class Peer;
+
+/**
+ * Accepts in-process connections, made through connect().
+ *
+ * Lets us drive a server with synthetic clients from the same process
+ * (e.g. in a benchmark), without any kernel networking.
+ */
+class LoopbackAcceptor : public AcceptorBase
+{
+public:
+    /**
+     * @param inBufferSize  The number of bytes that each direction of each
+     *                      connection can hold.
+     */
+    LoopbackAcceptor(
+        std::size_t inBufferSize = LoopbackSocket::DEFAULT_BUFFER_SIZE);
+
+    /**
+     * Opens a connection. The other side of the connection will be returned
+     * by a later accept() call.
+     *
+     * Thread-safe, may be called while another thread is accepting.
+     *
+     * @return The connecting side of the new connection.
+     */
+    std::unique_ptr<Peer> connect();
+
+    std::unique_ptr<Peer> accept() override;
+
+    bool reject() override;
+
+    /**
+     * No-op, loopback sockets are always up to date.
+     */
+    void checkPeerSockets() override;
+
+private:
+    /**
+     * If a connection is waiting to be accepted, returns its socket.
+     * Else, returns nullptr.
+     */
+    std::unique_ptr<LoopbackSocket> popPendingSocket();
+
+    /** The number of bytes that each direction of each connection can
+        hold. */
+    std::size_t bufferSize;
+
+    /** The accepting side of each connection that's waiting to be
+        accepted. */
+    std::queue<std::unique_ptr<LoopbackSocket>> pendingSockets;
+    std::mutex pendingMutex;
+};
+
+} // End namespace AM
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "PeerSocket.h"
+#include "BinaryBuffer.h"
+#include <memory>
+#include <utility>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+
+namespace AM
+{
+/**
+ * An in-process PeerSocket. Bytes sent on one socket of a pair are received
+ * on the other, with no kernel networking involved.
+ *
+ * Each direction has a fixed-size buffer, so a slow receiver causes partial
+ * sends the same way a full OS send buffer would.
+ *
+ * Thread-safe: one thread may send while another receives.
+ */
+class LoopbackSocket : public PeerSocket
+{
+public:
+    /** The default number of bytes that each direction can hold. Roughly
+        matches a typical OS socket buffer. */
+    static constexpr std::size_t DEFAULT_BUFFER_SIZE{64 * 1024};
+
+    /**
+     * Creates a pair of connected sockets.
+     *
+     * @param bufferSize  The number of bytes that each direction can hold.
+     */
+    static std::pair<std::unique_ptr<LoopbackSocket>,
+                     std::unique_ptr<LoopbackSocket>>
+        createPair(std::size_t bufferSize = DEFAULT_BUFFER_SIZE);
+
+    /**
+     * Closes both directions. The other socket will see a disconnect once
+     * it has received any bytes that were already sent.
+     */
+    ~LoopbackSocket() override;
+
+    int trySend(const Uint8* dataBuffer, int len) override;
+
+    int receive(Uint8* dataBuffer, int maxLen) override;
+
+    /**
+     * No-op, our readiness is always up to date.
+     */
+    void checkReady() override;
+
+    bool isReady() override;
+
+private:
+    /**
+     * A single direction of a connection.
+     */
+    struct Pipe {
+        Pipe(std::size_t bufferSize);
+
+        std::mutex mutex;
+
+        /** Notified when bytes are written or the pipe is closed. */
+        std::condition_variable condVar;
+
+        /** A ring buffer that holds the bytes waiting to be received. */
+        BinaryBuffer buffer;
+
+        /** The index of the first unreceived byte in buffer. */
+        std::size_t readIndex;
+
+        /** The number of unreceived bytes in buffer. */
+        std::size_t size;
+
+        /** If true, one of the sockets was destroyed. */
+        bool isClosed;
+    };
+
+    LoopbackSocket(const std::shared_ptr<Pipe>& inSendPipe,
+                   const std::shared_ptr<Pipe>& inReceivePipe);
+
+    /**
+     * Closes the given pipe and wakes anyone waiting on it.
+     */
+    static void close(Pipe& pipe);
+
+    /** The pipe that we send bytes into. */
+    std::shared_ptr<Pipe> sendPipe;
+
+    /** The pipe that we receive bytes from. */
+    std::shared_ptr<Pipe> receivePipe;
+};
+
+} // End namespace AM
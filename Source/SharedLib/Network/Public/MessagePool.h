@@ -0,0 +1,92 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <cstddef>
+
+namespace AM
+{
+
+/**
+ * A pool of reusable message objects, for messages that are received often
+ * and pushed to the simulation as std::shared_ptr<const T>.
+ *
+ * The pool keeps a reference to every message that it hands out. When the
+ * pool's reference is the only one left (i.e. every system that received the
+ * message has released it), the message is recycled. Since recycled messages
+ * keep their internal vectors' capacity, decoding into them doesn't allocate
+ * once the pool has warmed up.
+ *
+ * Only the thread that calls acquire() may use the pool. The messages that
+ * it hands out may be released from any thread.
+ */
+template<typename T>
+class MessagePool
+{
+public:
+    /** The default maximum number of messages that we'll keep. If they're
+        all in use, acquire() falls back to allocating one-off messages. */
+    static constexpr std::size_t DEFAULT_MAX_POOL_SIZE = 256;
+
+    /** The maximum number of messages that acquire() will check before
+        giving up and allocating. Keeps acquire() cheap when most messages
+        are in use. */
+    static constexpr std::size_t MAX_SEARCH_LENGTH = 16;
+
+    MessagePool(std::size_t inMaxPoolSize = DEFAULT_MAX_POOL_SIZE)
+    : maxPoolSize{inMaxPoolSize}
+    , messages{}
+    , nextIndex{0}
+    {
+    }
+
+    /**
+     * Returns a message that nobody else holds a reference to.
+     *
+     * Note: A recycled message still holds its old contents. The caller must
+     *       overwrite all of them, e.g. by deserializing into it.
+     */
+    std::shared_ptr<T> acquire()
+    {
+        // Look for a free message, starting after the last one we handed out.
+        // Since messages tend to be released in the order they were
+        // acquired, this usually finds one right away.
+        std::size_t messageCount{messages.size()};
+        std::size_t searchLength{std::min(messageCount, MAX_SEARCH_LENGTH)};
+        for (std::size_t i = 0; i < searchLength; ++i) {
+            std::size_t index{(nextIndex + i) % messageCount};
+            if (messages[index].use_count() == 1) {
+                // Sync with the release of the last thread that used it.
+                std::atomic_thread_fence(std::memory_order_acquire);
+
+                nextIndex = ((index + 1) % messageCount);
+                return messages[index];
+            }
+        }
+
+        // No free messages were found. Grow the pool if there's room.
+        // Note: We insert at nextIndex so that this message is the last to be
+        //       searched, since it'll be in use the longest.
+        std::shared_ptr<T> message{std::make_shared<T>()};
+        if (messageCount < maxPoolSize) {
+            messages.insert((messages.begin() + nextIndex), message);
+            nextIndex = ((nextIndex + 1) % messages.size());
+        }
+
+        return message;
+    }
+
+private:
+    /** The maximum number of messages that we'll keep. */
+    std::size_t maxPoolSize;
+
+    /** All of the messages that this pool owns. */
+    std::vector<std::shared_ptr<T>> messages;
+
+    /** The index in messages to start the next search at. */
+    std::size_t nextIndex;
+};
+
+} // End namespace AM
@@ -23,6 +23,10 @@ namespace AM
     reserved. */
 static constexpr unsigned int MAX_BATCH_SIZE{2 << 14};
 
+/** Returned by a socket's receive() if it's non-blocking and no bytes were
+    available. */
+static constexpr int RECEIVE_WOULD_BLOCK{-2};
+
 //--------------------------------------------------------------------------
 // Typedefs
 //--------------------------------------------------------------------------
@@ -62,13 +66,19 @@ static constexpr unsigned int SERVER_HEADER_SIZE
 
 /**
  * Used for indexing into the parts of a client header.
+ *
+ * The client sends a header, followed by a (potentially compressed) batch of
+ * messages.
  */
 struct ClientHeaderIndex {
     enum Index : Uint8 {
         /** Uint8, the iteration of tick offset adjustment that we're on. */
         AdjustmentIteration = 0,
+        /** Uint16. The low 15 bits hold the size of the message batch in
+            bytes. The high bit is set if the batch is compressed. */
+        BatchSize = 1,
         /** The start of the first message header if one is present. */
-        MessageHeaderStart = 1
+        MessageHeaderStart = 3
     };
 };
 /** The size of a client header in bytes. */
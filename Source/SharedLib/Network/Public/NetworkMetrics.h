@@ -0,0 +1,73 @@
+#pragma once
+
+#include "MessageType.h"
+#include "Histogram.h"
+#include <SDL_stdinc.h>
+#include <atomic>
+#include <array>
+#include <cstddef>
+
+namespace AM
+{
+/**
+ * Cumulative message counts and sizes for a single MessageType.
+ */
+struct MessageTypeMetrics {
+    Uint64 messagesSent{0};
+    Uint64 bytesSent{0};
+    Uint64 messagesReceived{0};
+    Uint64 bytesReceived{0};
+};
+
+/**
+ * Tracks message counts and sizes per MessageType, and the latency of
+ * outgoing messages.
+ *
+ * Unlike NetworkStats, these values are cumulative and never reset. This
+ * lets multiple consumers (e.g. a metrics exporter and a profiler) read them
+ * without stepping on each other. Consumers can take the difference between
+ * two reads to get a rate.
+ *
+ * Note: This is a static class for the same reasons as NetworkStats.
+ */
+class NetworkMetrics
+{
+public:
+    /** The number of values that a MessageType can hold. */
+    static constexpr std::size_t MESSAGE_TYPE_COUNT{256};
+
+    /**
+     * Returns the current values for the given message type.
+     */
+    static MessageTypeMetrics getMessageTypeMetrics(MessageType messageType);
+
+    /**
+     * Returns the send latency of every message that we've sent, in
+     * microseconds.
+     */
+    static Histogram::Snapshot getSendLatencySnapshot();
+
+    // Mutators
+    /** Records that a message of the given type and size was sent. */
+    static void recordMessageSent(MessageType messageType, std::size_t bytes);
+    /** Records that a message of the given type and size was received. */
+    static void recordMessageReceived(MessageType messageType,
+                                      std::size_t bytes);
+    /** Records the time, in microseconds, between a message being queued
+        and it being added to an outgoing batch. */
+    static void recordSendLatency(Uint64 latencyUs);
+
+private:
+    /** See MessageTypeMetrics for descriptions of these.
+        Indexed by MessageType. */
+    static std::array<std::atomic<Uint64>, MESSAGE_TYPE_COUNT> messagesSent;
+    static std::array<std::atomic<Uint64>, MESSAGE_TYPE_COUNT> bytesSent;
+    static std::array<std::atomic<Uint64>, MESSAGE_TYPE_COUNT>
+        messagesReceived;
+    static std::array<std::atomic<Uint64>, MESSAGE_TYPE_COUNT> bytesReceived;
+
+    /** See getSendLatencySnapshot(). */
+    static Histogram sendLatencyUs;
+};
+
+} // End namespace AM
@@ -1,13 +1,40 @@
 #pragma once
 
+#include "StreamCompressor.h"
 #include <atomic>
+#include <array>
 
 namespace AM
 {
+/** The number of compression levels that we track stats for. */
+static constexpr std::size_t COMPRESSION_LEVEL_COUNT{
+    static_cast<std::size_t>(StreamCompressor::Level::Count)};
+
 /** Used to pass data out to the consumer. */
 struct NetStatsDump {
     unsigned int bytesSent = 0;
     unsigned int bytesReceived = 0;
+
+    /** The number of batches that were compressed at each level. */
+    std::array<unsigned int, COMPRESSION_LEVEL_COUNT> compressedBatches{};
+    /** The total size of the compressed batches, before compression. */
+    unsigned int bytesBeforeCompression = 0;
+    /** The total size of the compressed batches, after compression. */
+    unsigned int bytesAfterCompression = 0;
+
+    /** The number of batches that weren't compressed because they were
+        too small. */
+    unsigned int skippedSmallBatches = 0;
+    /** The number of batches that weren't compressed because similar batches
+        haven't been compressing well. */
+    unsigned int skippedLowGainBatches = 0;
+
+    /** The largest number of bytes that were waiting in a single peer's send
+        backlog. */
+    std::size_t maxSendBacklog = 0;
+    /** The number of times that a peer had a non-empty send backlog after
+        sending. */
+    unsigned int backloggedSends = 0;
 };
 
 /**
@@ -35,6 +62,16 @@ public:
     static void recordBytesSent(unsigned int inBytesSent);
     /** Adds inBytesReceived to bytesReceived. */
     static void recordBytesReceived(unsigned int inBytesReceived);
+    /** Records that a batch was compressed. */
+    static void recordCompressedBatch(StreamCompressor::Level level,
+                                      unsigned int sizeBefore,
+                                      unsigned int sizeAfter);
+    /** Records that a batch was too small to compress. */
+    static void recordSkippedSmallBatch();
+    /** Records that a batch wasn't compressed due to a low expected gain. */
+    static void recordSkippedLowGainBatch();
+    /** Records the size of a peer's send backlog after sending. */
+    static void recordSendBacklog(std::size_t backlogSize);
 
 private:
     /** The number of bytes that have been sent since the last dump. */
@@ -42,6 +79,16 @@ private:
 
     /** The number of bytes that have been received since the last dump. */
     static std::atomic<unsigned int> bytesReceived;
+
+    /** See NetStatsDump for descriptions of these. */
+    static std::array<std::atomic<unsigned int>, COMPRESSION_LEVEL_COUNT>
+        compressedBatches;
+    static std::atomic<unsigned int> bytesBeforeCompression;
+    static std::atomic<unsigned int> bytesAfterCompression;
+    static std::atomic<unsigned int> skippedSmallBatches;
+    static std::atomic<unsigned int> skippedLowGainBatches;
+    static std::atomic<std::size_t> maxSendBacklog;
+    static std::atomic<unsigned int> backloggedSends;
 };
 
 } // End namespace AM
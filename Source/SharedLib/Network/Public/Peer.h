@@ -1,6 +1,7 @@
 #pragma once
 
 #include "NetworkDefs.h"
+#include "PeerSocket.h"
 #include "SocketSet.h"
 #include "TcpSocket.h"
 #include <memory>
@@ -11,6 +12,10 @@ namespace AM
 {
 /**
  * Represents a network peer for communication.
+ *
+ * Bytes are sent and received through a PeerSocket, so a peer may be
+ * connected over TCP or in-process (see LoopbackSocket).
+ *
  * TODO: Peer/acceptor seem like a redundant layer and should probably be
  * removed. A Client/Server class and the SocketSet/TcpSocket classes should be
  * able to cleanly handle all the responsibilities.
@@ -25,6 +30,17 @@ public:
                   and use the high bit to indicate compression. */
     static constexpr unsigned int MAX_WIRE_SIZE = 1450;
 
+    /** The initial size of our receive buffer. Must fit at least 1 max-size
+        message frame. Larger sizes let us receive more messages per syscall.
+        If a larger frame arrives (e.g. a server batch), the buffer grows to
+        fit it. */
+    static constexpr std::size_t RECEIVE_BUFFER_SIZE{MAX_WIRE_SIZE * 4};
+
+    /** The max number of bytes that can be waiting to be sent. If a send
+        would exceed this, we consider the peer unable to keep up and
+        disconnect them. */
+    static constexpr std::size_t MAX_SEND_BACKLOG_SIZE{256 * 1024};
+
     /**
      * Initiates a TCP connection that the other side can then accept.
      * (e.g. the client connecting to the server)
@@ -48,9 +64,9 @@ public:
          const std::shared_ptr<SocketSet>& inSet);
 
     /**
-     * Removes the socket from the set.
+     * Constructor for when you have a socket of any transport.
      */
-    ~Peer();
+    Peer(std::unique_ptr<PeerSocket> inSocket);
 
     /**
      * Returns false if the client was at some point found to be disconnected,
@@ -61,31 +77,52 @@ public:
     /**
      * Sends the data in the given buffer to this Peer.
      *
+     * Any bytes that don't fit in the OS's send buffer are added to our send
+     * backlog, to be sent by a later send() or flushSendBacklog() call.
+     * If the socket is non-blocking, this never waits.
+     *
      * Will error if the buffer size is larger than MAX_WIRE_SIZE.
      *
-     * @return Disconnected if the peer was found to be disconnected, else
-     * Success.
+     * @return Disconnected if the peer was found to be disconnected or the
+     *         backlog would exceed MAX_SEND_BACKLOG_SIZE, else Success.
      */
     NetworkResult send(const BinaryBufferSharedPtr& buffer);
 
     /**
      * Sends the data in the given buffer to this Peer.
+     * See send() above.
      *
      * Will error if numBytes is larger than MAX_WIRE_SIZE.
      *
-     * @return Disconnected if the peer was found to be disconnected, else
-     * Success.
+     * @return Disconnected if the peer was found to be disconnected or the
+     *         backlog would exceed MAX_SEND_BACKLOG_SIZE, else Success.
      */
     NetworkResult send(const Uint8* buffer, unsigned int numBytesToSend);
 
+    /**
+     * Sends as much of our send backlog as the OS will accept.
+     *
+     * @return Disconnected if the peer was found to be disconnected, else
+     *         Success.
+     */
+    NetworkResult flushSendBacklog();
+
+    /**
+     * Returns the number of bytes that are waiting to be sent.
+     */
+    std::size_t getSendBacklogSize() const;
+
     /**
      * Tries to receive bytes over the network.
      *
+     * Note: Any bytes that were already buffered by a receiveMessage() call
+     *       are returned first.
+     *
      * @param buffer  The buffer to fill with data, if any was received.
      * @param numBytes  The number of bytes to receive.
-     * @param checkSockets  If true, will call checkSockets() before checking
-     *                      socketReady(). Set this to false if you're going to
-     *                      call checkSockets() yourself.
+     * @param checkSockets  If true, will check the socket for activity before
+     *                      checking isReady(). Set this to false if you're
+     *                      going to check it yourself.
      * @return An appropriate NetworkResult. If return == Success,
      *         buffer contains the received data.
      */
@@ -104,13 +141,54 @@ public:
     NetworkResult receiveBytesWait(Uint8* buffer, unsigned int numBytes);
 
     /**
-     * Tries to receive a {size, message} pair over the network.
+     * Tries to receive a {header, body} frame over the network.
+     *
+     * If a full frame was already buffered, returns it without touching the
+     * socket. Otherwise, if the socket is ready, receives as many bytes as
+     * are available in one call. Any partial frame is kept for the next call.
+     *
+     * @param headerBuffer  The buffer to fill with the frame's header.
+     * @param headerSize  The size of the frame's header.
+     * @param sizeIndex  The index of the header's Uint16 body size field.
+     *                   The field's high bit is treated as a flag, and is
+     *                   ignored when reading the size.
+     * @param bodyBuffer  The buffer to fill with the frame's body. Must be at
+     *                    least maxBodySize bytes.
+     * @param maxBodySize  The largest body that the peer may send. If a
+     *                     larger one is received, we disconnect.
+     * @param outBodySize  If a frame was received, set to its body size.
+     * @param checkSockets  If true, will check the socket for activity before
+     *                      checking isReady(). Set this to false if you're
+     *                      going to check it yourself.
+     * @return An appropriate NetworkResult. If Success, headerBuffer and
+     *         bodyBuffer contain the received frame.
+     */
+    NetworkResult receiveFrame(Uint8* headerBuffer, unsigned int headerSize,
+                               unsigned int sizeIndex, Uint8* bodyBuffer,
+                               unsigned int maxBodySize, Uint16& outBodySize,
+                               bool checkSockets);
+
+    /**
+     * Receives a {header, body} frame, waiting if it's not yet available.
+     * See receiveFrame() for parameter descriptions.
+     *
+     * @return Success if a frame was received, else Disconnected.
+     */
+    NetworkResult receiveFrameWait(Uint8* headerBuffer,
+                                   unsigned int headerSize,
+                                   unsigned int sizeIndex, Uint8* bodyBuffer,
+                                   unsigned int maxBodySize,
+                                   Uint16& outBodySize);
+
+    /**
+     * Tries to receive a {header, message} frame over the network.
+     * See receiveFrame().
      *
      * @param messageBuffer  The buffer to fill with a message, if one was
      * received.
-     * @param checkSockets  If true, will call checkSockets() before checking
-     *                      socketReady(). Set this to false if you're going to
-     * call checkSockets() yourself.
+     * @param checkSockets  If true, will check the socket for activity before
+     *                      checking isReady(). Set this to false if you're
+     *                      going to check it yourself.
      * @return An appropriate ReceiveResult. If return.networkResult == Success,
      *         messageBuffer contains the received message.
      */
@@ -138,18 +216,65 @@ public:
     ReceiveResult receiveMessageWait(BinaryBufferPtr& messageBuffer);
 
 private:
+    /**
+     * If receiveBuffer contains a full frame, copies it out and removes it
+     * from the buffer. See receiveFrame() for parameter descriptions.
+     *
+     * @return Success if a frame was copied, NoWaitingData if the buffer
+     *         doesn't hold a full frame, or Disconnected if the frame was
+     *         malformed.
+     */
+    NetworkResult readBufferedFrame(Uint8* headerBuffer,
+                                    unsigned int headerSize,
+                                    unsigned int sizeIndex, Uint8* bodyBuffer,
+                                    unsigned int maxBodySize,
+                                    Uint16& outBodySize);
+
+    /**
+     * Receives as many bytes as are available (up to the free space in
+     * receiveBuffer) in a single call. If the socket is blocking, waits
+     * until at least 1 is.
+     *
+     * @return Success if bytes were received, NoWaitingData if the socket is
+     *         non-blocking and had none, or Disconnected if the peer closed
+     *         the connection or an error occurred.
+     */
+    NetworkResult fillReceiveBuffer();
+
+    /**
+     * Copies the given bytes to the end of sendBacklog.
+     *
+     * @return false if the bytes don't fit, else true.
+     */
+    bool addToSendBacklog(const Uint8* buffer, std::size_t numBytes);
+
     /** The socket for this peer. Must be a unique_ptr so we can move without
         copying. */
-    std::unique_ptr<TcpSocket> socket;
-
-    /** The set that this peer belongs to.
-        Must be a shared_ptr since we may or may not allocate it ourselves
-        depending on which constructor is called. */
-    std::shared_ptr<SocketSet> set;
+    std::unique_ptr<PeerSocket> socket;
 
     /** Tracks whether or not this peer is connected. Is set to false if a
         disconnect was detected when trying to send or receive. */
     std::atomic<bool> bIsConnected;
+
+    /** Holds received bytes that haven't been consumed yet. Partial frames
+        wait here until the rest of their bytes arrive. */
+    BinaryBuffer receiveBuffer;
+
+    /** The index of the first unconsumed byte in receiveBuffer. */
+    std::size_t readIndex;
+
+    /** The index after the last received byte in receiveBuffer. */
+    std::size_t writeIndex;
+
+    /** A ring buffer that holds bytes that the OS wasn't ready to accept.
+        Allocated the first time it's needed, since most peers keep up. */
+    BinaryBuffer sendBacklog;
+
+    /** The index of the first unsent byte in sendBacklog. */
+    std::size_t sendBacklogStart;
+
+    /** The number of unsent bytes in sendBacklog. */
+    std::size_t sendBacklogSize;
 };
 
 } /* End namespace AM */
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "NetworkDefs.h"
+#include <SDL_stdinc.h>
+
+namespace AM
+{
+/**
+ * The transport that a Peer sends and receives bytes through.
+ *
+ * TcpPeerSocket sends over the network. LoopbackSocket stays in-process,
+ * which lets us drive the server with synthetic clients (e.g. for
+ * benchmarking) without any kernel networking.
+ */
+class PeerSocket
+{
+public:
+    virtual ~PeerSocket() = default;
+
+    /**
+     * Sends up to len bytes from the given dataBuffer, without waiting for
+     * room in the transport's send buffer.
+     *
+     * @return The number of bytes sent, which may be less than len (including
+     *         0) if the send buffer is full. -1 if an error occurred, such as
+     *         the other side disconnecting.
+     */
+    virtual int trySend(const Uint8* dataBuffer, int len) = 0;
+
+    /**
+     * Receives up to maxLen bytes, waiting until at least 1 is available.
+     *
+     * @return The number of bytes received. RECEIVE_WOULD_BLOCK if the
+     *         transport is non-blocking and no bytes were available. Else,
+     *         <= 0 if an error occurred, such as the other side disconnecting.
+     */
+    virtual int receive(Uint8* dataBuffer, int maxLen) = 0;
+
+    /**
+     * Checks for activity, updating isReady().
+     *
+     * Note: If this socket shares a socket set with others, the set's owner
+     *       can check them all at once instead (see
+     *       AcceptorBase::checkPeerSockets()).
+     */
+    virtual void checkReady() = 0;
+
+    /**
+     * Returns true if the last activity check found that receive() won't
+     * wait.
+     */
+    virtual bool isReady() = 0;
+};
+
+} // End namespace AM
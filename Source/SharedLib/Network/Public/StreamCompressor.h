@@ -0,0 +1,125 @@
+#pragma once
+
+#include "BinaryBuffer.h"
+#include "SharedConfig.h"
+#include <SDL_stdinc.h>
+
+union LZ4_stream_u;
+union LZ4_streamHC_u;
+
+namespace AM
+{
+/**
+ * Compresses a sequence of message batches as a single LZ4 stream, so that
+ * each batch can reference data from the batches before it.
+ *
+ * Our batches are often only a few hundred bytes, which LZ4 compresses poorly
+ * when it starts each one with no history. Streaming lets repeated message
+ * layouts (e.g. consecutive MovementUpdates) compress well.
+ *
+ * Batches are copied into a ring buffer before being compressed, since LZ4
+ * requires previously compressed data to stay in place. The matching
+ * StreamDecompressor uses the same ring buffer size and wrap rule
+ * ("synchronized mode"), so every batch that's passed through compress()
+ * must be passed through its decompress(), in the same order.
+ */
+class StreamCompressor
+{
+public:
+    /**
+     * The available compression levels, from fastest to most compressed.
+     */
+    enum class Level : Uint8 {
+        /** LZ4 with a high acceleration value. */
+        Fast,
+        /** LZ4 with the default acceleration value. */
+        Default,
+        /** LZ4HC. Much slower, but compresses better. Allocates an extra
+            ~256KB per stream the first time it's used. */
+        High,
+        Count
+    };
+
+    /** The acceleration value used by Level::Fast. Each step trades about
+        3% of compression ratio for speed. */
+    static constexpr int FAST_ACCELERATION{8};
+
+    /** The LZ4HC compression level used by Level::High. */
+    static constexpr int HIGH_COMPRESSION_LEVEL{9};
+
+    /** The largest batch that can be compressed. */
+    static constexpr std::size_t MAX_BLOCK_SIZE{SharedConfig::MAX_BATCH_SIZE};
+
+    /** The size of each stream's ring buffer.
+        LZ4 uses the last 64KB as history. We add room for 2 blocks, since
+        the space at the end of the ring is skipped when a block doesn't fit,
+        and the block being written can't overwrite the history. */
+    static constexpr std::size_t RING_BUFFER_SIZE{(64 * 1024)
+                                                  + (2 * MAX_BLOCK_SIZE)};
+
+    /**
+     * @param inDictionary  If non-empty, primes the stream. Must outlive this
+     *                      object. See CompressionDictionary.
+     */
+    StreamCompressor(const BinaryBuffer& inDictionary);
+
+    ~StreamCompressor();
+
+    StreamCompressor(const StreamCompressor&) = delete;
+    StreamCompressor& operator=(const StreamCompressor&) = delete;
+
+    /**
+     * Compresses the given data, using the previously compressed data as
+     * history.
+     *
+     * @param sourceBuffer  A buffer containing the data to compress.
+     * @param sourceLength  The length of the data to compress. Must be <=
+     *                      MAX_BLOCK_SIZE.
+     * @param destBuffer  The buffer to write the compressed data to.
+     * @param destLength  The length of destBuffer. Should be at least
+     *                    ByteTools::compressBound(sourceLength).
+     * @param level  The compression level to use. May change between calls,
+     *               the decompressor doesn't need to know.
+     * @return The length of the compressed data.
+     */
+    std::size_t compress(const Uint8* sourceBuffer, std::size_t sourceLength,
+                         Uint8* destBuffer, std::size_t destLength,
+                         Level level = Level::Default);
+
+    /**
+     * Clears the stream's history and re-primes it with the dictionary.
+     * The matching StreamDecompressor must also be reset.
+     */
+    void reset();
+
+private:
+    /**
+     * Loads our current history into the inactive stream and makes it the
+     * active stream. Used when switching to or from Level::High.
+     */
+    void switchStreams();
+
+    /** The dictionary to prime the stream with. */
+    const BinaryBuffer& dictionary;
+
+    /** The LZ4 stream state. Used by Level::Fast and Level::Default. */
+    LZ4_stream_u* stream;
+
+    /** The LZ4HC stream state. Used by Level::High. Allocated the first time
+        it's used. */
+    LZ4_streamHC_u* streamHC;
+
+    /** If true, streamHC is the active stream. Else, stream is. */
+    bool highIsActive;
+
+    /** Holds the previously compressed batches. */
+    BinaryBuffer ringBuffer;
+
+    /** The index in ringBuffer that the next batch will be copied to. */
+    std::size_t ringOffset;
+
+    /** True if nothing has been compressed since the last reset(). */
+    bool streamIsEmpty;
+};
+
+} // End namespace AM
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "BinaryBuffer.h"
+#include <SDL_stdinc.h>
+
+union LZ4_streamDecode_u;
+
+namespace AM
+{
+/**
+ * Decompresses a sequence of message batches that were compressed by a
+ * StreamCompressor.
+ *
+ * Batches are decompressed into a ring buffer, where they stay available as
+ * history for the following batches. Every batch that was passed through the
+ * StreamCompressor must be passed through decompress(), in the same order.
+ */
+class StreamDecompressor
+{
+public:
+    /**
+     * @param inDictionary  Must match the StreamCompressor's dictionary.
+     *                      Must outlive this object.
+     */
+    StreamDecompressor(const BinaryBuffer& inDictionary);
+
+    ~StreamDecompressor();
+
+    StreamDecompressor(const StreamDecompressor&) = delete;
+    StreamDecompressor& operator=(const StreamDecompressor&) = delete;
+
+    /**
+     * Decompresses the given data.
+     *
+     * @param sourceBuffer  A buffer containing the data to decompress.
+     * @param sourceLength  The length of the data to decompress.
+     * @param outDecompressedLength  Set to the length of the decompressed
+     *                              data.
+     * @return A pointer to the decompressed data, which stays valid until the
+     *         next call to decompress(). nullptr if the data was malformed,
+     *         in which case the stream can't be recovered.
+     */
+    Uint8* decompress(const Uint8* sourceBuffer, std::size_t sourceLength,
+                      std::size_t& outDecompressedLength);
+
+    /**
+     * Clears the stream's history and re-primes it with the dictionary.
+     */
+    void reset();
+
+private:
+    /** The dictionary to prime the stream with. */
+    const BinaryBuffer& dictionary;
+
+    /** The LZ4 stream state. */
+    LZ4_streamDecode_u* stream;
+
+    /** Holds the previously decompressed batches. */
+    BinaryBuffer ringBuffer;
+
+    /** The index in ringBuffer that the next batch will be decompressed
+        to. */
+    std::size_t ringOffset;
+};
+
+} // End namespace AM
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "PeerSocket.h"
+#include <memory>
+
+namespace AM
+{
+class TcpSocket;
+class SocketSet;
+
+/**
+ * A PeerSocket that sends over TCP.
+ *
+ * Adds its socket to the given socket set, so that activity can be checked
+ * across many peers with a single call.
+ */
+class TcpPeerSocket : public PeerSocket
+{
+public:
+    /**
+     * Adds the socket to the given set.
+     */
+    TcpPeerSocket(std::unique_ptr<TcpSocket> inSocket,
+                  const std::shared_ptr<SocketSet>& inSet);
+
+    /**
+     * Removes the socket from the set.
+     */
+    ~TcpPeerSocket() override;
+
+    int trySend(const Uint8* dataBuffer, int len) override;
+
+    int receive(Uint8* dataBuffer, int maxLen) override;
+
+    void checkReady() override;
+
+    bool isReady() override;
+
+private:
+    /** Our underlying socket. */
+    std::unique_ptr<TcpSocket> socket;
+
+    /** The set that our socket belongs to. */
+    std::shared_ptr<SocketSet> set;
+};
+
+} // End namespace AM
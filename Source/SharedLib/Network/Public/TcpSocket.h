@@ -56,6 +56,19 @@ public:
      */
     int send(const void* dataBuffer, int len);
 
+    /**
+     * Sends up to len bytes from the given dataBuffer over this socket,
+     * without waiting for room in the OS's send buffer.
+     *
+     * Note: Only non-blocking if setNonBlocking() was called. Otherwise, this
+     *       will wait until all bytes are sent.
+     *
+     * @return The number of bytes sent, which may be less than len (including
+     *         0) if the OS's send buffer is full. -1 if an error occurred,
+     *         such as the client disconnecting.
+     */
+    int trySend(const void* dataBuffer, int len);
+
     /**
      * Receives data from this socket.
      *
@@ -68,11 +81,21 @@ public:
      * @param dataBuffer  The buffer to use.
      * @param maxLen  The maximum number of bytes to receive.
      * @return The number of bytes received.
-     *         If the number returned is <= 0, an error occurred, or the remote
-     *         host has closed the connection.
+     *         If this socket is non-blocking and no bytes were available,
+     *         RECEIVE_WOULD_BLOCK. Otherwise, if the number returned is <= 0,
+     *         an error occurred, or the remote host has closed the connection.
      */
     int receive(void* dataBuffer, int maxLen);
 
+    /**
+     * Puts this socket into non-blocking mode.
+     *
+     * Note: receive() should then only be called when isReady() is true,
+     *       since it'll return RECEIVE_WOULD_BLOCK if there's no data
+     *       waiting.
+     */
+    void setNonBlocking();
+
     /**
      * Checks if a socket has been marked as active.
      *
@@ -0,0 +1,224 @@
+#include "ChunkCodec.h"
+#include "AMAssert.h"
+
+namespace AM
+{
+void ChunkCodec::encode(const TileArray& tiles, std::vector<Uint8>& outBuffer)
+{
+    outBuffer.clear();
+
+    // Check if every tile matches the first tile, and find the highest
+    // palette index that's in use.
+    const std::vector<Uint8>& firstLayers{tiles[0].spriteLayers};
+    bool isUniform{true};
+    unsigned int highestIndex{0};
+    for (const TileSnapshot& tile : tiles) {
+        if (isUniform && (tile.spriteLayers != firstLayers)) {
+            isUniform = false;
+        }
+
+        for (Uint8 paletteIndex : tile.spriteLayers) {
+            if (paletteIndex > highestIndex) {
+                highestIndex = paletteIndex;
+            }
+        }
+    }
+
+    // If every tile is the same, we only need to write one of them.
+    if (isUniform) {
+        if (firstLayers.empty()) {
+            outBuffer.push_back(static_cast<Uint8>(Mode::Empty));
+        }
+        else {
+            AM_ASSERT(firstLayers.size() <= TileSnapshot::MAX_SPRITE_LAYERS,
+                      "Too many sprite layers: %zu", firstLayers.size());
+            outBuffer.push_back(static_cast<Uint8>(Mode::Uniform));
+            outBuffer.push_back(static_cast<Uint8>(firstLayers.size()));
+            outBuffer.insert(outBuffer.end(), firstLayers.begin(),
+                             firstLayers.end());
+        }
+        return;
+    }
+
+    // The tiles vary, encode them as runs.
+    encodeRuns(tiles, getIndexWidth(highestIndex), outBuffer);
+}
+
+bool ChunkCodec::decode(const Uint8* buffer, std::size_t bufferSize,
+                        TileArray& outTiles)
+{
+    if (bufferSize == 0) {
+        return false;
+    }
+
+    switch (static_cast<Mode>(buffer[0])) {
+        case Mode::Empty: {
+            if (bufferSize != 1) {
+                return false;
+            }
+
+            for (TileSnapshot& tile : outTiles) {
+                tile.spriteLayers.clear();
+            }
+            return true;
+        }
+        case Mode::Uniform: {
+            if (bufferSize < 2) {
+                return false;
+            }
+
+            std::size_t layerCount{buffer[1]};
+            if ((layerCount > TileSnapshot::MAX_SPRITE_LAYERS)
+                || (bufferSize != (2 + layerCount))) {
+                return false;
+            }
+
+            for (TileSnapshot& tile : outTiles) {
+                tile.spriteLayers.assign((buffer + 2),
+                                         (buffer + 2 + layerCount));
+            }
+            return true;
+        }
+        case Mode::Runs: {
+            return decodeRuns(buffer, bufferSize, outTiles);
+        }
+        default: {
+            return false;
+        }
+    }
+}
+
+unsigned int ChunkCodec::getIndexWidth(unsigned int highestIndex)
+{
+    unsigned int width{0};
+    while ((highestIndex >> width) != 0) {
+        width++;
+    }
+
+    return width;
+}
+
+void ChunkCodec::encodeRuns(const TileArray& tiles, unsigned int indexWidth,
+                            std::vector<Uint8>& outBuffer)
+{
+    // Write the header.
+    outBuffer.push_back(static_cast<Uint8>(Mode::Runs));
+    outBuffer.push_back(static_cast<Uint8>(indexWidth));
+
+    // Write each run of identical tiles.
+    std::size_t bitIndex{outBuffer.size() * 8};
+    std::size_t tileIndex{0};
+    while (tileIndex < tiles.size()) {
+        // Count how many of the following tiles match this one.
+        const std::vector<Uint8>& layers{tiles[tileIndex].spriteLayers};
+        std::size_t runLength{1};
+        while (((tileIndex + runLength) < tiles.size())
+               && (tiles[tileIndex + runLength].spriteLayers == layers)) {
+            runLength++;
+        }
+
+        AM_ASSERT(layers.size() <= TileSnapshot::MAX_SPRITE_LAYERS,
+                  "Too many sprite layers: %zu", layers.size());
+
+        // Write the run.
+        writeBits(outBuffer, bitIndex, static_cast<unsigned int>(runLength - 1),
+                  RUN_LENGTH_BITS);
+        writeBits(outBuffer, bitIndex, static_cast<unsigned int>(layers.size()),
+                  LAYER_COUNT_BITS);
+        for (Uint8 paletteIndex : layers) {
+            writeBits(outBuffer, bitIndex, paletteIndex, indexWidth);
+        }
+
+        tileIndex += runLength;
+    }
+}
+
+bool ChunkCodec::decodeRuns(const Uint8* buffer, std::size_t bufferSize,
+                            TileArray& outTiles)
+{
+    // Read the header.
+    if (bufferSize < 2) {
+        return false;
+    }
+    unsigned int indexWidth{buffer[1]};
+    if (indexWidth > 8) {
+        return false;
+    }
+
+    // Read each run, copying its tile into the output.
+    std::size_t bitIndex{2 * 8};
+    std::size_t tileIndex{0};
+    while (tileIndex < outTiles.size()) {
+        unsigned int runLength{0};
+        unsigned int layerCount{0};
+        if (!readBits(buffer, bufferSize, bitIndex, RUN_LENGTH_BITS, runLength)
+            || !readBits(buffer, bufferSize, bitIndex, LAYER_COUNT_BITS,
+                         layerCount)) {
+            return false;
+        }
+
+        runLength++;
+        if (((tileIndex + runLength) > outTiles.size())
+            || (layerCount > TileSnapshot::MAX_SPRITE_LAYERS)) {
+            return false;
+        }
+
+        std::vector<Uint8>& layers{outTiles[tileIndex].spriteLayers};
+        layers.resize(layerCount);
+        for (unsigned int i = 0; i < layerCount; ++i) {
+            unsigned int paletteIndex{0};
+            if (!readBits(buffer, bufferSize, bitIndex, indexWidth,
+                          paletteIndex)) {
+                return false;
+            }
+            layers[i] = static_cast<Uint8>(paletteIndex);
+        }
+
+        for (unsigned int i = 1; i < runLength; ++i) {
+            outTiles[tileIndex + i].spriteLayers = layers;
+        }
+
+        tileIndex += runLength;
+    }
+
+    return true;
+}
+
+void ChunkCodec::writeBits(std::vector<Uint8>& buffer, std::size_t& bitIndex,
+                           unsigned int value, unsigned int bitCount)
+{
+    for (unsigned int i = 0; i < bitCount; ++i) {
+        std::size_t byteIndex{bitIndex / 8};
+        if (byteIndex == buffer.size()) {
+            buffer.push_back(0);
+        }
+
+        if ((value >> i) & 1) {
+            buffer[byteIndex] |= static_cast<Uint8>(1 << (bitIndex % 8));
+        }
+
+        bitIndex++;
+    }
+}
+
+bool ChunkCodec::readBits(const Uint8* buffer, std::size_t bufferSize,
+                          std::size_t& bitIndex, unsigned int bitCount,
+                          unsigned int& outValue)
+{
+    if ((bitIndex + bitCount) > (bufferSize * 8)) {
+        return false;
+    }
+
+    outValue = 0;
+    for (unsigned int i = 0; i < bitCount; ++i) {
+        if ((buffer[bitIndex / 8] >> (bitIndex % 8)) & 1) {
+            outValue |= (1u << i);
+        }
+
+        bitIndex++;
+    }
+
+    return true;
+}
+
+} // End namespace AM
@@ -21,7 +21,10 @@ TileMapBase::TileMapBase(SpriteDataBase& inSpriteData)
 : spriteData{inSpriteData}
 , chunkExtent{}
 , tileExtent{}
-, tiles{}
+, chunks{}
+, emptyTile{}
+, versionEpoch{0}
+, versionCounter{0}
 {
 }
 
@@ -29,7 +32,101 @@ void TileMapBase::setTileSpriteLayer(int tileX, int tileY,
                                      unsigned int layerIndex,
                                      const Sprite& sprite)
 {
-    Tile& tile{tiles[linearizeTileIndex(tileX, tileY)]};
+    TileEdit edit{TileEdit::Type::SetSpriteLayer, tileX, tileY, layerIndex,
+                  sprite.numericID};
+    Chunk* chunk{getChunkForEdit(edit)};
+    if (chunk != nullptr) {
+        applyEdit(*chunk, edit);
+    }
+}
+
+void TileMapBase::setTileSpriteLayer(int tileX, int tileY,
+                                     unsigned int layerIndex,
+                                     const std::string& stringID)
+{
+    setTileSpriteLayer(tileX, tileY, layerIndex, spriteData.get(stringID));
+}
+
+void TileMapBase::setTileSpriteLayer(int tileX, int tileY,
+                                     unsigned int layerIndex, int numericID)
+{
+    setTileSpriteLayer(tileX, tileY, layerIndex, spriteData.get(numericID));
+}
+
+void TileMapBase::clearTile(int tileX, int tileY)
+{
+    TileEdit edit{TileEdit::Type::Clear, tileX, tileY};
+    Chunk* chunk{getChunkForEdit(edit)};
+    if (chunk != nullptr) {
+        applyEdit(*chunk, edit);
+    }
+}
+
+const Tile& TileMapBase::getTile(unsigned int x, unsigned int y) const
+{
+    AM_ASSERT(((x < static_cast<unsigned int>(tileExtent.xLength))
+               && (y < static_cast<unsigned int>(tileExtent.yLength))),
+              "Tried to get an out of bounds tile. (x, y): (%u, %u)", x, y);
+
+    // If the tile's chunk isn't in memory, return an empty tile.
+    auto chunkIt{chunks.find(linearizeChunkIndex(
+        (x / SharedConfig::CHUNK_WIDTH), (y / SharedConfig::CHUNK_WIDTH)))};
+    if (chunkIt == chunks.end()) {
+        return emptyTile;
+    }
+
+    return chunkIt->second.tiles[linearizeRelativeTileIndex(x, y)];
+}
+
+bool TileMapBase::hasChunk(const ChunkPosition& chunkPosition) const
+{
+    return chunks.contains(
+        linearizeChunkIndex(chunkPosition.x, chunkPosition.y));
+}
+
+const Chunk* TileMapBase::getChunk(const ChunkPosition& chunkPosition) const
+{
+    auto chunkIt{
+        chunks.find(linearizeChunkIndex(chunkPosition.x, chunkPosition.y))};
+    if (chunkIt == chunks.end()) {
+        return nullptr;
+    }
+
+    return &(chunkIt->second);
+}
+
+const ChunkExtent& TileMapBase::getChunkExtent() const
+{
+    return chunkExtent;
+}
+
+const TileExtent& TileMapBase::getTileExtent() const
+{
+    return tileExtent;
+}
+
+Chunk* TileMapBase::getChunkForEdit(const TileEdit& edit)
+{
+    // Note: operator[] default-constructs the chunk if it isn't present.
+    return &(chunks[linearizeChunkIndex(
+        (edit.tileX / SharedConfig::CHUNK_WIDTH),
+        (edit.tileY / SharedConfig::CHUNK_WIDTH))]);
+}
+
+void TileMapBase::applyEdit(Chunk& chunk, const TileEdit& edit)
+{
+    chunk.isDirty = true;
+    chunk.version = getNextChunkVersion();
+
+    Tile& tile{
+        chunk.tiles[linearizeRelativeTileIndex(edit.tileX, edit.tileY)]};
+    if (edit.type == TileEdit::Type::Clear) {
+        tile.spriteLayers.clear();
+        return;
+    }
+
+    const Sprite& sprite{spriteData.get(edit.numericID)};
+    unsigned int layerIndex{edit.layerIndex};
     std::vector<Tile::SpriteLayer>& spriteLayers{tile.spriteLayers};
 
     // If we're being asked to set the highest layer in the tile to the empty 
@@ -55,8 +152,11 @@ void TileMapBase::setTileSpriteLayer(int tileX, int tileY,
         BoundingBox worldBounds{};
         if (sprite.hasBoundingBox) {
             Position tilePosition{
-                static_cast<float>(tileX * SharedConfig::TILE_WORLD_WIDTH),
-                static_cast<float>(tileY * SharedConfig::TILE_WORLD_WIDTH), 0};
+                static_cast<float>(edit.tileX
+                                   * SharedConfig::TILE_WORLD_WIDTH),
+                static_cast<float>(edit.tileY
+                                   * SharedConfig::TILE_WORLD_WIDTH),
+                0};
             worldBounds
                 = Transforms::modelToWorld(sprite.modelBounds, tilePosition);
         }
@@ -74,46 +174,20 @@ void TileMapBase::setTileSpriteLayer(int tileX, int tileY,
     }
 }
 
-void TileMapBase::setTileSpriteLayer(int tileX, int tileY,
-                                     unsigned int layerIndex,
-                                     const std::string& stringID)
-{
-    setTileSpriteLayer(tileX, tileY, layerIndex, spriteData.get(stringID));
-}
-
-void TileMapBase::setTileSpriteLayer(int tileX, int tileY,
-                                     unsigned int layerIndex, int numericID)
-{
-    setTileSpriteLayer(tileX, tileY, layerIndex, spriteData.get(numericID));
-}
-
-void TileMapBase::clearTile(int tileX, int tileY)
-{
-    Tile& tile{tiles[linearizeTileIndex(tileX, tileY)]};
-    tile.spriteLayers.clear();
-}
-
-const Tile& TileMapBase::getTile(unsigned int x, unsigned int y) const
-{
-    unsigned int tileIndex{linearizeTileIndex(x, y)};
-    unsigned int maxTileIndex{
-        static_cast<unsigned int>(tileExtent.xLength * tileExtent.yLength)};
-    AM_ASSERT((tileIndex < maxTileIndex),
-              "Tried to get an out of bounds tile. tileIndex: %u, max: %u",
-              tileIndex, maxTileIndex);
-    ignore(maxTileIndex);
-
-    return tiles[tileIndex];
-}
-
-const ChunkExtent& TileMapBase::getChunkExtent() const
+Uint32 TileMapBase::getNextChunkVersion()
 {
-    return chunkExtent;
-}
+    // Mix the epoch and counter together (splitmix64's finalizer), so that
+    // versions from different epochs don't line up.
+    Uint64 mixed{(static_cast<Uint64>(versionEpoch) << 32)
+                 | ++versionCounter};
+    mixed = (mixed ^ (mixed >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    mixed = (mixed ^ (mixed >> 27)) * 0x94d049bb133111ebULL;
+    mixed = mixed ^ (mixed >> 31);
 
-const TileExtent& TileMapBase::getTileExtent() const
-{
-    return tileExtent;
+    // Note: 0 is the version of chunks that have never been modified, so we
+    //       avoid it.
+    Uint32 version{static_cast<Uint32>(mixed)};
+    return ((version == 0) ? 1 : version);
 }
 
 } // End namespace AM
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Tile.h"
+#include "SharedConfig.h"
+#include <SDL_stdinc.h>
+#include <array>
+
+namespace AM
+{
+/**
+ * A 16x16 group of tiles in the tile map.
+ *
+ * Chunks are the unit that tile data is loaded, streamed, and evicted in.
+ */
+struct Chunk {
+public:
+    /** The tiles that make up this chunk, stored in row-major order. */
+    std::array<Tile, SharedConfig::CHUNK_TILE_COUNT> tiles;
+
+    /** True if one of this chunk's tiles has been modified since this flag
+        was last cleared.
+        Used by the server to track which chunks need to be saved. */
+    bool isDirty{false};
+
+    /** Changed each time one of this chunk's tiles is modified (see
+        TileMapBase::getNextChunkVersion()).
+        Used to tell if a client's copy of this chunk is up to date. */
+    Uint32 version{0};
+};
+
+} // End namespace AM
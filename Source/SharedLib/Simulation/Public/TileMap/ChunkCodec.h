@@ -0,0 +1,171 @@
+#pragma once
+
+#include "TileSnapshot.h"
+#include "SharedConfig.h"
+#include <SDL_stdinc.h>
+#include <array>
+#include <vector>
+#include "bitsery/bitsery.h"
+#include "bitsery/traits/vector.h"
+
+namespace AM
+{
+/**
+ * Encodes a chunk's tiles into a compact byte form, and decodes them back.
+ *
+ * Used by ChunkSnapshot (the map file) and ChunkWireSnapshot (ChunkUpdate
+ * messages), in place of serializing each tile as its own length-prefixed
+ * vector.
+ *
+ * The encoded form starts with a 1-byte Mode:
+ *   Empty: No tile has any layers. Nothing else follows.
+ *   Uniform: Every tile has the same layers (e.g. a chunk of plain floor).
+ *            A layer count and the layers' palette indices follow, 1 byte
+ *            each.
+ *   Runs: A 1-byte index width follows, then a bit stream of runs. Each run
+ *         holds a repeat count (8 bits), a layer count (7 bits), and the
+ *         layers' palette indices (index width bits each).
+ *
+ * The index width is ceil(log2(highestIndex + 1)). Since palettes are built
+ * densely, this is the same as ceil(log2(paletteSize)).
+ */
+class ChunkCodec
+{
+public:
+    /** The tiles that make up a chunk, stored in row-major order. */
+    using TileArray = std::array<TileSnapshot, SharedConfig::CHUNK_TILE_COUNT>;
+
+    /** The number of bits used to store a run's repeat count. */
+    static constexpr unsigned int RUN_LENGTH_BITS = 8;
+
+    /** The number of bits used to store a run's layer count. */
+    static constexpr unsigned int LAYER_COUNT_BITS = 7;
+
+    /** The size of the largest possible encoded chunk. Used as the max size
+        when serializing the encoded bytes. */
+    static constexpr std::size_t MAX_ENCODED_SIZE
+        = 2
+          + (((SharedConfig::CHUNK_TILE_COUNT
+               * (RUN_LENGTH_BITS + LAYER_COUNT_BITS
+                  + (TileSnapshot::MAX_SPRITE_LAYERS * 8)))
+              + 7)
+             / 8);
+
+    /**
+     * Encodes the given tiles into outBuffer.
+     *
+     * @param tiles  The tiles to encode.
+     * @param outBuffer  The buffer to fill. Will be cleared before encoding.
+     */
+    static void encode(const TileArray& tiles, std::vector<Uint8>& outBuffer);
+
+    /**
+     * Decodes the given encoded bytes into outTiles.
+     *
+     * @param buffer  The encoded bytes.
+     * @param bufferSize  The number of encoded bytes.
+     * @param outTiles  The tiles to fill. Each tile's layers will be
+     *                  overwritten.
+     * @return true if the bytes were successfully decoded, false if they
+     *         were malformed.
+     */
+    static bool decode(const Uint8* buffer, std::size_t bufferSize,
+                       TileArray& outTiles);
+
+    /**
+     * Returns the number of bits needed to store every index in
+     * [0, highestIndex].
+     */
+    static unsigned int getIndexWidth(unsigned int highestIndex);
+
+private:
+    enum class Mode : Uint8 { Empty, Uniform, Runs };
+
+    static_assert(TileSnapshot::MAX_SPRITE_LAYERS < (1 << LAYER_COUNT_BITS),
+                  "Layer count won't fit in LAYER_COUNT_BITS.");
+    static_assert(SharedConfig::CHUNK_TILE_COUNT <= (1 << RUN_LENGTH_BITS),
+                  "Run length won't fit in RUN_LENGTH_BITS.");
+
+    /**
+     * Encodes tiles using the Runs mode.
+     */
+    static void encodeRuns(const TileArray& tiles, unsigned int indexWidth,
+                           std::vector<Uint8>& outBuffer);
+
+    /**
+     * Decodes bytes that were encoded using the Runs mode.
+     */
+    static bool decodeRuns(const Uint8* buffer, std::size_t bufferSize,
+                           TileArray& outTiles);
+
+    /**
+     * Appends the lowest bitCount bits of value to the given buffer,
+     * starting at bitIndex. Bits are written LSB-first.
+     *
+     * @param bitIndex  The absolute bit index to write at. Will be advanced
+     *                  by bitCount.
+     */
+    static void writeBits(std::vector<Uint8>& buffer, std::size_t& bitIndex,
+                          unsigned int value, unsigned int bitCount);
+
+    /**
+     * Reads bitCount bits from the given buffer, starting at bitIndex.
+     *
+     * @param bitIndex  The absolute bit index to read from. Will be advanced
+     *                  by bitCount.
+     * @return true if the bits were read, false if they would overrun the
+     *         buffer.
+     */
+    static bool readBits(const Uint8* buffer, std::size_t bufferSize,
+                         std::size_t& bitIndex, unsigned int bitCount,
+                         unsigned int& outValue);
+};
+
+/**
+ * Bitsery extension that serializes a ChunkCodec::TileArray in its encoded
+ * form.
+ *
+ * Usage: serializer.ext(chunk.tiles, PackedChunkTiles{});
+ */
+struct PackedChunkTiles {
+    template<typename Ser, typename Fnc>
+    void serialize(Ser& serializer, const ChunkCodec::TileArray& tiles,
+                   Fnc&&) const
+    {
+        // Note: We re-use a per-thread buffer so we don't allocate for every
+        //       chunk.
+        thread_local std::vector<Uint8> encodedBuffer{};
+        ChunkCodec::encode(tiles, encodedBuffer);
+        serializer.container1b(encodedBuffer, ChunkCodec::MAX_ENCODED_SIZE);
+    }
+
+    template<typename Des, typename Fnc>
+    void deserialize(Des& deserializer, ChunkCodec::TileArray& tiles,
+                     Fnc&&) const
+    {
+        thread_local std::vector<Uint8> encodedBuffer{};
+        deserializer.container1b(encodedBuffer, ChunkCodec::MAX_ENCODED_SIZE);
+
+        if (!ChunkCodec::decode(encodedBuffer.data(), encodedBuffer.size(),
+                                tiles)) {
+            deserializer.adapter().error(bitsery::ReaderError::InvalidData);
+        }
+    }
+};
+
+} // End namespace AM
+
+namespace bitsery
+{
+namespace traits
+{
+template<>
+struct ExtensionTraits<AM::PackedChunkTiles, AM::ChunkCodec::TileArray> {
+    using TValue = void;
+    static constexpr bool SupportValueOverload = false;
+    static constexpr bool SupportObjectOverload = true;
+    static constexpr bool SupportLambdaOverload = false;
+};
+
+} // End namespace traits
+} // End namespace bitsery
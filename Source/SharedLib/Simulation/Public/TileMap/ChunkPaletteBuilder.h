@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+
+namespace AM
+{
+/**
+ * Adds IDs to a chunk snapshot's palette, and looks up their indices in
+ * constant time.
+ *
+ * Snapshots only hold their palette as a vector, so that they stay plain
+ * data. When building a snapshot tile by tile, use one of these (local to
+ * the build) instead of searching the palette for each layer.
+ *
+ * Usage:
+ *   ChunkPaletteBuilder<std::string> paletteBuilder{chunkSnapshot.palette};
+ *   tileSnapshot.spriteLayers.push_back(paletteBuilder.getIndex(stringID));
+ *
+ * @tparam T  The palette's ID type. std::string for ChunkSnapshot, int for
+ *            ChunkWireSnapshot.
+ */
+template<typename T>
+class ChunkPaletteBuilder
+{
+public:
+    /**
+     * @param inPalette  The palette to build. Any IDs that are already in it
+     *                   keep their indices.
+     */
+    ChunkPaletteBuilder(std::vector<T>& inPalette)
+    : palette{inPalette}
+    , paletteIndices{}
+    {
+        for (unsigned int i = 0; i < palette.size(); ++i) {
+            paletteIndices.try_emplace(palette[i], i);
+        }
+    }
+
+    /**
+     * Returns the palette index for the given ID.
+     * If the ID is not in the palette, it will be added.
+     */
+    unsigned int getIndex(const T& id)
+    {
+        // Check if we already have this ID.
+        auto [it, wasInserted]{paletteIndices.try_emplace(
+            id, static_cast<unsigned int>(palette.size()))};
+
+        // If we didn't have the ID, add it.
+        if (wasInserted) {
+            palette.push_back(id);
+        }
+
+        return it->second;
+    }
+
+private:
+    /** The palette that we're building. */
+    std::vector<T>& palette;
+
+    /** Maps IDs to their index in the palette. */
+    std::unordered_map<T, unsigned int> paletteIndices;
+};
+
+} // End namespace AM
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "TileSnapshot.h"
+#include "ChunkCodec.h"
 #include "SharedConfig.h"
 #include <vector>
 #include <array>
@@ -11,7 +12,8 @@ namespace AM
 /**
  * Holds chunk data in a persistable form (palette IDs instead of pointers).
  *
- * Used in saving/loading the tile map.
+ * Used in saving/loading the tile map. To build one, see
+ * ChunkPaletteBuilder.
  */
 struct ChunkSnapshot {
 public:
@@ -27,41 +29,37 @@ public:
         Tile layers hold indices into this palette. */
     std::vector<std::string> palette;
 
-    /** The tiles that make up this chunk, stored in row-major order. */
-    std::array<TileSnapshot, SharedConfig::CHUNK_TILE_COUNT> tiles;
-
-    /**
-     * Returns the palette index for the given ID.
-     * If the ID is not in the palette, it will be added.
-     */
-    unsigned int getPaletteIndex(const std::string& stringID)
-    {
-        // TODO: If this gets to be a performance issue, we can look into
-        //       switching palette to a map. Serialization will be more
-        //       complicated, though.
-
-        // Check if we already have this string.
-        for (unsigned int i = 0; i < palette.size(); ++i) {
-            if (palette[i] == stringID) {
-                // We already have the string, returns its index.
-                return i;
-            }
-        }
-
-        // We didn't have the string, add it.
-        palette.push_back(stringID);
-        return static_cast<unsigned int>(palette.size() - 1);
-    }
+    /** The tiles that make up this chunk, stored in row-major order.
+        Serialized through ChunkCodec. */
+    ChunkCodec::TileArray tiles;
 };
 
 template<typename S>
-void serialize(S& serializer, ChunkSnapshot& testChunk)
+void serializePalette(S& serializer, ChunkSnapshot& testChunk)
 {
     serializer.container(testChunk.palette, ChunkSnapshot::MAX_IDS,
                          [](S& serializer, std::string& string) {
                              serializer.text1b(string,
                                                ChunkSnapshot::MAX_ID_LENGTH);
                          });
+}
+
+template<typename S>
+void serialize(S& serializer, ChunkSnapshot& testChunk)
+{
+    serializePalette(serializer, testChunk);
+
+    serializer.ext(testChunk.tiles, PackedChunkTiles{});
+}
+
+/**
+ * Serializes a chunk in the version 0 map format, which stored each tile as
+ * its own length-prefixed vector. Only used for loading old map files.
+ */
+template<typename S>
+void serializeV0(S& serializer, ChunkSnapshot& testChunk)
+{
+    serializePalette(serializer, testChunk);
 
     serializer.container(testChunk.tiles);
 }
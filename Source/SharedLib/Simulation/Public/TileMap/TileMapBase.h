@@ -1,9 +1,14 @@
 #pragma once
 
 #include "Tile.h"
+#include "Chunk.h"
 #include "ChunkExtent.h"
+#include "ChunkPosition.h"
 #include "TileExtent.h"
+#include "SharedConfig.h"
+#include "EmptySpriteID.h"
 #include <vector>
+#include <unordered_map>
 
 namespace AM
 {
@@ -12,7 +17,10 @@ class SpriteDataBase;
 
 /**
  * Owns and manages the world's tile map state.
- * Tiles are conceptually organized into 16x16 chunks.
+ * Tiles are organized into 16x16 chunks.
+ *
+ * Only the chunks that are currently in memory are stored. Tiles in chunks
+ * that aren't in memory are treated as empty.
  *
  * Persisted tile map data is loaded from TileMap.bin.
  */
@@ -26,6 +34,8 @@ public:
      */
     TileMapBase(SpriteDataBase& inSpriteData);
 
+    virtual ~TileMapBase() = default;
+
     /**
      * Sets the given sprite layer to the given tile.
      *
@@ -33,6 +43,10 @@ public:
      * it. Any tiles added during resizing will be default initialized to
      * the "empty sprite".
      *
+     * If the tile's chunk isn't in memory, it's obtained through
+     * getChunkForEdit(). If that doesn't return it, the edit is either
+     * deferred until the chunk is loaded or dropped, depending on the map.
+     *
      * Note: There's no bounds checking on tileX/tileY. It's on you to make
      *       sure they're valid.
      */
@@ -55,6 +69,10 @@ public:
     /**
      * Clears all sprite layers out of the given tile.
      *
+     * If the tile's chunk isn't in memory, it's obtained through
+     * getChunkForEdit(). If that doesn't return it, the edit is either
+     * deferred until the chunk is loaded or dropped, depending on the map.
+     *
      * Note: There's no bounds checking on tileX/tileY. It's on you to make
      *       sure they're valid.
      */
@@ -62,9 +80,21 @@ public:
 
     /**
      * Gets a const reference to the tile at the given coordinates.
+     *
+     * If the tile's chunk isn't in memory, returns an empty tile.
      */
     const Tile& getTile(unsigned int x, unsigned int y) const;
 
+    /**
+     * Returns true if the given chunk is in memory.
+     */
+    bool hasChunk(const ChunkPosition& chunkPosition) const;
+
+    /**
+     * Returns the given chunk, or nullptr if it isn't in memory.
+     */
+    const Chunk* getChunk(const ChunkPosition& chunkPosition) const;
+
     /**
      * Returns the map extent, with chunks as the unit.
      */
@@ -85,17 +115,81 @@ public:
 
 protected:
     /**
-     * Returns the index in the tiles vector where the tile with the given
-     * coordinates can be found.
+     * Returns the key that the chunk with the given coordinates is stored
+     * under in the chunks map.
      */
-    inline unsigned int linearizeTileIndex(int x, int y) const
+    inline unsigned int linearizeChunkIndex(int chunkX, int chunkY) const
     {
-        return (y * tileExtent.xLength) + x;
+        return (chunkY * chunkExtent.xLength) + chunkX;
     }
 
+    /**
+     * Returns the index in its chunk's tiles array where the tile with the
+     * given coordinates can be found.
+     */
+    static inline unsigned int linearizeRelativeTileIndex(int tileX,
+                                                          int tileY)
+    {
+        return ((tileY % SharedConfig::CHUNK_WIDTH) * SharedConfig::CHUNK_WIDTH)
+               + (tileX % SharedConfig::CHUNK_WIDTH);
+    }
+
+    /**
+     * A single edit to a tile.
+     */
+    struct TileEdit {
+        enum class Type {
+            /** Set a sprite layer, see setTileSpriteLayer(). */
+            SetSpriteLayer,
+            /** Clear the tile, see clearTile(). */
+            Clear
+        };
+
+        Type type{Type::SetSpriteLayer};
+
+        /** The coordinates of the tile to edit. */
+        int tileX{0};
+        int tileY{0};
+
+        /** If type == SetSpriteLayer, the layer to set. */
+        unsigned int layerIndex{0};
+
+        /** If type == SetSpriteLayer, the new sprite's numeric ID. */
+        int numericID{EMPTY_SPRITE_ID};
+    };
+
+    /**
+     * Returns the chunk that contains the given edit's tile, so that the
+     * edit can be applied to it.
+     *
+     * By default, adds an empty chunk if it isn't in memory. Maps that page
+     * their chunks in should override this to bring in the saved chunk
+     * instead. If that can't be done right away, they may hold onto the
+     * edit and apply it later through applyEdit().
+     *
+     * @return The chunk, or nullptr if the edit shouldn't be applied now.
+     */
+    virtual Chunk* getChunkForEdit(const TileEdit& edit);
+
+    /**
+     * Applies the given edit to the given chunk, and gives the chunk a new
+     * version.
+     */
+    void applyEdit(Chunk& chunk, const TileEdit& edit);
+
+    /**
+     * Returns a new chunk version, to give to a chunk that was just edited.
+     *
+     * Versions are a hash of versionEpoch and a counter, so they won't repeat
+     * within a run. Since the epoch changes each run, versions from a run
+     * that ended before it could save (e.g. a crash) won't be reused either.
+     */
+    Uint32 getNextChunkVersion();
+
     /** The version of the map format. Kept as just a 16-bit int for now, we
-        can see later if we care to make it more complicated. */
-    static constexpr uint16_t MAP_FORMAT_VERSION = 0;
+        can see later if we care to make it more complicated.
+        Version 1: Chunk tiles are packed using ChunkCodec. */
+    static constexpr uint16_t MAP_FORMAT_VERSION = 1;
 
     /** Used to get sprites while constructing tiles. */
     SpriteDataBase& spriteData;
@@ -106,8 +200,19 @@ protected:
     /** The map's extent, with tiles as the unit. */
     TileExtent tileExtent;
 
-    /** The tiles that make up this map, stored in row-major order. */
-    std::vector<Tile> tiles;
+    /** The chunks that are currently in memory, keyed by their linearized
+        index (see linearizeChunkIndex()). */
+    std::unordered_map<unsigned int, Chunk> chunks;
+
+    /** Returned by getTile() for tiles in chunks that aren't in memory. */
+    Tile emptyTile;
+
+    /** Mixed into each new chunk version. Maps that persist their chunk
+        versions should set this to a new value each run. */
+    Uint32 versionEpoch;
+
+    /** The number of chunk versions that have been handed out this run. */
+    Uint32 versionCounter;
 };
 
 } // End namespace AM
@@ -44,8 +44,18 @@ void serialize(S& serializer, TileMapSnapshot& testTileMap)
     serializer.value4b(testTileMap.yLengthChunks);
 
     // Note: The SFINAE here breaks unless we use a size_t.
+    // Note: Version 0 maps didn't pack their tiles. Since the version is
+    //       read first, we can still load them.
     serializer.container(testTileMap.chunks,
-                         static_cast<std::size_t>(TileMapSnapshot::MAX_CHUNKS));
+                         static_cast<std::size_t>(TileMapSnapshot::MAX_CHUNKS),
+                         [&testTileMap](S& serializer, ChunkSnapshot& chunk) {
+                             if (testTileMap.version == 0) {
+                                 serializeV0(serializer, chunk);
+                             }
+                             else {
+                                 serializer.object(chunk);
+                             }
+                         });
 }
 
 } // End namespace AM
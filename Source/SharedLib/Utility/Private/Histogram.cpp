@@ -0,0 +1,89 @@
+#include "Histogram.h"
+#include "AMAssert.h"
+#include <bit>
+
+namespace AM
+{
+Histogram::Histogram()
+: bucketCounts{}
+, count{0}
+, sum{0}
+{
+}
+
+void Histogram::record(Uint64 value)
+{
+    bucketCounts[getBucketIndex(value)].fetch_add(1,
+                                                  std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(value, std::memory_order_relaxed);
+}
+
+Histogram::Snapshot Histogram::getSnapshot() const
+{
+    Snapshot snapshot{};
+    for (std::size_t i = 0; i < BUCKET_COUNT; ++i) {
+        snapshot.bucketCounts[i]
+            = bucketCounts[i].load(std::memory_order_relaxed);
+    }
+    snapshot.count = count.load(std::memory_order_relaxed);
+    snapshot.sum = sum.load(std::memory_order_relaxed);
+
+    return snapshot;
+}
+
+void Histogram::reset()
+{
+    for (std::atomic<Uint64>& bucketCount : bucketCounts) {
+        bucketCount.store(0, std::memory_order_relaxed);
+    }
+    count.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+}
+
+std::size_t Histogram::getBucketIndex(Uint64 value)
+{
+    if (value <= 1) {
+        return 0;
+    }
+
+    // The bucket is the number of bits needed to hold (value - 1), since
+    // each bucket's upper bound is inclusive.
+    std::size_t bucketIndex{
+        static_cast<std::size_t>(std::bit_width(value - 1))};
+    return (bucketIndex < BUCKET_COUNT) ? bucketIndex : (BUCKET_COUNT - 1);
+}
+
+Uint64 Histogram::getBucketUpperBound(std::size_t bucketIndex)
+{
+    AM_ASSERT(bucketIndex < BUCKET_COUNT, "Bucket index out of bounds.");
+    if (bucketIndex == (BUCKET_COUNT - 1)) {
+        return UINT64_MAX;
+    }
+
+    return (static_cast<Uint64>(1) << bucketIndex);
+}
+
+Uint64 Histogram::Snapshot::getPercentile(double percentile) const
+{
+    if (count == 0) {
+        return 0;
+    }
+
+    // Find the first bucket where the running count reaches the target.
+    Uint64 targetCount{static_cast<Uint64>(percentile * count)};
+    if (targetCount == 0) {
+        targetCount = 1;
+    }
+    Uint64 runningCount{0};
+    for (std::size_t i = 0; i < BUCKET_COUNT; ++i) {
+        runningCount += bucketCounts[i];
+        if (runningCount >= targetCount) {
+            return getBucketUpperBound(i);
+        }
+    }
+
+    return getBucketUpperBound(BUCKET_COUNT - 1);
+}
+
+} // End namespace AM
@@ -6,45 +6,54 @@ namespace AM
 IDPool::IDPool(unsigned int inPoolSize)
 : poolSize(inPoolSize)
 , containerSize(poolSize + SAFETY_BUFFER)
-, lastAddedIndex(0)
 , reservedIDCount(0)
 , IDs(containerSize)
+, freeIDs(containerSize)
+, freeHead(0)
+, freeCount(containerSize)
 {
+    // Fill the ring, starting at 1 so that 0 is the last ID to be given out.
+    for (unsigned int i = 0; i < containerSize; ++i) {
+        freeIDs[i] = ((i + 1) % containerSize);
+    }
 }
 
 unsigned int IDPool::reserveID()
 {
-    if (reservedIDCount > poolSize) {
+    if ((reservedIDCount > poolSize) || (freeCount == 0)) {
         LOG_FATAL("Tried to reserve ID when all were taken.");
         return 0;
     }
 
-    // Find the next empty index.
-    for (unsigned int i = 1; i < poolSize; ++i) {
-        // If this index is false (ID is unused).
-        unsigned int index{(lastAddedIndex + i) % containerSize};
-        if (!IDs[index]) {
-            IDs[index] = true;
-            lastAddedIndex = index;
-            reservedIDCount++;
-
-            return index;
-        }
-    }
+    // Pop the oldest free ID off the front of the ring.
+    unsigned int ID{freeIDs[freeHead]};
+    freeHead = ((freeHead + 1) % containerSize);
+    freeCount--;
 
-    LOG_FATAL("Couldn't find an empty index when one should exist.");
-    return 0;
+    IDs[ID] = true;
+    reservedIDCount++;
+
+    return ID;
 }
 
 void IDPool::freeID(unsigned int ID)
 {
-    if (IDs[ID]) {
+    if ((ID < containerSize) && IDs[ID]) {
         IDs[ID] = false;
         reservedIDCount--;
+
+        // Push the ID onto the back of the ring.
+        freeIDs[(freeHead + freeCount) % containerSize] = ID;
+        freeCount++;
     }
     else {
         LOG_FATAL("Tried to free an unused ID.");
     }
 }
 
+unsigned int IDPool::getContainerSize() const
+{
+    return containerSize;
+}
+
 } // namespace AM
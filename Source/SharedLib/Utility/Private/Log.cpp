@@ -1,4 +1,13 @@
 #include "Log.h"
+#include <SDL_timer.h>
+#include <array>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <atomic>
 #include <cstdio>
 #include <cstdarg>
 
@@ -6,94 +15,499 @@ namespace AM
 {
 const std::atomic<Uint32>* Log::currentTickPtr = nullptr;
 std::atomic<bool> Log::tickPtrIsRegistered = false;
-FILE* logFilePtr = nullptr;
+std::atomic<Log::Level> Log::minLevel = Log::Level::Info;
+std::atomic<Uint64> Log::droppedMessageCount = 0;
+std::atomic<Uint64> Log::suppressedMessageCount = 0;
 
-void Log::registerCurrentTickPtr(const std::atomic<Uint32>* inCurrentTickPtr)
+namespace
 {
-    currentTickPtr = inCurrentTickPtr;
-    tickPtrIsRegistered = true;
-}
+/**
+ * A single formatted log message.
+ *
+ * Fixed-size, so that producers never allocate.
+ */
+struct LogRecord {
+    Log::Level level{Log::Level::Info};
+
+    /** The sim tick that the message was logged during. */
+    Uint32 tick{0};
+
+    const char* fileName{nullptr};
+
+    int line{0};
 
-void Log::info(const char* expression, ...)
+    /** The number of messages from the same call site that were suppressed
+        before this one. */
+    Uint32 suppressedCount{0};
+
+    std::array<char, Log::MAX_MESSAGE_LENGTH> text{};
+};
+
+/**
+ * A single-producer, single-consumer ring of log records.
+ *
+ * Each logging thread owns one ring. The producer is the owning thread,
+ * the consumer is whoever holds LogWriter::writeMutex.
+ */
+class LogRing
 {
-    // If the app hasn't registered a tick count, default to 0.
-    Uint32 currentTick = 0;
-    if (tickPtrIsRegistered) {
-        currentTick = *currentTickPtr;
+public:
+    /** The max number of records that can be waiting to be written.
+        Must be a power of 2. */
+    static constexpr std::size_t CAPACITY{256};
+
+    /**
+     * Returns the next free record, or nullptr if the ring is full.
+     * If non-null, the record must be published with endPush().
+     */
+    LogRecord* beginPush()
+    {
+        std::size_t currentTail{tail.load(std::memory_order_relaxed)};
+        if ((currentTail - head.load(std::memory_order_acquire)) == CAPACITY) {
+            return nullptr;
+        }
+
+        return &(records[currentTail & (CAPACITY - 1)]);
     }
 
-    // Get the va_list into arg.
-    std::va_list arg;
-    va_start(arg, expression);
+    /**
+     * Publishes the record that was returned by beginPush().
+     */
+    void endPush()
+    {
+        tail.store((tail.load(std::memory_order_relaxed) + 1),
+                   std::memory_order_release);
+    }
+
+    /**
+     * Calls writeRecord on each published record, then frees them.
+     */
+    template<typename Func>
+    void drain(Func&& writeRecord)
+    {
+        std::size_t currentHead{head.load(std::memory_order_relaxed)};
+        std::size_t currentTail{tail.load(std::memory_order_acquire)};
+        while (currentHead != currentTail) {
+            writeRecord(records[currentHead & (CAPACITY - 1)]);
+            currentHead++;
+        }
+
+        head.store(currentHead, std::memory_order_release);
+    }
+
+    /** If true, a thread is currently using this ring. When a thread exits,
+        its ring is released to be reused by the next new thread. */
+    std::atomic<bool> isOwned{true};
+
+    /** The number of messages that were dropped since the last drain, due
+        to this ring being full. */
+    std::atomic<Uint64> droppedCount{0};
+
+private:
+    std::array<LogRecord, CAPACITY> records{};
 
-    // If enabled, write to file.
-    if (logFilePtr != nullptr) {
-        // Copy the va_list since it's undefined to use it twice.
-        std::va_list argCopy;
-        va_copy(argCopy, arg);
+    /** The index of the next record to be written out. */
+    std::atomic<std::size_t> head{0};
 
-        std::fprintf(logFilePtr, "Tick %u: ", currentTick);
-        std::vfprintf(logFilePtr, expression, argCopy);
-        std::fprintf(logFilePtr, "\n");
-        std::fflush(logFilePtr);
+    /** The index of the next record to be pushed. */
+    std::atomic<std::size_t> tail{0};
+};
 
-        va_end(argCopy);
+/**
+ * Owns each thread's ring, and the background thread that writes them out.
+ */
+class LogWriter
+{
+public:
+    /** How often the background thread writes out queued messages. */
+    static constexpr std::chrono::milliseconds WRITE_PERIOD{5};
+
+    /**
+     * Returns the writer, creating it if necessary.
+     *
+     * Note: The writer is intentionally never destroyed, so that messages
+     *       logged during static destruction still have somewhere to go.
+     */
+    static LogWriter& get()
+    {
+        static LogWriter* writer{new LogWriter()};
+        return *writer;
     }
 
-    // Write to stdout.
-    std::printf("Tick %u: ", currentTick);
-    std::vprintf(expression, arg);
-    std::printf("\n");
-    std::fflush(stdout);
+    /**
+     * Returns a ring for the calling thread to use, reusing a released ring
+     * if one is available.
+     */
+    LogRing& acquireRing()
+    {
+        std::scoped_lock lock{ringsMutex};
+        for (std::unique_ptr<LogRing>& ring : rings) {
+            bool expected{false};
+            if (ring->isOwned.compare_exchange_strong(expected, true)) {
+                return *ring;
+            }
+        }
 
-    va_end(arg);
+        rings.push_back(std::make_unique<LogRing>());
+        return *(rings.back());
+    }
+
+    /**
+     * Writes out every queued message.
+     */
+    void drain()
+    {
+        std::scoped_lock lock{writeMutex};
+
+        // Grab the current rings, so that we don't block new threads from
+        // getting a ring while we do file I/O.
+        // Note: Rings are never freed, so the pointers stay valid.
+        {
+            std::scoped_lock ringsLock{ringsMutex};
+            drainRings.clear();
+            for (std::unique_ptr<LogRing>& ring : rings) {
+                drainRings.push_back(ring.get());
+            }
+        }
+
+        Uint64 droppedCount{0};
+        for (LogRing* ring : drainRings) {
+            ring->drain(
+                [this](const LogRecord& record) { writeRecord(record); });
+            droppedCount += ring->droppedCount.exchange(0);
+        }
+
+        if (droppedCount > 0) {
+            writeLine("Dropped %llu log messages (queue was full).\n",
+                      static_cast<unsigned long long>(droppedCount));
+        }
+
+        std::fflush(stdout);
+        if (logFilePtr != nullptr) {
+            std::fflush(logFilePtr);
+        }
+    }
+
+    /**
+     * Writes out the given record immediately, skipping the rings.
+     * Used after the background thread has stopped.
+     */
+    void writeDirect(const LogRecord& record)
+    {
+        std::scoped_lock lock{writeMutex};
+        writeRecord(record);
+
+        std::fflush(stdout);
+        if (logFilePtr != nullptr) {
+            std::fflush(logFilePtr);
+        }
+    }
+
+    void openLogFile(const std::string& fileName)
+    {
+        std::scoped_lock lock{writeMutex};
+        logFilePtr = std::fopen(fileName.c_str(), "w");
+        if (logFilePtr == nullptr) {
+            std::printf("Failed to open log file for writing.\n");
+        }
+    }
+
+    /**
+     * Returns true if the background thread is writing out queued messages.
+     */
+    bool isRunning() const { return !exitRequested; }
+
+    /**
+     * Call after pushing a record. If stop() ran while we were pushing, its
+     * final drain may have missed our record, so this writes it out.
+     */
+    void drainIfStopped()
+    {
+        // Note: This pairs with the fence in stop(). Either we see that
+        //       we've stopped, or stop()'s drain sees our record.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (exitRequested) {
+            drain();
+        }
+    }
+
+private:
+    LogWriter()
+    : rings{}
+    , logFilePtr{nullptr}
+    , drainRings{}
+    , writeThreadObj{}
+    , exitRequested{false}
+    {
+        writeThreadObj = std::thread(&LogWriter::writeLoop, this);
+
+        // Make sure any queued messages are written before we exit.
+        std::atexit([] { LogWriter::get().stop(); });
+    }
+
+    /**
+     * Stops the background thread and writes out any queued messages.
+     */
+    void stop()
+    {
+        {
+            std::scoped_lock lock{wakeMutex};
+            exitRequested = true;
+        }
+        wakeCondVar.notify_one();
+        writeThreadObj.join();
+
+        // Note: See drainIfStopped().
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        drain();
+    }
+
+    /**
+     * Thread function. Periodically writes out any queued messages.
+     */
+    void writeLoop()
+    {
+        std::unique_lock lock{wakeMutex};
+        while (!exitRequested) {
+            wakeCondVar.wait_for(lock, WRITE_PERIOD);
+
+            lock.unlock();
+            drain();
+            lock.lock();
+        }
+    }
+
+    /**
+     * Formats the given record and writes it to stdout and the log file.
+     * writeMutex must be held.
+     */
+    void writeRecord(const LogRecord& record)
+    {
+        if (record.level >= Log::Level::Error) {
+            writeLine("Error at file: %s, line: %d, during tick: %u\n",
+                      record.fileName, record.line, record.tick);
+        }
+        else {
+            writeLine("Tick %u: %s", record.tick,
+                      getLevelPrefix(record.level));
+        }
+
+        if (record.suppressedCount > 0) {
+            writeLine("%s (suppressed %u similar messages)\n",
+                      record.text.data(), record.suppressedCount);
+        }
+        else {
+            writeLine("%s\n", record.text.data());
+        }
+    }
+
+    /**
+     * Prints the given string to stdout and the log file.
+     * writeMutex must be held.
+     */
+    void writeLine(const char* expression, ...)
+    {
+        std::va_list arg;
+        va_start(arg, expression);
+
+        // If enabled, write to file.
+        if (logFilePtr != nullptr) {
+            // Copy the va_list since it's undefined to use it twice.
+            std::va_list argCopy;
+            va_copy(argCopy, arg);
+            std::vfprintf(logFilePtr, expression, argCopy);
+            va_end(argCopy);
+        }
+
+        // Write to stdout.
+        std::vprintf(expression, arg);
+
+        va_end(arg);
+    }
+
+    static const char* getLevelPrefix(Log::Level level)
+    {
+        switch (level) {
+            case Log::Level::Debug:
+                return "Debug: ";
+            case Log::Level::Warning:
+                return "Warning: ";
+            default:
+                return "";
+        }
+    }
+
+    /** Each thread's ring. Rings are never freed, only released to be
+        reused. */
+    std::vector<std::unique_ptr<LogRing>> rings;
+    std::mutex ringsMutex;
+
+    /** If non-null, messages are also written to this file. */
+    FILE* logFilePtr;
+
+    /** Serializes writing to stdout and the log file. */
+    std::mutex writeMutex;
+
+    /** The rings that drain() is currently writing out. Guarded by
+        writeMutex. */
+    std::vector<LogRing*> drainRings;
+
+    std::thread writeThreadObj;
+    std::atomic<bool> exitRequested;
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondVar;
+};
+
+/**
+ * Releases the calling thread's ring when the thread exits.
+ */
+struct ThreadRingHandle {
+    LogRing* ring{nullptr};
+
+    ~ThreadRingHandle()
+    {
+        if (ring != nullptr) {
+            ring->isOwned = false;
+        }
+    }
+};
+
+LogRing& getThreadRing(LogWriter& writer)
+{
+    thread_local ThreadRingHandle handle{};
+    if (handle.ring == nullptr) {
+        handle.ring = &(writer.acquireRing());
+    }
+
+    return *(handle.ring);
 }
 
-void Log::error(const char* fileName, int line, const char* expression, ...)
+} // End anonymous namespace
+
+bool Log::Callsite::shouldLog(Uint32& outSuppressedCount)
 {
-    // If the app hasn't registered a tick count, default to 0.
-    Uint32 currentTick = 0;
-    if (currentTickPtr != nullptr) {
-        currentTick = *currentTickPtr;
+    static const Uint64 PERIOD_COUNTS{static_cast<Uint64>(
+        RATE_LIMIT_PERIOD_S
+        * static_cast<double>(SDL_GetPerformanceFrequency()))};
+
+    // If the current period has passed, start a new one.
+    // Note: If multiple threads race here, a few extra messages may get
+    //       through. That's fine, we just need to prevent floods.
+    Uint64 currentTime{SDL_GetPerformanceCounter()};
+    Uint64 currentPeriodStart{periodStart.load(std::memory_order_relaxed)};
+    if ((currentTime - currentPeriodStart) >= PERIOD_COUNTS) {
+        if (periodStart.compare_exchange_strong(currentPeriodStart,
+                                                currentTime)) {
+            periodCount = 0;
+        }
     }
 
-    // Get the va_list into arg.
-    std::va_list arg;
-    va_start(arg, expression);
+    if (periodCount.fetch_add(1, std::memory_order_relaxed)
+        < RATE_LIMIT_MESSAGES) {
+        outSuppressedCount = suppressedCount.exchange(0);
+        return true;
+    }
+    else {
+        suppressedCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+}
 
-    // If enabled, write to file.
-    if (logFilePtr != nullptr) {
-        // Copy the va_list since it's undefined to use it twice.
-        std::va_list argCopy;
-        va_copy(argCopy, arg);
+void Log::registerCurrentTickPtr(const std::atomic<Uint32>* inCurrentTickPtr)
+{
+    currentTickPtr = inCurrentTickPtr;
+    tickPtrIsRegistered = true;
+}
 
-        std::fprintf(logFilePtr,
-                     "Error at file: %s, line: %d, during tick: %u\n", fileName,
-                     line, currentTick);
-        std::vfprintf(logFilePtr, expression, argCopy);
-        std::fprintf(logFilePtr, "\n");
-        std::fflush(logFilePtr);
+void Log::write(Level level, Callsite* callsite, const char* fileName,
+                int line, const char* expression, ...)
+{
+    if (level < minLevel.load(std::memory_order_relaxed)) {
+        return;
+    }
 
-        va_end(argCopy);
+    // If this call site is flooding, suppress the message.
+    Uint32 suppressedCount{0};
+    if ((callsite != nullptr) && !(callsite->shouldLog(suppressedCount))) {
+        suppressedMessageCount.fetch_add(1, std::memory_order_relaxed);
+        return;
     }
 
-    // Write to stdout.
-    std::printf("Error at file: %s, line: %d, during tick: %u\n", fileName,
-                line, currentTick);
-    std::vprintf(expression, arg);
-    std::printf("\n");
-    std::fflush(stdout);
+    // Get a record to write into.
+    // Note: We format the message here instead of on the writer thread,
+    //       since the arguments may not outlive this call.
+    LogWriter& writer{LogWriter::get()};
+    bool isError{level >= Level::Error};
+    LogRecord directRecord{};
+    LogRing* ring{nullptr};
+    LogRecord* record{&directRecord};
+    if (writer.isRunning()) {
+        ring = &(getThreadRing(writer));
+        record = ring->beginPush();
+
+        // If the ring is full and this is an error, make room for it.
+        if ((record == nullptr) && isError) {
+            writer.drain();
+            record = ring->beginPush();
+        }
+
+        if (record == nullptr) {
+            ring->droppedCount.fetch_add(1, std::memory_order_relaxed);
+            droppedMessageCount.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    // If the app hasn't registered a tick count, default to 0.
+    record->level = level;
+    record->tick = (tickPtrIsRegistered ? currentTickPtr->load() : 0);
+    record->fileName = fileName;
+    record->line = line;
+    record->suppressedCount = suppressedCount;
 
+    std::va_list arg;
+    va_start(arg, expression);
+    std::vsnprintf(record->text.data(), record->text.size(), expression, arg);
     va_end(arg);
+
+    if (ring == nullptr) {
+        writer.writeDirect(*record);
+        return;
+    }
+    ring->endPush();
+
+    // Errors may be followed by an abort, so write them out immediately.
+    if (isError) {
+        writer.drain();
+    }
+    else {
+        writer.drainIfStopped();
+    }
+}
+
+void Log::flush()
+{
+    LogWriter::get().drain();
 }
 
 void Log::enableFileLogging(const std::string& fileName)
 {
-    // Open the log file.
-    logFilePtr = fopen(fileName.c_str(), "w");
-    if (logFilePtr == nullptr) {
-        std::printf("Failed to open log file for writing.\n");
-    }
+    LogWriter::get().openLogFile(fileName);
+}
+
+void Log::setMinLevel(Level inMinLevel)
+{
+    minLevel = inMinLevel;
+}
+
+Uint64 Log::getDroppedMessageCount()
+{
+    return droppedMessageCount;
+}
+
+Uint64 Log::getSuppressedMessageCount()
+{
+    return suppressedMessageCount;
 }
 
 } // namespace AM
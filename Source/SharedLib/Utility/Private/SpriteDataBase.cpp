@@ -52,6 +52,16 @@ const Sprite& SpriteDataBase::get(const std::string& stringID) const
     return *(it->second);
 }
 
+const Sprite* SpriteDataBase::find(const std::string& stringID) const
+{
+    auto it = stringMap.find(stringID);
+    if (it == stringMap.end()) {
+        return nullptr;
+    }
+
+    return it->second;
+}
+
 const Sprite& SpriteDataBase::get(int numericID) const
 {
     if (numericID == EMPTY_SPRITE_ID) {
@@ -0,0 +1,131 @@
+#include "SystemProfiler.h"
+#include "Log.h"
+#include "AMAssert.h"
+#include <SDL_timer.h>
+#include <algorithm>
+
+namespace AM
+{
+SystemProfiler::ScopedTimer::ScopedTimer(SystemProfiler& inProfiler,
+                                         std::size_t inSystemIndex)
+: profiler{inProfiler}
+, systemIndex{inSystemIndex}
+, startTime{SDL_GetPerformanceCounter()}
+{
+}
+
+SystemProfiler::ScopedTimer::~ScopedTimer()
+{
+    Uint64 durationUs{((SDL_GetPerformanceCounter() - startTime) * 1'000'000)
+                      / SDL_GetPerformanceFrequency()};
+    profiler.recordDuration(systemIndex,
+                            static_cast<Uint32>(
+                                std::min(durationUs, Uint64{UINT32_MAX})));
+}
+
+SystemProfiler::SystemProfiler(
+    std::string_view inDebugName, double inReportPeriodS,
+    std::initializer_list<std::string_view> systemNames)
+: debugName{inDebugName}
+, reportPeriodS{inReportPeriodS}
+, reportTimer{}
+, systemData{}
+, systemCount{systemNames.size()}
+, latestReport{}
+, sortBuffer{}
+{
+    if (systemCount > MAX_SYSTEMS) {
+        LOG_FATAL("Too many systems for profiler: %s", debugName.c_str());
+    }
+
+    std::size_t systemIndex{0};
+    for (std::string_view systemName : systemNames) {
+        systemData[systemIndex].name = systemName;
+        systemIndex++;
+    }
+
+    sortBuffer.reserve(SAMPLE_COUNT);
+
+    // Prime the timer so we don't get a giant value on the first usage.
+    reportTimer.updateSavedTime();
+}
+
+void SystemProfiler::recordDuration(std::size_t systemIndex,
+                                    Uint32 durationUs)
+{
+    AM_ASSERT(systemIndex < systemCount, "Invalid system index.");
+    SystemData& data{systemData[systemIndex]};
+
+    // Write the duration into the ring.
+    // Note: Only one thread records for a given profiler, so we don't need
+    //       anything stronger. Readers may see a slightly stale ring.
+    Uint64 sampleCount{data.sampleCount.load(std::memory_order_relaxed)};
+    data.durationsUs[sampleCount % SAMPLE_COUNT].store(
+        durationUs, std::memory_order_relaxed);
+    data.sampleCount.store((sampleCount + 1), std::memory_order_release);
+
+    if (durationUs > data.maxUs.load(std::memory_order_relaxed)) {
+        data.maxUs.store(durationUs, std::memory_order_relaxed);
+    }
+    data.runCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SystemProfiler::update()
+{
+    // If it's time to report, do so.
+    if (reportTimer.getDeltaSeconds(false) >= reportPeriodS) {
+        buildReport();
+        logReport();
+        reportTimer.updateSavedTime();
+    }
+}
+
+void SystemProfiler::buildReport()
+{
+    latestReport.resize(systemCount);
+    for (std::size_t i = 0; i < systemCount; ++i) {
+        SystemData& data{systemData[i]};
+        SystemReport& report{latestReport[i]};
+        report.name = data.name;
+
+        // Copy out the system's recent durations.
+        std::size_t sampleCount{static_cast<std::size_t>(std::min(
+            data.sampleCount.load(std::memory_order_acquire),
+            Uint64{SAMPLE_COUNT}))};
+        sortBuffer.clear();
+        for (std::size_t j = 0; j < sampleCount; ++j) {
+            sortBuffer.push_back(
+                data.durationsUs[j].load(std::memory_order_relaxed));
+        }
+
+        // Find the percentiles.
+        report.p50Us = 0;
+        report.p99Us = 0;
+        if (!(sortBuffer.empty())) {
+            std::sort(sortBuffer.begin(), sortBuffer.end());
+            report.p50Us = sortBuffer[(sortBuffer.size() - 1) / 2];
+            report.p99Us = sortBuffer[((sortBuffer.size() - 1) * 99) / 100];
+        }
+
+        report.maxUs = data.maxUs.exchange(0, std::memory_order_relaxed);
+        report.runCount = data.runCount.exchange(0, std::memory_order_relaxed);
+    }
+}
+
+const std::vector<SystemProfiler::SystemReport>&
+    SystemProfiler::getLatestReport() const
+{
+    return latestReport;
+}
+
+void SystemProfiler::logReport()
+{
+    LOG_INFO("%s system timings (p50/p99/max, in us):", debugName.c_str());
+    for (const SystemReport& report : latestReport) {
+        LOG_INFO("  %.*s: %u/%u/%u over %u runs",
+                 static_cast<int>(report.name.size()), report.name.data(),
+                 report.p50Us, report.p99Us, report.maxUs, report.runCount);
+    }
+}
+
+} // End namespace AM
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <SDL_stdinc.h>
+#include <atomic>
+#include <array>
+#include <cstddef>
+
+namespace AM
+{
+/**
+ * A thread-safe histogram with power-of-2 buckets.
+ *
+ * Bucket 0 holds values <= 1, and bucket i holds values in (2^(i-1), 2^i].
+ * The last bucket holds everything larger than the bucket before it.
+ *
+ * Recording is a few relaxed atomic increments, so it's cheap enough to do
+ * on hot paths. Values aren't stored, so percentiles are approximate (to the
+ * bucket's upper bound).
+ */
+class Histogram
+{
+public:
+    /** The number of buckets. With microsecond values, the last bounded
+        bucket covers up to ~4 seconds. */
+    static constexpr std::size_t BUCKET_COUNT{24};
+
+    /**
+     * A point-in-time copy of a histogram's data.
+     */
+    struct Snapshot {
+        /** The number of values that fell into each bucket. */
+        std::array<Uint64, BUCKET_COUNT> bucketCounts{};
+
+        /** The total number of recorded values. */
+        Uint64 count{0};
+
+        /** The sum of all recorded values. */
+        Uint64 sum{0};
+
+        /**
+         * Returns the upper bound of the bucket that contains the given
+         * percentile (0 - 1) of the recorded values. Returns 0 if no values
+         * were recorded.
+         */
+        Uint64 getPercentile(double percentile) const;
+    };
+
+    Histogram();
+
+    /**
+     * Records the given value.
+     */
+    void record(Uint64 value);
+
+    /**
+     * Returns a copy of the current data.
+     *
+     * Note: If values are being recorded concurrently, the copy may be
+     *       slightly inconsistent (e.g. count may not match the sum of
+     *       bucketCounts).
+     */
+    Snapshot getSnapshot() const;
+
+    /**
+     * Clears all recorded values.
+     */
+    void reset();
+
+    /**
+     * Returns the index of the bucket that the given value falls into.
+     */
+    static std::size_t getBucketIndex(Uint64 value);
+
+    /**
+     * Returns the largest value that falls into the given bucket.
+     * The last bucket returns UINT64_MAX.
+     */
+    static Uint64 getBucketUpperBound(std::size_t bucketIndex);
+
+private:
+    /** The number of values that have fallen into each bucket. */
+    std::array<std::atomic<Uint64>, BUCKET_COUNT> bucketCounts;
+
+    /** The total number of recorded values. */
+    std::atomic<Uint64> count;
+
+    /** The sum of all recorded values. */
+    std::atomic<Uint64> sum;
+};
+
+} // End namespace AM
@@ -8,28 +8,35 @@ namespace AM
 /**
  * Provides unique identifiers.
  *
- * TODO: Re-use of IDs is an issue (e.g. if client 0 disconnects and another
- *       client connects and is given ID 0, there may be old messages in the
- *       queues that refer to ID 0 that will be incorrectly applied to the new
- *       client).
- *       The current soft solution is to reserve more IDs than we need, so
- *       that we don't immediately re-use the same ID. The real solution is to
- *       copy EnTT by making the top ~n bytes of our ID an "iteration", which
- *       gets incremented when the ID is freed.
+ * Reserving and freeing are O(1). Free IDs are kept in a FIFO ring, so a
+ * freed ID goes to the back of the line.
+ *
+ * Note: Re-use of IDs can be an issue (e.g. if client 0 disconnects and
+ *       another client connects and is given ID 0, there may be old messages
+ *       in the queues that refer to ID 0 that will be incorrectly applied to
+ *       the new client).
+ *       The FIFO order, along with SAFETY_BUFFER, makes immediate re-use
+ *       unlikely. Users that need a hard guarantee should pair each ID with a
+ *       generation that gets incremented when the ID is freed (see the
+ *       server's ClientRegistry).
  */
 class IDPool
 {
 public:
+    /** Extra room so that we don't run into reuse issues when almost all IDs
+        are reserved.
+        Note: If this isn't sufficient, you can just make your pool much
+              larger than the number of IDs you plan on using. */
+    static constexpr unsigned int SAFETY_BUFFER = 100;
+
     IDPool(unsigned int inPoolSize);
 
     /**
-     * Reserves and returns the next empty ID.
+     * Reserves and returns the next free ID.
      *
      * Marches forward, e.g. if 0-10 were reserved and freed, 11 will still be
-     * the next reserved ID. After we reserve the last ID, we wrap back around.
-     * This, along with SAFETY_BUFFER, aims to remove situations where an ID
-     * was reserved, freed, and re-reserved while old data exists in the
-     * system.
+     * the next reserved ID. Freed IDs are given out again only after every
+     * ID that was free before them.
      */
     unsigned int reserveID();
 
@@ -38,29 +45,35 @@ public:
      */
     void freeID(unsigned int ID);
 
-private:
-    /** Extra room so that we don't run into reuse issues when almost all IDs
-        are reserved.
-        Note: If this isn't sufficient, you can just make your pool much
-              larger than the number of IDs you plan on using. */
-    static constexpr unsigned int SAFETY_BUFFER = 100;
+    /**
+     * Returns the number of IDs in our container. All IDs that we give out
+     * are less than this value.
+     */
+    unsigned int getContainerSize() const;
 
+private:
     /** The maximum number of IDs that we can give out. */
     unsigned int poolSize;
 
     /** The size of our container. Equal to poolSize + SAFETY_BUFFER. */
     unsigned int containerSize;
 
-    /** The last index that we added an ID to. */
-    unsigned int lastAddedIndex;
-
     /** The number of currently reserved IDs. */
     unsigned int reservedIDCount;
 
     /**
-     * If ID 'x' is available, IDs[x] will be true. Else, it will be false.
+     * If ID 'x' is reserved, IDs[x] will be true. Else, it will be false.
      */
     std::vector<bool> IDs;
+
+    /** A ring of free IDs, in the order that they'll be given out. */
+    std::vector<unsigned int> freeIDs;
+
+    /** The index in freeIDs of the next ID to give out. */
+    unsigned int freeHead;
+
+    /** The number of IDs in freeIDs. */
+    unsigned int freeCount;
 };
 
 } // namespace AM
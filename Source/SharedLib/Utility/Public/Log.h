@@ -2,33 +2,47 @@
 
 #include <SDL_stdinc.h>
 #include <atomic>
+#include <cstddef>
 #include <cstdlib>
 #include <string>
 
 /**
  * Use these macros instead of calling the functions directly.
+ *
+ * Each call site gets its own rate limiter (see Log::Callsite). LOG_FATAL
+ * isn't rate limited, since it only happens once.
  */
-#define LOG_INFO(...)                                                          \
+#define AM_LOG_WITH_LEVEL(level, ...)                                          \
     do {                                                                       \
-        AM::Log::info(__VA_ARGS__);                                            \
+        static AM::Log::Callsite amLogCallsite{};                              \
+        AM::Log::write(level, &amLogCallsite, __FILE__, __LINE__,              \
+                       __VA_ARGS__);                                           \
     } while (false)
 
+#define LOG_DEBUG(...)                                                         \
+    AM_LOG_WITH_LEVEL(AM::Log::Level::Debug, __VA_ARGS__)
+
+#define LOG_INFO(...)                                                          \
+    AM_LOG_WITH_LEVEL(AM::Log::Level::Info, __VA_ARGS__)
+
+#define LOG_WARNING(...)                                                       \
+    AM_LOG_WITH_LEVEL(AM::Log::Level::Warning, __VA_ARGS__)
+
 #ifdef NDEBUG
 #define LOG_ERROR(...)                                                         \
-    do {                                                                       \
-        AM::Log::error(__FILE__, __LINE__, __VA_ARGS__);                       \
-    } while (false)
+    AM_LOG_WITH_LEVEL(AM::Log::Level::Error, __VA_ARGS__)
 #else
 #define LOG_ERROR(...)                                                         \
     do {                                                                       \
-        AM::Log::error(__FILE__, __LINE__, __VA_ARGS__);                       \
+        AM_LOG_WITH_LEVEL(AM::Log::Level::Error, __VA_ARGS__);                 \
         std::abort();                                                          \
     } while (false)
 #endif
 
 #define LOG_FATAL(...)                                                         \
     do {                                                                       \
-        AM::Log::error(__FILE__, __LINE__, __VA_ARGS__);                       \
+        AM::Log::write(AM::Log::Level::Fatal, nullptr, __FILE__, __LINE__,     \
+                       __VA_ARGS__);                                           \
         std::abort();                                                          \
     } while (false)
 
@@ -37,8 +51,10 @@ namespace AM
 /**
  * Facilitates logging info and errors to stdout or a log file.
  *
- * Our logging system has 3 levels:
+ * Our logging system has 5 levels:
+ *   LOG_DEBUG: Print the given string, if the min level allows it.
  *   LOG_INFO: Print the given string in release and debug.
+ *   LOG_WARNING: Same as LOG_INFO, but marked as a warning.
  *   LOG_ERROR: Print file name, line number, and the given string. In debug
  *             this will also std::abort().
  *   LOG_FATAL: Print file name, line number, and the given string. In debug
@@ -49,31 +65,105 @@ namespace AM
  * errors.
  * Generally, we'll start error cases as LOG_FATAL, then switch them to
  * LOG_ERROR if there's some expected failure that we can't yet fix.
+ *
+ * Logging is asynchronous: the calling thread formats its message into a
+ * fixed-size record in its own lock-free ring, and a background thread
+ * writes the records out. Errors are written out before returning, since
+ * we may be about to abort.
+ * If a thread's ring is full, its messages are dropped and counted. If a
+ * call site logs more than RATE_LIMIT_MESSAGES times per
+ * RATE_LIMIT_PERIOD_S, the extra messages are suppressed and counted.
  */
 class Log
 {
 public:
+    /**
+     * The severity of a log message.
+     */
+    enum class Level : Uint8 { Debug, Info, Warning, Error, Fatal };
+
+    /** The max length of a single message. Longer messages are truncated. */
+    static constexpr std::size_t MAX_MESSAGE_LENGTH{224};
+
+    /** The max number of messages that a single call site may log per
+        RATE_LIMIT_PERIOD_S. */
+    static constexpr Uint32 RATE_LIMIT_MESSAGES{10};
+    static constexpr double RATE_LIMIT_PERIOD_S{1};
+
+    /**
+     * Rate limits the messages from a single call site.
+     * The LOG_ macros give each call site a static instance of this.
+     */
+    class Callsite
+    {
+    public:
+        /**
+         * Returns true if the call site may log a message now.
+         *
+         * @param outSuppressedCount  If returning true, set to the number of
+         *                            messages that were suppressed since
+         *                            the last one that was logged.
+         */
+        bool shouldLog(Uint32& outSuppressedCount);
+
+    private:
+        /** The SDL performance counter value from when the current rate
+            limit period started. */
+        std::atomic<Uint64> periodStart{0};
+
+        /** The number of messages that were attempted in this period. */
+        std::atomic<Uint32> periodCount{0};
+
+        /** The number of messages that were suppressed since the last one
+            that was logged. */
+        std::atomic<Uint32> suppressedCount{0};
+    };
+
     static void
         registerCurrentTickPtr(const std::atomic<Uint32>* inCurrentTickPtr);
 
     /**
-     * Prints the given info to stdout (and a file, if enableFileLogging() was
-     * called.), then flushes the buffer.
+     * Queues the given message to be printed to stdout (and a file, if
+     * enableFileLogging() was called.).
+     *
+     * Messages at Level::Error and above are written before this returns.
+     *
+     * @param callsite  The call site's rate limiter. If nullptr, the message
+     *                  isn't rate limited.
+     * @param fileName  The file that the message came from. Only printed for
+     *                  errors.
+     * @param line  The line that the message came from. Only printed for
+     *              errors.
      */
-    static void info(const char* expression, ...);
+    static void write(Level level, Callsite* callsite, const char* fileName,
+                      int line, const char* expression, ...);
 
     /**
-     * Prints the given info to stdout (and a file, if enableFileLogging() was
-     * called.), then flushes the buffer.
+     * Blocks until every queued message has been written.
      */
-    static void error(const char* fileName, int line, const char* expression,
-                      ...);
+    static void flush();
 
     /**
      * Opens a file with the given file name and enables file logging.
      */
     static void enableFileLogging(const std::string& fileName);
 
+    /**
+     * Messages below the given level will be discarded. Defaults to Info.
+     */
+    static void setMinLevel(Level inMinLevel);
+
+    /**
+     * Returns the number of messages that were dropped because a thread's
+     * ring was full.
+     */
+    static Uint64 getDroppedMessageCount();
+
+    /**
+     * Returns the number of messages that were suppressed by rate limiting.
+     */
+    static Uint64 getSuppressedMessageCount();
+
 private:
     /**
      * Should be passed the sim's tick through registerCurrentTickPtr.
@@ -83,6 +173,15 @@ private:
 
     /** Used to safely test if currentTickPtr is ready to use. */
     static std::atomic<bool> tickPtrIsRegistered;
+
+    /** Messages below this level are discarded. */
+    static std::atomic<Level> minLevel;
+
+    /** See getDroppedMessageCount(). */
+    static std::atomic<Uint64> droppedMessageCount;
+
+    /** See getSuppressedMessageCount(). */
+    static std::atomic<Uint64> suppressedMessageCount;
 };
 
 } /* End namespace AM */
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "SerializeBuffer.h"
+#include "BinaryBuffer.h"
 #include "Log.h"
 #include <SDL_stdinc.h>
 #include "bitsery/bitsery.h"
@@ -18,6 +19,7 @@ class Serialize
 {
 public:
     using OutputAdapter = bitsery::OutputBufferAdapter<SerializeBuffer>;
+    using GrowableOutputAdapter = bitsery::OutputBufferAdapter<BinaryBuffer>;
 
     /**
      * Serializes the given object, writing the serialized bytes into the given
@@ -54,6 +56,46 @@ public:
                 - startIndex);
     }
 
+    /**
+     * Serializes the given object in a single pass, growing the given buffer
+     * as needed.
+     *
+     * Unlike toBuffer(), doesn't require the buffer to be pre-sized, so
+     * there's no need to call measureSize() first. When done, the buffer is
+     * resized to end at the last serialized byte. Its capacity is kept, so
+     * re-using a buffer avoids re-allocating.
+     *
+     * @param outputBuffer  The buffer to store the serialized object data in.
+     * @param objectToSerialize  The object to serialize. Must be serializable.
+     * @param startIndex  Optional, how far into the buffer to start writing the
+     *                    serialized bytes. Bytes before this index are left
+     *                    alone (e.g. so a header can be filled in after).
+     * @return The number of bytes written into outputBuffer, not including
+     *         startIndex.
+     */
+    template<typename T>
+    static std::size_t toGrowableBuffer(BinaryBuffer& outputBuffer,
+                                        T& objectToSerialize,
+                                        std::size_t startIndex = 0)
+    {
+        // Make sure the buffer reaches the write offset.
+        if (outputBuffer.size() < startIndex) {
+            outputBuffer.resize(startIndex);
+        }
+
+        // Create the adapter manually so we can change the write offset.
+        GrowableOutputAdapter adapter{outputBuffer};
+        adapter.currentWritePos(startIndex);
+
+        // Serialize, then trim any extra space that the adapter grew by.
+        // Note: The return value will include the offset.
+        std::size_t endIndex{bitsery::quickSerialization<GrowableOutputAdapter>(
+            std::move(adapter), objectToSerialize)};
+        outputBuffer.resize(endIndex);
+
+        return (endIndex - startIndex);
+    }
+
     /**
      * Serializes the given object, writing the serialized bytes into the
      * given file.
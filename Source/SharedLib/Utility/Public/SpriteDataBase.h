@@ -40,6 +40,12 @@ public:
      */
     const Sprite& get(int numericID) const;
 
+    /**
+     * Returns the sprite with the given string ID, or nullptr if there isn't
+     * one.
+     */
+    const Sprite* find(const std::string& stringID) const;
+
     /**
      * Get a reference to the vector of all the sprites.
      */
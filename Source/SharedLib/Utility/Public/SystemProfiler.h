@@ -0,0 +1,169 @@
+#pragma once
+
+#include "Timer.h"
+#include <SDL_stdinc.h>
+#include <atomic>
+#include <array>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <initializer_list>
+#include <cstddef>
+
+namespace AM
+{
+/**
+ * A lightweight, always-on profiler for the systems that a simulation runs
+ * each tick.
+ *
+ * Each system's recent durations are kept in a ring. Every report period,
+ * the p50, p99, and max durations of each system are logged and saved, so
+ * that they can be read (e.g. by a simulation extension).
+ *
+ * Unlike Tracy, this doesn't need a viewer to be attached, so it's usable on
+ * production servers.
+ *
+ * Usage:
+ *   {
+ *       SystemProfiler::ScopedTimer timer{profiler, MY_SYSTEM_INDEX};
+ *       mySystem.run();
+ *   }
+ *   ...
+ *   profiler.update();
+ */
+class SystemProfiler
+{
+public:
+    /** The max number of systems that a profiler can track. */
+    static constexpr std::size_t MAX_SYSTEMS{32};
+
+    /** The number of recent durations that we keep for each system.
+        Percentiles are calculated from these. */
+    static constexpr std::size_t SAMPLE_COUNT{256};
+
+    /**
+     * A single system's timing data, over a report period.
+     */
+    struct SystemReport {
+        /** The system's name. */
+        std::string_view name{};
+
+        /** The 50th and 99th percentile durations, in microseconds, of the
+            system's recent runs. */
+        Uint32 p50Us{0};
+        Uint32 p99Us{0};
+
+        /** The longest duration, in microseconds, of the system's runs since
+            the last report. */
+        Uint32 maxUs{0};
+
+        /** The number of times that the system ran since the last report. */
+        Uint32 runCount{0};
+    };
+
+    /**
+     * Times the enclosing scope and records it for the given system.
+     */
+    class ScopedTimer
+    {
+    public:
+        ScopedTimer(SystemProfiler& inProfiler, std::size_t inSystemIndex);
+
+        ~ScopedTimer();
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        SystemProfiler& profiler;
+
+        std::size_t systemIndex;
+
+        /** The SDL performance counter value from when we were
+            constructed. */
+        Uint64 startTime;
+    };
+
+    /**
+     * @param inDebugName  The name to prefix our logged reports with.
+     * @param inReportPeriodS  How often, in seconds, to report.
+     * @param systemNames  The names of the systems to track. Systems are
+     *                     referred to by their index in this list.
+     */
+    SystemProfiler(std::string_view inDebugName, double inReportPeriodS,
+                   std::initializer_list<std::string_view> systemNames);
+
+    /**
+     * Records a single run of the given system.
+     */
+    void recordDuration(std::size_t systemIndex, Uint32 durationUs);
+
+    /**
+     * If enough time has passed, builds and logs a report.
+     *
+     * Should be called once per tick, after the systems have ran.
+     */
+    void update();
+
+    /**
+     * Builds a report from the current data, saving it as the latest
+     * report. Resets the max durations and run counts.
+     */
+    void buildReport();
+
+    /**
+     * Returns the most recent report, with one entry per system. Empty until
+     * the first report is built.
+     */
+    const std::vector<SystemReport>& getLatestReport() const;
+
+private:
+    /**
+     * A single system's recorded data.
+     */
+    struct SystemData {
+        /** The system's name. */
+        std::string name{};
+
+        /** The system's recent durations, in microseconds. */
+        std::array<std::atomic<Uint32>, SAMPLE_COUNT> durationsUs{};
+
+        /** The total number of durations that have been recorded. The next
+            duration is written at (sampleCount % SAMPLE_COUNT). */
+        std::atomic<Uint64> sampleCount{0};
+
+        /** The longest duration since the last report. */
+        std::atomic<Uint32> maxUs{0};
+
+        /** The number of runs since the last report. */
+        std::atomic<Uint32> runCount{0};
+    };
+
+    /**
+     * Logs latestReport.
+     */
+    void logReport();
+
+    /** The name to prefix our logged reports with. */
+    std::string debugName;
+
+    /** How often, in seconds, to report. */
+    double reportPeriodS;
+
+    /** Tracks how long it's been since our last report. */
+    Timer reportTimer;
+
+    /** Each system's data. The first systemCount elements are used. */
+    std::array<SystemData, MAX_SYSTEMS> systemData;
+
+    /** The number of systems that we're tracking. */
+    std::size_t systemCount;
+
+    /** See getLatestReport(). */
+    std::vector<SystemReport> latestReport;
+
+    /** Used while building a report, holds a copy of a system's durations. */
+    std::vector<Uint32> sortBuffer;
+};
+
+} // End namespace AM
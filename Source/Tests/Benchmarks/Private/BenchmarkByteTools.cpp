@@ -0,0 +1,64 @@
+#include "catch2/catch_all.hpp"
+#include "ByteTools.h"
+#include "BinaryBuffer.h"
+#include <random>
+#include <string>
+
+using namespace AM;
+
+namespace
+{
+/**
+ * Returns a buffer of the given size, filled with data that compresses
+ * roughly like our message batches: runs of repeated values mixed with
+ * random bytes.
+ */
+BinaryBuffer buildSourceBuffer(std::size_t size)
+{
+    std::mt19937 generator{12345};
+    std::uniform_int_distribution<int> byteDist{0, 255};
+    std::uniform_int_distribution<int> runDist{1, 16};
+
+    BinaryBuffer buffer(size);
+    std::size_t index{0};
+    while (index < size) {
+        // Add a random byte, then repeat it for a random run length.
+        Uint8 value{static_cast<Uint8>(byteDist(generator))};
+        std::size_t runLength{static_cast<std::size_t>(runDist(generator))};
+        for (std::size_t i = 0; (i < runLength) && (index < size); ++i) {
+            buffer[index++] = value;
+        }
+    }
+
+    return buffer;
+}
+
+} // End anonymous namespace
+
+TEST_CASE("BenchmarkByteTools")
+{
+    const std::size_t sourceSize{
+        GENERATE(as<std::size_t>{}, 1024, (8 * 1024), (64 * 1024))};
+    const std::string suffix{" - " + std::to_string(sourceSize) + " bytes"};
+
+    BinaryBuffer sourceBuffer{buildSourceBuffer(sourceSize)};
+    BinaryBuffer compressedBuffer(ByteTools::compressBound(sourceSize));
+
+    BENCHMARK("Compress" + suffix)
+    {
+        return ByteTools::compress(sourceBuffer.data(), sourceBuffer.size(),
+                                   compressedBuffer.data(),
+                                   compressedBuffer.size());
+    };
+
+    std::size_t compressedSize{ByteTools::compress(
+        sourceBuffer.data(), sourceBuffer.size(), compressedBuffer.data(),
+        compressedBuffer.size())};
+    BinaryBuffer decompressedBuffer(sourceSize);
+    BENCHMARK("Decompress" + suffix)
+    {
+        return ByteTools::decompress(compressedBuffer.data(), compressedSize,
+                                     decompressedBuffer.data(),
+                                     decompressedBuffer.size());
+    };
+}
@@ -0,0 +1,122 @@
+#include "catch2/catch_all.hpp"
+#include "EntityLocator.h"
+#include "entt/entity/registry.hpp"
+#include "Position.h"
+#include "BoundingBox.h"
+#include "Transforms.h"
+#include "SharedConfig.h"
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace AM;
+
+namespace
+{
+/** The map size, in tiles. */
+constexpr unsigned int MAP_X_LENGTH{128};
+constexpr unsigned int MAP_Y_LENGTH{128};
+
+/** The model-space bounds that we give each entity. */
+constexpr float HALF_TILE{SharedConfig::TILE_WORLD_WIDTH / 2.f};
+constexpr BoundingBox MODEL_BOUNDS{0, HALF_TILE, 0, HALF_TILE, 0, HALF_TILE};
+
+/**
+ * Returns the given number of random positions, spread across the map.
+ * Uses a fixed seed so results are comparable across runs.
+ */
+std::vector<Position> getRandomPositions(std::size_t count)
+{
+    std::mt19937 generator{12345};
+    std::uniform_real_distribution<float> xDist{
+        0, ((MAP_X_LENGTH - 1) * SharedConfig::TILE_WORLD_WIDTH)};
+    std::uniform_real_distribution<float> yDist{
+        0, ((MAP_Y_LENGTH - 1) * SharedConfig::TILE_WORLD_WIDTH)};
+
+    std::vector<Position> positions(count);
+    for (Position& position : positions) {
+        position = {xDist(generator), yDist(generator), 0};
+    }
+
+    return positions;
+}
+
+/**
+ * Creates the given number of entities at random positions and adds them to
+ * the locator.
+ */
+std::vector<entt::entity> addEntities(entt::registry& registry,
+                                      EntityLocator& entityLocator,
+                                      std::size_t count)
+{
+    std::vector<Position> positions{getRandomPositions(count)};
+    std::vector<entt::entity> entities(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        entities[i] = registry.create();
+        BoundingBox& boundingBox{registry.emplace<BoundingBox>(
+            entities[i],
+            Transforms::modelToWorldCentered(MODEL_BOUNDS, positions[i]))};
+        entityLocator.setEntityLocation(entities[i], boundingBox);
+    }
+
+    return entities;
+}
+
+} // End anonymous namespace
+
+TEST_CASE("BenchmarkEntityLocator")
+{
+    const std::size_t entityCount{
+        GENERATE(as<std::size_t>{}, 100, 1000, 10000)};
+    const std::string suffix{" - " + std::to_string(entityCount)
+                             + " entities"};
+
+    entt::registry registry;
+    EntityLocator entityLocator(registry);
+    entityLocator.setGridSize(MAP_X_LENGTH, MAP_Y_LENGTH);
+    std::vector<entt::entity> entities{
+        addEntities(registry, entityLocator, entityCount)};
+
+    // Move each entity to a new position, like a sim tick would.
+    std::vector<Position> newPositions{getRandomPositions(entityCount)};
+    BENCHMARK("Set location" + suffix)
+    {
+        for (std::size_t i = 0; i < entityCount; ++i) {
+            BoundingBox& boundingBox{
+                registry.get<BoundingBox>(entities[i])};
+            boundingBox = Transforms::modelToWorldCentered(MODEL_BOUNDS,
+                                                           newPositions[i]);
+            entityLocator.setEntityLocation(entities[i], boundingBox);
+        }
+    };
+
+    // Query an AOI-sized cylinder around the center of the map.
+    Position mapCenter{
+        ((MAP_X_LENGTH / 2) * SharedConfig::TILE_WORLD_WIDTH),
+        ((MAP_Y_LENGTH / 2) * SharedConfig::TILE_WORLD_WIDTH), 0};
+    const unsigned int radius{
+        static_cast<unsigned int>(SharedConfig::AOI_RADIUS)};
+    BENCHMARK("Query fine" + suffix)
+    {
+        return entityLocator.getEntitiesFine(mapCenter, radius).size();
+    };
+
+    BENCHMARK("Query coarse" + suffix)
+    {
+        return entityLocator.getEntitiesCoarse(mapCenter, radius).size();
+    };
+
+    // Each run removes a separate entity, so we add one per run on top of
+    // the base population.
+    BENCHMARK_ADVANCED("Remove" + suffix)(Catch::Benchmark::Chronometer meter)
+    {
+        std::vector<entt::entity> runEntities{
+            addEntities(registry, entityLocator,
+                        static_cast<std::size_t>(meter.runs()))};
+
+        meter.measure(
+            [&](int i) { entityLocator.removeEntity(runEntities[i]); });
+
+        registry.destroy(runEntities.begin(), runEntities.end());
+    };
+}
@@ -0,0 +1,34 @@
+#include "catch2/catch_all.hpp"
+#include <string_view>
+#include <vector>
+
+/**
+ * Runs the benchmarks.
+ *
+ * If no reporter is given on the command line, results are printed to the
+ * console and written to BenchmarkResults.json, so they can be compared
+ * across commits.
+ */
+int main(int argc, char* argv[])
+{
+    std::vector<char*> args(argv, (argv + argc));
+
+    // If the user didn't pick a reporter, add our defaults.
+    bool hasReporter{false};
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg{argv[i]};
+        if ((arg == "-r") || arg.starts_with("--reporter")) {
+            hasReporter = true;
+            break;
+        }
+    }
+
+    static char consoleArg[]{"--reporter=console"};
+    static char jsonArg[]{"--reporter=JSON::out=BenchmarkResults.json"};
+    if (!hasReporter) {
+        args.push_back(consoleArg);
+        args.push_back(jsonArg);
+    }
+
+    return Catch::Session().run(static_cast<int>(args.size()), args.data());
+}
@@ -0,0 +1,133 @@
+#include "catch2/catch_all.hpp"
+#include "MovementHelpers.h"
+#include "Tile.h"
+#include "TileExtent.h"
+#include "Position.h"
+#include "BoundingBox.h"
+#include "Transforms.h"
+#include "SharedConfig.h"
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace AM;
+
+namespace
+{
+/** The width of a tile, in world units. */
+constexpr float TILE_WIDTH{SharedConfig::TILE_WORLD_WIDTH};
+
+/**
+ * A minimal tile map that provides the interface resolveCollisions() needs.
+ *
+ * We use this instead of a real tile map, since those need SpriteData.json.
+ */
+class BenchmarkTileMap
+{
+public:
+    /**
+     * Builds a map where every tile has a floor layer with no bounding box,
+     * plus (layerCount - 1) layers with boxes.
+     * The boxes are stacked above MIN_BOX_Z, so entities on the ground never
+     * hit them and every layer gets checked.
+     */
+    BenchmarkTileMap(int xLength, int yLength, unsigned int layerCount)
+    : tileExtent{0, 0, xLength, yLength}
+    , tiles(static_cast<std::size_t>(xLength * yLength))
+    {
+        for (int y = 0; y < yLength; ++y) {
+            for (int x = 0; x < xLength; ++x) {
+                Tile& tile{tiles[(y * xLength) + x]};
+                tile.spriteLayers.resize(layerCount);
+
+                // Floor.
+                tile.spriteLayers[0].sprite.numericID = 0;
+                tile.spriteLayers[0].sprite.hasBoundingBox = false;
+
+                // Boxes.
+                float minX{x * TILE_WIDTH};
+                float minY{y * TILE_WIDTH};
+                for (unsigned int i = 1; i < layerCount; ++i) {
+                    Tile::SpriteLayer& layer{tile.spriteLayers[i]};
+                    layer.sprite.numericID = static_cast<int>(i);
+                    layer.sprite.hasBoundingBox = true;
+
+                    float minZ{MIN_BOX_Z + (i * TILE_WIDTH)};
+                    layer.worldBounds
+                        = {minX, (minX + TILE_WIDTH), minY,
+                           (minY + TILE_WIDTH), minZ, (minZ + TILE_WIDTH)};
+                }
+            }
+        }
+    }
+
+    const TileExtent& getTileExtent() const { return tileExtent; }
+
+    const Tile& getTile(int x, int y) const
+    {
+        return tiles[(y * tileExtent.xLength) + x];
+    }
+
+private:
+    /** The lowest Z that a box will be placed at. */
+    static constexpr float MIN_BOX_Z{1000};
+
+    TileExtent tileExtent;
+
+    std::vector<Tile> tiles;
+};
+
+/** The map size, in tiles. */
+constexpr int MAP_X_LENGTH{64};
+constexpr int MAP_Y_LENGTH{64};
+
+/** The number of movements to resolve per benchmark run. */
+constexpr std::size_t MOVEMENT_COUNT{1000};
+
+} // End anonymous namespace
+
+TEST_CASE("BenchmarkMovementHelpers")
+{
+    // The number of sprite layers in each tile.
+    const unsigned int layerCount{GENERATE(1u, 4u, 8u)};
+
+    // The width of each entity's bounding box, in world units.
+    const int boxWidth{GENERATE(16, 64)};
+
+    BenchmarkTileMap tileMap{MAP_X_LENGTH, MAP_Y_LENGTH, layerCount};
+
+    // Build a set of movements, spread across the map.
+    const float width{static_cast<float>(boxWidth)};
+    const BoundingBox modelBounds{0, width, 0, width, 0, width};
+    std::mt19937 generator{12345};
+    std::uniform_real_distribution<float> xDist{
+        (TILE_WIDTH * 2), ((MAP_X_LENGTH - 2) * TILE_WIDTH)};
+    std::uniform_real_distribution<float> yDist{
+        (TILE_WIDTH * 2), ((MAP_Y_LENGTH - 2) * TILE_WIDTH)};
+
+    std::vector<BoundingBox> currentBounds(MOVEMENT_COUNT);
+    std::vector<BoundingBox> desiredBounds(MOVEMENT_COUNT);
+    for (std::size_t i = 0; i < MOVEMENT_COUNT; ++i) {
+        Position position{xDist(generator), yDist(generator), 0};
+        currentBounds[i]
+            = Transforms::modelToWorldCentered(modelBounds, position);
+
+        position.x += 1;
+        position.y += 1;
+        desiredBounds[i]
+            = Transforms::modelToWorldCentered(modelBounds, position);
+    }
+
+    BENCHMARK("resolveCollisions - " + std::to_string(layerCount)
+              + " layers, " + std::to_string(boxWidth)
+              + " unit box, " + std::to_string(MOVEMENT_COUNT) + " moves")
+    {
+        float sum{0};
+        for (std::size_t i = 0; i < MOVEMENT_COUNT; ++i) {
+            BoundingBox resolvedBounds{MovementHelpers::resolveCollisions(
+                currentBounds[i], desiredBounds[i], tileMap)};
+            sum += resolvedBounds.minX;
+        }
+        return sum;
+    };
+}
@@ -0,0 +1,125 @@
+#include "catch2/catch_all.hpp"
+#include "Serialize.h"
+#include "Deserialize.h"
+#include "MovementUpdate.h"
+#include "ChunkUpdate.h"
+#include "ChunkPaletteBuilder.h"
+#include "BinaryBuffer.h"
+#include "SharedConfig.h"
+#include <string>
+#include <vector>
+
+using namespace AM;
+
+namespace
+{
+/**
+ * Returns a movement update with the given number of moving entities.
+ */
+MovementUpdate buildMovementUpdate(std::size_t stateCount)
+{
+    MovementUpdate movementUpdate{};
+    movementUpdate.tickNum = 12345;
+    movementUpdate.movementStates.resize(stateCount);
+
+    for (std::size_t i = 0; i < stateCount; ++i) {
+        MovementState& state{movementUpdate.movementStates[i]};
+        state.entity = static_cast<entt::entity>(i);
+        state.input.inputStates[Input::XUp] = Input::Pressed;
+        state.input.inputStates[Input::YDown] = ((i % 2) == 0)
+                                                    ? Input::Pressed
+                                                    : Input::Released;
+        state.position = {(i * 1.5f), (i * 2.5f), 0};
+        state.velocity.x = Velocity::DEFAULT_MAX_VELOCITY;
+        state.velocity.y = -Velocity::DEFAULT_MAX_VELOCITY;
+    }
+
+    return movementUpdate;
+}
+
+/**
+ * Returns a chunk update with the given number of chunks.
+ * Each chunk is a floor with a few walls, like a typical built-up area.
+ */
+ChunkUpdate buildChunkUpdate(std::size_t chunkCount)
+{
+    ChunkUpdate chunkUpdate{};
+    chunkUpdate.chunks.resize(chunkCount);
+
+    for (std::size_t i = 0; i < chunkCount; ++i) {
+        ChunkWireSnapshot& chunk{chunkUpdate.chunks[i]};
+        chunk.x = static_cast<Uint16>(i % 8);
+        chunk.y = static_cast<Uint16>(i / 8);
+        chunk.version = static_cast<Uint32>(i);
+
+        ChunkPaletteBuilder<int> paletteBuilder{chunk.palette};
+        Uint8 floorIndex{static_cast<Uint8>(paletteBuilder.getIndex(6))};
+        Uint8 wallIndex{static_cast<Uint8>(paletteBuilder.getIndex(17))};
+        Uint8 rugIndex{static_cast<Uint8>(paletteBuilder.getIndex(15))};
+        for (unsigned int j = 0; j < SharedConfig::CHUNK_TILE_COUNT; ++j) {
+            std::vector<Uint8>& layers{chunk.tiles[j].spriteLayers};
+            layers.push_back(floorIndex);
+            if ((j % SharedConfig::CHUNK_WIDTH) == 0) {
+                layers.push_back(wallIndex);
+            }
+            else if ((j % 7) == 0) {
+                layers.push_back(rugIndex);
+            }
+        }
+    }
+
+    return chunkUpdate;
+}
+
+} // End anonymous namespace
+
+TEST_CASE("BenchmarkSerialization")
+{
+    SECTION("MovementUpdate")
+    {
+        const std::size_t stateCount{
+            GENERATE(as<std::size_t>{}, 10, 100, 1000)};
+        const std::string suffix{" - " + std::to_string(stateCount)
+                                 + " states"};
+
+        MovementUpdate movementUpdate{buildMovementUpdate(stateCount)};
+        BinaryBuffer buffer(Serialize::measureSize(movementUpdate));
+
+        BENCHMARK("Serialize MovementUpdate" + suffix)
+        {
+            return Serialize::toBuffer(buffer.data(), buffer.size(),
+                                       movementUpdate);
+        };
+
+        MovementUpdate outputUpdate{};
+        BENCHMARK("Deserialize MovementUpdate" + suffix)
+        {
+            return Deserialize::fromBuffer(buffer.data(), buffer.size(),
+                                           outputUpdate);
+        };
+    }
+
+    SECTION("ChunkUpdate")
+    {
+        const std::size_t chunkCount{
+            GENERATE(as<std::size_t>{}, 1, 9, 50)};
+        const std::string suffix{" - " + std::to_string(chunkCount)
+                                 + " chunks"};
+
+        ChunkUpdate chunkUpdate{buildChunkUpdate(chunkCount)};
+        BinaryBuffer buffer(Serialize::measureSize(chunkUpdate));
+
+        BENCHMARK("Serialize ChunkUpdate" + suffix)
+        {
+            return Serialize::toBuffer(buffer.data(), buffer.size(),
+                                       chunkUpdate);
+        };
+
+        ChunkUpdate outputUpdate{};
+        BENCHMARK("Deserialize ChunkUpdate" + suffix)
+        {
+            return Deserialize::fromBuffer(buffer.data(), buffer.size(),
+                                           outputUpdate);
+        };
+    }
+}
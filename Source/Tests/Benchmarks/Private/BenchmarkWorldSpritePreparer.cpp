@@ -0,0 +1,133 @@
+#include "catch2/catch_all.hpp"
+#include "WorldSpritePreparer.h"
+#include "TileMap.h"
+#include "SpriteData.h"
+#include "AssetCache.h"
+#include "Camera.h"
+#include "Position.h"
+#include "PreviousPosition.h"
+#include "Sprite.h"
+#include "Transforms.h"
+#include "ScreenPoint.h"
+#include "TileExtent.h"
+#include "SharedConfig.h"
+#include "EmptySpriteID.h"
+#include "Paths.h"
+#include "entt/entity/registry.hpp"
+#include "SDL2pp/SDL.hh"
+#include "SDL2pp/Window.hh"
+#include "SDL2pp/Renderer.hh"
+#include "SDL2pp/Exception.hh"
+#include <filesystem>
+#include <random>
+#include <string>
+
+using namespace AM;
+using namespace AM::Client;
+
+namespace
+{
+/** The map size, in chunks. */
+constexpr unsigned int MAP_X_LENGTH_CHUNKS{4};
+constexpr unsigned int MAP_Y_LENGTH_CHUNKS{4};
+
+/** The camera's screen size. */
+constexpr float SCREEN_WIDTH{1280};
+constexpr float SCREEN_HEIGHT{720};
+
+/**
+ * Returns the first sprite that does or doesn't have a bounding box, or the
+ * empty sprite if there isn't one.
+ */
+const Sprite& findSprite(const SpriteData& spriteData, bool hasBoundingBox)
+{
+    for (const Sprite& sprite : spriteData.getAllSprites()) {
+        if ((sprite.numericID != EMPTY_SPRITE_ID)
+            && (sprite.hasBoundingBox == hasBoundingBox)) {
+            return sprite;
+        }
+    }
+
+    return spriteData.get(EMPTY_SPRITE_ID);
+}
+
+} // End anonymous namespace
+
+TEST_CASE("BenchmarkWorldSpritePreparer")
+{
+    // SpriteData needs the client's resources. If they aren't next to the
+    // executable, skip this benchmark.
+    if (!std::filesystem::exists(Paths::BASE_PATH + "SpriteData.json")) {
+        SKIP("SpriteData.json not found, skipping WorldSpritePreparer.");
+    }
+
+    const std::size_t spriteCount{
+        GENERATE(as<std::size_t>{}, 100, 500, 1000, 2000)};
+
+    try {
+        // Set up a hidden window, so we can load the sprite textures.
+        SDL2pp::SDL sdl(SDL_INIT_VIDEO);
+        SDL2pp::Window sdlWindow("Benchmarks", SDL_WINDOWPOS_UNDEFINED,
+                                 SDL_WINDOWPOS_UNDEFINED, 1, 1,
+                                 SDL_WINDOW_HIDDEN);
+        SDL2pp::Renderer sdlRenderer(sdlWindow, -1, SDL_RENDERER_SOFTWARE);
+        AssetCache assetCache(sdlRenderer.Get());
+        SpriteData spriteData(assetCache);
+
+        // Fill the map with floors, and put a wall along every 4th row.
+        const Sprite& floor{findSprite(spriteData, false)};
+        const Sprite& wall{findSprite(spriteData, true)};
+        TileMap tileMap(spriteData);
+        tileMap.setMapSize(MAP_X_LENGTH_CHUNKS, MAP_Y_LENGTH_CHUNKS);
+        const TileExtent& tileExtent{tileMap.getTileExtent()};
+        for (int y = 0; y < tileExtent.yLength; ++y) {
+            for (int x = 0; x < tileExtent.xLength; ++x) {
+                tileMap.setTileSpriteLayer(x, y, 0, floor);
+                if ((y % 4) == 0) {
+                    tileMap.setTileSpriteLayer(x, y, 1, wall);
+                }
+            }
+        }
+
+        // Center the camera on the map.
+        Camera camera{};
+        camera.behavior = Camera::Fixed;
+        camera.position = {
+            ((tileExtent.xLength * SharedConfig::TILE_WORLD_WIDTH) / 2.f),
+            ((tileExtent.yLength * SharedConfig::TILE_WORLD_WIDTH) / 2.f), 0};
+        camera.prevPosition = camera.position;
+        camera.extent.width = SCREEN_WIDTH;
+        camera.extent.height = SCREEN_HEIGHT;
+
+        ScreenPoint cameraCenter{
+            Transforms::worldToScreen(camera.position, camera.zoomFactor)};
+        camera.extent.x = cameraCenter.x - (camera.extent.width / 2);
+        camera.extent.y = cameraCenter.y - (camera.extent.height / 2);
+
+        // Add entities within view of the camera.
+        entt::registry registry;
+        std::mt19937 generator{12345};
+        std::uniform_real_distribution<float> offsetDist{
+            -SharedConfig::VIEW_RADIUS, SharedConfig::VIEW_RADIUS};
+        for (std::size_t i = 0; i < spriteCount; ++i) {
+            entt::entity entity{registry.create()};
+            Position position{(camera.position.x + offsetDist(generator)),
+                              (camera.position.y + offsetDist(generator)),
+                              0};
+            registry.emplace<Position>(entity, position);
+            registry.emplace<PreviousPosition>(entity, position.x, position.y,
+                                               position.z);
+            registry.emplace<Sprite>(entity, wall);
+        }
+
+        WorldSpritePreparer worldSpritePreparer(registry, tileMap,
+                                                spriteData);
+        BENCHMARK("prepareSprites - " + std::to_string(spriteCount)
+                  + " sprites")
+        {
+            return worldSpritePreparer.prepareSprites(camera, 0.5).size();
+        };
+    } catch (SDL2pp::Exception& e) {
+        SKIP("Failed to initialize SDL: " << e.GetSDLError());
+    }
+}
@@ -0,0 +1,231 @@
+#include "SDL.h"
+#include "ByteTools.h"
+#include "StreamCompressor.h"
+#include "StreamDecompressor.h"
+#include "CompressionDictionary.h"
+#include "MovementUpdate.h"
+#include "NetworkDefs.h"
+#include "Serialize.h"
+#include "Timer.h"
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * Compares the compression ratio and CPU cost of compressing each batch
+ * independently against compressing batches as a stream.
+ *
+ * Usage: CompressionTest [DictionaryPath] [SampleDir]
+ *   DictionaryPath: If given, also benchmarks streaming with this dictionary.
+ *   SampleDir: If given, each generated batch is written to a file in this
+ *              directory. These can be used to train a dictionary, e.g.
+ *              "zstd --train SampleDir/* -o CompressionDictionary.bin".
+ */
+
+static constexpr unsigned int BATCH_COUNT{10'000};
+static constexpr unsigned int ENTITY_COUNT{100};
+static constexpr unsigned int MAX_MOVEMENT_STATES_PER_BATCH{12};
+
+using namespace AM;
+
+/**
+ * Generates batches that resemble our MovementUpdate traffic: a few entities
+ * per tick, moving smoothly.
+ */
+std::vector<BinaryBuffer> generateBatches()
+{
+    std::mt19937 generator{1234};
+    std::uniform_int_distribution<unsigned int> stateCountDist{
+        1, MAX_MOVEMENT_STATES_PER_BATCH};
+    std::uniform_int_distribution<unsigned int> entityDist{0,
+                                                           ENTITY_COUNT - 1};
+    std::uniform_int_distribution<int> inputDist{0, 2};
+
+    std::vector<MovementState> entityStates(ENTITY_COUNT);
+    for (unsigned int i = 0; i < ENTITY_COUNT; ++i) {
+        entityStates[i].entity = static_cast<entt::entity>(i);
+        entityStates[i].position.x = static_cast<float>(i * 64);
+        entityStates[i].position.y = static_cast<float>(i * 32);
+    }
+
+    std::vector<BinaryBuffer> batches{};
+    for (Uint32 tick = 1; tick <= BATCH_COUNT; ++tick) {
+        // Move some random entities.
+        MovementUpdate movementUpdate{tick};
+        unsigned int stateCount{stateCountDist(generator)};
+        for (unsigned int i = 0; i < stateCount; ++i) {
+            MovementState& state{entityStates[entityDist(generator)]};
+            state.input.inputStates[Input::XUp]
+                = static_cast<Input::State>(inputDist(generator) == 0);
+            state.velocity.x
+                = (state.input.inputStates[Input::XUp] ? 5.f : 0.f);
+            state.position.x += (state.velocity.x / 30.f);
+            movementUpdate.movementStates.push_back(state);
+        }
+
+        // Serialize it into a batch, with a message header.
+        BinaryBuffer batch(MESSAGE_HEADER_SIZE
+                           + Serialize::measureSize(movementUpdate));
+        batch[MessageHeaderIndex::MessageType]
+            = static_cast<Uint8>(MessageType::MovementUpdate);
+        ByteTools::write16(
+            static_cast<Uint16>(batch.size() - MESSAGE_HEADER_SIZE),
+            &(batch[MessageHeaderIndex::Size]));
+        Serialize::toBuffer(batch.data(), batch.size(), movementUpdate,
+                            MESSAGE_HEADER_SIZE);
+
+        batches.push_back(std::move(batch));
+    }
+
+    return batches;
+}
+
+void printResult(const std::string& name, std::size_t rawBytes,
+                 std::size_t compressedBytes, double compressSeconds,
+                 double decompressSeconds)
+{
+    std::cout << name << ":\n"
+              << "    Raw: " << rawBytes << "B, Compressed: "
+              << compressedBytes << "B, Ratio: "
+              << (static_cast<double>(rawBytes) / compressedBytes) << "\n"
+              << "    Compress: " << (compressSeconds * 1'000'000 / BATCH_COUNT)
+              << "us/batch, Decompress: "
+              << (decompressSeconds * 1'000'000 / BATCH_COUNT)
+              << "us/batch" << std::endl;
+}
+
+/**
+ * Compresses each batch independently.
+ */
+void benchmarkPerBatch(const std::vector<BinaryBuffer>& batches)
+{
+    std::vector<BinaryBuffer> compressedBatches(batches.size());
+    std::size_t rawBytes{0};
+    std::size_t compressedBytes{0};
+
+    Timer timer{};
+    for (std::size_t i = 0; i < batches.size(); ++i) {
+        const BinaryBuffer& batch{batches[i]};
+        BinaryBuffer& compressedBatch{compressedBatches[i]};
+        compressedBatch.resize(ByteTools::compressBound(batch.size()));
+        std::size_t compressedSize{ByteTools::compress(
+            batch.data(), batch.size(), compressedBatch.data(),
+            compressedBatch.size())};
+        compressedBatch.resize(compressedSize);
+
+        rawBytes += batch.size();
+        compressedBytes += compressedBatch.size();
+    }
+    double compressSeconds{timer.getDeltaSeconds(true)};
+
+    BinaryBuffer decompressedBatch(SharedConfig::MAX_BATCH_SIZE);
+    for (const BinaryBuffer& compressedBatch : compressedBatches) {
+        ByteTools::decompress(compressedBatch.data(), compressedBatch.size(),
+                              decompressedBatch.data(),
+                              decompressedBatch.size());
+    }
+    double decompressSeconds{timer.getDeltaSeconds(true)};
+
+    printResult("Per-batch", rawBytes, compressedBytes, compressSeconds,
+                decompressSeconds);
+}
+
+/**
+ * Compresses the batches as a stream, checking that they decompress
+ * correctly.
+ */
+void benchmarkStream(const std::string& name,
+                     const std::vector<BinaryBuffer>& batches,
+                     const BinaryBuffer& dictionary,
+                     StreamCompressor::Level level)
+{
+    StreamCompressor compressor{dictionary};
+    StreamDecompressor decompressor{dictionary};
+    std::vector<BinaryBuffer> compressedBatches(batches.size());
+    std::size_t rawBytes{0};
+    std::size_t compressedBytes{0};
+
+    Timer timer{};
+    for (std::size_t i = 0; i < batches.size(); ++i) {
+        const BinaryBuffer& batch{batches[i]};
+        BinaryBuffer& compressedBatch{compressedBatches[i]};
+        compressedBatch.resize(ByteTools::compressBound(batch.size()));
+        std::size_t compressedSize{compressor.compress(
+            batch.data(), batch.size(), compressedBatch.data(),
+            compressedBatch.size(), level)};
+        compressedBatch.resize(compressedSize);
+
+        rawBytes += batch.size();
+        compressedBytes += compressedBatch.size();
+    }
+    double compressSeconds{timer.getDeltaSeconds(true)};
+
+    bool allMatched{true};
+    for (std::size_t i = 0; i < batches.size(); ++i) {
+        std::size_t decompressedSize{0};
+        const Uint8* decompressedBatch{decompressor.decompress(
+            compressedBatches[i].data(), compressedBatches[i].size(),
+            decompressedSize)};
+        allMatched = allMatched && (decompressedBatch != nullptr)
+                     && (decompressedSize == batches[i].size())
+                     && std::equal(batches[i].begin(), batches[i].end(),
+                                   decompressedBatch);
+    }
+    double decompressSeconds{timer.getDeltaSeconds(true)};
+
+    printResult(name, rawBytes, compressedBytes, compressSeconds,
+                decompressSeconds);
+    if (!allMatched) {
+        std::cout << "    Error: Decompressed data didn't match."
+                  << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (SDL_Init(0) == -1) {
+        std::cout << "SDL_Init: " << SDL_GetError() << std::endl;
+        return 1;
+    }
+
+    std::vector<BinaryBuffer> batches{generateBatches()};
+
+    // If a sample directory was given, write the batches to it.
+    if (argc > 2) {
+        for (std::size_t i = 0; i < batches.size(); ++i) {
+            std::string filePath{std::string{argv[2]} + "/"
+                                 + std::to_string(i) + ".bin"};
+            std::ofstream sampleFile(filePath, std::ios::binary);
+            sampleFile.write(reinterpret_cast<const char*>(batches[i].data()),
+                             batches[i].size());
+        }
+    }
+
+    benchmarkPerBatch(batches);
+    const BinaryBuffer noDictionary{};
+    benchmarkStream("Streaming (fast)", batches, noDictionary,
+                    StreamCompressor::Level::Fast);
+    benchmarkStream("Streaming (default)", batches, noDictionary,
+                    StreamCompressor::Level::Default);
+    benchmarkStream("Streaming (high)", batches, noDictionary,
+                    StreamCompressor::Level::High);
+
+    // If a dictionary was given, benchmark with it.
+    // Note: We load it the same way the server and client do, so it's
+    //       trimmed to the size that LZ4 will actually use.
+    if (argc > 1) {
+        BinaryBuffer dictionary{};
+        if (!(CompressionDictionary::loadFromFile(argv[1], dictionary))) {
+            std::cout << "Failed to open dictionary: " << argv[1]
+                      << std::endl;
+            return 1;
+        }
+        benchmarkStream("Streaming with dictionary (default)", batches,
+                        dictionary, StreamCompressor::Level::Default);
+    }
+
+    return 0;
+}
@@ -0,0 +1,185 @@
+#include "ClientWorker.h"
+#include "SharedConfig.h"
+#include "Log.h"
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+
+namespace AM
+{
+namespace LTC
+{
+ClientWorker::ClientWorker(const sockaddr_in& inServerAddress,
+                           ScenarioType inScenarioType,
+                           unsigned int numClients, Uint32 firstSeed)
+: serverAddress{inServerAddress}
+, scenarioType{inScenarioType}
+, clients{}
+, addedClientCount{0}
+, startedClientCount{0}
+, epollFd{epoll_create1(0)}
+, events{}
+, simCaller{std::bind_front(&ClientWorker::simTick, this),
+            SharedConfig::SIM_TICK_TIMESTEP_S, "Sim", false}
+, networkCaller{std::bind_front(&ClientWorker::networkTick, this),
+                SharedConfig::NETWORK_TICK_TIMESTEP_S, "Network", true}
+, reconnectStormCaller{std::bind_front(&ClientWorker::reconnectStorm, this),
+                       RECONNECT_STORM_PERIOD_S, "ReconnectStorm", true}
+, nextStormIndex{0}
+, isRunning{true}
+, workerThread{}
+{
+    if (epollFd == -1) {
+        LOG_FATAL("Failed to create epoll instance: %d", errno);
+    }
+
+    clients.reserve(numClients);
+    for (unsigned int i = 0; i < numClients; ++i) {
+        clients.push_back(
+            std::make_unique<SimulatedClient>(scenarioType, (firstSeed + i)));
+    }
+
+    workerThread = std::thread(&ClientWorker::run, this);
+}
+
+ClientWorker::~ClientWorker()
+{
+    isRunning = false;
+    workerThread.join();
+
+    for (std::unique_ptr<SimulatedClient>& client : clients) {
+        client->disconnect(true);
+    }
+    close(epollFd);
+}
+
+bool ClientWorker::addClient()
+{
+    unsigned int addedCount{addedClientCount.load()};
+    while (addedCount < clients.size()) {
+        if (addedClientCount.compare_exchange_weak(addedCount,
+                                                   (addedCount + 1))) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ClientWorker::run()
+{
+    simCaller.initTimer();
+    networkCaller.initTimer();
+    reconnectStormCaller.initTimer();
+
+    while (isRunning) {
+        connectAddedClients();
+
+        // Wait for socket events until the next tick is due.
+        double timeTillNextTick{std::min(simCaller.getTimeTillNextCall(),
+                                         networkCaller.getTimeTillNextCall())};
+        int timeoutMs{
+            static_cast<int>(std::max(0.0, (timeTillNextTick * 1000)))};
+        processEvents(timeoutMs);
+
+        simCaller.update();
+        networkCaller.update();
+        if (scenarioType == ScenarioType::ReconnectStorm) {
+            reconnectStormCaller.update();
+        }
+    }
+}
+
+void ClientWorker::connectAddedClients()
+{
+    unsigned int addedCount{addedClientCount.load()};
+    while (startedClientCount < addedCount) {
+        connectClient(startedClientCount);
+        startedClientCount++;
+    }
+}
+
+void ClientWorker::connectClient(unsigned int clientIndex)
+{
+    int socket{clients[clientIndex]->connect(serverAddress)};
+    if (socket == -1) {
+        return;
+    }
+
+    // Wait for the socket to become writable, which signals that the
+    // connection finished.
+    epoll_event event{};
+    event.events = (EPOLLIN | EPOLLOUT);
+    event.data.u32 = clientIndex;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, socket, &event) == -1) {
+        LOG_INFO("Failed to add socket to epoll: %d", errno);
+        clients[clientIndex]->disconnect(false);
+    }
+}
+
+void ClientWorker::processEvents(int timeoutMs)
+{
+    int eventCount{epoll_wait(epollFd, events.data(), MAX_EVENTS, timeoutMs)};
+    if ((eventCount == -1) && (errno != EINTR)) {
+        LOG_FATAL("epoll_wait failed: %d", errno);
+    }
+
+    for (int i = 0; i < eventCount; ++i) {
+        unsigned int clientIndex{events[i].data.u32};
+        SimulatedClient& client{*(clients[clientIndex])};
+
+        // If the connection just finished, stop waiting for writability.
+        // Note: Closing the socket removes it from the epoll instance, so we
+        //       don't need to do anything if it fails.
+        if (client.getState() == SimulatedClient::State::Connecting) {
+            if (!(client.finishConnect())) {
+                continue;
+            }
+
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.u32 = clientIndex;
+            epoll_ctl(epollFd, EPOLL_CTL_MOD, client.getSocket(), &event);
+        }
+
+        if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) {
+            client.receive();
+        }
+    }
+}
+
+void ClientWorker::simTick()
+{
+    for (std::unique_ptr<SimulatedClient>& client : clients) {
+        client->simTick();
+    }
+}
+
+void ClientWorker::networkTick()
+{
+    for (std::unique_ptr<SimulatedClient>& client : clients) {
+        client->networkTick();
+    }
+}
+
+void ClientWorker::reconnectStorm()
+{
+    // Reconnect the next RECONNECT_STORM_FRACTION of our clients.
+    // Note: We go in order, so that every client eventually gets reconnected.
+    unsigned int stormSize{static_cast<unsigned int>(
+        std::ceil(startedClientCount * RECONNECT_STORM_FRACTION))};
+    for (unsigned int i = 0; i < stormSize; ++i) {
+        unsigned int clientIndex{nextStormIndex};
+        nextStormIndex = ((nextStormIndex + 1) % startedClientCount);
+
+        if (clients[clientIndex]->getState()
+            == SimulatedClient::State::Connected) {
+            clients[clientIndex]->disconnect(true);
+            connectClient(clientIndex);
+        }
+    }
+}
+
+} // End namespace LTC
+} // End namespace AM
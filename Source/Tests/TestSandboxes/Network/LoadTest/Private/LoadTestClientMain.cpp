@@ -1,17 +1,21 @@
 #include <SDL.h>
 #include "SDL2pp/SDL.hh"
-#include "SDL2pp/Window.hh"
-#include "SDL2pp/Renderer.hh"
 #include "SDL2pp/Exception.hh"
 
-#include "Timer.h"
 #include "Log.h"
 
-#include "SimulatedClient.h"
+#include "ClientWorker.h"
+#include "LoadTestStats.h"
+#include "MovementScenario.h"
 #include "UserConfig.h"
 
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <algorithm>
 #include <exception>
 #include <atomic>
+#include <chrono>
+#include <cstring>
 #include <vector>
 #include <memory>
 #include <string>
@@ -26,36 +30,136 @@ static constexpr unsigned int DEFAULT_NUM_CLIENTS = 10;
 /** Default time to wait, in milliseconds, between connecting clients. */
 static constexpr unsigned int DEFAULT_CONNECTION_WAIT_TIME_MS = 1;
 
+/** Default scenario if no argument is given. */
+static constexpr ScenarioType DEFAULT_SCENARIO = ScenarioType::RandomWalk;
+
+/** Default number of worker threads if no argument is given. */
+static constexpr unsigned int DEFAULT_NUM_WORKERS = 4;
+
+/** Default run duration, in seconds, if no argument is given. 0 runs until
+    the app is closed. */
+static constexpr unsigned int DEFAULT_DURATION_S = 0;
+
+/** How often to log a progress summary, in seconds. */
+static constexpr unsigned int SUMMARY_PERIOD_S = 5;
+
 void printUsage()
 {
     std::printf(
-        "Usage: LoadTestClientMain.exe <NumClients> <ConnectionWaitTime>\n"
+        "Usage: LoadTestClientMain.exe <NumClients> <ConnectionWaitTime> "
+        "<Scenario> <NumWorkers> <Duration>\n"
         "  NumClients: How many clients to simulate. Default: 10.\n"
         "  ConnectionWaitTime: How long, in milliseconds, to wait between"
-        " connecting clients. Default: 1.\n");
+        " connecting clients. Default: 1.\n"
+        "  Scenario: How the clients move. One of: clustered, randomwalk,"
+        " corridor, reconnectstorm. Default: randomwalk.\n"
+        "  NumWorkers: How many threads to spread the clients across."
+        " Default: 4.\n"
+        "  Duration: How long, in seconds, to run before printing a summary"
+        " and exiting. 0 runs until closed. Default: 0.\n");
 }
 
-void connectClients(unsigned int numClients, unsigned int connectionWaitTimeMs,
-                    std::vector<std::unique_ptr<SimulatedClient>>* clients)
+/**
+ * Parses the given argument into an unsigned int.
+ *
+ * @return true if the argument was a valid integer >= minValue, else false.
+ */
+bool parseArgument(const char* argument, int minValue,
+                   unsigned int& outValue)
 {
-    LOG_INFO("Connecting %u clients with a %ums wait time.", numClients,
-             connectionWaitTimeMs);
+    char* end;
+    long input = std::strtol(argument, &end, 10);
+    if ((*end != '\0') || (input < minValue)) {
+        std::printf("Invalid input: %s\n", argument);
+        printUsage();
+        return false;
+    }
 
-    // Open all of the connections.
-    for (unsigned int i = 0; i < numClients; ++i) {
-        (*clients)[i]->connect();
+    outValue = static_cast<unsigned int>(input);
+    return true;
+}
 
-        // Sleep for our wait time.
-        std::this_thread::sleep_for(
-            std::chrono::milliseconds(connectionWaitTimeMs));
+/**
+ * Resolves the server address from UserConfig.json.
+ */
+sockaddr_in resolveServerAddress()
+{
+    Client::ServerAddress configAddress{
+        Client::UserConfig::get().getServerAddress()};
+
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* result{nullptr};
+    if (getaddrinfo(configAddress.IP.c_str(), nullptr, &hints, &result)
+        != 0) {
+        LOG_FATAL("Failed to resolve server address: %s",
+                  configAddress.IP.c_str());
     }
 
-    LOG_INFO("%u clients connected.", numClients);
+    sockaddr_in serverAddress{};
+    std::memcpy(&serverAddress, result->ai_addr, sizeof(serverAddress));
+    serverAddress.sin_port = htons(static_cast<Uint16>(configAddress.port));
+    freeaddrinfo(result);
+
+    return serverAddress;
+}
+
+/**
+ * Logs the stats that have accumulated since the last summary.
+ */
+void logProgress(LoadTestTotals& lastTotals, double elapsedS)
+{
+    LoadTestTotals totals{LoadTestStats::getTotals()};
+    LOG_INFO("Connected: %u, Sent: %.0f B/s, Received: %.0f B/s",
+             LoadTestStats::getConnectedClientCount(),
+             ((totals.bytesSent - lastTotals.bytesSent) / elapsedS),
+             ((totals.bytesReceived - lastTotals.bytesReceived) / elapsedS));
+    lastTotals = totals;
+}
+
+/**
+ * Logs the stats for the whole run.
+ */
+void logSummary(unsigned int numClients, double runTimeS)
+{
+    LoadTestTotals totals{LoadTestStats::getTotals()};
+    Histogram::Snapshot connectLatency{
+        LoadTestStats::getConnectLatencySnapshot()};
+    Histogram::Snapshot inputLatency{LoadTestStats::getInputLatencySnapshot()};
+    double clientSeconds{numClients * runTimeS};
+
+    LOG_INFO("===== Load test summary (%.0fs) =====", runTimeS);
+    LOG_INFO("Connections: %llu, Failed: %llu, Disconnections: %llu",
+             static_cast<unsigned long long>(totals.connections),
+             static_cast<unsigned long long>(totals.failedConnections),
+             static_cast<unsigned long long>(totals.disconnections));
+    LOG_INFO("Sent: %llu B (%.1f B/s per client), %llu inputs",
+             static_cast<unsigned long long>(totals.bytesSent),
+             (totals.bytesSent / clientSeconds),
+             static_cast<unsigned long long>(totals.inputsSent));
+    LOG_INFO("Received: %llu B (%.1f B/s per client), %llu batches",
+             static_cast<unsigned long long>(totals.bytesReceived),
+             (totals.bytesReceived / clientSeconds),
+             static_cast<unsigned long long>(totals.batchesReceived));
+    LOG_INFO(
+        "Connect latency (us): p50 <= %llu, p99 <= %llu",
+        static_cast<unsigned long long>(connectLatency.getPercentile(0.5)),
+        static_cast<unsigned long long>(connectLatency.getPercentile(0.99)));
+    LOG_INFO(
+        "Input latency (us): p50 <= %llu, p99 <= %llu, mean %llu "
+        "(%llu samples)",
+        static_cast<unsigned long long>(inputLatency.getPercentile(0.5)),
+        static_cast<unsigned long long>(inputLatency.getPercentile(0.99)),
+        static_cast<unsigned long long>(
+            (inputLatency.count > 0) ? (inputLatency.sum / inputLatency.count)
+                                     : 0),
+        static_cast<unsigned long long>(inputLatency.count));
 }
 
 int main(int argc, char** argv)
 try {
-    if (argc > 3) {
+    if (argc > 6) {
         std::printf("Too many arguments.\n");
         printUsage();
         return 1;
@@ -67,60 +171,62 @@ try {
     // Initialize the user config.
     Client::UserConfig::get();
 
-    // Set up file logging.
-    // TODO: This currently will do weird stuff if you have 2 instances of this
-    //       app open.
-    //    Log::enableFileLogging("LoadTestClient.log");
-
-    // Check for a NumClients argument.
+    // Parse our arguments.
     unsigned int numClients{DEFAULT_NUM_CLIENTS};
-    if (argc > 1) {
-        char* end;
-        int input = std::strtol(argv[1], &end, 10);
-        if ((*end != '\0') || (input < 1)) {
-            // Input didn't parse into an integer, or value was less than 1.
-            std::printf("Invalid input: %s\n", argv[1]);
-            printUsage();
-            return 1;
-        }
-        else {
-            numClients = static_cast<unsigned int>(input);
-        }
+    if ((argc > 1) && !parseArgument(argv[1], 1, numClients)) {
+        return 1;
     }
 
-    // Check for a ConnectionWaitTime argument.
     unsigned int connectionWaitTimeMs{DEFAULT_CONNECTION_WAIT_TIME_MS};
-    if (argc > 2) {
-        char* end;
-        int input = std::strtol(argv[2], &end, 10);
-        if ((*end != '\0') || (input < 1)) {
-            // Input didn't parse into a float, or value was less than 1.
-            std::printf("Invalid input: %s\n", argv[1]);
-            printUsage();
-            return 1;
-        }
-        else {
-            connectionWaitTimeMs = static_cast<unsigned int>(input);
-        }
+    if ((argc > 2) && !parseArgument(argv[2], 0, connectionWaitTimeMs)) {
+        return 1;
     }
 
-    // Construct the clients.
-    std::vector<std::unique_ptr<SimulatedClient>> clients;
-    for (unsigned int i = 0; i < numClients; ++i) {
-        clients.push_back(std::make_unique<SimulatedClient>());
-        clients[i]->setNetstatsLoggingEnabled(false);
+    ScenarioType scenarioType{DEFAULT_SCENARIO};
+    if ((argc > 3) && !MovementScenario::fromString(argv[3], scenarioType)) {
+        std::printf("Invalid scenario: %s\n", argv[3]);
+        printUsage();
+        return 1;
     }
 
-    // Enable only one client's logging so we don't get spammed.
-    // Netstats logging is static, so it'll get the data from all clients.
-    clients[0]->setNetstatsLoggingEnabled(true);
+    unsigned int numWorkers{DEFAULT_NUM_WORKERS};
+    if ((argc > 4) && !parseArgument(argv[4], 1, numWorkers)) {
+        return 1;
+    }
+    numWorkers = std::min(numWorkers, numClients);
 
-    // Start the client connections thread.
-    std::thread connectionThreadObj(connectClients, numClients,
-                                    connectionWaitTimeMs, &clients);
+    unsigned int durationS{DEFAULT_DURATION_S};
+    if ((argc > 5) && !parseArgument(argv[5], 0, durationS)) {
+        return 1;
+    }
+
+    // Spread the clients across the workers.
+    sockaddr_in serverAddress{resolveServerAddress()};
+    std::vector<std::unique_ptr<ClientWorker>> workers;
+    Uint32 nextSeed{0};
+    for (unsigned int i = 0; i < numWorkers; ++i) {
+        unsigned int workerClientCount{(numClients / numWorkers)
+                                       + ((i < (numClients % numWorkers))
+                                              ? 1
+                                              : 0)};
+        workers.push_back(std::make_unique<ClientWorker>(
+            serverAddress, scenarioType, workerClientCount, nextSeed));
+        nextSeed += workerClientCount;
+    }
+
+    LOG_INFO("Running %u clients across %u workers. Scenario: %s, "
+             "connection wait time: %ums.",
+             numClients, numWorkers, MovementScenario::toString(scenarioType),
+             connectionWaitTimeMs);
 
     // Start the main loop.
-    std::atomic<bool> exitRequested = false;
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point startTime{Clock::now()};
+    Clock::time_point lastConnectTime{startTime};
+    Clock::time_point lastSummaryTime{startTime};
+    LoadTestTotals lastTotals{};
+    unsigned int addedClientCount{0};
+    bool exitRequested{false};
     while (!exitRequested) {
         // Check for attempts to exit.
         SDL_Event event;
@@ -130,13 +236,39 @@ try {
             }
         }
 
-        // Process the simulated clients.
-        for (auto& client : clients) {
-            client->tick();
+        Clock::time_point now{Clock::now()};
+        if ((durationS > 0)
+            && ((now - startTime) >= std::chrono::seconds(durationS))) {
+            exitRequested = true;
+        }
+
+        // Ramp up the connections, round-robin across the workers.
+        while ((addedClientCount < numClients)
+               && ((now - lastConnectTime)
+                   >= std::chrono::milliseconds(connectionWaitTimeMs))) {
+            workers[addedClientCount % numWorkers]->addClient();
+            addedClientCount++;
+            lastConnectTime = now;
+
+            if (connectionWaitTimeMs > 0) {
+                break;
+            }
+        }
+
+        // Periodically log our progress.
+        std::chrono::duration<double> timeSinceSummary{now - lastSummaryTime};
+        if (timeSinceSummary.count() >= SUMMARY_PERIOD_S) {
+            logProgress(lastTotals, timeSinceSummary.count());
+            lastSummaryTime = now;
         }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
     }
 
-    connectionThreadObj.join();
+    // Stop the workers before summarizing, so the stats are final.
+    workers.clear();
+    std::chrono::duration<double> runTime{Clock::now() - startTime};
+    logSummary(numClients, runTime.count());
 
     return 0;
 } catch (SDL2pp::Exception& e) {
@@ -0,0 +1,94 @@
+#include "LoadTestStats.h"
+
+namespace AM
+{
+namespace LTC
+{
+// Initialize data.
+std::atomic<Uint64> LoadTestStats::bytesSent = 0;
+std::atomic<Uint64> LoadTestStats::bytesReceived = 0;
+std::atomic<Uint64> LoadTestStats::batchesReceived = 0;
+std::atomic<Uint64> LoadTestStats::inputsSent = 0;
+std::atomic<Uint64> LoadTestStats::connections = 0;
+std::atomic<Uint64> LoadTestStats::failedConnections = 0;
+std::atomic<Uint64> LoadTestStats::disconnections = 0;
+std::atomic<unsigned int> LoadTestStats::connectedClientCount = 0;
+Histogram LoadTestStats::connectLatencyUs{};
+Histogram LoadTestStats::inputLatencyUs{};
+
+LoadTestTotals LoadTestStats::getTotals()
+{
+    LoadTestTotals totals{};
+    totals.bytesSent = bytesSent;
+    totals.bytesReceived = bytesReceived;
+    totals.batchesReceived = batchesReceived;
+    totals.inputsSent = inputsSent;
+    totals.connections = connections;
+    totals.failedConnections = failedConnections;
+    totals.disconnections = disconnections;
+
+    return totals;
+}
+
+unsigned int LoadTestStats::getConnectedClientCount()
+{
+    return connectedClientCount;
+}
+
+Histogram::Snapshot LoadTestStats::getConnectLatencySnapshot()
+{
+    return connectLatencyUs.getSnapshot();
+}
+
+Histogram::Snapshot LoadTestStats::getInputLatencySnapshot()
+{
+    return inputLatencyUs.getSnapshot();
+}
+
+void LoadTestStats::recordBytesSent(std::size_t inBytesSent)
+{
+    bytesSent.fetch_add(inBytesSent, std::memory_order_relaxed);
+}
+
+void LoadTestStats::recordBytesReceived(std::size_t inBytesReceived)
+{
+    bytesReceived.fetch_add(inBytesReceived, std::memory_order_relaxed);
+}
+
+void LoadTestStats::recordBatchReceived()
+{
+    batchesReceived.fetch_add(1, std::memory_order_relaxed);
+}
+
+void LoadTestStats::recordInputSent()
+{
+    inputsSent.fetch_add(1, std::memory_order_relaxed);
+}
+
+void LoadTestStats::recordConnection(Uint64 connectLatency)
+{
+    connections.fetch_add(1, std::memory_order_relaxed);
+    connectedClientCount.fetch_add(1, std::memory_order_relaxed);
+    connectLatencyUs.record(connectLatency);
+}
+
+void LoadTestStats::recordFailedConnection()
+{
+    failedConnections.fetch_add(1, std::memory_order_relaxed);
+}
+
+void LoadTestStats::recordDisconnection(bool wasIntentional)
+{
+    if (!wasIntentional) {
+        disconnections.fetch_add(1, std::memory_order_relaxed);
+    }
+    connectedClientCount.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void LoadTestStats::recordInputLatency(Uint64 inputLatency)
+{
+    inputLatencyUs.record(inputLatency);
+}
+
+} // End namespace LTC
+} // End namespace AM
@@ -0,0 +1,166 @@
+#include "MovementScenario.h"
+
+namespace AM
+{
+namespace LTC
+{
+MovementScenario::MovementScenario(ScenarioType inType, Uint32 seed)
+: type{inType}
+, randomEngine{seed + 1}
+, directionX{0}
+, directionY{0}
+, inputIsStale{true}
+, ticksTillChange{0}
+, displacementX{0}
+, displacementY{0}
+{
+    // Start each corridor walker at a random point in its leg, so they're
+    // spread along the corridor.
+    if (type == ScenarioType::Corridor) {
+        directionX = ((getRandom(0, 1) == 0) ? -1 : 1);
+        ticksTillChange = getRandom(1, CORRIDOR_LEG_TICKS);
+    }
+}
+
+bool MovementScenario::tick(Input& outInput)
+{
+    bool inputChanged{false};
+    if (ticksTillChange == 0) {
+        int previousDirectionX{directionX};
+        int previousDirectionY{directionY};
+        chooseNextMove();
+
+        if ((directionX != previousDirectionX)
+            || (directionY != previousDirectionY)) {
+            inputChanged = true;
+        }
+    }
+
+    // If the server doesn't know our direction yet, send it.
+    // Note: A fresh entity isn't moving, so there's no need to send a stop.
+    if (inputIsStale) {
+        if ((directionX != 0) || (directionY != 0)) {
+            inputChanged = true;
+        }
+        inputIsStale = false;
+    }
+
+    if (inputChanged) {
+        outInput = getInput(directionX, directionY);
+    }
+
+    ticksTillChange--;
+    displacementX += directionX;
+    displacementY += directionY;
+
+    return inputChanged;
+}
+
+void MovementScenario::reset()
+{
+    displacementX = 0;
+    displacementY = 0;
+    inputIsStale = true;
+}
+
+bool MovementScenario::fromString(std::string_view name,
+                                  ScenarioType& outType)
+{
+    for (ScenarioType scenarioType :
+         {ScenarioType::Clustered, ScenarioType::RandomWalk,
+          ScenarioType::Corridor, ScenarioType::ReconnectStorm}) {
+        if (name == toString(scenarioType)) {
+            outType = scenarioType;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+const char* MovementScenario::toString(ScenarioType type)
+{
+    switch (type) {
+        case ScenarioType::Clustered:
+            return "clustered";
+        case ScenarioType::RandomWalk:
+            return "randomwalk";
+        case ScenarioType::Corridor:
+            return "corridor";
+        case ScenarioType::ReconnectStorm:
+            return "reconnectstorm";
+    }
+
+    return "";
+}
+
+void MovementScenario::chooseNextMove()
+{
+    switch (type) {
+        case ScenarioType::Clustered: {
+            // Move in a random direction, but head back toward our spawn
+            // point if we've strayed too far.
+            directionX = (static_cast<int>(getRandom(0, 2)) - 1);
+            directionY = (static_cast<int>(getRandom(0, 2)) - 1);
+            if (displacementX > CLUSTER_RADIUS_TICKS) {
+                directionX = -1;
+            }
+            else if (displacementX < -CLUSTER_RADIUS_TICKS) {
+                directionX = 1;
+            }
+            if (displacementY > CLUSTER_RADIUS_TICKS) {
+                directionY = -1;
+            }
+            else if (displacementY < -CLUSTER_RADIUS_TICKS) {
+                directionY = 1;
+            }
+
+            ticksTillChange
+                = getRandom(CLUSTERED_MIN_TICKS, CLUSTERED_MAX_TICKS);
+            break;
+        }
+        case ScenarioType::RandomWalk:
+        case ScenarioType::ReconnectStorm: {
+            directionX = (static_cast<int>(getRandom(0, 2)) - 1);
+            directionY = (static_cast<int>(getRandom(0, 2)) - 1);
+            ticksTillChange = getRandom(WALK_MIN_TICKS, WALK_MAX_TICKS);
+            break;
+        }
+        case ScenarioType::Corridor: {
+            // Turn around.
+            directionX = ((directionX == 1) ? -1 : 1);
+            directionY = 0;
+            ticksTillChange = CORRIDOR_LEG_TICKS;
+            break;
+        }
+    }
+}
+
+Input MovementScenario::getInput(int directionX, int directionY)
+{
+    Input input{};
+    if (directionX > 0) {
+        input.inputStates[Input::XUp] = Input::Pressed;
+    }
+    else if (directionX < 0) {
+        input.inputStates[Input::XDown] = Input::Pressed;
+    }
+
+    if (directionY > 0) {
+        input.inputStates[Input::YUp] = Input::Pressed;
+    }
+    else if (directionY < 0) {
+        input.inputStates[Input::YDown] = Input::Pressed;
+    }
+
+    return input;
+}
+
+unsigned int MovementScenario::getRandom(unsigned int min, unsigned int max)
+{
+    std::uniform_int_distribution<unsigned int> distribution{min, max};
+    return distribution(randomEngine);
+}
+
+} // End namespace LTC
+} // End namespace AM
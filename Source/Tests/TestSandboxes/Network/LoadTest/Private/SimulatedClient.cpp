@@ -1,47 +1,443 @@
 #include "SimulatedClient.h"
+#include "LoadTestStats.h"
+#include "Config.h"
 #include "SharedConfig.h"
+#include "CompressionDictionary.h"
+#include "ConnectionResponse.h"
+#include "InputChangeRequest.h"
+#include "Heartbeat.h"
+#include "Peer.h"
+#include "Deserialize.h"
+#include "Log.h"
+#include <SDL_timer.h>
+#include <sys/socket.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <algorithm>
 
 namespace AM
 {
 namespace LTC
 {
-SimulatedClient::SimulatedClient()
-: network()
-, networkCaller(std::bind_front(&Client::Network::tick, &network),
-                SharedConfig::NETWORK_TICK_TIMESTEP_S, "Network", true)
-, worldSim(network.getEventDispatcher(), network)
-, simCaller(std::bind_front(&WorldSimulation::tick, &worldSim),
-            SharedConfig::SIM_TICK_TIMESTEP_S, "Sim", false)
-, isConnected(false)
+SimulatedClient::SimulatedClient(ScenarioType scenarioType, Uint32 seed)
+: socket{-1}
+, state{State::Disconnected}
+, scenario{scenarioType, seed}
+, connectStartTime{0}
+, clientEntity{entt::null}
+, currentTick{0}
+, tickAdjustment{0}
+, adjustmentIteration{0}
+, isApplyingTickAdjustment{false}
+, messagesSentSinceTick{0}
+, tracedInput{}
+, tracedInputSendTime{0}
+, sendBatchBuffer(Peer::MAX_WIRE_SIZE)
+, sendBatchIndex{CLIENT_HEADER_SIZE}
+, sendBacklog{}
+, receiveBuffer(RECEIVE_BUFFER_SIZE)
+, receiveBufferSize{0}
+, batchDecompressor{CompressionDictionary::get()}
+, movementUpdate{}
 {
 }
 
-void SimulatedClient::connect()
+SimulatedClient::~SimulatedClient()
 {
-    // Connect to the server.
-    worldSim.connect();
+    if (socket != -1) {
+        close(socket);
+    }
+}
+
+int SimulatedClient::connect(const sockaddr_in& serverAddress)
+{
+    socket = ::socket(AF_INET, (SOCK_STREAM | SOCK_NONBLOCK), 0);
+    if (socket == -1) {
+        LOG_INFO("Failed to create socket: %d", errno);
+        LoadTestStats::recordFailedConnection();
+        return -1;
+    }
+
+    // Our batches are small and latency-sensitive, don't let them wait.
+    int noDelay{1};
+    setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+    int result{::connect(socket,
+                         reinterpret_cast<const sockaddr*>(&serverAddress),
+                         sizeof(serverAddress))};
+    if ((result == -1) && (errno != EINPROGRESS)) {
+        LOG_INFO("Failed to connect: %d", errno);
+        close(socket);
+        socket = -1;
+        LoadTestStats::recordFailedConnection();
+        return -1;
+    }
+
+    state = State::Connecting;
+    connectStartTime = SDL_GetPerformanceCounter();
+    return socket;
+}
+
+bool SimulatedClient::finishConnect()
+{
+    int error{0};
+    socklen_t errorLength{sizeof(error)};
+    if ((getsockopt(socket, SOL_SOCKET, SO_ERROR, &error, &errorLength) == -1)
+        || (error != 0)) {
+        disconnect(false);
+        return false;
+    }
+
+    // The server will send a ConnectionResponse when it processes our
+    // connection.
+    state = State::AwaitingResponse;
+    return true;
+}
+
+bool SimulatedClient::receive()
+{
+    // Receive until the OS has no more bytes for us.
+    while (true) {
+        ssize_t result{recv(socket, (receiveBuffer.data() + receiveBufferSize),
+                            (receiveBuffer.size() - receiveBufferSize), 0)};
+        if (result > 0) {
+            receiveBufferSize += static_cast<std::size_t>(result);
+            LoadTestStats::recordBytesReceived(
+                static_cast<std::size_t>(result));
+
+            if (!processReceivedBatches()) {
+                LOG_INFO("Received a malformed batch, disconnecting.");
+                disconnect(false);
+                return false;
+            }
+        }
+        else if ((result == -1)
+                 && ((errno == EAGAIN) || (errno == EWOULDBLOCK)
+                     || (errno == EINTR))) {
+            return true;
+        }
+        else {
+            // The server closed the connection (or some other error).
+            disconnect(false);
+            return false;
+        }
+    }
+}
+
+void SimulatedClient::simTick()
+{
+    if (state != State::Connected) {
+        return;
+    }
 
-    // Start the tick timer at the current time.
-    simCaller.initTimer();
-    networkCaller.initTimer();
+    Uint32 targetTick{currentTick + 1};
 
-    isConnected = true;
+    // Apply any adjustments that we receive from the server.
+    targetTick += transferTickAdjustment();
+
+    // Process ticks until we match what the server wants.
+    // Note: This may process 0 ticks, or multiple ticks.
+    while (currentTick < targetTick) {
+        // If our scenario wants a new input, send it.
+        Input newInput{};
+        if (scenario.tick(newInput)) {
+            InputChangeRequest inputChangeRequest{};
+            inputChangeRequest.tickNum = currentTick;
+            inputChangeRequest.input = newInput;
+            queueMessage(inputChangeRequest);
+            LoadTestStats::recordInputSent();
+
+            // If we aren't already timing an input, time this one.
+            if (tracedInputSendTime == 0) {
+                tracedInput = newInput;
+                tracedInputSendTime = SDL_GetPerformanceCounter();
+            }
+
+            if (Client::Config::SEND_INPUTS_IMMEDIATELY) {
+                sendBatch();
+            }
+
+            // If sending caused us to disconnect, stop. disconnect() reset
+            // our tick, so we can't keep counting toward targetTick.
+            if (state != State::Connected) {
+                return;
+            }
+        }
+
+        currentTick++;
+    }
 }
 
-void SimulatedClient::tick()
+bool SimulatedClient::networkTick()
 {
-    if (isConnected) {
-        // Process the world sim.
-        simCaller.update();
+    if (state != State::Connected) {
+        return true;
+    }
 
-        // Process the network.
-        networkCaller.update();
+    // If we haven't sent any messages since the last tick, heartbeat.
+    if (messagesSentSinceTick == 0) {
+        queueMessage(Heartbeat{currentTick});
     }
+    messagesSentSinceTick = 0;
+
+    return sendBatch();
 }
 
-void SimulatedClient::setNetstatsLoggingEnabled(bool inNetstatsLoggingEnabled)
+void SimulatedClient::disconnect(bool isIntentional)
 {
-    network.setNetstatsLoggingEnabled(inNetstatsLoggingEnabled);
+    if (socket != -1) {
+        close(socket);
+        socket = -1;
+    }
+
+    if (state == State::Connected) {
+        LoadTestStats::recordDisconnection(isIntentional);
+    }
+    else if ((state != State::Disconnected) && !isIntentional) {
+        LoadTestStats::recordFailedConnection();
+    }
+
+    // Reset our state, so we can connect again.
+    state = State::Disconnected;
+    clientEntity = entt::null;
+    currentTick = 0;
+    tickAdjustment = 0;
+    adjustmentIteration = 0;
+    isApplyingTickAdjustment = false;
+    messagesSentSinceTick = 0;
+    tracedInputSendTime = 0;
+    scenario.reset();
+    sendBatchIndex = CLIENT_HEADER_SIZE;
+    sendBacklog.clear();
+    receiveBufferSize = 0;
+    batchDecompressor.reset();
+}
+
+SimulatedClient::State SimulatedClient::getState() const
+{
+    return state;
+}
+
+int SimulatedClient::getSocket() const
+{
+    return socket;
+}
+
+bool SimulatedClient::processReceivedBatches()
+{
+    // Process every full batch in the buffer.
+    std::size_t readIndex{0};
+    while ((receiveBufferSize - readIndex) >= SERVER_HEADER_SIZE) {
+        const Uint8* header{receiveBuffer.data() + readIndex};
+        Uint16 batchSize{
+            ByteTools::read16(header + ServerHeaderIndex::BatchSize)};
+        batchSize &= ~(1U << 15);
+        if (batchSize > (RECEIVE_BUFFER_SIZE - SERVER_HEADER_SIZE)) {
+            return false;
+        }
+
+        // If we don't have the full batch yet, wait for more bytes.
+        if ((receiveBufferSize - readIndex)
+            < (SERVER_HEADER_SIZE + batchSize)) {
+            break;
+        }
+
+        if (!processBatch(header, (header + SERVER_HEADER_SIZE),
+                          batchSize)) {
+            return false;
+        }
+        readIndex += (SERVER_HEADER_SIZE + batchSize);
+    }
+
+    // Move any partial batch to the front of the buffer.
+    std::copy((receiveBuffer.data() + readIndex),
+              (receiveBuffer.data() + receiveBufferSize),
+              receiveBuffer.data());
+    receiveBufferSize -= readIndex;
+
+    return true;
+}
+
+bool SimulatedClient::processBatch(const Uint8* header, const Uint8* batch,
+                                   std::size_t batchSize)
+{
+    LoadTestStats::recordBatchReceived();
+
+    // Check if we need to adjust our tick.
+    adjustIfNeeded(
+        static_cast<Sint8>(header[ServerHeaderIndex::TickAdjustment]),
+        header[ServerHeaderIndex::AdjustmentIteration]);
+
+    // If the batch is compressed, decompress it.
+    // Note: Every compressed batch must go through batchDecompressor, to keep
+    //       its history in sync with the server's.
+    bool isCompressed{
+        (ByteTools::read16(header + ServerHeaderIndex::BatchSize)
+         & (1U << 15))
+        != 0};
+    if (isCompressed) {
+        batch = batchDecompressor.decompress(batch, batchSize, batchSize);
+        if (batch == nullptr) {
+            return false;
+        }
+    }
+
+    // Process the messages.
+    std::size_t bufferIndex{0};
+    while ((bufferIndex + MESSAGE_HEADER_SIZE) <= batchSize) {
+        MessageType messageType{static_cast<MessageType>(
+            batch[bufferIndex + MessageHeaderIndex::MessageType])};
+        Uint16 messageSize{ByteTools::read16(
+            batch + bufferIndex + MessageHeaderIndex::Size)};
+        if ((bufferIndex + MESSAGE_HEADER_SIZE + messageSize) > batchSize) {
+            return false;
+        }
+
+        // Note: We ignore fragments, since they only carry large messages
+        //       (e.g. chunk data) that we don't need.
+        processMessage(messageType,
+                       (batch + bufferIndex + MessageHeaderIndex::MessageStart),
+                       messageSize);
+
+        bufferIndex += (MESSAGE_HEADER_SIZE + messageSize);
+    }
+
+    return (bufferIndex == batchSize);
+}
+
+void SimulatedClient::processMessage(MessageType messageType,
+                                     const Uint8* messageBuffer,
+                                     std::size_t messageSize)
+{
+    switch (messageType) {
+        case MessageType::ConnectionResponse: {
+            ConnectionResponse connectionResponse{};
+            if ((state != State::AwaitingResponse)
+                || !(Deserialize::fromBuffer(messageBuffer, messageSize,
+                                             connectionResponse))) {
+                break;
+            }
+
+            // Aim our tick for some reasonable point ahead of the server.
+            // The server will adjust us after the first message anyway.
+            clientEntity = connectionResponse.entity;
+            currentTick = connectionResponse.tickNum
+                          + Client::Config::INITIAL_TICK_OFFSET;
+            state = State::Connected;
+
+            Uint64 connectTime{SDL_GetPerformanceCounter()
+                               - connectStartTime};
+            LoadTestStats::recordConnection(
+                (connectTime * 1000000) / SDL_GetPerformanceFrequency());
+            break;
+        }
+        case MessageType::MovementUpdate: {
+            // If we're timing an input, check if this update reflects it.
+            if ((tracedInputSendTime == 0)
+                || !(Deserialize::fromBuffer(messageBuffer, messageSize,
+                                             movementUpdate))) {
+                break;
+            }
+
+            for (const MovementState& movementState :
+                 movementUpdate.movementStates) {
+                if ((movementState.entity == clientEntity)
+                    && (movementState.input.inputStates
+                        == tracedInput.inputStates)) {
+                    Uint64 latency{SDL_GetPerformanceCounter()
+                                   - tracedInputSendTime};
+                    LoadTestStats::recordInputLatency(
+                        (latency * 1000000) / SDL_GetPerformanceFrequency());
+                    tracedInputSendTime = 0;
+                    break;
+                }
+            }
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+}
+
+void SimulatedClient::adjustIfNeeded(Sint8 receivedTickAdj,
+                                     Uint8 receivedAdjIteration)
+{
+    // If it's the current iteration and we aren't already applying it,
+    // apply it.
+    if ((receivedTickAdj != 0)
+        && (receivedAdjIteration == adjustmentIteration)
+        && !isApplyingTickAdjustment) {
+        tickAdjustment += receivedTickAdj;
+        isApplyingTickAdjustment = true;
+    }
+}
+
+int SimulatedClient::transferTickAdjustment()
+{
+    if (!isApplyingTickAdjustment) {
+        return 0;
+    }
+
+    if (tickAdjustment < 0) {
+        // We can only freeze for 1 tick at a time.
+        tickAdjustment += 1;
+        return -1;
+    }
+    else if (tickAdjustment > 0) {
+        // We can process multiple ticks to catch up.
+        int adjustment{tickAdjustment};
+        tickAdjustment = 0;
+        return adjustment;
+    }
+    else {
+        // We finished applying the adjustment, increment the iteration.
+        adjustmentIteration++;
+        isApplyingTickAdjustment = false;
+        return 0;
+    }
+}
+
+bool SimulatedClient::sendBatch()
+{
+    // If we have any messages waiting, move them into the backlog.
+    std::size_t batchSize{sendBatchIndex - CLIENT_HEADER_SIZE};
+    if (batchSize > 0) {
+        // Note: We don't compress, since our batches are tiny.
+        sendBatchBuffer[ClientHeaderIndex::AdjustmentIteration]
+            = adjustmentIteration;
+        ByteTools::write16(
+            static_cast<Uint16>(batchSize),
+            (sendBatchBuffer.data() + ClientHeaderIndex::BatchSize));
+        sendBacklog.insert(sendBacklog.end(), sendBatchBuffer.begin(),
+                           (sendBatchBuffer.begin() + sendBatchIndex));
+        sendBatchIndex = CLIENT_HEADER_SIZE;
+    }
+
+    if (sendBacklog.empty()) {
+        return true;
+    }
+    else if (sendBacklog.size() > MAX_SEND_BACKLOG_SIZE) {
+        LOG_INFO("Send backlog is full, disconnecting.");
+        disconnect(false);
+        return false;
+    }
+
+    // Send as much of the backlog as the OS will accept.
+    ssize_t result{::send(socket, sendBacklog.data(), sendBacklog.size(),
+                          MSG_NOSIGNAL)};
+    if (result >= 0) {
+        LoadTestStats::recordBytesSent(static_cast<std::size_t>(result));
+        sendBacklog.erase(sendBacklog.begin(), (sendBacklog.begin() + result));
+    }
+    else if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
+        disconnect(false);
+        return false;
+    }
+
+    return true;
 }
 
 } // End namespace LTC
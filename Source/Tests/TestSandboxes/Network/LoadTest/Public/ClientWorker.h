@@ -0,0 +1,139 @@
+#pragma once
+
+#include "SimulatedClient.h"
+#include "PeriodicCaller.h"
+#include <sys/epoll.h>
+#include <netinet/in.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace AM
+{
+namespace LTC
+{
+/**
+ * Drives a shard of simulated clients from a single thread.
+ *
+ * Each worker owns its own epoll instance, and waits on it between sim and
+ * network ticks. This lets a handful of workers drive thousands of clients,
+ * instead of needing a thread (or two) per client.
+ *
+ * Connections are started when the main thread calls addClient(), so that it
+ * can control the rate at which clients connect.
+ */
+class ClientWorker
+{
+public:
+    /**
+     * Constructs the worker's clients and starts its thread.
+     *
+     * @param firstSeed  The scenario seed to give the first client. Each
+     *                   following client gets the next seed.
+     */
+    ClientWorker(const sockaddr_in& inServerAddress, ScenarioType scenarioType,
+                 unsigned int numClients, Uint32 firstSeed);
+
+    /**
+     * Stops the worker's thread and disconnects its clients.
+     */
+    ~ClientWorker();
+
+    /**
+     * Tells the worker to start connecting its next client.
+     *
+     * @return false if all of this worker's clients have already been added,
+     *         else true.
+     */
+    bool addClient();
+
+private:
+    /** The max number of events to process per epoll_wait(). */
+    static constexpr int MAX_EVENTS{256};
+
+    /** How often to disconnect and reconnect clients in the ReconnectStorm
+        scenario. */
+    static constexpr double RECONNECT_STORM_PERIOD_S{20};
+
+    /** The fraction of connected clients to reconnect in each storm. */
+    static constexpr double RECONNECT_STORM_FRACTION{0.25};
+
+    /**
+     * The worker thread's loop.
+     */
+    void run();
+
+    /**
+     * Starts connecting any clients that the main thread has added.
+     */
+    void connectAddedClients();
+
+    /**
+     * Starts connecting the client at the given index, and adds its socket
+     * to our epoll instance.
+     */
+    void connectClient(unsigned int clientIndex);
+
+    /**
+     * Waits up to timeoutMs for socket events, then processes them.
+     */
+    void processEvents(int timeoutMs);
+
+    /**
+     * Calls simTick() on every client.
+     */
+    void simTick();
+
+    /**
+     * Calls networkTick() on every client.
+     */
+    void networkTick();
+
+    /**
+     * Disconnects and reconnects a fraction of our connected clients.
+     */
+    void reconnectStorm();
+
+    /** The address to connect clients to. */
+    const sockaddr_in serverAddress;
+
+    const ScenarioType scenarioType;
+
+    /** This worker's clients. Index matches the epoll event data. */
+    std::vector<std::unique_ptr<SimulatedClient>> clients;
+
+    /** The number of clients that the main thread has added. */
+    std::atomic<unsigned int> addedClientCount;
+
+    /** The number of added clients that we've started connecting. */
+    unsigned int startedClientCount;
+
+    /** Our epoll instance's file descriptor. */
+    int epollFd;
+
+    /** Holds the events returned by epoll_wait(). */
+    std::array<epoll_event, MAX_EVENTS> events;
+
+    /** Calls simTick() at the sim tick rate. */
+    PeriodicCaller simCaller;
+
+    /** Calls networkTick() at the network tick rate. */
+    PeriodicCaller networkCaller;
+
+    /** Calls reconnectStorm() in the ReconnectStorm scenario. */
+    PeriodicCaller reconnectStormCaller;
+
+    /** The next client to consider in reconnectStorm(). */
+    unsigned int nextStormIndex;
+
+    /** Turn false to signal that the worker thread should end. */
+    std::atomic<bool> isRunning;
+
+    /** The worker thread. */
+    std::thread workerThread;
+};
+
+} // End namespace LTC
+} // End namespace AM
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Histogram.h"
+#include <SDL_stdinc.h>
+#include <atomic>
+
+namespace AM
+{
+namespace LTC
+{
+/**
+ * Cumulative counters for a load test run.
+ */
+struct LoadTestTotals {
+    Uint64 bytesSent{0};
+    Uint64 bytesReceived{0};
+    Uint64 batchesReceived{0};
+    Uint64 inputsSent{0};
+
+    /** The number of connections that received a ConnectionResponse. */
+    Uint64 connections{0};
+    /** The number of connection attempts that failed before receiving a
+        ConnectionResponse. */
+    Uint64 failedConnections{0};
+    /** The number of connected clients that were disconnected, not counting
+        intentional reconnects. */
+    Uint64 disconnections{0};
+};
+
+/**
+ * Tracks the load test's bandwidth, connection, and latency stats, across
+ * all of the worker threads.
+ *
+ * Note: This is a static class for the same reason as NetworkStats, the
+ *       stats are recorded deep inside the workers' client state machines.
+ */
+class LoadTestStats
+{
+public:
+    /**
+     * Returns the cumulative counters.
+     */
+    static LoadTestTotals getTotals();
+
+    /**
+     * Returns the number of clients that are currently connected.
+     */
+    static unsigned int getConnectedClientCount();
+
+    /**
+     * Returns the distribution of times, in microseconds, from starting a
+     * connection to receiving its ConnectionResponse.
+     */
+    static Histogram::Snapshot getConnectLatencySnapshot();
+
+    /**
+     * Returns the distribution of times, in microseconds, from sending an
+     * input to receiving a movement update that reflects it.
+     */
+    static Histogram::Snapshot getInputLatencySnapshot();
+
+    // Mutators
+    static void recordBytesSent(std::size_t bytesSent);
+    static void recordBytesReceived(std::size_t bytesReceived);
+    static void recordBatchReceived();
+    static void recordInputSent();
+    static void recordConnection(Uint64 connectLatencyUs);
+    static void recordFailedConnection();
+    static void recordDisconnection(bool wasIntentional);
+    static void recordInputLatency(Uint64 inputLatencyUs);
+
+private:
+    static std::atomic<Uint64> bytesSent;
+    static std::atomic<Uint64> bytesReceived;
+    static std::atomic<Uint64> batchesReceived;
+    static std::atomic<Uint64> inputsSent;
+    static std::atomic<Uint64> connections;
+    static std::atomic<Uint64> failedConnections;
+    static std::atomic<Uint64> disconnections;
+    static std::atomic<unsigned int> connectedClientCount;
+
+    static Histogram connectLatencyUs;
+    static Histogram inputLatencyUs;
+};
+
+} // End namespace LTC
+} // End namespace AM
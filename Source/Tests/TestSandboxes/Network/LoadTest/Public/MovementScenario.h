@@ -0,0 +1,126 @@
+#pragma once
+
+#include "Input.h"
+#include <SDL_stdinc.h>
+#include <random>
+#include <string_view>
+
+namespace AM
+{
+namespace LTC
+{
+/**
+ * The movement patterns that simulated clients can follow.
+ */
+enum class ScenarioType {
+    /** Clients move in short bursts, staying near where they spawned.
+        Stresses dense area of interest overlap. */
+    Clustered,
+    /** Clients walk in random directions. */
+    RandomWalk,
+    /** Clients walk back and forth along the X axis, across many chunks.
+        Stresses chunk streaming and area of interest churn. */
+    Corridor,
+    /** Clients walk in random directions, and large groups of them
+        periodically reconnect at once. Stresses entity spawning and area of
+        interest initialization. */
+    ReconnectStorm
+};
+
+/**
+ * Decides which inputs a single simulated client sends, based on its
+ * scenario.
+ */
+class MovementScenario
+{
+public:
+    /**
+     * @param seed  Used to seed this client's random decisions. Should be
+     *              unique per client, so they don't all move in lockstep.
+     */
+    MovementScenario(ScenarioType inType, Uint32 seed);
+
+    /**
+     * Advances the scenario by 1 sim tick.
+     *
+     * @param outInput  If returning true, set to the client's new input.
+     * @return true if the client's input changed, else false.
+     */
+    bool tick(Input& outInput);
+
+    /**
+     * Call when the client reconnects. The server gives us a fresh entity
+     * at our spawn point, so this resets our displacement and makes the
+     * next tick() resend our current direction.
+     */
+    void reset();
+
+    /**
+     * Parses the given scenario name.
+     *
+     * @return true if the name was valid, else false.
+     */
+    static bool fromString(std::string_view name, ScenarioType& outType);
+
+    /**
+     * Returns the given scenario's name.
+     */
+    static const char* toString(ScenarioType type);
+
+private:
+    /** The range of ticks to hold each input for, in the Clustered
+        scenario. */
+    static constexpr unsigned int CLUSTERED_MIN_TICKS{5};
+    static constexpr unsigned int CLUSTERED_MAX_TICKS{20};
+
+    /** How far a client may move away from its spawn point, in ticks of
+        movement along each axis, in the Clustered scenario. */
+    static constexpr int CLUSTER_RADIUS_TICKS{60};
+
+    /** The range of ticks to hold each input for, in the RandomWalk and
+        ReconnectStorm scenarios. */
+    static constexpr unsigned int WALK_MIN_TICKS{15};
+    static constexpr unsigned int WALK_MAX_TICKS{90};
+
+    /** How many ticks each leg of the Corridor scenario lasts. */
+    static constexpr unsigned int CORRIDOR_LEG_TICKS{600};
+
+    /**
+     * Chooses the next direction to move in and how long to hold it.
+     */
+    void chooseNextMove();
+
+    /**
+     * Returns an input that moves in the given direction.
+     * Each direction is -1, 0, or 1.
+     */
+    static Input getInput(int directionX, int directionY);
+
+    /**
+     * Returns a random integer in the range [min, max].
+     */
+    unsigned int getRandom(unsigned int min, unsigned int max);
+
+    ScenarioType type;
+
+    std::minstd_rand randomEngine;
+
+    /** The direction that we're currently moving in. Each is -1, 0, or 1. */
+    int directionX;
+    int directionY;
+
+    /** If true, the server doesn't know our current direction yet, so the
+        next tick() should send it even if it doesn't change. */
+    bool inputIsStale;
+
+    /** How many ticks are left until we change direction. */
+    unsigned int ticksTillChange;
+
+    /** How far we've moved from our spawn point, in ticks of movement along
+        each axis. */
+    int displacementX;
+    int displacementY;
+};
+
+} // End namespace LTC
+} // End namespace AM
@@ -1,47 +1,251 @@
 #pragma once
 
-#include "QueuedEvents.h"
-#include "Network.h"
-#include "WorldSimulation.h"
-#include "PeriodicCaller.h"
+#include "MovementScenario.h"
+#include "MovementUpdate.h"
+#include "StreamDecompressor.h"
+#include "BinaryBuffer.h"
+#include "NetworkDefs.h"
+#include "Serialize.h"
+#include "MessageRegistry.h"
+#include "ByteTools.h"
+#include "Input.h"
+#include "entt/entity/registry.hpp"
 #include <SDL_stdinc.h>
-#include <atomic>
+#include <netinet/in.h>
+#include <cstddef>
 
 namespace AM
 {
 namespace LTC
 {
 /**
- * Represents a single simulated client.
- * Maintains only as much state as is necessary to keep the connection going
- * and send inputs.
+ * A lightweight simulated client.
+ *
+ * Maintains only as much state as is necessary to keep the connection going,
+ * send its scenario's inputs, and measure latency. Owns a non-blocking socket,
+ * but doesn't own a thread. Instead, a ClientWorker drives many of these from
+ * a single epoll loop.
  */
 class SimulatedClient
 {
 public:
-    SimulatedClient();
+    enum class State {
+        /** Not connected. */
+        Disconnected,
+        /** Waiting for the TCP connection to finish. */
+        Connecting,
+        /** Connected, waiting for the server's ConnectionResponse. */
+        AwaitingResponse,
+        /** Fully connected, ticking and sending inputs. */
+        Connected
+    };
 
     /**
-     * Calls worldSim.connect().
+     * @param seed  Used to seed the client's scenario. Should be unique per
+     *              client.
      */
-    void connect();
+    SimulatedClient(ScenarioType scenarioType, Uint32 seed);
 
     /**
-     * Calls the sim and network ticks.
+     * Closes the socket, if it's open.
      */
-    void tick();
+    ~SimulatedClient();
 
-    void setNetstatsLoggingEnabled(bool inNetstatsLoggingEnabled);
+    /**
+     * Starts a non-blocking connection to the given address.
+     *
+     * @return The new socket's file descriptor, or -1 if the connection
+     *         couldn't be started.
+     */
+    int connect(const sockaddr_in& serverAddress);
+
+    /**
+     * Call when the socket becomes writable while we're Connecting.
+     *
+     * @return true if the connection succeeded, else false (the client will
+     *         be Disconnected).
+     */
+    bool finishConnect();
+
+    /**
+     * Receives and processes all of the bytes that are waiting on the socket.
+     *
+     * @return false if the server disconnected us, else true.
+     */
+    bool receive();
+
+    /**
+     * Processes one sim tick, advancing our scenario and applying any tick
+     * adjustments from the server.
+     */
+    void simTick();
+
+    /**
+     * Processes one network tick. Queues a heartbeat if we haven't sent
+     * anything since the last network tick, then sends our batch.
+     *
+     * @return false if the server disconnected us, else true.
+     */
+    bool networkTick();
+
+    /**
+     * Closes the socket and resets our state, so that we can connect again.
+     *
+     * @param isIntentional  If true, the disconnect won't be counted in the
+     *                       stats (e.g. during a reconnect storm).
+     */
+    void disconnect(bool isIntentional);
+
+    State getState() const;
+
+    /**
+     * Returns our socket's file descriptor, or -1 if we aren't connected.
+     */
+    int getSocket() const;
 
 private:
-    Client::Network network;
-    PeriodicCaller networkCaller;
+    /** The max number of bytes that can be waiting to be sent. If we exceed
+        this, the server isn't keeping up with us and we disconnect. */
+    static constexpr std::size_t MAX_SEND_BACKLOG_SIZE{64 * 1024};
+
+    /** The size of our receive buffer. Must fit at least 1 max-size server
+        batch. */
+    static constexpr std::size_t RECEIVE_BUFFER_SIZE{16 * 1024};
+
+    /**
+     * Processes every full server batch in receiveBuffer, leaving any
+     * partial batch for the next receive.
+     *
+     * @return false if a batch was malformed, else true.
+     */
+    bool processReceivedBatches();
 
-    WorldSimulation worldSim;
-    PeriodicCaller simCaller;
+    /**
+     * Processes a single server batch.
+     *
+     * @return false if the batch was malformed, else true.
+     */
+    bool processBatch(const Uint8* header, const Uint8* batch,
+                      std::size_t batchSize);
+
+    /**
+     * Processes a single received message.
+     */
+    void processMessage(MessageType messageType, const Uint8* messageBuffer,
+                        std::size_t messageSize);
+
+    /**
+     * Applies the given tick adjustment, if we haven't already.
+     * Mirrors Client::Network::adjustIfNeeded().
+     */
+    void adjustIfNeeded(Sint8 receivedTickAdj, Uint8 receivedAdjIteration);
 
-    std::atomic<bool> isConnected;
+    /**
+     * Returns the amount that our tick should be adjusted by this sim tick.
+     * Mirrors Client::Network::transferTickAdjustment().
+     */
+    int transferTickAdjustment();
+
+    /**
+     * Serializes the given message into our current batch.
+     */
+    template<typename T>
+    void queueMessage(const T& message);
+
+    /**
+     * Moves the current batch into sendBacklog, then sends as much of the
+     * backlog as the OS will accept.
+     *
+     * @return false if the server disconnected us, else true.
+     */
+    bool sendBatch();
+
+    /** Our socket's file descriptor. -1 if not connected. */
+    int socket;
+
+    State state;
+
+    /** Decides which inputs we send. */
+    MovementScenario scenario;
+
+    /** The SDL performance counter value from when we started connecting. */
+    Uint64 connectStartTime;
+
+    /** The entity ID that we were given by the server. */
+    entt::entity clientEntity;
+
+    /** The tick that we're currently on. */
+    Uint32 currentTick;
+
+    /** The adjustment that the server has told us to apply to the tick. */
+    int tickAdjustment;
+
+    /** Tracks what iteration of tick offset adjustments we're on. */
+    Uint8 adjustmentIteration;
+
+    /** True when we're applying a tick adjustment. */
+    bool isApplyingTickAdjustment;
+
+    /** The number of messages that we've queued since the last network
+        tick. Used to determine if we need to heartbeat. */
+    unsigned int messagesSentSinceTick;
+
+    /** The input that we're timing, waiting for the server to reflect it in
+        a movement update. Only 1 input is timed at once. */
+    Input tracedInput;
+
+    /** The SDL performance counter value from when tracedInput was sent.
+        0 if we aren't timing an input. */
+    Uint64 tracedInputSendTime;
+
+    /** Holds the batch that we're currently putting together, after a
+        client header. */
+    BinaryBuffer sendBatchBuffer;
+
+    /** The current end of the batch in sendBatchBuffer. */
+    std::size_t sendBatchIndex;
+
+    /** Holds bytes that the OS wasn't ready to accept. */
+    BinaryBuffer sendBacklog;
+
+    /** Holds received bytes that haven't been processed yet. */
+    BinaryBuffer receiveBuffer;
+
+    /** The number of bytes in receiveBuffer. */
+    std::size_t receiveBufferSize;
+
+    /** Decompresses the server's batch stream. */
+    StreamDecompressor batchDecompressor;
+
+    /** Holds received movement updates while we look for tracedInput.
+        Kept as a member so its capacity is reused. */
+    MovementUpdate movementUpdate;
 };
 
+template<typename T>
+void SimulatedClient::queueMessage(const T& message)
+{
+    // If the message won't fit in the current batch, send the batch.
+    std::size_t messageSize{MESSAGE_HEADER_SIZE
+                            + measureMessageSize(message)};
+    if ((sendBatchIndex + messageSize) > sendBatchBuffer.size()) {
+        sendBatch();
+    }
+
+    // Serialize the message, leaving room for the message header.
+    Uint8* messageHeader{sendBatchBuffer.data() + sendBatchIndex};
+    std::size_t payloadSize{Serialize::toBuffer(
+        sendBatchBuffer.data(), sendBatchBuffer.size(), message,
+        (sendBatchIndex + MESSAGE_HEADER_SIZE))};
+
+    messageHeader[MessageHeaderIndex::MessageType]
+        = static_cast<Uint8>(T::MESSAGE_TYPE);
+    ByteTools::write16(static_cast<Uint16>(payloadSize),
+                       (messageHeader + MessageHeaderIndex::Size));
+
+    sendBatchIndex += (MESSAGE_HEADER_SIZE + payloadSize);
+    messagesSentSinceTick++;
+}
+
 } // End namespace LTC
 } // End namespace AM
@@ -0,0 +1,240 @@
+#include "SDL2pp/SDL.hh"
+#include "SDL2pp/Exception.hh"
+
+#include "UserConfigInitializer.h"
+#include "SpriteData.h"
+#include "Network.h"
+#include "Simulation.h"
+#include "MessageProcessor.h"
+#include "InputTraceReader.h"
+#include "LoopbackAcceptor.h"
+#include "ServerNetworkDefs.h"
+#include "QueuedEvents.h"
+#include "PeriodicCaller.h"
+#include "SharedConfig.h"
+#include "Histogram.h"
+#include "Log.h"
+
+#include <SDL_timer.h>
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <string>
+
+using namespace AM;
+using namespace AM::Server;
+
+void printUsage()
+{
+    std::printf(
+        "Usage: ReplayTest.exe <TraceFile> <Speed>\n"
+        "  TraceFile: The input trace to replay. Recorded by the server when"
+        " Config::RECORD_INPUT_TRACE is true.\n"
+        "  Speed: \"fast\" to process ticks back-to-back, or \"realtime\" to"
+        " process them at the sim tick rate. Default: fast.\n"
+        "Note: The server's resource files (TileMap.bin, SpriteData.json,"
+        " etc) must be next to the executable. The map may be saved over,"
+        " so use a copy.\n");
+}
+
+/**
+ * Feeds an input trace into a fresh Simulation, timing each tick.
+ */
+class TraceReplayer
+{
+public:
+    TraceReplayer(const std::string& traceFilePath)
+    : userConfigInitializer{}
+    , spriteData{}
+    , network{std::make_unique<LoopbackAcceptor>(), false}
+    , simulation{network, spriteData}
+    , messageProcessor{network.getEventDispatcher()}
+    , traceReader{traceFilePath}
+    , nextRecord{}
+    , hasNextRecord{traceReader.readNext(nextRecord)}
+    , tickTimesUs{}
+    , maxTickTimeUs{0}
+    , recordCount{0}
+    {
+    }
+
+    /**
+     * Feeds in every record up to the current tick, then runs the tick.
+     */
+    void tick()
+    {
+        // Feed in the records that the server received before this tick.
+        Uint32 currentTick{simulation.getCurrentTick()};
+        while (hasNextRecord && (nextRecord.tickNum <= currentTick)) {
+            replayRecord(nextRecord);
+            hasNextRecord = traceReader.readNext(nextRecord);
+        }
+
+        // Run and time the tick.
+        Uint64 startTime{SDL_GetPerformanceCounter()};
+        simulation.tick();
+        Uint64 tickTimeUs{((SDL_GetPerformanceCounter() - startTime) * 1000000)
+                          / SDL_GetPerformanceFrequency()};
+        tickTimesUs.record(tickTimeUs);
+        maxTickTimeUs = std::max(maxTickTimeUs, tickTimeUs);
+    }
+
+    /**
+     * Returns true if every record has been replayed.
+     */
+    bool isFinished() { return !hasNextRecord; }
+
+    /**
+     * Logs the tick cost statistics.
+     */
+    void logSummary(double wallTimeS)
+    {
+        Histogram::Snapshot snapshot{tickTimesUs.getSnapshot()};
+        double simTimeS{snapshot.count * SharedConfig::SIM_TICK_TIMESTEP_S};
+
+        LOG_INFO("===== Replay summary =====");
+        LOG_INFO("Replayed %llu records over %llu ticks (%.1fs of sim time) "
+                 "in %.1fs.",
+                 static_cast<unsigned long long>(recordCount),
+                 static_cast<unsigned long long>(snapshot.count), simTimeS,
+                 wallTimeS);
+        LOG_INFO("Tick cost (us): mean %llu, p50 <= %llu, p90 <= %llu, "
+                 "p99 <= %llu, max %llu",
+                 static_cast<unsigned long long>(
+                     (snapshot.count > 0) ? (snapshot.sum / snapshot.count)
+                                          : 0),
+                 static_cast<unsigned long long>(snapshot.getPercentile(0.5)),
+                 static_cast<unsigned long long>(snapshot.getPercentile(0.9)),
+                 static_cast<unsigned long long>(snapshot.getPercentile(0.99)),
+                 static_cast<unsigned long long>(maxTickTimeUs));
+        LOG_INFO("Tick budget (us): %.0f",
+                 (SharedConfig::SIM_TICK_TIMESTEP_S * 1000000));
+    }
+
+private:
+    /**
+     * Pushes the given record into the simulation, the same way that the
+     * network's receive thread would.
+     */
+    void replayRecord(InputTraceRecord& record)
+    {
+        recordCount++;
+        switch (record.recordType) {
+            case InputTrace::RecordType::ClientConnected: {
+                network.getEventDispatcher().emplace<ClientConnected>(
+                    record.netID);
+                break;
+            }
+            case InputTrace::RecordType::ClientDisconnected: {
+                network.getEventDispatcher().emplace<ClientDisconnected>(
+                    record.netID);
+                break;
+            }
+            case InputTrace::RecordType::Message: {
+                messageProcessor.processReceivedMessage(
+                    record.netID, record.messageType,
+                    record.messageBuffer.data(),
+                    static_cast<unsigned int>(record.messageBuffer.size()));
+                break;
+            }
+            default: {
+                LOG_FATAL("Invalid record type: %u",
+                          static_cast<unsigned int>(record.recordType));
+            }
+        }
+    }
+
+    UserConfigInitializer userConfigInitializer;
+
+    SpriteData spriteData;
+
+    /** Never has any clients, so the messages that the sim sends are
+        serialized but dropped.
+        Doesn't record an input trace, since it would overwrite the trace
+        that we're replaying. */
+    Network network;
+
+    Simulation simulation;
+
+    /** Deserializes the traced messages and pushes them to the sim. */
+    MessageProcessor messageProcessor;
+
+    InputTraceReader traceReader;
+
+    /** The next record to replay. Only valid if hasNextRecord is true. */
+    InputTraceRecord nextRecord;
+    bool hasNextRecord;
+
+    /** The duration of each tick, in microseconds. */
+    Histogram tickTimesUs;
+    Uint64 maxTickTimeUs;
+
+    /** The number of records that we've replayed. */
+    Uint64 recordCount;
+};
+
+int main(int argc, char** argv)
+try {
+    if ((argc < 2) || (argc > 3)) {
+        printUsage();
+        return 1;
+    }
+
+    bool isRealtime{false};
+    if (argc > 2) {
+        if (std::strcmp(argv[2], "realtime") == 0) {
+            isRealtime = true;
+        }
+        else if (std::strcmp(argv[2], "fast") != 0) {
+            std::printf("Invalid speed: %s\n", argv[2]);
+            printUsage();
+            return 1;
+        }
+    }
+
+    // Set up the SDL constructs.
+    SDL2pp::SDL sdl(0);
+
+    TraceReplayer replayer{argv[1]};
+    LOG_INFO("Replaying %s at %s speed.", argv[1],
+             (isRealtime ? "realtime" : "fast"));
+
+    Uint64 startTime{SDL_GetPerformanceCounter()};
+    if (isRealtime) {
+        PeriodicCaller simCaller(std::bind_front(&TraceReplayer::tick,
+                                                 &replayer),
+                                 SharedConfig::SIM_TICK_TIMESTEP_S, "Sim",
+                                 false);
+        simCaller.initTimer();
+        while (!replayer.isFinished()) {
+            simCaller.update();
+
+            // If we have time, sleep so we don't waste CPU spinning.
+            if (simCaller.getTimeTillNextCall() > .003) {
+                SDL_Delay(1);
+            }
+        }
+    }
+    else {
+        while (!replayer.isFinished()) {
+            replayer.tick();
+        }
+    }
+    double wallTimeS{
+        static_cast<double>(SDL_GetPerformanceCounter() - startTime)
+        / SDL_GetPerformanceFrequency()};
+
+    replayer.logSummary(wallTimeS);
+    Log::flush();
+
+    return 0;
+} catch (SDL2pp::Exception& e) {
+    LOG_INFO("Error in: %s  Reason:  %s", e.GetSDLFunction().c_str(),
+             e.GetSDLError().c_str());
+    return 1;
+} catch (std::exception& e) {
+    LOG_INFO("%s", e.what());
+    return 1;
+}
@@ -0,0 +1,177 @@
+#include "catch2/catch_all.hpp"
+#include "ChunkCodec.h"
+#include "ChunkSnapshot.h"
+#include "ChunkWireSnapshot.h"
+#include "ChunkPaletteBuilder.h"
+#include "Serialize.h"
+#include "Deserialize.h"
+#include "SharedConfig.h"
+#include <vector>
+#include <string>
+
+using namespace AM;
+
+bool tilesMatch(const ChunkCodec::TileArray& tilesA,
+                const ChunkCodec::TileArray& tilesB)
+{
+    for (unsigned int i = 0; i < SharedConfig::CHUNK_TILE_COUNT; ++i) {
+        if (tilesA[i].spriteLayers != tilesB[i].spriteLayers) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+TEST_CASE("TestChunkCodec")
+{
+    ChunkCodec::TileArray tiles{};
+    ChunkCodec::TileArray decodedTiles{};
+    std::vector<Uint8> buffer{};
+
+    SECTION("Index width")
+    {
+        REQUIRE(ChunkCodec::getIndexWidth(0) == 0);
+        REQUIRE(ChunkCodec::getIndexWidth(1) == 1);
+        REQUIRE(ChunkCodec::getIndexWidth(3) == 2);
+        REQUIRE(ChunkCodec::getIndexWidth(4) == 3);
+        REQUIRE(ChunkCodec::getIndexWidth(255) == 8);
+    }
+
+    SECTION("Empty chunk")
+    {
+        // Give the output some junk, to make sure it gets cleared.
+        decodedTiles[5].spriteLayers = {1, 2};
+
+        ChunkCodec::encode(tiles, buffer);
+        REQUIRE(buffer.size() == 1);
+
+        REQUIRE(ChunkCodec::decode(buffer.data(), buffer.size(), decodedTiles));
+        REQUIRE(tilesMatch(decodedTiles, tiles));
+    }
+
+    SECTION("Uniform chunk")
+    {
+        for (TileSnapshot& tile : tiles) {
+            tile.spriteLayers = {0, 1};
+        }
+
+        ChunkCodec::encode(tiles, buffer);
+        REQUIRE(buffer.size() == 4);
+
+        REQUIRE(ChunkCodec::decode(buffer.data(), buffer.size(), decodedTiles));
+        REQUIRE(tilesMatch(decodedTiles, tiles));
+    }
+
+    SECTION("Mixed chunk")
+    {
+        // A floor with a few walls and an empty corner.
+        for (unsigned int i = 0; i < SharedConfig::CHUNK_TILE_COUNT; ++i) {
+            tiles[i].spriteLayers = {0};
+            if ((i % SharedConfig::CHUNK_WIDTH) == 0) {
+                tiles[i].spriteLayers.push_back(1);
+            }
+            if (i == (SharedConfig::CHUNK_TILE_COUNT - 1)) {
+                tiles[i].spriteLayers.clear();
+            }
+        }
+        tiles[17].spriteLayers = {2, 3, 4};
+
+        ChunkCodec::encode(tiles, buffer);
+
+        REQUIRE(ChunkCodec::decode(buffer.data(), buffer.size(), decodedTiles));
+        REQUIRE(tilesMatch(decodedTiles, tiles));
+    }
+
+    SECTION("Every tile different")
+    {
+        for (unsigned int i = 0; i < SharedConfig::CHUNK_TILE_COUNT; ++i) {
+            tiles[i].spriteLayers = {static_cast<Uint8>(i)};
+        }
+
+        ChunkCodec::encode(tiles, buffer);
+
+        REQUIRE(ChunkCodec::decode(buffer.data(), buffer.size(), decodedTiles));
+        REQUIRE(tilesMatch(decodedTiles, tiles));
+    }
+
+    SECTION("Malformed input")
+    {
+        tiles[0].spriteLayers = {0};
+        tiles[1].spriteLayers = {1};
+        ChunkCodec::encode(tiles, buffer);
+
+        // Truncated data should fail.
+        REQUIRE(!ChunkCodec::decode(buffer.data(), (buffer.size() - 1),
+                                    decodedTiles));
+
+        // An unknown mode should fail.
+        buffer[0] = 200;
+        REQUIRE(!ChunkCodec::decode(buffer.data(), buffer.size(),
+                                    decodedTiles));
+
+        // No data should fail.
+        REQUIRE(!ChunkCodec::decode(buffer.data(), 0, decodedTiles));
+    }
+
+    SECTION("Round trip, then edit")
+    {
+        // Build a wire snapshot and round trip it into a reused snapshot
+        // that already has a palette.
+        ChunkWireSnapshot wireSnapshot{};
+        {
+            ChunkPaletteBuilder<int> paletteBuilder{wireSnapshot.palette};
+            wireSnapshot.tiles[0].spriteLayers.push_back(
+                static_cast<Uint8>(paletteBuilder.getIndex(6)));
+            wireSnapshot.tiles[1].spriteLayers.push_back(
+                static_cast<Uint8>(paletteBuilder.getIndex(17)));
+        }
+        Serialize::toGrowableBuffer(buffer, wireSnapshot);
+
+        ChunkWireSnapshot loadedWireSnapshot{};
+        loadedWireSnapshot.palette = {17, 6};
+        REQUIRE(Deserialize::fromBuffer(buffer.data(), buffer.size(),
+                                        loadedWireSnapshot));
+
+        // Existing IDs should map to their loaded index, new IDs should be
+        // appended.
+        ChunkPaletteBuilder<int> wirePaletteBuilder{loadedWireSnapshot.palette};
+        REQUIRE(wirePaletteBuilder.getIndex(6) == 0);
+        REQUIRE(wirePaletteBuilder.getIndex(17) == 1);
+        REQUIRE(wirePaletteBuilder.getIndex(15) == 2);
+        REQUIRE(loadedWireSnapshot.palette.size() == 3);
+
+        // Do the same for a persisted snapshot.
+        ChunkSnapshot chunkSnapshot{};
+        {
+            ChunkPaletteBuilder<std::string> paletteBuilder{
+                chunkSnapshot.palette};
+            chunkSnapshot.tiles[0].spriteLayers.push_back(
+                static_cast<Uint8>(paletteBuilder.getIndex("floor")));
+            chunkSnapshot.tiles[1].spriteLayers.push_back(
+                static_cast<Uint8>(paletteBuilder.getIndex("wall")));
+        }
+        buffer.clear();
+        Serialize::toGrowableBuffer(buffer, chunkSnapshot);
+
+        ChunkSnapshot loadedSnapshot{};
+        loadedSnapshot.palette = {"wall", "floor"};
+        REQUIRE(Deserialize::fromBuffer(buffer.data(), buffer.size(),
+                                        loadedSnapshot));
+
+        ChunkPaletteBuilder<std::string> paletteBuilder{loadedSnapshot.palette};
+        REQUIRE(paletteBuilder.getIndex("floor") == 0);
+        REQUIRE(paletteBuilder.getIndex("wall") == 1);
+        REQUIRE(paletteBuilder.getIndex("rug") == 2);
+        REQUIRE(loadedSnapshot.palette.size() == 3);
+    }
+
+    SECTION("Palette builders keep the first index of duplicate IDs")
+    {
+        std::vector<int> palette{6, 17, 6};
+        ChunkPaletteBuilder<int> paletteBuilder{palette};
+        REQUIRE(paletteBuilder.getIndex(6) == 0);
+        REQUIRE(paletteBuilder.getIndex(17) == 1);
+        REQUIRE(palette.size() == 3);
+    }
+}
@@ -0,0 +1,62 @@
+#include "catch2/catch_all.hpp"
+#include "Histogram.h"
+
+using namespace AM;
+
+TEST_CASE("TestHistogram")
+{
+    Histogram histogram{};
+
+    SECTION("Values fall into power-of-2 buckets")
+    {
+        REQUIRE(Histogram::getBucketIndex(0) == 0);
+        REQUIRE(Histogram::getBucketIndex(1) == 0);
+        REQUIRE(Histogram::getBucketIndex(2) == 1);
+        REQUIRE(Histogram::getBucketIndex(3) == 2);
+        REQUIRE(Histogram::getBucketIndex(4) == 2);
+        REQUIRE(Histogram::getBucketIndex(5) == 3);
+        REQUIRE(Histogram::getBucketIndex(1024) == 10);
+        REQUIRE(Histogram::getBucketIndex(1025) == 11);
+
+        // Each value should be within its bucket's upper bound.
+        for (Uint64 value : {1, 2, 3, 100, 1000, 100000}) {
+            std::size_t bucketIndex{Histogram::getBucketIndex(value)};
+            REQUIRE(value <= Histogram::getBucketUpperBound(bucketIndex));
+            if (bucketIndex > 0) {
+                REQUIRE(value
+                        > Histogram::getBucketUpperBound(bucketIndex - 1));
+            }
+        }
+    }
+
+    SECTION("Large values go in the last bucket")
+    {
+        REQUIRE(Histogram::getBucketIndex(UINT64_MAX)
+                == (Histogram::BUCKET_COUNT - 1));
+        REQUIRE(Histogram::getBucketUpperBound(Histogram::BUCKET_COUNT - 1)
+                == UINT64_MAX);
+    }
+
+    SECTION("Snapshot holds recorded values")
+    {
+        histogram.record(1);
+        histogram.record(3);
+        histogram.record(3);
+        histogram.record(100);
+
+        Histogram::Snapshot snapshot{histogram.getSnapshot()};
+        REQUIRE(snapshot.count == 4);
+        REQUIRE(snapshot.sum == 107);
+        REQUIRE(snapshot.bucketCounts[0] == 1);
+        REQUIRE(snapshot.bucketCounts[2] == 2);
+        REQUIRE(snapshot.bucketCounts[7] == 1);
+
+        // Percentiles resolve to their bucket's upper bound.
+        REQUIRE(snapshot.getPercentile(0.5) == 4);
+        REQUIRE(snapshot.getPercentile(1.0) == 128);
+
+        histogram.reset();
+        REQUIRE(histogram.getSnapshot().count == 0);
+        REQUIRE(histogram.getSnapshot().getPercentile(0.5) == 0);
+    }
+}
@@ -0,0 +1,43 @@
+#include "catch2/catch_all.hpp"
+#include "IDPool.h"
+#include <vector>
+
+using namespace AM;
+
+TEST_CASE("TestIDPool")
+{
+    const unsigned int POOL_SIZE{10};
+    IDPool idPool(POOL_SIZE);
+
+    SECTION("IDs march forward")
+    {
+        // The first ID is 1, then they count up.
+        REQUIRE(idPool.reserveID() == 1);
+        REQUIRE(idPool.reserveID() == 2);
+        REQUIRE(idPool.reserveID() == 3);
+    }
+
+    SECTION("Freed IDs go to the back of the line")
+    {
+        unsigned int firstID{idPool.reserveID()};
+        idPool.freeID(firstID);
+
+        // The freed ID shouldn't be given out until every other ID has been.
+        std::vector<unsigned int> reservedIDs{};
+        for (unsigned int i = 0; i < (idPool.getContainerSize() - 1); ++i) {
+            reservedIDs.push_back(idPool.reserveID());
+            REQUIRE(reservedIDs.back() != firstID);
+
+            // Free it so we don't run out.
+            idPool.freeID(reservedIDs.back());
+        }
+        REQUIRE(idPool.reserveID() == firstID);
+    }
+
+    SECTION("IDs are within the container")
+    {
+        for (unsigned int i = 0; i < POOL_SIZE; ++i) {
+            REQUIRE(idPool.reserveID() < idPool.getContainerSize());
+        }
+    }
+}
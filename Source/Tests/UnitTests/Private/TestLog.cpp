@@ -0,0 +1,74 @@
+#include "catch2/catch_all.hpp"
+#include "Log.h"
+#include <chrono>
+#include <thread>
+
+using namespace AM;
+
+TEST_CASE("TestLog")
+{
+    SECTION("A call site is limited to RATE_LIMIT_MESSAGES per period")
+    {
+        Log::Callsite callsite{};
+        Uint32 suppressedCount{0};
+        for (Uint32 i = 0; i < Log::RATE_LIMIT_MESSAGES; ++i) {
+            REQUIRE(callsite.shouldLog(suppressedCount));
+            REQUIRE(suppressedCount == 0);
+        }
+
+        // The rest of this period's messages should be suppressed.
+        REQUIRE(!(callsite.shouldLog(suppressedCount)));
+        REQUIRE(!(callsite.shouldLog(suppressedCount)));
+        REQUIRE(!(callsite.shouldLog(suppressedCount)));
+
+        // The next period's first message should report the suppressions.
+        std::this_thread::sleep_for(std::chrono::duration<double>(
+            Log::RATE_LIMIT_PERIOD_S * 1.1));
+        REQUIRE(callsite.shouldLog(suppressedCount));
+        REQUIRE(suppressedCount == 3);
+    }
+
+    SECTION("Suppressed messages are counted")
+    {
+        Log::Callsite callsite{};
+        Uint64 startCount{Log::getSuppressedMessageCount()};
+        for (Uint32 i = 0; i < (Log::RATE_LIMIT_MESSAGES + 5); ++i) {
+            Log::write(Log::Level::Info, &callsite, __FILE__, __LINE__,
+                       "TestLog rate limit message %u", i);
+        }
+
+        REQUIRE((Log::getSuppressedMessageCount() - startCount) == 5);
+        Log::flush();
+    }
+
+    SECTION("Messages are dropped and counted when a thread's ring is full")
+    {
+        // Log from a fresh thread, so we get an empty ring. Log faster than
+        // the writer thread can keep up, until a message gets dropped.
+        // Note: We skip rate limiting so that every message reaches the
+        //       ring.
+        Uint64 startCount{Log::getDroppedMessageCount()};
+        Uint64 droppedAfterError{0};
+        std::thread logThread([&]() {
+            for (unsigned int i = 0; i < 100'000; ++i) {
+                Log::write(Log::Level::Info, nullptr, __FILE__, __LINE__,
+                           "TestLog flood message %u", i);
+                if (Log::getDroppedMessageCount() != startCount) {
+                    break;
+                }
+            }
+
+            // Errors make room for themselves instead of being dropped.
+            Uint64 droppedBeforeError{Log::getDroppedMessageCount()};
+            Log::write(Log::Level::Error, nullptr, __FILE__, __LINE__,
+                       "TestLog error message (expected)");
+            droppedAfterError
+                = (Log::getDroppedMessageCount() - droppedBeforeError);
+        });
+        logThread.join();
+
+        REQUIRE(Log::getDroppedMessageCount() > startCount);
+        REQUIRE(droppedAfterError == 0);
+        Log::flush();
+    }
+}
@@ -0,0 +1,81 @@
+#include "catch2/catch_all.hpp"
+#include "LoopbackAcceptor.h"
+#include "LoopbackSocket.h"
+#include "Peer.h"
+#include "NetworkDefs.h"
+#include "ByteTools.h"
+#include <array>
+#include <memory>
+
+using namespace AM;
+
+TEST_CASE("TestLoopbackSocket")
+{
+    SECTION("Bytes are received in order, across the end of the ring")
+    {
+        auto [socketA, socketB] = LoopbackSocket::createPair(8);
+        std::array<Uint8, 6> sendBytes{1, 2, 3, 4, 5, 6};
+        std::array<Uint8, 8> receiveBytes{};
+
+        // Fill most of the ring, then drain it so the next send wraps.
+        REQUIRE(socketA->trySend(sendBytes.data(), 6) == 6);
+        REQUIRE(socketB->receive(receiveBytes.data(), 8) == 6);
+        REQUIRE(socketA->trySend(sendBytes.data(), 6) == 6);
+
+        // Only 2 bytes of room are left.
+        REQUIRE(socketA->trySend(sendBytes.data(), 6) == 2);
+
+        REQUIRE(socketB->isReady());
+        REQUIRE(socketB->receive(receiveBytes.data(), 8) == 8);
+        std::array<Uint8, 8> expectedBytes{1, 2, 3, 4, 5, 6, 1, 2};
+        REQUIRE(receiveBytes == expectedBytes);
+        REQUIRE(!(socketB->isReady()));
+    }
+
+    SECTION("Destroying a socket disconnects the other side")
+    {
+        auto [socketA, socketB] = LoopbackSocket::createPair();
+        std::array<Uint8, 1> bytes{1};
+        socketA = nullptr;
+
+        REQUIRE(socketB->trySend(bytes.data(), 1) == -1);
+        REQUIRE(socketB->isReady());
+        REQUIRE(socketB->receive(bytes.data(), 1) == 0);
+    }
+
+    SECTION("Peers exchange messages through the acceptor")
+    {
+        LoopbackAcceptor acceptor{};
+        std::unique_ptr<Peer> clientPeer{acceptor.connect()};
+        std::unique_ptr<Peer> serverPeer{acceptor.accept()};
+        REQUIRE(serverPeer != nullptr);
+        REQUIRE(acceptor.accept() == nullptr);
+
+        // Send a message with a 2-byte payload.
+        std::array<Uint8, (MESSAGE_HEADER_SIZE + 2)> message{};
+        message[MessageHeaderIndex::MessageType] = 7;
+        ByteTools::write16(2, &(message[MessageHeaderIndex::Size]));
+        message[MessageHeaderIndex::MessageStart] = 42;
+        message[MessageHeaderIndex::MessageStart + 1] = 43;
+        REQUIRE(clientPeer->send(message.data(), message.size())
+                == NetworkResult::Success);
+
+        std::array<Uint8, Peer::MAX_WIRE_SIZE> messageBuffer{};
+        ReceiveResult result{
+            serverPeer->receiveMessage(messageBuffer.data(), true)};
+        REQUIRE(result.networkResult == NetworkResult::Success);
+        REQUIRE(static_cast<Uint8>(result.messageType) == 7);
+        REQUIRE(result.messageSize == 2);
+        REQUIRE(messageBuffer[0] == 42);
+        REQUIRE(messageBuffer[1] == 43);
+
+        // Nothing else is waiting.
+        result = serverPeer->receiveMessage(messageBuffer.data(), true);
+        REQUIRE(result.networkResult == NetworkResult::NoWaitingData);
+
+        // Disconnecting the client is seen by the server.
+        clientPeer = nullptr;
+        result = serverPeer->receiveMessage(messageBuffer.data(), true);
+        REQUIRE(result.networkResult == NetworkResult::Disconnected);
+    }
+}
@@ -0,0 +1,33 @@
+#include "catch2/catch_all.hpp"
+#include "MessagePool.h"
+#include <memory>
+#include <vector>
+
+using namespace AM;
+
+TEST_CASE("TestMessagePool")
+{
+    MessagePool<std::vector<int>> messagePool;
+
+    SECTION("Released messages are recycled")
+    {
+        std::shared_ptr<std::vector<int>> message{messagePool.acquire()};
+        message->assign(100, 1);
+        std::vector<int>* messagePtr{message.get()};
+
+        // Release it, then acquire again. We should get the same message,
+        // with its capacity intact.
+        message = nullptr;
+        message = messagePool.acquire();
+        REQUIRE(message.get() == messagePtr);
+        REQUIRE(message->capacity() >= 100);
+    }
+
+    SECTION("Held messages aren't recycled")
+    {
+        std::shared_ptr<const std::vector<int>> heldMessage{
+            messagePool.acquire()};
+        std::shared_ptr<std::vector<int>> newMessage{messagePool.acquire()};
+        REQUIRE(newMessage.get() != heldMessage.get());
+    }
+}
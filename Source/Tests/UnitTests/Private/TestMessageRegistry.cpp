@@ -0,0 +1,49 @@
+#include "catch2/catch_all.hpp"
+#include "MessageRegistry.h"
+#include "Serialize.h"
+
+using namespace AM;
+
+/**
+ * Checks that each fixed-size message in the given list serializes to its
+ * SERIALIZED_SIZE.
+ */
+template<typename... Ts>
+void checkFixedSizes(MessageList<Ts...>)
+{
+    (
+        [] {
+            if constexpr (FixedSizeMessage<Ts>) {
+                Ts message{};
+                REQUIRE(Serialize::measureSize(message) == Ts::SERIALIZED_SIZE);
+            }
+        }(),
+        ...);
+}
+
+TEST_CASE("TestMessageRegistry")
+{
+    SECTION("Fixed sizes match serialized sizes")
+    {
+        checkFixedSizes(ClientToServerMessages{});
+        checkFixedSizes(ServerToClientMessages{});
+    }
+
+    SECTION("Dispatch finds the matching type")
+    {
+        MessageType dispatchedType{MessageType::NotSet};
+        bool wasFound{ServerToClientMessages::dispatch(
+            MessageType::TileUpdate, [&]<typename T>(std::type_identity<T>) {
+                dispatchedType = T::MESSAGE_TYPE;
+            })};
+        REQUIRE(wasFound);
+        REQUIRE(dispatchedType == MessageType::TileUpdate);
+    }
+
+    SECTION("Dispatch rejects unknown types")
+    {
+        bool wasFound{ClientToServerMessages::dispatch(
+            MessageType::TileUpdate, [](auto) {})};
+        REQUIRE(!wasFound);
+    }
+}
@@ -0,0 +1,104 @@
+#include "catch2/catch_all.hpp"
+#include "StreamCompressor.h"
+#include "StreamDecompressor.h"
+#include "Client.h"
+#include "LoopbackSocket.h"
+#include "Peer.h"
+#include "NetworkDefs.h"
+#include "SharedConfig.h"
+#include "ByteTools.h"
+#include <algorithm>
+#include <memory>
+#include <random>
+
+using namespace AM;
+using namespace AM::Server;
+
+TEST_CASE("TestStreamCompressor")
+{
+    const BinaryBuffer noDictionary{};
+    StreamCompressor compressor{noDictionary};
+    StreamDecompressor decompressor{noDictionary};
+
+    SECTION("A full, incompressible batch round-trips within the frame limit")
+    {
+        // Random bytes are about as incompressible as data gets, so LZ4
+        // will expand them.
+        std::minstd_rand randomEngine{1};
+        std::uniform_int_distribution<unsigned int> byteDist{0, 255};
+        BinaryBuffer batch(Client::MAX_BATCH_PAYLOAD_SIZE);
+        for (Uint8& byte : batch) {
+            byte = static_cast<Uint8>(byteDist(randomEngine));
+        }
+
+        // Compress it into a frame, the same way Client::sendBatch() does.
+        BinaryBuffer frame(SERVER_HEADER_SIZE
+                           + ByteTools::compressBound(batch.size()));
+        std::size_t compressedSize{compressor.compress(
+            batch.data(), batch.size(), (frame.data() + SERVER_HEADER_SIZE),
+            (frame.size() - SERVER_HEADER_SIZE))};
+        REQUIRE(compressedSize > 0);
+        REQUIRE(compressedSize <= SharedConfig::MAX_BATCH_SIZE);
+        ByteTools::write16(
+            static_cast<Uint16>(compressedSize | (1U << 15)),
+            (frame.data() + ServerHeaderIndex::BatchSize));
+
+        // Send the frame through a peer, in wire-sized pieces.
+        auto [serverSocket, clientSocket] = LoopbackSocket::createPair();
+        Peer serverPeer{std::move(serverSocket)};
+        Peer clientPeer{std::move(clientSocket)};
+        std::size_t frameSize{SERVER_HEADER_SIZE + compressedSize};
+        for (std::size_t sendIndex = 0; sendIndex < frameSize;
+             sendIndex += Peer::MAX_WIRE_SIZE) {
+            unsigned int bytesToSend{static_cast<unsigned int>(std::min(
+                (frameSize - sendIndex),
+                static_cast<std::size_t>(Peer::MAX_WIRE_SIZE)))};
+            REQUIRE(serverPeer.send((frame.data() + sendIndex), bytesToSend)
+                    == NetworkResult::Success);
+        }
+
+        // Receive it the same way the client does.
+        BinaryBuffer header(SERVER_HEADER_SIZE);
+        BinaryBuffer body(SharedConfig::MAX_BATCH_SIZE);
+        Uint16 bodySize{0};
+        REQUIRE(clientPeer.receiveFrameWait(header.data(), SERVER_HEADER_SIZE,
+                                            ServerHeaderIndex::BatchSize,
+                                            body.data(),
+                                            SharedConfig::MAX_BATCH_SIZE,
+                                            bodySize)
+                == NetworkResult::Success);
+        REQUIRE(bodySize == compressedSize);
+
+        // Decompress it and check that it matches.
+        std::size_t decompressedSize{0};
+        Uint8* decompressed{
+            decompressor.decompress(body.data(), bodySize, decompressedSize)};
+        REQUIRE(decompressed != nullptr);
+        REQUIRE(decompressedSize == batch.size());
+        REQUIRE(std::equal(batch.begin(), batch.end(), decompressed));
+    }
+
+    SECTION("Batches compress against the stream's history")
+    {
+        BinaryBuffer batch(500);
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            batch[i] = static_cast<Uint8>(i % 7);
+        }
+
+        BinaryBuffer compressed(ByteTools::compressBound(batch.size()));
+        for (unsigned int i = 0; i < 3; ++i) {
+            std::size_t compressedSize{
+                compressor.compress(batch.data(), batch.size(),
+                                    compressed.data(), compressed.size())};
+            REQUIRE(compressedSize > 0);
+            REQUIRE(compressedSize < batch.size());
+
+            std::size_t decompressedSize{0};
+            Uint8* decompressed{decompressor.decompress(
+                compressed.data(), compressedSize, decompressedSize)};
+            REQUIRE(decompressed != nullptr);
+            REQUIRE(decompressedSize == batch.size());
+            REQUIRE(std::equal(batch.begin(), batch.end(), decompressed));
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#include "catch2/catch_all.hpp"
+#include "SystemProfiler.h"
+
+using namespace AM;
+
+TEST_CASE("TestSystemProfiler")
+{
+    SystemProfiler profiler{"Test", 1, {"SystemA", "SystemB"}};
+
+    SECTION("Report holds each system's percentiles")
+    {
+        for (Uint32 i = 1; i <= 100; ++i) {
+            profiler.recordDuration(0, i);
+        }
+        profiler.recordDuration(1, 7);
+        profiler.buildReport();
+
+        const std::vector<SystemProfiler::SystemReport>& report{
+            profiler.getLatestReport()};
+        REQUIRE(report.size() == 2);
+        REQUIRE(report[0].name == "SystemA");
+        REQUIRE(report[0].p50Us == 50);
+        REQUIRE(report[0].p99Us == 99);
+        REQUIRE(report[0].maxUs == 100);
+        REQUIRE(report[0].runCount == 100);
+        REQUIRE(report[1].p50Us == 7);
+        REQUIRE(report[1].maxUs == 7);
+        REQUIRE(report[1].runCount == 1);
+    }
+
+    SECTION("Max and run count reset after each report")
+    {
+        profiler.recordDuration(0, 100);
+        profiler.buildReport();
+        profiler.recordDuration(0, 5);
+        profiler.buildReport();
+
+        const SystemProfiler::SystemReport& report{
+            profiler.getLatestReport()[0]};
+        REQUIRE(report.maxUs == 5);
+        REQUIRE(report.runCount == 1);
+    }
+
+    SECTION("Percentiles only use the most recent samples")
+    {
+        // Fill the ring with large values, then overwrite it with small ones.
+        for (std::size_t i = 0; i < SystemProfiler::SAMPLE_COUNT; ++i) {
+            profiler.recordDuration(0, 1000);
+        }
+        for (std::size_t i = 0; i < SystemProfiler::SAMPLE_COUNT; ++i) {
+            profiler.recordDuration(0, 10);
+        }
+        profiler.buildReport();
+
+        const SystemProfiler::SystemReport& report{
+            profiler.getLatestReport()[0]};
+        REQUIRE(report.p99Us == 10);
+        REQUIRE(report.maxUs == 1000);
+    }
+}
@@ -0,0 +1,181 @@
+#include "catch2/catch_all.hpp"
+#include "TileMap.h"
+#include "SpriteData.h"
+#include "PagedMapFile.h"
+#include "ChunkSnapshot.h"
+#include "ChunkPaletteBuilder.h"
+#include "Serialize.h"
+#include "Deserialize.h"
+#include "BinaryBuffer.h"
+#include "Paths.h"
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <chrono>
+#include <thread>
+
+using namespace AM;
+using namespace AM::Server;
+
+namespace
+{
+/** A sprite data file with a single sprite, used if the real one isn't
+    next to the executable. */
+constexpr const char* TEST_SPRITE_DATA{R"({
+    "spriteSheets": [{
+        "sprites": [{
+            "numericID": 0,
+            "displayName": "Test Wall",
+            "stringID": "test_wall",
+            "hasBoundingBox": true,
+            "modelBounds": {"minX": 0, "maxX": 32, "minY": 0, "maxY": 32,
+                            "minZ": 0, "maxZ": 32}
+        }]
+    }]
+})"};
+
+/**
+ * Writes a 2x1 chunk map to the given path. Tile (16, 0) (the first tile of
+ * chunk (1, 0)) has a single layer, holding the given sprite.
+ */
+void writeTestMap(const std::string& mapPath, const std::string& stringID)
+{
+    PagedMapFile::write(
+        mapPath, 2, 1, 1,
+        [&](unsigned int chunkIndex, BinaryBuffer& outBytes) -> Uint32 {
+            ChunkSnapshot chunkSnapshot{};
+            if (chunkIndex == 1) {
+                ChunkPaletteBuilder<std::string> paletteBuilder{
+                    chunkSnapshot.palette};
+                unsigned int paletteIndex{paletteBuilder.getIndex(stringID)};
+                chunkSnapshot.tiles[0].spriteLayers.push_back(
+                    static_cast<Uint8>(paletteIndex));
+            }
+
+            outBytes.resize(Serialize::measureSize(chunkSnapshot));
+            Serialize::toBuffer(outBytes.data(), outBytes.size(),
+                                chunkSnapshot);
+            return 0;
+        });
+}
+
+/**
+ * Runs the map's residency updates until the given chunk is resident, the
+ * same way the sim does each tick.
+ *
+ * @return true if the chunk became resident, else false.
+ */
+bool waitForChunk(TileMap& tileMap, const ChunkPosition& chunkPosition)
+{
+    for (unsigned int i = 0; i < 1000; ++i) {
+        tileMap.requestChunk(chunkPosition);
+        tileMap.updateResidency();
+        if (tileMap.hasChunk(chunkPosition)) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    return false;
+}
+
+} // End anonymous namespace
+
+TEST_CASE("TestTileMap")
+{
+    // If the real sprite data isn't next to the executable, use ours.
+    const std::string spriteDataPath{Paths::BASE_PATH + "SpriteData.json"};
+    bool addedSpriteData{false};
+    if (!(std::filesystem::exists(spriteDataPath))) {
+        std::ofstream spriteDataFile{spriteDataPath};
+        spriteDataFile << TEST_SPRITE_DATA;
+        addedSpriteData = true;
+    }
+
+    SpriteData spriteData{};
+    const Sprite& sprite{spriteData.get(0)};
+    const std::string mapPath{Paths::BASE_PATH + "TileMap.bin"};
+    writeTestMap(mapPath, spriteData.getStringID(0));
+
+    SECTION("Editing a non-resident chunk keeps its saved tiles")
+    {
+        {
+            TileMap tileMap{spriteData};
+            REQUIRE(!(tileMap.hasChunk({1, 0})));
+            REQUIRE(!(tileMap.isResident({16, 0, 1, 1})));
+
+            // Edit a different tile in the non-resident chunk. The edit
+            // should wait for the chunk to load instead of blocking on it.
+            tileMap.setTileSpriteLayer(17, 0, 0, sprite);
+            REQUIRE(!(tileMap.hasChunk({1, 0})));
+
+            // Once the chunk loads, the edit should be applied on top of its
+            // saved tiles.
+            REQUIRE(waitForChunk(tileMap, {1, 0}));
+            REQUIRE(tileMap.getTile(16, 0).spriteLayers.size() == 1);
+            REQUIRE(tileMap.getTile(17, 0).spriteLayers.size() == 1);
+
+            tileMap.save("TileMap.bin");
+        }
+
+        // Both the saved tile and the edit should be in the file.
+        PagedMapFile mapFile{};
+        REQUIRE(mapFile.open(mapPath));
+
+        BinaryBuffer chunkBytes{};
+        REQUIRE(mapFile.readChunkBytes(1, chunkBytes));
+        ChunkSnapshot chunkSnapshot{};
+        REQUIRE(Deserialize::fromBuffer(chunkBytes.data(), chunkBytes.size(),
+                                        chunkSnapshot));
+        REQUIRE(chunkSnapshot.tiles[0].spriteLayers.size() == 1);
+        REQUIRE(chunkSnapshot.tiles[1].spriteLayers.size() == 1);
+    }
+
+    SECTION("Edits that are waiting on their chunk are applied on save")
+    {
+        {
+            TileMap tileMap{spriteData};
+            tileMap.clearTile(17, 0);
+            tileMap.save("TileMap.bin");
+        }
+
+        PagedMapFile mapFile{};
+        REQUIRE(mapFile.open(mapPath));
+
+        BinaryBuffer chunkBytes{};
+        REQUIRE(mapFile.readChunkBytes(1, chunkBytes));
+        ChunkSnapshot chunkSnapshot{};
+        REQUIRE(Deserialize::fromBuffer(chunkBytes.data(), chunkBytes.size(),
+                                        chunkSnapshot));
+        REQUIRE(chunkSnapshot.tiles[0].spriteLayers.size() == 1);
+        REQUIRE(chunkSnapshot.tiles[1].spriteLayers.empty());
+    }
+
+    SECTION("Versions aren't reused after an unsaved run")
+    {
+        Uint32 firstVersion{0};
+        {
+            TileMap tileMap{spriteData};
+            REQUIRE(waitForChunk(tileMap, {0, 0}));
+            tileMap.setTileSpriteLayer(0, 0, 0, sprite);
+            firstVersion = tileMap.getChunkVersion({0, 0});
+        }
+
+        // Put the map back the way it was, as if the first run crashed
+        // before it could save.
+        writeTestMap(mapPath, spriteData.getStringID(0));
+
+        // The same edit should give a different version.
+        TileMap tileMap{spriteData};
+        REQUIRE(waitForChunk(tileMap, {0, 0}));
+        REQUIRE(tileMap.getChunkVersion({0, 0}) == 0);
+        tileMap.setTileSpriteLayer(0, 0, 0, sprite);
+        REQUIRE(tileMap.getChunkVersion({0, 0}) != 0);
+        REQUIRE(tileMap.getChunkVersion({0, 0}) != firstVersion);
+    }
+
+    std::filesystem::remove(mapPath);
+    if (addedSpriteData) {
+        std::filesystem::remove(spriteDataPath);
+    }
+}